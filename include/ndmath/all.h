@@ -13,6 +13,18 @@
     #include "random.h"
     #include "trig.h"
     #include "statistics.h"
+    #include "parallel.h"
+    #include "reduce.h"
+    #include "ufunc.h"
+    #include "mask.h"
+    #include "sort.h"
+    #include "blas.h"
+    #include "decomp.h"
+    #include "cache.h"
+    #include "backend.h"
+    #include "sparse.h"
+    #include "iterative.h"
+    #include "batched.h"
 
 
 #endif
\ No newline at end of file
@@ -131,18 +131,26 @@ extern ndarray_t deepcopy(ndarray_t *src);
 /**
  * @brief Finds indices of minimum values along specified axis
  * @param this Pointer to the input array
- * @param axis String specifying the axis ("rows", "cols", or NULL for flattened array)
+ * @param axis String specifying the axis: "x" (column index per row, (rows, 1)),
+ *             "y" (row index per column, (1, cols)) or "all" (flat row-major
+ *             index, (1, 1))
  * @return ndarray_t containing indices of minimum values
- * @note Returns indices, not the actual minimum values
+ * @note Returns indices, not the actual minimum values; see nd_minmax() to get
+ *       both in one pass
+ * @note Ties resolve to the first occurrence; NaN values are skipped
  */
 extern ndarray_t argmin(ndarray_t *this, char *axis);
 
 /**
  * @brief Finds indices of maximum values along specified axis
  * @param this Pointer to the input array
- * @param axis String specifying the axis ("rows", "cols", or NULL for flattened array)
+ * @param axis String specifying the axis: "x" (column index per row, (rows, 1)),
+ *             "y" (row index per column, (1, cols)) or "all" (flat row-major
+ *             index, (1, 1))
  * @return ndarray_t containing indices of maximum values
- * @note Returns indices, not the actual maximum values
+ * @note Returns indices, not the actual maximum values; see nd_minmax() to get
+ *       both in one pass
+ * @note Ties resolve to the first occurrence; NaN values are skipped
  */
 extern ndarray_t argmax(ndarray_t *this, char *axis);
 
@@ -224,6 +232,26 @@ extern ndarray_t row_index(ndarray_t *this, int row);
  */
 extern ndarray_t get_lines(ndarray_t *this, int *line_numbers, int number);
 
+/**
+ * @brief Views a rectangular block of an array without copying it
+ * @param this Pointer to the source array
+ * @param row First row of the block
+ * @param col First column of the block
+ * @param rows Number of rows in the block
+ * @param cols Number of columns in the block
+ * @return ndarray_t whose rows point into the source rows; writes through the
+ *         view change the source
+ * @note Release with nd_view_free(), never with clean()
+ * @warning The view is invalid once the source is freed or its rows are reordered
+ */
+extern ndarray_t nd_view(ndarray_t *this, size_t row, size_t col, size_t rows, size_t cols);
+
+/**
+ * @brief Releases a view created by nd_view(), leaving the source untouched
+ * @param view Pointer to the view
+ */
+extern void nd_view_free(ndarray_t *view);
+
 /* ========================================================================== */
 /*                           ASSIGNMENT FUNCTIONS                            */
 /* ========================================================================== */
@@ -0,0 +1,119 @@
+/**
+ * @file backend.h
+ * @brief Optional external BLAS/LAPACK backend for the dense kernels
+ *
+ * This header file provides the switch between the built-in kernels and a
+ * vendor BLAS/LAPACK (OpenBLAS, MKL, BLIS with its LAPACK, ...) linked in at
+ * build time. With the backend compiled in and selected:
+ *
+ * - nd_gemm() and nd_sgemm(), and with them matmul() and every blocked
+ *   algorithm, call cblas_dgemm() / cblas_sgemm(); A Aᵀ and Aᵀ A use
+ *   cblas_dsyrk() so that they stay exactly symmetric
+ * - nd_lu(), and with it inv(), det(), nd_slogdet() and the LU solves, calls
+ *   dgetrf
+ * - qr() calls dgeqrf and dorgqr
+ * - eig() calls dsyevd for symmetric input and dgeev otherwise
+ * - svd() calls dgesdd
+ *
+ * The operands are copied into contiguous column-major (LAPACK) or row-major
+ * (CBLAS) buffers, as ndarray_t rows are separate allocations; the copies
+ * are O(n²) against O(n³) work, and products below a few million
+ * multiply-adds stay on the built-in kernels. Every other function, and every
+ * call when the backend is not built in, uses the built-in kernels, so
+ * results only differ by rounding.
+ *
+ * The backend is compiled in with `make BLAS=openblas`, or
+ * `make BLAS_LIBS="-lcblas -llapack -lblas"` for split libraries: this
+ * defines ND_USE_CBLAS and links the libraries given. LAPACK is called
+ * through its Fortran interface, so only cblas.h is needed at build time.
+ *
+ * @author [Your Name]
+ * @date [Date]
+ * @version 1.0
+ *
+ * @note The selection is process-wide. It may be changed while other threads
+ *       use the library; calls already running may finish on either backend
+ */
+
+#ifndef BACKEND
+#define BACKEND
+
+#include "ndarray.h"
+#include "blas.h"
+#include "decomp.h"
+
+/* ========================================================================== */
+/*                                  TYPES                                    */
+/* ========================================================================== */
+
+/** @brief Kernels used by the dense linear algebra */
+typedef enum {
+    ND_BACKEND_BUILTIN = 0,     /**< The kernels of blas.c and decomp.c */
+    ND_BACKEND_EXTERNAL         /**< The CBLAS/LAPACK linked in at build time */
+} nd_backend_t;
+
+/* ========================================================================== */
+/*                               SELECTION                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Selects the kernels used from now on
+ * @param backend ND_BACKEND_EXTERNAL or ND_BACKEND_BUILTIN
+ * @return bool False, with the selection unchanged, when the external backend
+ *         was not compiled in
+ * @note The initial selection is external when it is compiled in, unless the
+ *       environment sets NDMATH_BACKEND=builtin
+ *
+ * @code
+ * nd_set_backend(ND_BACKEND_BUILTIN);   // e.g. to compare results
+ * ndarray_t C = matmul(&A, &B);
+ * nd_set_backend(ND_BACKEND_EXTERNAL);
+ * @endcode
+ */
+extern bool nd_set_backend(nd_backend_t backend);
+
+/**
+ * @brief Kernels currently selected
+ * @return nd_backend_t ND_BACKEND_EXTERNAL only when compiled in and selected
+ */
+extern nd_backend_t nd_get_backend(void);
+
+/**
+ * @brief Name of the external library, for logs
+ * @return const char* The configuration string of the library when it
+ *         provides one, "cblas" otherwise, or "builtin" when not compiled in
+ */
+extern const char *nd_backend_name(void);
+
+/* ========================================================================== */
+/*                        DISPATCH (used by the library)                     */
+/* ========================================================================== */
+
+/*
+ * Each call returns false, leaving its outputs untouched, when the external
+ * backend is not selected or the problem is too small or too large for it;
+ * the caller then runs its built-in kernel.
+ */
+
+/** @brief C = alpha op(A) op(B) + beta C through cblas_dgemm(), shapes already checked */
+extern bool nd_backend_gemm(nd_transpose_t transA, nd_transpose_t transB, double alpha,
+                            ndarray_t *A, ndarray_t *B, double beta, ndarray_t *C);
+
+/** @brief nd_sgemm() through cblas_sgemm() */
+extern bool nd_backend_sgemm(nd_transpose_t transA, nd_transpose_t transB, size_t m, size_t n, size_t k,
+                             float alpha, const float *A, size_t lda, const float *B, size_t ldb,
+                             float beta, float *C, size_t ldc);
+
+/** @brief Partial-pivoting LU of square A through dgetrf, filling lu as nd_lu() does */
+extern bool nd_backend_lu(ndarray_t *A, nd_lu_t *lu);
+
+/** @brief Thin QR of A through dgeqrf and dorgqr: Q is m x k and R is k x n, k = min(m, n) */
+extern bool nd_backend_qr(ndarray_t *A, ndarray_t *Q, ndarray_t *R);
+
+/** @brief 1 x n eigenvalues of square A: ascending through dsyevd when symmetric, the real parts from dgeev otherwise */
+extern bool nd_backend_eigvals(ndarray_t *A, bool symmetric, ndarray_t *values);
+
+/** @brief 1 x min(m, n) singular values of A in descending order through dgesdd */
+extern bool nd_backend_svdvals(ndarray_t *A, ndarray_t *values);
+
+#endif // !BACKEND
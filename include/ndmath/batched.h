@@ -0,0 +1,66 @@
+/**
+ * @file batched.h
+ * @brief Many small independent linear systems solved at once
+ *
+ * This header file provides solves and inverses for batches of small dense
+ * matrices, such as a 3x3 color transform per pixel or a 6x6 constraint per
+ * particle, where calling inv() or nd_lu() per item would spend more time in
+ * allocations and calls than in arithmetic:
+ *
+ * - A batch of count n x n matrices is a count x (n * n) ndarray, one matrix
+ *   per row stored row-major, so a batch of 3x3 matrices has 9 columns
+ * - A batch of right-hand sides is a count x (n * k) ndarray, one n x k
+ *   block per row stored row-major (k = 1: one vector per row)
+ *
+ * Items are solved 8 at a time, one per SIMD lane: each group is transposed
+ * into a structure-of-arrays buffer and eliminated with branch-free partial
+ * pivoting, so every operation runs across the 8 items at once. Groups are
+ * spread over the worker pool (see parallel.h).
+ *
+ * @author [Your Name]
+ * @date [Date]
+ * @version 1.0
+ *
+ * @note An item whose matrix is exactly singular gets a row of NaN in the
+ *       result instead of stopping the whole batch
+ */
+
+#ifndef BATCHED
+#define BATCHED
+
+#include "ndarray.h"
+
+/* ========================================================================== */
+/*                                 SOLVES                                    */
+/* ========================================================================== */
+
+/**
+ * @brief Solves A_i X_i = B_i for every item i of a batch
+ * @param A_batch count x (n * n) batch of square matrices, left unchanged
+ * @param b_batch count x (n * k) batch of right-hand sides, left unchanged
+ * @return ndarray_t New count x (n * k) array holding the X_i in the layout of b_batch
+ * @note Gaussian elimination with partial pivoting, as nd_lu(); the rows of
+ *       singular items are NaN
+ * @warning Exits with a dimension message when A_batch does not have a square
+ *          number of columns, when the batches differ in length, or when the
+ *          columns of b_batch are not a multiple of n
+ *
+ * @code
+ * // 3x3 systems, one per pixel: M is count x 9, rgb is count x 3
+ * ndarray_t x = nd_batched_solve(&M, &rgb);
+ * @endcode
+ */
+extern ndarray_t nd_batched_solve(ndarray_t *A_batch, ndarray_t *b_batch);
+
+/**
+ * @brief Inverts every matrix of a batch
+ * @param A_batch count x (n * n) batch of square matrices, left unchanged
+ * @return ndarray_t New count x (n * n) array holding the inverses, row-major
+ * @note Same elimination as nd_batched_solve() against the identity; the
+ *       rows of singular items are NaN
+ * @warning Exits with a dimension message when A_batch does not have a square
+ *          number of columns
+ */
+extern ndarray_t nd_batched_inv(ndarray_t *A_batch);
+
+#endif // !BATCHED
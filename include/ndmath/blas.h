@@ -0,0 +1,194 @@
+/**
+ * @file blas.h
+ * @brief Dense matrix kernels (BLAS level 3) for ndarray structures
+ *
+ * This header file provides the general matrix multiply behind matmul() and
+ * the factorizations of linalg.h. The implementation follows the classic
+ * layered design of high-performance GEMM:
+ *
+ * - op(B) is packed into kc x nc panels of nr-wide column slivers (L2)
+ * - op(A) is packed into mc x kc blocks of mr-tall row slivers (L3), with
+ *   alpha folded into the packed values
+ * - A register-blocked microkernel multiplies one mr x kc sliver (L1) by
+ *   one kc x nr sliver streamed from L2 and accumulates the mr x nr tile
+ *   into C
+ *
+ * Large products run on the worker pool (see parallel.h). The threads form a
+ * grid over C: tall-skinny products are split by rows, short-wide ones by
+ * columns, and square ones both ways. Each B panel is packed once and
+ * shared, and every thread packs its rows of A into its own buffer. The
+ * buffer is first touched by that thread, so it is local to its NUMA node.
+ *
+ * The microkernel is selected once at run time: AVX-512 (8 x 24 tile) or
+ * AVX2/FMA (6 x 8 tile) on x86-64 processors that support them, and a
+ * portable C kernel elsewhere. Packing reads rows through the row pointers,
+ * so the operands do not need to be contiguous.
+ *
+ * nd_trsm() and nd_trmm() solve with and multiply by a triangular matrix.
+ * The triangle is halved recursively and the block coupling the halves is
+ * applied with nd_gemm(), so only triangles of order 32 or less are handled
+ * by plain substitution and the bulk of the flops runs in the microkernel.
+ *
+ * nd_sgemm() is the single precision counterpart over plain row-major float
+ * storage, with tiles twice as wide (8 x 48 with AVX-512). It serves the
+ * float32 factorizations of nd_solve_mixed() (see decomp.h).
+ *
+ * @author [Your Name]
+ * @date [Date]
+ * @version 1.0
+ */
+
+#ifndef BLAS
+#define BLAS
+
+#include "ndarray.h"
+
+/* ========================================================================== */
+/*                                 TYPES                                     */
+/* ========================================================================== */
+
+/**
+ * @brief Whether an operand is used as stored or transposed
+ */
+typedef enum {
+    ND_NO_TRANS = 0,    /**< op(X) = X */
+    ND_TRANS            /**< op(X) = Xᵀ */
+} nd_transpose_t;
+
+/**
+ * @brief Side of the triangular operand in nd_trsm() and nd_trmm()
+ */
+typedef enum {
+    ND_LEFT = 0,        /**< op(A) X */
+    ND_RIGHT            /**< X op(A) */
+} nd_side_t;
+
+/**
+ * @brief Triangle of A that is read; the other one is never accessed
+ */
+typedef enum {
+    ND_LOWER = 0,       /**< A is lower triangular */
+    ND_UPPER            /**< A is upper triangular */
+} nd_uplo_t;
+
+/**
+ * @brief Whether the diagonal of a triangular operand is used
+ */
+typedef enum {
+    ND_NON_UNIT = 0,    /**< The stored diagonal */
+    ND_UNIT             /**< Ones, whatever is stored (as in an LU factor) */
+} nd_diag_t;
+
+/* ========================================================================== */
+/*                         GENERAL MATRIX MULTIPLY                           */
+/* ========================================================================== */
+
+/**
+ * @brief General matrix multiply: C = alpha * op(A) * op(B) + beta * C
+ * @param transA ND_TRANS to use Aᵀ instead of A
+ * @param transB ND_TRANS to use Bᵀ instead of B
+ * @param alpha Scale applied to the product
+ * @param A Left operand, op(A) is m x k
+ * @param B Right operand, op(B) is k x n
+ * @param beta Scale applied to the existing contents of C; when beta is 0
+ *             C is overwritten and its previous contents (even NaN) ignored
+ * @param C Output, already allocated as m x n
+ * @warning Exits with a dimension message when the shapes do not agree
+ * @warning C must not share storage with A or B
+ *
+ * @code
+ * ndarray_t C = zeros(A.shape[0], B.shape[0]);
+ * nd_gemm(ND_NO_TRANS, ND_TRANS, 1.0, &A, &B, 0.0, &C);   // C = A * Bᵀ
+ * @endcode
+ */
+extern void nd_gemm(nd_transpose_t transA, nd_transpose_t transB, double alpha,
+                    ndarray_t *A, ndarray_t *B, double beta, ndarray_t *C);
+
+/* ========================================================================== */
+/*                           TRIANGULAR MATRICES                             */
+/* ========================================================================== */
+
+/**
+ * @brief Triangular solve with many right-hand sides:
+ *        X = alpha * op(A)⁻¹ * B, or X = alpha * B * op(A)⁻¹ with ND_RIGHT
+ * @param side ND_LEFT or ND_RIGHT, the side of op(A)
+ * @param uplo Triangle of A that is stored
+ * @param transA ND_TRANS to use Aᵀ instead of A
+ * @param diag ND_UNIT to take the diagonal of A as ones
+ * @param alpha Scale applied to B
+ * @param A Square triangular matrix, left unchanged
+ * @param B Right-hand sides: n x nrhs with ND_LEFT, nrhs x n with ND_RIGHT
+ * @param X Output with the shape of B, already allocated; pass B itself to
+ *          solve in place
+ * @note A zero on the diagonal gives infinities or NaN, as in BLAS; check the
+ *       factorization for singularity beforehand
+ * @warning Exits with a matrix error when A is not square and with a
+ *          dimension message when the shapes do not agree
+ * @warning X must not share storage with A, nor with B unless it is B
+ *
+ * @code
+ * // With an unpivoted A = L U: solve A X = B in place
+ * nd_trsm(ND_LEFT, ND_LOWER, ND_NO_TRANS, ND_UNIT, 1.0, &LU, &B, &B);
+ * nd_trsm(ND_LEFT, ND_UPPER, ND_NO_TRANS, ND_NON_UNIT, 1.0, &LU, &B, &B);
+ * @endcode
+ */
+extern void nd_trsm(nd_side_t side, nd_uplo_t uplo, nd_transpose_t transA, nd_diag_t diag, double alpha,
+                    ndarray_t *A, ndarray_t *B, ndarray_t *X);
+
+/**
+ * @brief Triangular matrix multiply:
+ *        X = alpha * op(A) * B, or X = alpha * B * op(A) with ND_RIGHT
+ * @param side ND_LEFT or ND_RIGHT, the side of op(A)
+ * @param uplo Triangle of A that is stored
+ * @param transA ND_TRANS to use Aᵀ instead of A
+ * @param diag ND_UNIT to take the diagonal of A as ones
+ * @param alpha Scale applied to the product
+ * @param A Square triangular matrix, left unchanged
+ * @param B n x ncols with ND_LEFT, nrows x n with ND_RIGHT
+ * @param X Output with the shape of B, already allocated; pass B itself to
+ *          multiply in place
+ * @note Half the flops of nd_gemm() with the full matrix, and no copy of
+ *       the triangle is made
+ * @warning Exits with a matrix error when A is not square and with a
+ *          dimension message when the shapes do not agree
+ * @warning X must not share storage with A, nor with B unless it is B
+ *
+ * @code
+ * // Rebuild A = L Lᵀ from a Cholesky factor
+ * ndarray_t A = transpose(&L);
+ * nd_trmm(ND_LEFT, ND_LOWER, ND_NO_TRANS, ND_NON_UNIT, 1.0, &L, &A, &A);
+ * @endcode
+ */
+extern void nd_trmm(nd_side_t side, nd_uplo_t uplo, nd_transpose_t transA, nd_diag_t diag, double alpha,
+                    ndarray_t *A, ndarray_t *B, ndarray_t *X);
+
+/**
+ * @brief Single precision general matrix multiply on row-major storage:
+ *        C = alpha * op(A) * op(B) + beta * C
+ * @param transA ND_TRANS to use Aᵀ instead of A
+ * @param transB ND_TRANS to use Bᵀ instead of B
+ * @param m Rows of op(A) and C
+ * @param n Columns of op(B) and C
+ * @param k Columns of op(A), rows of op(B)
+ * @param alpha Scale applied to the product
+ * @param A Element (0, 0) of A; row i starts at A + i * lda
+ * @param lda Distance between rows of A, in floats
+ * @param B Element (0, 0) of B; row i starts at B + i * ldb
+ * @param ldb Distance between rows of B, in floats
+ * @param beta Scale applied to C; when beta is 0 C is overwritten
+ * @param C Element (0, 0) of C; row i starts at C + i * ldc
+ * @param ldc Distance between rows of C, in floats
+ * @note Leading dimensions let A, B and C be blocks of larger matrices
+ * @warning C must not share storage with A or B
+ *
+ * @code
+ * // Trailing update of a blocked factorization: A22 -= A21 * A12
+ * nd_sgemm(ND_NO_TRANS, ND_NO_TRANS, n - j, n - j, nb, -1.0f,
+ *          a + j * n + j - nb, n, a + (j - nb) * n + j, n, 1.0f, a + j * n + j, n);
+ * @endcode
+ */
+extern void nd_sgemm(nd_transpose_t transA, nd_transpose_t transB, size_t m, size_t n, size_t k,
+                     float alpha, const float *A, size_t lda, const float *B, size_t ldb,
+                     float beta, float *C, size_t ldc);
+
+#endif // !BLAS
@@ -0,0 +1,143 @@
+/**
+ * @file cache.h
+ * @brief Least-recently-used cache of matrix factorizations
+ *
+ * This header file provides an opt-in cache for programs that solve against
+ * the same few coefficient matrices many times. Factorizations (LU, Cholesky
+ * or QR, see decomp.h) are kept under a memory budget and found again by the
+ * contents of the matrix, so a repeated solve costs O(n²) for hashing,
+ * comparison and substitution instead of an O(n³) factorization:
+ *
+ * - A budget in bytes, 0 (the default) disabling the cache
+ * - Solves, inv() and det() that reuse cached factorizations
+ * - Borrowed access to a cached factorization for any other use
+ * - Hit, miss and eviction counters
+ *
+ * Entries are keyed by a 64-bit hash of the shape and every value of the
+ * matrix, so changing any element (or passing a different array with equal
+ * contents) is handled without invalidation calls. Each entry keeps a copy of
+ * its matrix, compared on a hash match, so a hash collision is a miss rather
+ * than the factorization of another matrix; the copy counts against the
+ * budget.
+ *
+ * @author [Your Name]
+ * @date [Date]
+ * @version 1.0
+ *
+ * @note The cache is shared by all threads and guarded by a mutex; the
+ *       factorizations themselves run outside of it
+ */
+
+#ifndef CACHE
+#define CACHE
+
+#include "ndarray.h"
+#include "decomp.h"
+
+/* ========================================================================== */
+/*                                  TYPES                                    */
+/* ========================================================================== */
+
+/** @brief Factorization kinds */
+typedef enum {
+    ND_FACT_LU,         /**< nd_lu(): square A */
+    ND_FACT_CHOLESKY,   /**< nd_cholesky(): symmetric positive definite A */
+    ND_FACT_QR          /**< nd_qr() with column pivoting: any m x n A */
+} nd_fact_kind_t;
+
+/**
+ * @brief Factorization borrowed from the cache
+ * @note Only the member matching kind is set
+ */
+typedef struct {
+    nd_fact_kind_t kind;    /**< Which factorization is held */
+    nd_lu_t lu;             /**< ND_FACT_LU */
+    nd_cholesky_t chol;     /**< ND_FACT_CHOLESKY */
+    nd_qr_t qr;             /**< ND_FACT_QR */
+} nd_factorization_t;
+
+/** @brief Cache counters since the last nd_cache_clear() */
+typedef struct {
+    size_t hits;        /**< Lookups served from the cache */
+    size_t misses;      /**< Lookups that factored the matrix */
+    size_t evictions;   /**< Entries dropped to stay under the budget */
+    size_t entries;     /**< Factorizations held now */
+    size_t bytes;       /**< Memory held now */
+    size_t budget;      /**< Current budget in bytes */
+} nd_cache_stats_t;
+
+/* ========================================================================== */
+/*                               SETTINGS                                    */
+/* ========================================================================== */
+
+/**
+ * @brief Sets the memory budget of the cache
+ * @param bytes Most bytes of factorizations kept; 0 disables the cache and
+ *              empties it. The initial budget is NDMATH_FACTOR_CACHE from the
+ *              environment, or 0
+ * @note Least recently used entries are evicted to fit the new budget; a
+ *       factorization larger than the whole budget is never cached
+ */
+extern void nd_cache_set_budget(size_t bytes);
+
+/**
+ * @brief Drops every cached factorization and resets the counters
+ * @note Factorizations still borrowed are released by nd_cache_release()
+ */
+extern void nd_cache_clear(void);
+
+/**
+ * @brief Current counters and memory use
+ * @return nd_cache_stats_t Snapshot of the counters
+ */
+extern nd_cache_stats_t nd_cache_stats(void);
+
+/* ========================================================================== */
+/*                                LOOKUPS                                    */
+/* ========================================================================== */
+
+/**
+ * @brief Borrows the factorization of A, computing and caching it on a miss
+ * @param A Pointer to the matrix, left unchanged
+ * @param kind Factorization wanted
+ * @return nd_factorization_t* Factorization valid until nd_cache_release(),
+ *         even if it is evicted meanwhile; it is shared and must not be
+ *         modified
+ * @note Works with the cache disabled too: the factorization is then computed
+ *       for this call only and freed by nd_cache_release()
+ * @warning Exits with a shape error when A is not square for LU or Cholesky
+ *
+ * @code
+ * nd_factorization_t *f = nd_cache_acquire(&A, ND_FACT_LU);
+ * if(!f->lu.singular)
+ *     X = nd_lu_solve(&f->lu, &B);
+ * nd_cache_release(f);
+ * @endcode
+ */
+extern nd_factorization_t *nd_cache_acquire(ndarray_t *A, nd_fact_kind_t kind);
+
+/**
+ * @brief Returns a factorization borrowed with nd_cache_acquire()
+ * @param f Pointer returned by nd_cache_acquire(), not used afterwards
+ */
+extern void nd_cache_release(nd_factorization_t *f);
+
+/**
+ * @brief Solves A X = B with a cached factorization of A
+ * @param A Pointer to the matrix, left unchanged
+ * @param B Right-hand sides, with as many rows as A
+ * @param kind ND_FACT_LU or ND_FACT_CHOLESKY for square A, ND_FACT_QR for
+ *             the least-squares solution of an m x n A with m >= n
+ * @return ndarray_t New n x nrhs solution
+ * @warning Exits with a singular error when A is singular (or not positive
+ *          definite for ND_FACT_CHOLESKY), and with a dimension message when
+ *          B does not have as many rows as A
+ *
+ * @code
+ * nd_cache_set_budget(64 << 20);   // once, at start-up
+ * ndarray_t x = nd_cache_solve(&A, &b, ND_FACT_LU);
+ * @endcode
+ */
+extern ndarray_t nd_cache_solve(ndarray_t *A, ndarray_t *B, nd_fact_kind_t kind);
+
+#endif // !CACHE
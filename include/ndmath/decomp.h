@@ -0,0 +1,553 @@
+/**
+ * @file decomp.h
+ * @brief Matrix factorizations and the solvers built on them
+ *
+ * This header file provides factorization objects that are computed once and
+ * reused for any number of solves. The factorizations are recursive: the
+ * columns are split in halves down to narrow leaf panels, and every update
+ * between halves is an nd_gemm() call (see blas.h), so almost all of the
+ * work runs through the packed, threaded matrix multiply.
+ *
+ * - LU with partial pivoting: PA = LU for square A
+ * - Cholesky: A = LLᵀ for symmetric positive definite A, blocked and
+ *   right-looking, with the trailing update split into GEMM block columns
+ * - Householder QR: A = QR (or AP = QR with column pivoting) for any m x n A,
+ *   with Q kept as blocks of reflectors in compact WY form, I - V T Vᵀ
+ * - Symmetric eigendecomposition: A = V diag(λ) Vᵀ through Householder
+ *   reduction to tridiagonal form, then QL iteration (values only), divide
+ *   and conquer (all vectors) or bisection and inverse iteration (a subset)
+ * - Singular value decomposition: A = U Σ Vᵀ through Householder reduction
+ *   to bidiagonal form, then implicit QR on the bidiagonal matrix
+ * - Randomized rank-k SVD from a sampled range of A, for matrices too large
+ *   to decompose fully
+ * - Least squares through QR, or through the SVD of R when A is ill
+ *   conditioned, and normal equations accumulated over row batches
+ * - Mixed-precision solves: LU or Cholesky in float32 through nd_sgemm(),
+ *   refined to double accuracy with residuals computed in double
+ *
+ * Row exchanges swap row pointers, so pivoting never moves matrix data.
+ *
+ * @author [Your Name]
+ * @date [Date]
+ * @version 1.0
+ *
+ * @note Factorizations own their storage; release them with the matching
+ *       free function
+ */
+
+#ifndef DECOMP
+#define DECOMP
+
+#include "ndarray.h"
+
+/* ========================================================================== */
+/*                                 TYPES                                     */
+/* ========================================================================== */
+
+/**
+ * @brief LU factorization with partial pivoting, PA = LU
+ */
+typedef struct {
+    ndarray_t LU;       /**< n x n: unit lower L below the diagonal, U on and above it */
+    size_t *perm;       /**< Row i of LU comes from row perm[i] of A */
+    int sign;           /**< Sign of the permutation, +1 or -1 */
+    bool singular;      /**< An exactly zero pivot was met */
+} nd_lu_t;
+
+/**
+ * @brief Cholesky factorization, A = LLᵀ
+ */
+typedef struct {
+    ndarray_t L;        /**< n x n lower triangular factor, zero above the diagonal */
+    double logdet;      /**< log(det(A)) = 2 * sum(log(L[i][i])), NaN when indefinite */
+    bool indefinite;    /**< A pivot was not positive; L is incomplete */
+} nd_cholesky_t;
+
+/**
+ * @brief Householder QR factorization, AP = QR
+ *
+ * Q is never formed: the reflectors are stored below the diagonal of QR and
+ * applied on demand by nd_qr_apply_qt() and nd_qr_apply_q(), in blocks of 64
+ * with their T factors.
+ */
+typedef struct {
+    ndarray_t QR;       /**< m x n: R on and above the diagonal, reflectors below it */
+    ndarray_t T;        /**< Triangular factors of the reflector blocks, side by side */
+    double *tau;        /**< min(m, n) reflector scales */
+    size_t *perm;       /**< Column i of R comes from column perm[i] of A */
+    bool pivoted;       /**< Columns were pivoted; otherwise perm is the identity */
+} nd_qr_t;
+
+/**
+ * @brief Eigenvalues and eigenvectors of a symmetric matrix, A V = V diag(λ)
+ */
+typedef struct {
+    ndarray_t values;   /**< 1 x k eigenvalues in ascending order */
+    ndarray_t vectors;  /**< n x k unit eigenvectors as columns, orthogonal; no data when not requested */
+    bool converged;     /**< Every eigenvalue converged; false only for input such as NaN */
+} nd_eigh_t;
+
+/**
+ * @brief Which parts of the SVD to compute
+ */
+typedef enum {
+    ND_SVD_VALUES = 0,  /**< Singular values only */
+    ND_SVD_THIN,        /**< U is m x k and Vᵀ is k x n, k = min(m, n) */
+    ND_SVD_FULL         /**< U is m x m and Vᵀ is n x n */
+} nd_svd_mode_t;
+
+/**
+ * @brief Singular value decomposition, A = U diag(S) Vᵀ
+ */
+typedef struct {
+    ndarray_t U;        /**< Left singular vectors as columns; no data for ND_SVD_VALUES */
+    ndarray_t S;        /**< 1 x min(m, n) singular values in descending order */
+    ndarray_t Vt;       /**< Right singular vectors as rows; no data for ND_SVD_VALUES */
+    bool converged;     /**< Every singular value converged; false only for input such as NaN */
+} nd_svd_t;
+
+/**
+ * @brief Least-squares solution of A X ≈ B
+ */
+typedef struct {
+    ndarray_t x;        /**< n x nrhs minimizer of |A X - B|, of least norm when A is rank deficient */
+    size_t rank;        /**< Numerical rank of A */
+    double rcond;       /**< 1 / cond(A): a 1-norm estimate on the QR path, S[k-1] / S[0] on the SVD path */
+    bool used_svd;      /**< Solved through the SVD of R; otherwise by back substitution with R */
+} nd_lstsq_t;
+
+/**
+ * @brief Normal equations AᵀA X = AᵀB summed over row batches of A and B
+ */
+typedef struct {
+    ndarray_t AtA;      /**< n x n sum of AᵀA over the batches */
+    ndarray_t AtB;      /**< n x nrhs sum of AᵀB over the batches */
+    size_t rows;        /**< Rows accumulated so far */
+} nd_normal_eq_t;
+
+/**
+ * @brief Solution of A X = B by a float32 factorization and float64 refinement
+ */
+typedef struct {
+    ndarray_t x;        /**< n x nrhs solution */
+    size_t iterations;  /**< Refinement steps, each one O(n² nrhs) */
+    bool cholesky;      /**< A was factored by Cholesky; otherwise by LU */
+    bool fallback;      /**< Refinement did not converge and x comes from a double factorization */
+} nd_mixed_t;
+
+/* ========================================================================== */
+/*                            LU FACTORIZATION                               */
+/* ========================================================================== */
+
+/**
+ * @brief Factors a square matrix as PA = LU with partial pivoting
+ * @param this Pointer to a square ndarray, left unchanged
+ * @return nd_lu_t The factorization; release it with nd_lu_free()
+ * @note A singular matrix is still factored completely, with singular set
+ *       and a zero on the diagonal of U, so det() of it is 0
+ * @warning Exits with a matrix error when this is not square
+ *
+ * @code
+ * nd_lu_t lu = nd_lu(&A);
+ * ndarray_t X = nd_lu_solve(&lu, &B);   // A X = B, any number of columns
+ * nd_lu_free(&lu);
+ * @endcode
+ */
+extern nd_lu_t nd_lu(ndarray_t *this);
+
+/**
+ * @brief Solves A X = B with a factorization from nd_lu()
+ * @param lu Pointer to the factorization of A
+ * @param B Right-hand sides, n x nrhs
+ * @return ndarray_t New n x nrhs array holding X
+ * @note Recursive forward and back substitution: the off-diagonal blocks go
+ *       through nd_gemm(), so many right-hand sides run at GEMM speed
+ * @warning Exits with a singular error when A is singular, and with a
+ *          dimension message when B does not have n rows
+ */
+extern ndarray_t nd_lu_solve(nd_lu_t *lu, ndarray_t *B);
+
+/**
+ * @brief Releases a factorization returned by nd_lu()
+ * @param lu Pointer to the factorization
+ */
+extern void nd_lu_free(nd_lu_t *lu);
+
+/* ========================================================================== */
+/*                         CHOLESKY FACTORIZATION                            */
+/* ========================================================================== */
+
+/**
+ * @brief Factors a symmetric positive definite matrix as A = LLᵀ
+ * @param this Pointer to a square ndarray, left unchanged; only its lower
+ *             triangle is read
+ * @return nd_cholesky_t The factorization; release it with nd_cholesky_free()
+ * @note Half the work of nd_lu() and no pivoting. logdet stays finite where
+ *       det() would overflow or underflow
+ * @note A matrix that is not positive definite is reported through
+ *       indefinite rather than an exit, so the call doubles as a test
+ * @warning Exits with a matrix error when this is not square
+ *
+ * @code
+ * nd_cholesky_t ch = nd_cholesky(&S);
+ * if(!ch.indefinite)
+ *     X = nd_cholesky_solve(&ch, &B);   // S X = B
+ * nd_cholesky_free(&ch);
+ * @endcode
+ */
+extern nd_cholesky_t nd_cholesky(ndarray_t *this);
+
+/**
+ * @brief Solves A X = B with a factorization from nd_cholesky()
+ * @param chol Pointer to the factorization of A
+ * @param B Right-hand sides, n x nrhs
+ * @return ndarray_t New n x nrhs array holding X
+ * @note Solves L Y = B, then Lᵀ X = Y, with the recursive triangular solves
+ *       used by nd_lu_solve()
+ * @warning Exits with an error when A was not positive definite, and with a
+ *          dimension message when B does not have n rows
+ */
+extern ndarray_t nd_cholesky_solve(nd_cholesky_t *chol, ndarray_t *B);
+
+/**
+ * @brief Updates a factorization of A in place to one of A + x xᵀ
+ * @param chol Pointer to the factorization of A
+ * @param x Vector of n entries, n x 1 or 1 x n, left unchanged
+ * @note One Givens rotation per row of L, so O(n²) instead of the O(n³) of a
+ *       new nd_cholesky(); logdet is updated as well
+ * @warning Exits with an error when A was not positive definite, and with a
+ *          dimension message when x does not have n entries
+ *
+ * @code
+ * nd_cholesky_update(&ch, &row);   // the Gram matrix gained an observation
+ * @endcode
+ */
+extern void nd_cholesky_update(nd_cholesky_t *chol, ndarray_t *x);
+
+/**
+ * @brief Updates a factorization of A in place to one of A - x xᵀ
+ * @param chol Pointer to the factorization of A
+ * @param x Vector of n entries, n x 1 or 1 x n, left unchanged
+ * @return bool False, with chol unchanged, when A - x xᵀ is not positive
+ *         definite or is singular to working precision
+ * @note Solves L p = x, then applies the Givens rotations that take
+ *       [p; sqrt(1 - pᵀp)] to a unit vector (LINPACK dchdd), so O(n²) and
+ *       without the instability of hyperbolic rotations
+ * @warning Exits with an error when A was not positive definite, and with a
+ *          dimension message when x does not have n entries
+ */
+extern bool nd_cholesky_downdate(nd_cholesky_t *chol, ndarray_t *x);
+
+/**
+ * @brief Releases a factorization returned by nd_cholesky()
+ * @param chol Pointer to the factorization
+ */
+extern void nd_cholesky_free(nd_cholesky_t *chol);
+
+/* ========================================================================== */
+/*                            QR FACTORIZATION                               */
+/* ========================================================================== */
+
+/**
+ * @brief Factors an m x n matrix as AP = QR with Householder reflectors
+ * @param this Pointer to the ndarray, left unchanged
+ * @param pivot true to pivot columns by largest remaining norm, which makes
+ *              |R[i][i]| non-increasing and reveals the numerical rank
+ * @return nd_qr_t The factorization; release it with nd_qr_free()
+ * @note Without pivoting, almost all of the work is nd_gemm(): panels are
+ *       factored recursively and applied as block reflectors. Each Householder
+ *       step at the leaves is a single pass over the rows, which keeps tall
+ *       matrices (millions of rows) bandwidth-friendly
+ * @note Pivoting has to look at every column before choosing the next one, so
+ *       half of its work is a pass over the trailing matrix per column
+ *
+ * @code
+ * nd_qr_t f = nd_qr(&A, false);
+ * ndarray_t R = nd_qr_r(&f);
+ * nd_qr_apply_qt(&f, &B);              // B = Qᵀ B, no Q formed
+ * nd_qr_free(&f);
+ * @endcode
+ */
+extern nd_qr_t nd_qr(ndarray_t *this, bool pivot);
+
+/**
+ * @brief Replaces B with Qᵀ B
+ * @param qr Pointer to the factorization of an m x n matrix
+ * @param B m x nrhs array, overwritten
+ * @warning Exits with a dimension message when B does not have m rows
+ */
+extern void nd_qr_apply_qt(nd_qr_t *qr, ndarray_t *B);
+
+/**
+ * @brief Replaces B with Q B
+ * @param qr Pointer to the factorization of an m x n matrix
+ * @param B m x nrhs array, overwritten
+ * @warning Exits with a dimension message when B does not have m rows
+ */
+extern void nd_qr_apply_q(nd_qr_t *qr, ndarray_t *B);
+
+/**
+ * @brief The triangular factor R
+ * @param qr Pointer to the factorization of an m x n matrix
+ * @return ndarray_t New min(m, n) x n upper trapezoidal array
+ */
+extern ndarray_t nd_qr_r(nd_qr_t *qr);
+
+/**
+ * @brief Forms Q explicitly
+ * @param qr Pointer to the factorization of an m x n matrix
+ * @param economy true for the first min(m, n) columns (m x min(m, n)),
+ *                false for the full m x m orthogonal matrix
+ * @return ndarray_t New array holding Q
+ */
+extern ndarray_t nd_qr_q(nd_qr_t *qr, bool economy);
+
+/**
+ * @brief Least-squares solution of A X = B
+ * @param qr Pointer to the factorization of A, m x n with m >= n
+ * @param B Right-hand sides, m x nrhs
+ * @return ndarray_t New n x nrhs array minimizing |A X - B| column by column,
+ *         with the column permutation undone
+ * @warning Exits with a singular error when R has a zero on its diagonal,
+ *          and with a dimension message when m < n or B does not have m rows
+ */
+extern ndarray_t nd_qr_solve(nd_qr_t *qr, ndarray_t *B);
+
+/**
+ * @brief Releases a factorization returned by nd_qr()
+ * @param qr Pointer to the factorization
+ */
+extern void nd_qr_free(nd_qr_t *qr);
+
+/* ========================================================================== */
+/*                      SYMMETRIC EIGENDECOMPOSITION                         */
+/* ========================================================================== */
+
+/**
+ * @brief Eigenvalues, and optionally eigenvectors, of a symmetric matrix
+ * @param this Pointer to a square ndarray, left unchanged; only its lower
+ *             triangle is read
+ * @param vectors true to compute the eigenvectors as well
+ * @return nd_eigh_t The decomposition; release it with nd_eigh_free()
+ * @note The matrix is reduced to tridiagonal form in panels, half of the
+ *       work in nd_gemm() and half in products with the remaining triangle.
+ *       Eigenvalues alone then take O(n²) QL iteration; eigenvectors come
+ *       from divide and conquer, whose joins and the final change of basis
+ *       are again nd_gemm() calls
+ * @warning Exits with a matrix error when this is not square
+ *
+ * @code
+ * nd_eigh_t eh = nd_eigh(&S, true);
+ * double smallest = eh.values.data[0][0];
+ * // eigenvector of smallest: column 0 of eh.vectors
+ * nd_eigh_free(&eh);
+ * @endcode
+ */
+extern nd_eigh_t nd_eigh(ndarray_t *this, bool vectors);
+
+/**
+ * @brief A range of eigenvalues, and optionally eigenvectors, of a symmetric
+ *        matrix
+ * @param this Pointer to a square ndarray, left unchanged; only its lower
+ *             triangle is read
+ * @param first Index of the first eigenvalue wanted, counting from the
+ *              smallest (0)
+ * @param count Number of eigenvalues wanted
+ * @param vectors true to compute the matching eigenvectors
+ * @return nd_eigh_t values is 1 x count and vectors n x count
+ * @note After the tridiagonal reduction, each eigenvalue is found by
+ *       bisection and each eigenvector by inverse iteration, O(n) per step,
+ *       so a few eigenpairs of a large matrix cost little more than the
+ *       reduction itself
+ * @warning Exits with an index error when count is 0 or the range passes n,
+ *          and with a matrix error when this is not square
+ *
+ * @code
+ * nd_eigh_t top = nd_eigh_range(&S, n - 3, 3, true);   // the 3 largest
+ * nd_eigh_free(&top);
+ * @endcode
+ */
+extern nd_eigh_t nd_eigh_range(ndarray_t *this, size_t first, size_t count, bool vectors);
+
+/**
+ * @brief Releases a decomposition returned by nd_eigh() or nd_eigh_range()
+ * @param eig Pointer to the decomposition
+ */
+extern void nd_eigh_free(nd_eigh_t *eig);
+
+/* ========================================================================== */
+/*                      SINGULAR VALUE DECOMPOSITION                         */
+/* ========================================================================== */
+
+/**
+ * @brief Singular value decomposition of an m x n matrix
+ * @param this Pointer to the ndarray, left unchanged
+ * @param mode ND_SVD_VALUES, ND_SVD_THIN or ND_SVD_FULL
+ * @return nd_svd_t The decomposition; release it with nd_svd_free()
+ * @note A is reduced to bidiagonal form QᵀAP by Householder reflectors from
+ *       both sides, half of the work in nd_gemm() on the worker pool. When A
+ *       is at least 1.5 times taller than wide, an nd_qr() comes first and R
+ *       is reduced instead, so tall matrices (many samples, few features) cost
+ *       little more than their QR. Implicit QR with shifts then diagonalizes
+ *       the bidiagonal matrix; its rotations are buffered and applied to the
+ *       singular vectors in cache-sized column strips, in parallel
+ * @note AᵀA is never formed, so small singular values are accurate relative
+ *       to the largest one rather than to its square
+ *
+ * @code
+ * nd_svd_t sv = nd_svd(&X, ND_SVD_THIN);   // X: samples x features, centered
+ * // principal axes: rows of sv.Vt; explained variance: S[i]² / (samples - 1)
+ * nd_svd_free(&sv);
+ * @endcode
+ */
+extern nd_svd_t nd_svd(ndarray_t *this, nd_svd_mode_t mode);
+
+/**
+ * @brief Rank-k SVD by randomized range finding (Halko, Martinsson and Tropp)
+ * @param this Pointer to the m x n ndarray, left unchanged
+ * @param k Number of singular triplets (1 <= k <= min(m, n))
+ * @param oversample Extra sample columns, l = k + oversample (capped at
+ *                   min(m, n)); 5 to 10 is typical
+ * @param power_iters Power iterations; each one sharpens a slowly decaying
+ *                    spectrum at the cost of two more passes over A
+ * @param seed Seed of the Gaussian test matrix; equal seeds give equal results
+ * @return nd_svd_t U is m x k, S is 1 x k and Vt is k x n; release it with
+ *         nd_svd_free()
+ * @note The range of A is sampled as Y = A Ω and orthonormalized by a
+ *       Householder nd_qr(), so A ≈ Q Qᵀ A; the small l x n matrix Qᵀ A then
+ *       goes through nd_svd(). Time is O(m n l), and A is only read by
+ *       nd_gemm() in 2 + 2 power_iters passes, so it may live in a
+ *       memory-mapped file
+ * @warning Exits with an index error when k is 0 or above min(m, n)
+ *
+ * @code
+ * nd_svd_t top = nd_svd_randomized(&X, 50, 10, 2, 42);   // leading 50 components
+ * nd_svd_free(&top);
+ * @endcode
+ */
+extern nd_svd_t nd_svd_randomized(ndarray_t *this, size_t k, size_t oversample, size_t power_iters, uint64_t seed);
+
+/**
+ * @brief Releases a decomposition returned by nd_svd() or nd_svd_randomized()
+ * @param svd Pointer to the decomposition
+ */
+extern void nd_svd_free(nd_svd_t *svd);
+
+/* ========================================================================== */
+/*                              LEAST SQUARES                                */
+/* ========================================================================== */
+
+/**
+ * @brief Least-squares solution of A X ≈ B, choosing QR or SVD by conditioning
+ * @param this Pointer to the m x n matrix A, left unchanged
+ * @param B Right-hand sides, m x nrhs
+ * @return nd_lstsq_t Solution, rank and conditioning; release it with
+ *         nd_lstsq_free()
+ * @note A is factored once by the blocked nd_qr(). When m >= n and the
+ *       estimated 1 / cond(R) is above 1e-8, X comes from back substitution
+ *       with R. Otherwise, and always for wide A, R is decomposed by nd_svd()
+ *       and singular values below max(m, n) ε S[0] are dropped, which gives
+ *       the minimum-norm solution. AᵀA is never formed
+ * @warning Exits with a dimension message when B does not have m rows
+ *
+ * @code
+ * nd_lstsq_t fit = nd_lstsq(&X, &y);   // X: samples x features, y: samples x 1
+ * printf("rank %zu, rcond %g\n", fit.rank, fit.rcond);
+ * nd_lstsq_free(&fit);
+ * @endcode
+ */
+extern nd_lstsq_t nd_lstsq(ndarray_t *this, ndarray_t *B);
+
+/**
+ * @brief Releases a solution returned by nd_lstsq() or nd_normal_eq_solve()
+ * @param ls Pointer to the solution
+ */
+extern void nd_lstsq_free(nd_lstsq_t *ls);
+
+/**
+ * @brief Starts empty normal equations for n columns and nrhs right-hand sides
+ * @param n Columns of A (must be > 0)
+ * @param nrhs Columns of B (must be > 0)
+ * @return nd_normal_eq_t Accumulator; release it with nd_normal_eq_free()
+ * @note Memory is O(n² + n nrhs) however many rows are added, so a regression
+ *       over more rows than fit in memory can read them in batches, e.g. with
+ *       load_ndarray(), and split each batch into A and B with nd_view()
+ *
+ * @code
+ * nd_normal_eq_t ne = nd_normal_eq(features, 1);
+ * // for each batch of rows (features + 1 columns, the target last):
+ * ndarray_t X = nd_view(&batch, 0, 0, batch.shape[0], features);
+ * ndarray_t y = nd_view(&batch, 0, features, batch.shape[0], 1);
+ * nd_normal_eq_add(&ne, &X, &y);
+ * nd_view_free(&X);
+ * nd_view_free(&y);
+ * // then:
+ * nd_lstsq_t fit = nd_normal_eq_solve(&ne);
+ * nd_lstsq_free(&fit);
+ * nd_normal_eq_free(&ne);
+ * @endcode
+ */
+extern nd_normal_eq_t nd_normal_eq(size_t n, size_t nrhs);
+
+/**
+ * @brief Adds a batch of rows, AtA += AᵀA and AtB += AᵀB
+ * @param ne Pointer to the accumulator
+ * @param A Batch of rows of A, rows x n
+ * @param B The same rows of B, rows x nrhs
+ * @note Two nd_gemm() calls; the batch can be freed afterwards
+ * @warning Exits with a dimension message when the shapes do not match
+ */
+extern void nd_normal_eq_add(nd_normal_eq_t *ne, ndarray_t *A, ndarray_t *B);
+
+/**
+ * @brief Solves the accumulated normal equations with nd_lstsq()
+ * @param ne Pointer to the accumulator, which is left unchanged so that more
+ *           batches can be added and the system solved again
+ * @return nd_lstsq_t Solution; release it with nd_lstsq_free()
+ * @warning cond(AᵀA) = cond(A)², so about twice as many digits are lost as by
+ *          nd_lstsq() on A itself; prefer nd_lstsq() when A fits in memory
+ */
+extern nd_lstsq_t nd_normal_eq_solve(nd_normal_eq_t *ne);
+
+/**
+ * @brief Releases the sums of an accumulator
+ * @param ne Pointer to the accumulator
+ */
+extern void nd_normal_eq_free(nd_normal_eq_t *ne);
+
+/* ========================================================================== */
+/*                             MIXED PRECISION                               */
+/* ========================================================================== */
+
+/**
+ * @brief Solves A X = B to double accuracy with a float32 factorization
+ * @param this Pointer to the n x n matrix A, left unchanged
+ * @param B Right-hand sides, n x nrhs
+ * @return nd_mixed_t Solution and how it was found; release it with
+ *         nd_mixed_free()
+ * @note A is rounded to float and factored by Cholesky when it is exactly
+ *       symmetric and positive definite, by LU with partial pivoting
+ *       otherwise; the O(n³) work runs in nd_sgemm() at about twice the rate
+ *       of nd_gemm(). Each refinement step computes R = B - A X in double and
+ *       adds the float32 solution of A D = R to X, until
+ *       |R| <= |X| |A| ε √n in the max norm. When cond(A) nears 1 / ε of
+ *       float (about 10⁷), the residual stops halving, and after 30 steps or
+ *       such a stall X is recomputed by nd_cholesky() or nd_lu() in double
+ * @warning Exits with a singular error when A is singular, and with a
+ *          dimension message when B does not have n rows
+ *
+ * @code
+ * nd_mixed_t s = nd_solve_mixed(&A, &B);
+ * printf("%zu steps, fallback %d\n", s.iterations, s.fallback);
+ * nd_mixed_free(&s);
+ * @endcode
+ */
+extern nd_mixed_t nd_solve_mixed(ndarray_t *this, ndarray_t *B);
+
+/**
+ * @brief Releases a solution returned by nd_solve_mixed()
+ * @param mixed Pointer to the solution
+ */
+extern void nd_mixed_free(nd_mixed_t *mixed);
+
+#endif // !DECOMP
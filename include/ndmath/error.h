@@ -173,4 +173,24 @@ extern void row_col_error();
  */
 extern void null_matrix_data_rows();
 
+/**
+ * @brief Handle singular matrix errors
+ * 
+ * Reports errors when a factorization meets an exactly zero pivot and the
+ * requested operation (solve, inverse) has no unique result.
+ * 
+ * @note This function terminates the program
+ */
+extern void singular_error();
+
+/**
+ * @brief Handle non positive definite matrix errors
+ * 
+ * Reports errors when a Cholesky factorization meets a pivot that is not
+ * positive, so the matrix is not symmetric positive definite.
+ * 
+ * @note This function terminates the program
+ */
+extern void spd_error();
+
 #endif // ERROR
\ No newline at end of file
@@ -0,0 +1,327 @@
+/**
+ * @file iterative.h
+ * @brief Krylov subspace solvers for large linear systems and eigenproblems
+ *
+ * This header file provides iterative solvers for systems A x = b, and for a
+ * few eigenpairs of A, when A is too large to factor and is only touched
+ * through matrix-vector products:
+ *
+ * - Operators wrapping a dense ndarray, a CSR matrix (see sparse.h) or a user
+ *   matvec callback
+ * - Jacobi and ILU(0) preconditioners built from a CSR matrix
+ * - Conjugate gradient for symmetric positive definite A
+ * - BiCGSTAB and restarted GMRES for general A
+ * - Restarted Lanczos (symmetric A) and Arnoldi (general A) for the k
+ *   eigenvalues largest in magnitude, largest or smallest, in O(n k) memory
+ *
+ * Every solver allocates its work vectors once before iterating, and records
+ * the relative residual ||b - A x|| / ||b|| of every iteration in a trace.
+ *
+ * @author [Your Name]
+ * @date [Date]
+ * @version 1.0
+ *
+ * @note Results own their arrays and must be released with nd_krylov_free()
+ *       or nd_eigs_free()
+ */
+
+#ifndef ITERATIVE
+#define ITERATIVE
+
+#include "ndarray.h"
+#include "sparse.h"
+
+/* ========================================================================== */
+/*                                OPERATORS                                  */
+/* ========================================================================== */
+
+/**
+ * @brief Matrix-vector product callback
+ * @param x n contiguous input values
+ * @param y n contiguous output values, overwritten; never overlaps x
+ * @param ctx User data given to nd_operator_callback()
+ */
+typedef void (*nd_matvec_fn)(const double *x, double *y, void *ctx);
+
+/**
+ * @brief Square linear operator seen by the solvers
+ * @note The operator borrows its matrix, which must outlive every solve
+ */
+typedef struct {
+    size_t n;           /**< Rows and columns */
+    nd_matvec_fn apply; /**< y = A x */
+    void *ctx;          /**< Passed to apply */
+} nd_operator_t;
+
+/**
+ * @brief Operator for a dense square ndarray
+ * @param A Pointer to the n x n array
+ * @return nd_operator_t Operator whose products run on the worker pool
+ */
+extern nd_operator_t nd_operator_dense(ndarray_t *A);
+
+/**
+ * @brief Operator for a square CSR matrix
+ * @param A Pointer to the n x n matrix
+ * @return nd_operator_t Operator using nd_csr_matvec()
+ */
+extern nd_operator_t nd_operator_csr(const nd_csr_t *A);
+
+/**
+ * @brief Operator for a user matvec callback
+ * @param n Rows and columns of the operator (must be > 0)
+ * @param apply Callback computing y = A x
+ * @param ctx User data passed to every call
+ * @return nd_operator_t Operator for matrix-free solves
+ */
+extern nd_operator_t nd_operator_callback(size_t n, nd_matvec_fn apply, void *ctx);
+
+/* ========================================================================== */
+/*                             PRECONDITIONERS                               */
+/* ========================================================================== */
+
+/** @brief Preconditioner kinds */
+typedef enum {
+    ND_PRECOND_NONE,    /**< Identity */
+    ND_PRECOND_JACOBI,  /**< Inverse of the diagonal of A */
+    ND_PRECOND_ILU0     /**< Incomplete LU with the sparsity pattern of A */
+} nd_precond_kind_t;
+
+/**
+ * @brief Preconditioner M ~ A applied as z = M^-1 r
+ */
+typedef struct {
+    nd_precond_kind_t kind; /**< Which fields below are set */
+    size_t n;               /**< Rows and columns */
+    double *inv_diag;       /**< Jacobi: reciprocal diagonal of A */
+    nd_csr_t lu;            /**< ILU(0): unit L strictly below, U on and above the diagonal */
+    size_t *diag;           /**< ILU(0): position of each diagonal entry in lu */
+} nd_precond_t;
+
+/**
+ * @brief Jacobi (diagonal) preconditioner
+ * @param A Pointer to the n x n CSR matrix
+ * @return nd_precond_t Preconditioner with M = diag(A)
+ * @warning Exits with a singular error when a diagonal entry is zero or missing
+ */
+extern nd_precond_t nd_precond_jacobi(const nd_csr_t *A);
+
+/**
+ * @brief ILU(0) preconditioner
+ * @param A Pointer to the n x n CSR matrix
+ * @return nd_precond_t Preconditioner with M = L U, where L and U keep the
+ *         nonzero pattern of A and drop all fill-in
+ * @warning Exits with a singular error when a pivot is zero or a diagonal
+ *          entry is missing
+ */
+extern nd_precond_t nd_precond_ilu0(const nd_csr_t *A);
+
+/**
+ * @brief Applies a preconditioner, z = M^-1 r
+ * @param M Pointer to the preconditioner
+ * @param r n contiguous input values
+ * @param z n contiguous output values; must not overlap r
+ */
+extern void nd_precond_apply(const nd_precond_t *M, const double *r, double *z);
+
+/**
+ * @brief Releases the storage of a preconditioner
+ * @param M Preconditioner to free
+ */
+extern void nd_precond_free(nd_precond_t *M);
+
+/* ========================================================================== */
+/*                                 SOLVERS                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Progress callback, called once per trace entry
+ * @param iteration Iteration just completed, 0 for the initial guess
+ * @param residual Relative residual at that iteration
+ * @param ctx User data from the options
+ */
+typedef void (*nd_krylov_monitor_fn)(size_t iteration, double residual, void *ctx);
+
+/**
+ * @brief Solver options; start from nd_krylov_defaults()
+ */
+typedef struct {
+    double tol;                     /**< Stop once ||b - A x|| <= tol ||b|| */
+    size_t max_iters;               /**< Most iterations (GMRES: inner steps in total) */
+    size_t restart;                 /**< GMRES basis size before a restart */
+    const nd_precond_t *precond;    /**< Preconditioner, or NULL */
+    nd_krylov_monitor_fn monitor;   /**< Progress callback, or NULL */
+    void *monitor_ctx;              /**< Passed to monitor */
+} nd_krylov_opts_t;
+
+/**
+ * @brief Result of an iterative solve
+ */
+typedef struct {
+    ndarray_t x;        /**< Solution, in the shape of b */
+    ndarray_t trace;    /**< 1 x (iterations + 1) relative residuals, starting at x0 */
+    size_t iterations;  /**< Iterations performed */
+    double residual;    /**< Final relative residual */
+    bool converged;     /**< residual <= tol was reached */
+} nd_krylov_t;
+
+/**
+ * @brief Default options: tol 1e-8, 1000 iterations, GMRES(30), no preconditioner
+ * @return nd_krylov_opts_t Options to adjust before a solve
+ */
+extern nd_krylov_opts_t nd_krylov_defaults(void);
+
+/**
+ * @brief Preconditioned conjugate gradient
+ * @param A Pointer to a symmetric positive definite operator
+ * @param b Right-hand side, n x 1 or 1 x n
+ * @param x0 Initial guess in the shape of b, or NULL for zero
+ * @param opts Pointer to options, or NULL for nd_krylov_defaults();
+ *        the preconditioner must be symmetric positive definite too
+ * @return nd_krylov_t Solution and residual trace
+ * @note One operator and one preconditioner application per iteration
+ * @warning Exits with an error message when b or x0 does not have n values
+ *
+ * @code
+ * nd_operator_t op = nd_operator_csr(&A);
+ * nd_precond_t M = nd_precond_ilu0(&A);
+ * nd_krylov_opts_t opts = nd_krylov_defaults();
+ * opts.precond = &M;
+ * nd_krylov_t r = nd_cg(&op, &b, NULL, &opts);
+ * printf("%zu iterations, residual %g\n", r.iterations, r.residual);
+ * nd_krylov_free(&r);
+ * nd_precond_free(&M);
+ * @endcode
+ */
+extern nd_krylov_t nd_cg(const nd_operator_t *A, ndarray_t *b, ndarray_t *x0,
+                         const nd_krylov_opts_t *opts);
+
+/**
+ * @brief Preconditioned BiCGSTAB
+ * @param A Pointer to a square operator
+ * @param b Right-hand side, n x 1 or 1 x n
+ * @param x0 Initial guess in the shape of b, or NULL for zero
+ * @param opts Pointer to options, or NULL for nd_krylov_defaults()
+ * @return nd_krylov_t Solution and residual trace
+ * @note Two operator and two preconditioner applications per iteration;
+ *       stops unconverged on a breakdown (rho or omega vanishing)
+ * @warning Exits with an error message when b or x0 does not have n values
+ */
+extern nd_krylov_t nd_bicgstab(const nd_operator_t *A, ndarray_t *b, ndarray_t *x0,
+                               const nd_krylov_opts_t *opts);
+
+/**
+ * @brief Restarted GMRES with right preconditioning
+ * @param A Pointer to a square operator
+ * @param b Right-hand side, n x 1 or 1 x n
+ * @param x0 Initial guess in the shape of b, or NULL for zero
+ * @param opts Pointer to options, or NULL for nd_krylov_defaults();
+ *        opts->restart vectors of n values are kept
+ * @return nd_krylov_t Solution and residual trace
+ * @note Modified Gram-Schmidt Arnoldi with Givens rotations; the residual of
+ *       right preconditioning is the true residual, so tol means the same as
+ *       for the other solvers
+ * @warning Exits with an error message when b or x0 does not have n values
+ */
+extern nd_krylov_t nd_gmres(const nd_operator_t *A, ndarray_t *b, ndarray_t *x0,
+                            const nd_krylov_opts_t *opts);
+
+/**
+ * @brief Releases the arrays of a solver result
+ * @param result Result of nd_cg(), nd_bicgstab() or nd_gmres()
+ */
+extern void nd_krylov_free(nd_krylov_t *result);
+
+/* ========================================================================== */
+/*                              EIGENSOLVERS                                 */
+/* ========================================================================== */
+
+/** @brief Which end of the spectrum nd_lanczos() and nd_arnoldi() look for */
+typedef enum {
+    ND_EIGS_MAGNITUDE,  /**< Largest |λ| */
+    ND_EIGS_LARGEST,    /**< Largest λ (real part for nd_arnoldi()) */
+    ND_EIGS_SMALLEST    /**< Smallest λ (real part for nd_arnoldi()) */
+} nd_eigs_which_t;
+
+/**
+ * @brief Eigensolver options; start from nd_eigs_defaults()
+ */
+typedef struct {
+    nd_eigs_which_t which;  /**< Eigenvalues wanted */
+    size_t basis;           /**< Krylov vectors kept, 0 for max(2k + 1, 20); at least k + 2 */
+    double tol;             /**< Stop once |A x - λ x| <= tol |λ| for every wanted pair */
+    size_t max_restarts;    /**< Most restarts */
+    uint64_t seed;          /**< Seed of the random start vector */
+} nd_eigs_opts_t;
+
+/**
+ * @brief Eigenpairs found by nd_lanczos() or nd_arnoldi()
+ * @note A complex pair λ, conj(λ) takes two neighbouring columns, positive
+ *       imaginary part first: they hold the real and imaginary parts of the
+ *       eigenvector of λ (the one of conj(λ) is its conjugate)
+ */
+typedef struct {
+    ndarray_t values;   /**< 1 x k eigenvalues (real parts) in the order of which */
+    ndarray_t imag;     /**< 1 x k imaginary parts, zero for nd_lanczos() */
+    ndarray_t vectors;  /**< n x k unit eigenvectors as columns */
+    size_t restarts;    /**< Restarts performed */
+    size_t matvecs;     /**< Operator applications */
+    bool converged;     /**< Every pair met tol */
+} nd_eigs_t;
+
+/**
+ * @brief Default options: largest magnitude, tol 1e-10, 300 restarts, seed 0
+ * @return nd_eigs_opts_t Options to adjust before a solve
+ */
+extern nd_eigs_opts_t nd_eigs_defaults(void);
+
+/**
+ * @brief k eigenpairs of a symmetric operator by thick-restart Lanczos
+ * @param A Pointer to a symmetric operator of size n
+ * @param k Eigenpairs wanted, 0 < k < n
+ * @param opts Pointer to options, or NULL for nd_eigs_defaults()
+ * @return nd_eigs_t Eigenvalues and orthonormal eigenvectors
+ * @note The basis is kept fully orthogonal by two passes of classical
+ *       Gram-Schmidt, both products of which are nd_gemm() calls on the
+ *       worker pool. A restart keeps the Ritz vectors of the k + (basis - k) / 2
+ *       best values, which is equivalent to an implicit restart. Memory is
+ *       (basis + 1 + k) vectors of n values
+ * @warning Exits with an index error when k is 0 or not below n
+ *
+ * @code
+ * nd_operator_t op = nd_operator_csr(&L);
+ * nd_eigs_opts_t opts = nd_eigs_defaults();
+ * opts.which = ND_EIGS_SMALLEST;
+ * nd_eigs_t e = nd_lanczos(&op, 10, &opts);   // 10 smallest of a Laplacian
+ * nd_eigs_free(&e);
+ * @endcode
+ */
+extern nd_eigs_t nd_lanczos(const nd_operator_t *A, size_t k, const nd_eigs_opts_t *opts);
+
+/**
+ * @brief k eigenpairs of a general operator by Krylov-Schur restarted Arnoldi
+ * @param A Pointer to a square operator of size n
+ * @param k Eigenpairs wanted, 0 < k < n; one more is returned when the k-th
+ *          is the first of a complex pair
+ * @param opts Pointer to options, or NULL for nd_eigs_defaults()
+ * @return nd_eigs_t Eigenvalues and unit eigenvectors
+ * @note Orthogonalization and memory as for nd_lanczos(). The small projected
+ *       matrix is solved by Hessenberg QR and inverse iteration, and a
+ *       restart keeps an orthonormal basis of the Ritz vectors wanted
+ * @warning Exits with an index error when k is 0 or not below n
+ *
+ * @code
+ * nd_operator_t op = nd_operator_callback(n, google_matvec, &graph);
+ * nd_eigs_t e = nd_arnoldi(&op, 1, NULL);   // dominant eigenvector
+ * nd_eigs_free(&e);
+ * @endcode
+ */
+extern nd_eigs_t nd_arnoldi(const nd_operator_t *A, size_t k, const nd_eigs_opts_t *opts);
+
+/**
+ * @brief Releases the arrays of an eigensolver result
+ * @param result Result of nd_lanczos() or nd_arnoldi()
+ */
+extern void nd_eigs_free(nd_eigs_t *result);
+
+#endif // !ITERATIVE
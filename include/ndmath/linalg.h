@@ -8,7 +8,8 @@
  * 
  * The library includes:
  * - Matrix decompositions (QR, SVD, Eigenvalue)
- * - Matrix operations (multiplication, inversion, determinant)
+ * - Matrix operations (multiplication, inversion, determinant, powers,
+ *   exponential, matrix chains)
  * - Vector operations (dot product, outer product, norms)
  * - Advanced numerical algorithms with iterative solvers
  * 
@@ -32,19 +33,22 @@
     /**
      * @brief Computes the determinant of a square matrix
      * 
-     * Calculates the determinant of a square matrix using appropriate numerical
-     * methods. The determinant is a scalar value that provides important
+     * Calculates the determinant of a square matrix from its LU factorization
+     * with partial pivoting: the product of the pivots times the sign of the
+     * row permutation. The determinant is a scalar value that provides important
      * information about the matrix properties (invertibility, volume scaling).
      * 
      * @param this Pointer to a square ndarray matrix
      * @return double The determinant value
      * 
      * @note Matrix must be square (n×n) for determinant calculation
-     * @warning Returns NaN or undefined value for non-square matrices
-     * @warning Large matrices may suffer from numerical instability
+     * @warning Exits with a shape error for non-square matrices
+     * @warning Large matrices may overflow or underflow the product of pivots;
+     *          nd_slogdet() returns the logarithm instead
      * 
      * @par Time Complexity:
-     * O(n³) for general matrices using LU decomposition
+     * O(n³) for general matrices using LU decomposition; O(n²) when the LU
+     * factorization of the same matrix is in the factorization cache (cache.h)
      * 
      * @par Example:
      * @code
@@ -57,6 +61,42 @@
      */
     extern double det(ndarray_t *this);
 
+    /**
+     * @brief Sign and logarithm of the determinant, as returned by nd_slogdet()
+     */
+    typedef struct {
+        double sign;        /**< +1 or -1, and 0 for a singular matrix */
+        double logabsdet;   /**< log|det(A)|, -inf for a singular matrix */
+    } nd_slogdet_t;
+
+    /**
+     * @brief Computes the determinant in the log domain
+     * 
+     * Sums log|u_ii| over the pivots of the LU factorization with partial
+     * pivoting instead of multiplying them, so det(A) = sign * exp(logabsdet)
+     * is represented even when the product over- or underflows a double, as it
+     * does for most matrices beyond a few hundred rows. The sign combines the
+     * signs of the pivots with the sign of the row permutation.
+     * 
+     * @param this Pointer to a square ndarray matrix
+     * @return nd_slogdet_t Sign and log|det(A)|
+     * 
+     * @note Uses the factorization cache like det() (see cache.h)
+     * @note For a symmetric positive definite matrix, nd_cholesky() gives
+     *       logdet directly at half the cost
+     * @warning Exits with a shape error for non-square matrices
+     * 
+     * @par Time Complexity:
+     * O(n³), the same blocked LU as det()
+     * 
+     * @par Example:
+     * @code
+     * nd_slogdet_t ld = nd_slogdet(&cov);   // 2000x2000 covariance
+     * double loglik = -0.5 * (ld.logabsdet + n * log(2.0 * M_PI) + quad);
+     * @endcode
+     */
+    extern nd_slogdet_t nd_slogdet(ndarray_t *this);
+
     /**
      * @brief Computes matrix norms along specified axis
      * 
@@ -89,8 +129,9 @@
     /**
      * @brief Computes the matrix inverse
      * 
-     * Calculates the inverse of a square matrix using numerical methods
-     * such as LU decomposition with partial pivoting or Gauss-Jordan elimination.
+     * Calculates the inverse of a square matrix by solving A X = I with the
+     * LU factorization of nd_lu() (see decomp.h). To apply A⁻¹ to a few
+     * vectors, prefer nd_lu_solve(): it avoids forming the inverse at all.
      * 
      * @param this Pointer to a square, invertible ndarray matrix
      * @return ndarray_t New ndarray containing the matrix inverse
@@ -98,18 +139,47 @@
      * @pre Matrix must be square and non-singular (det(A) ≠ 0)
      * @post Result satisfies: A × A⁻¹ = I (identity matrix)
      * 
-     * @warning Returns invalid result for singular or near-singular matrices
+     * @warning Exits with a singular error for an exactly singular matrix
      * @warning Numerical errors can accumulate for ill-conditioned matrices
      * @note Consider using pseudo-inverse for non-square or rank-deficient matrices
      * 
      * @par Time Complexity:
-     * O(n³) for n×n matrices
+     * O(n³) for n×n matrices; the LU factorization is reused from the
+     * factorization cache when it is enabled (cache.h)
      * 
      * @par Numerical Stability:
      * Check condition number before inversion for numerical stability
      */
     extern ndarray_t inv(ndarray_t *this);
 
+    /**
+     * @brief Updates an inverse in place after a rank-k change of the matrix
+     *
+     * Turns A⁻¹ into (A + U Vᵀ)⁻¹ by the Sherman-Morrison-Woodbury formula
+     * (A + U Vᵀ)⁻¹ = A⁻¹ - A⁻¹U (I + VᵀA⁻¹U)⁻¹ VᵀA⁻¹. Only a k×k system is
+     * solved; the rest is three products through nd_gemm(). Pass the same
+     * array as U and V for a symmetric update A + U Uᵀ.
+     *
+     * @param inverse Pointer to the n×n inverse of A, overwritten
+     * @param U Pointer to an n×k matrix
+     * @param V Pointer to an n×k matrix
+     * @return bool False, with inverse unchanged, when A + U Vᵀ is singular
+     *
+     * @warning Exits with a shape error when inverse is not square, and with
+     *          a dimension message when U or V is not n×k
+     * @note Rounding errors accumulate over many updates; recompute with
+     *       inv() from time to time when A is ill conditioned
+     *
+     * @par Time Complexity:
+     * O(n²k + k³) instead of O(n³) for a new inv(); O(n²) for k = 1
+     *
+     * @par Example:
+     * @code
+     * nd_inv_update(&G_inv, &x, &x);   // G + x xᵀ after a new observation x
+     * @endcode
+     */
+    extern bool nd_inv_update(ndarray_t *inverse, ndarray_t *U, ndarray_t *V);
+
     /**
      * @brief Matrix multiplication (linear algebra product)
      * 
@@ -135,6 +205,75 @@
      */
     extern ndarray_t matmul(ndarray_t *this, ndarray_t *arrayB);
 
+    /**
+     * @brief Integer power of a square matrix by repeated squaring
+     * 
+     * Computes A^k with about 2 log₂|k| products through nd_gemm() (see
+     * blas.h), ping-ponging between three n×n buffers instead of allocating
+     * a new array for every product.
+     * 
+     * @param this Pointer to a square ndarray matrix
+     * @param k Exponent; 0 gives the identity and a negative k gives
+     *          (A⁻¹)^|k|
+     * @return ndarray_t New n×n array holding A^k
+     * 
+     * @warning Exits with a shape error for non-square matrices, and with a
+     *          singular error for a negative k and a singular matrix
+     * 
+     * @par Time Complexity:
+     * O(n³ log k)
+     * 
+     * @par Example:
+     * @code
+     * ndarray_t P100 = nd_matrix_power(&P, 100);   // 100-step transition matrix
+     * @endcode
+     */
+    extern ndarray_t nd_matrix_power(ndarray_t *this, long k);
+
+    /**
+     * @brief Matrix exponential e^A
+     * 
+     * Scaling and squaring with Padé approximants (Higham 2005). The degree
+     * (3, 5, 7, 9 or 13) is the lowest whose error bound at ‖A‖₁ is below
+     * double precision. Beyond that, A is scaled by 2^-s to within the bound
+     * of degree 13 and the approximant is squared s times. The approximant
+     * is a single LU solve, so the cost is a handful of matrix products.
+     * 
+     * @param this Pointer to a square ndarray matrix
+     * @return ndarray_t New n×n array holding e^A
+     * 
+     * @warning Exits with a shape error for non-square matrices
+     * @note For a Markov generator Q, nd_expm(t Q) is the transition
+     *       matrix over time t
+     * 
+     * @par Time Complexity:
+     * O(n³ (6 + s)) with s = max(0, ⌈log₂(‖A‖₁ / 5.37)⌉)
+     */
+    extern ndarray_t nd_expm(ndarray_t *this);
+
+    /**
+     * @brief Product of a chain of matrices in the cheapest order
+     * 
+     * Finds the parenthesization of A₀ A₁ ... A_{count-1} with the fewest
+     * multiply-adds by dynamic programming over the shapes (O(count³)), then
+     * runs the products through nd_gemm(). A chain such as (1000×10)(10×1000)
+     * (1000×10) costs 100 times less than left to right.
+     * 
+     * @param arrays Pointers to the factors, in order
+     * @param count Number of factors, at least 1
+     * @return ndarray_t New array holding the product
+     * 
+     * @warning Exits with a dimension message when consecutive factors do
+     *          not agree
+     * 
+     * @par Example:
+     * @code
+     * ndarray_t *chain[] = {&A, &B, &C, &D};
+     * ndarray_t ABCD = nd_multi_matmul(chain, 4);
+     * @endcode
+     */
+    extern ndarray_t nd_multi_matmul(ndarray_t **arrays, size_t count);
+
     /* =================================================================== */
     /*                        VECTOR OPERATIONS                           */
     /* =================================================================== */
@@ -142,19 +281,21 @@
     /**
      * @brief Computes the dot product of two vectors
      * 
-     * Calculates the inner product (dot product) between two column vectors.
-     * For vectors u and v, computes u·v = Σ(u[i] × v[i]).
+     * Calculates the inner product (dot product) of two arrays over all of
+     * their elements, paired in row-major order. For vectors u and v,
+     * computes u·v = Σ(u[i] × v[i]); rows, columns and matrices of any shapes
+     * with the same number of elements are accepted.
      * 
-     * @param a Pointer to the first vector (column vector)
-     * @param b Pointer to the second vector (column vector)
+     * @param a Pointer to the first operand
+     * @param b Pointer to the second operand, with as many elements as a
      * @return ndarray_t Scalar result as a 1×1 ndarray
      * 
-     * @pre Both vectors must have the same length
-     * @pre Vectors should be column vectors (n×1 matrices)
      * @post Result is a scalar value in ndarray format
      * 
      * @note Returns scalar product, not element-wise multiplication
-     * @warning Undefined behavior if vector dimensions don't match
+     * @note Summed with the mode of nd_set_summation() (see reduce.h).
+     *       Earlier versions multiplied only the first columns of a and b
+     * @warning Exits with a shape error when the element counts differ
      * 
      * @par Mathematical Definition:
      * a·b = Σ(i=0 to n-1) a[i] × b[i]
@@ -195,47 +336,41 @@
     /* =================================================================== */
 
     /**
-     * @brief Computes eigenvalues using iterative methods
+     * @brief Computes the eigenvalues of a square matrix
      * 
-     * Calculates the eigenvalues of a square matrix using iterative algorithms
-     * such as the power method or QR algorithm. The number of iterations
-     * controls the precision of the result.
+     * Symmetric matrices are handed to nd_eigh() (see decomp.h): Householder
+     * reduction to tridiagonal form followed by QL iteration, which returns
+     * every eigenvalue to working accuracy in ascending order and ignores
+     * nbiters. Other matrices run shifted QR iterations until the part below
+     * the diagonal vanishes, or for at most nbiters steps.
      * 
      * @param this Pointer to a square ndarray matrix
-     * @param nbiters Number of iterations for the eigenvalue algorithm
-     * @return ndarray_t New ndarray containing the eigenvalues
+     * @param nbiters Most QR iterations for a nonsymmetric matrix
+     * @return ndarray_t New 1 x n ndarray containing the eigenvalues
      * 
      * @pre Matrix must be square
-     * @note Higher iteration count generally improves accuracy
-     * @note For symmetric matrices, eigenvalues are guaranteed to be real
-     * @warning Complex eigenvalues may not be handled correctly
-     * @warning Convergence not guaranteed for all matrices
+     * @note Use nd_eigh() directly for eigenvectors, and nd_eigh_range() for
+     *       a few eigenvalues of a large symmetric matrix
+     * @warning Complex eigenvalues of a nonsymmetric matrix are not
+     *          computed: their 2 x 2 blocks never converge, and the diagonal
+     *          after nbiters steps is returned
      * 
      * @par Time Complexity:
-     * O(n³ × nbiters) for n×n matrices
-     * 
-     * @par Numerical Considerations:
-     * - Increase nbiters for better precision
-     * - Some matrices may require special handling (defective matrices)
-     * - Consider matrix conditioning for numerical stability
+     * O(n³) for symmetric matrices, O(n³ × nbiters) otherwise
      */
     extern ndarray_t eig(ndarray_t *this, size_t nbiters);
 
     /**
-     * @brief Computes Singular Value Decomposition (SVD)
+     * @brief Computes the singular values of a matrix
      * 
-     * Performs SVD factorization of a matrix: A = U × Σ × V^T
-     * where U and V are orthogonal matrices and Σ is diagonal with non-negative entries.
+     * The values of A = U × Σ × V^T, computed by nd_svd() (see decomp.h) without forming
+     * A^T × A, so small singular values keep their accuracy. Use nd_svd() directly for
+     * U and V^T.
      * 
      * @param this Pointer to the input ndarray matrix (m×n)
-     * @return ndarray_t Structure containing the SVD components
+     * @return ndarray_t New 1×min(m, n) array of singular values in descending order
      * 
      * @note SVD exists for any matrix (not just square matrices)
-     * @note Singular values are returned in descending order
-     * @post U is m×m orthogonal, V is n×n orthogonal, Σ is m×n diagonal
-     * 
-     * @warning Return format needs clarification (single array vs. multiple arrays)
-     * @note SVD is fundamental for many numerical algorithms
      * 
      * @par Applications:
      * - Principal Component Analysis (PCA)
@@ -254,22 +389,21 @@
     /**
      * @brief Computes QR decomposition of a matrix
      * 
-     * Performs QR factorization: A = Q × R where Q is orthogonal and R is upper triangular.
-     * This is an in-place decomposition that modifies the provided Q and R matrices.
+     * Performs QR factorization: A = Q × R where Q has orthonormal columns and R is upper
+     * triangular, using blocked Householder reflections (see nd_qr() in decomp.h).
+     * Q and R are allocated by the call.
      * 
      * @param this Pointer to the input matrix to decompose (m×n)
-     * @param Q Pointer to pre-allocated ndarray for orthogonal matrix (m×m)
-     * @param R Pointer to pre-allocated ndarray for upper triangular matrix (m×n)
+     * @param Q Pointer that receives the orthonormal factor (m×k, k = min(m, n))
+     * @param R Pointer that receives the upper triangular factor (k×n)
      * 
-     * @pre Q and R must be pre-allocated with correct dimensions
-     * @pre this should be m×n matrix where m ≥ n for standard QR
-     * @post Q is orthogonal: Q^T × Q = I
-     * @post R is upper triangular: R[i][j] = 0 for i > j
+     * @post Q^T × Q = I, even for ill-conditioned A
+     * @post R is upper triangular with a non-negative diagonal
      * @post A = Q × R (original matrix reconstructed)
      * 
-     * @note This function modifies Q and R arrays in-place
-     * @note Uses algorithms like Gram-Schmidt or Householder reflections
-     * @warning Ensure Q and R are properly allocated before calling
+     * @note Any previous contents of Q and R are not freed
+     * @note To solve least-squares problems or apply Q^T without forming Q, use
+     *       nd_qr(), nd_qr_apply_qt() and nd_qr_solve() directly
      * 
      * @par Applications:
      * - Solving linear least squares problems
@@ -283,7 +417,7 @@
      * @par Example Usage:
      * @code
      * ndarray_t A, Q, R;
-     * // Initialize A with data, allocate Q and R
+     * // Initialize A with data
      * qr(&A, &Q, &R);
      * // Now Q and R contain the decomposition
      * @endcode
@@ -335,8 +469,9 @@
  * // ... initialize A, allocate Q and R with proper dimensions
  * qr(&A, &Q, &R);
  * 
- * // SVD for dimensionality reduction
- * ndarray_t U_sigma_Vt = svd(&A);
+ * // Singular values, and the full SVD for dimensionality reduction
+ * ndarray_t sigma = svd(&A);
+ * nd_svd_t sv = nd_svd(&A, ND_SVD_THIN);
  * 
  * // Eigenvalue computation
  * size_t iterations = 1000;
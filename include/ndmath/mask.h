@@ -0,0 +1,186 @@
+/**
+ * @file mask.h
+ * @brief Boolean masks, comparisons and mask-driven selection for ndarray structures
+ *
+ * This header file provides bit-packed boolean masks and the operations that
+ * produce and consume them:
+ *
+ * - Comparisons between arrays (with broadcasting) or against a scalar
+ * - Logical combination of masks and population counts
+ * - nd_where() to blend two arrays element-wise under a mask
+ * - nd_compress() to keep only the selected elements, rows or columns
+ *
+ * A mask stores one bit per element in row-major order, 64 elements per
+ * word. A 10M-row selection therefore costs 1.25 MB instead of the 80 MB of
+ * a double-valued 0/1 array. Comparisons and compaction run on the worker
+ * pool (see parallel.h).
+ *
+ * @author [Your Name]
+ * @date [Date]
+ * @version 1.0
+ *
+ * @note Masks own their storage and must be released with nd_mask_free()
+ */
+
+#ifndef MASK
+#define MASK
+
+#include "ndarray.h"
+#include <stdint.h>
+
+/* ========================================================================== */
+/*                                MASK TYPE                                  */
+/* ========================================================================== */
+
+/**
+ * @brief Bit-packed boolean matrix
+ * @note Element (i, j) is bit k = i * cols + j, stored in bits[k / 64] at
+ *       position k % 64; padding bits of the last word are always zero
+ */
+typedef struct {
+    size_t shape[2];    /**< Rows and columns */
+    size_t nwords;      /**< Number of 64-bit words, ceil(rows * cols / 64) */
+    uint64_t *bits;     /**< Packed bits */
+} nd_mask_t;
+
+/**
+ * @brief Allocates a mask with every bit cleared
+ * @param rows Number of rows (must be > 0)
+ * @param cols Number of columns (must be > 0)
+ * @return nd_mask_t New mask
+ * @warning Exits with a shape error for zero dimensions
+ */
+extern nd_mask_t nd_mask(size_t rows, size_t cols);
+
+/**
+ * @brief Releases the storage of a mask
+ * @param mask Mask to free; its bits pointer is reset to NULL
+ */
+extern void nd_mask_free(nd_mask_t *mask);
+
+/**
+ * @brief Reads one bit of a mask
+ * @param mask Mask to read
+ * @param i Row index
+ * @param j Column index
+ * @return true if the element is selected
+ * @warning No bounds checking
+ */
+extern bool nd_mask_get(const nd_mask_t *mask, size_t i, size_t j);
+
+/**
+ * @brief Writes one bit of a mask
+ * @param mask Mask to modify
+ * @param i Row index
+ * @param j Column index
+ * @param value New state of the bit
+ * @warning No bounds checking
+ */
+extern void nd_mask_set(nd_mask_t *mask, size_t i, size_t j, bool value);
+
+/* ========================================================================== */
+/*                               COMPARISONS                                 */
+/* ========================================================================== */
+
+/**
+ * @brief Compares two arrays element-wise
+ * @param a Left operand
+ * @param op Comparison: "<", "<=", ">", ">=", "==" or "!="
+ * @param b Right operand
+ * @return nd_mask_t Mask of the broadcast shape, bit set where a op b holds
+ * @note Each dimension of a and b must match or be 1, as in nd_ufunc_binary()
+ * @note "==" is exact; comparisons with NaN are false except "!="
+ * @warning Exits for an unknown operator or incompatible shapes
+ *
+ * @code
+ * nd_mask_t up = nd_compare(&close, ">", &open);
+ * @endcode
+ */
+extern nd_mask_t nd_compare(ndarray_t *a, const char *op, ndarray_t *b);
+
+/**
+ * @brief Compares every element of an array with a scalar
+ * @param this Left operand
+ * @param op Comparison: "<", "<=", ">", ">=", "==" or "!="
+ * @param value Right operand
+ * @return nd_mask_t Mask shaped like this
+ *
+ * @code
+ * ndarray_t price = cslice(&data, 3, 4);
+ * nd_mask_t cheap = nd_compare_scalar(&price, "<", 10.0);   // (rows, 1)
+ * @endcode
+ */
+extern nd_mask_t nd_compare_scalar(ndarray_t *this, const char *op, double value);
+
+/* ========================================================================== */
+/*                              MASK LOGIC                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Element-wise AND of two masks of the same shape
+ * @return nd_mask_t New mask
+ * @warning Exits with a shape error when the shapes differ
+ */
+extern nd_mask_t nd_mask_and(const nd_mask_t *a, const nd_mask_t *b);
+
+/**
+ * @brief Element-wise OR of two masks of the same shape
+ * @return nd_mask_t New mask
+ * @warning Exits with a shape error when the shapes differ
+ */
+extern nd_mask_t nd_mask_or(const nd_mask_t *a, const nd_mask_t *b);
+
+/**
+ * @brief Element-wise negation of a mask
+ * @return nd_mask_t New mask
+ */
+extern nd_mask_t nd_mask_not(const nd_mask_t *mask);
+
+/**
+ * @brief Counts the selected elements of a mask
+ * @param mask Mask to count
+ * @return size_t Number of set bits
+ */
+extern size_t nd_mask_count(const nd_mask_t *mask);
+
+/* ========================================================================== */
+/*                               SELECTION                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Picks elements from a where the mask is set and from b elsewhere
+ * @param mask Selection mask, defines the result shape
+ * @param a Values for set bits, broadcast to the mask shape
+ * @param b Values for cleared bits, broadcast to the mask shape
+ * @return ndarray_t New ndarray of the mask shape
+ * @warning Exits when a or b does not broadcast to the mask shape
+ *
+ * @code
+ * ndarray_t zero = zeros(1, 1);
+ * ndarray_t clipped = nd_where(&negative, &zero, &data);
+ * @endcode
+ */
+extern ndarray_t nd_where(const nd_mask_t *mask, ndarray_t *a, ndarray_t *b);
+
+/**
+ * @brief Keeps the elements, rows or columns selected by a mask
+ * @param this Pointer to the input ndarray
+ * @param mask Selection mask:
+ *             - axis "x": shape (rows, 1), one bit per row
+ *             - axis "y": shape (1, cols), one bit per column
+ *             - axis "all": shaped like this, one bit per element
+ * @param axis "x" (select rows), "y" (select columns) or "all" (select elements)
+ * @return ndarray_t New ndarray of shape (count, cols), (rows, count) or
+ *         (1, count); an empty ndarray (shape 0, data NULL) when nothing is selected
+ * @note The selected data keeps its original order
+ * @warning Exits with a shape error when the mask does not match the axis
+ *
+ * @code
+ * nd_mask_t keep = nd_compare_scalar(&price, "<", 10.0);
+ * ndarray_t cheap_rows = nd_compress(&data, &keep, "x");
+ * nd_mask_free(&keep);
+ * @endcode
+ */
+extern ndarray_t nd_compress(ndarray_t *this, const nd_mask_t *mask, char *axis);
+
+#endif // !MASK
@@ -0,0 +1,94 @@
+/**
+ * @file parallel.h
+ * @brief Worker thread pool and vectorization helpers for ndarray kernels
+ *
+ * This header file exposes the small amount of execution machinery shared by
+ * the compute-heavy modules of the library: a persistent pool of worker
+ * threads driven through nd_parallel_for(), and the function attribute used
+ * to build hot kernels for several instruction sets with runtime selection.
+ *
+ * @author [Your Name]
+ * @date [Date]
+ * @version 1.0
+ *
+ * @note Work is always split into fixed-size chunks, so results of parallel
+ *       reductions do not depend on the number of threads in use
+ * @note Calls made from inside a running task execute serially on that thread
+ */
+
+#ifndef PARALLEL
+#define PARALLEL
+
+#include "ndarray.h"
+
+/* ========================================================================== */
+/*                           VECTORIZATION HELPERS                           */
+/* ========================================================================== */
+
+/**
+ * @brief Builds the decorated function for several x86-64 ISA levels
+ * @note The dynamic loader picks the best clone (AVX-512, AVX2 or baseline)
+ *       for the running CPU once, at symbol resolution time
+ * @note Expands to nothing on compilers or targets without ifunc support
+ */
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+#define ND_SIMD_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define ND_SIMD_CLONES
+#endif
+
+/* ========================================================================== */
+/*                              THREAD POOL                                  */
+/* ========================================================================== */
+
+/**
+ * @brief Task body executed by nd_parallel_for()
+ * @param begin First index of the chunk (inclusive)
+ * @param end Last index of the chunk (exclusive)
+ * @param ctx User context forwarded unchanged from nd_parallel_for()
+ */
+typedef void (*nd_task_fn)(size_t begin, size_t end, void *ctx);
+
+/**
+ * @brief Sets the number of threads used by parallel kernels
+ * @param nthreads Number of threads, including the calling thread
+ *                 - 0: Restore the default (NDMATH_NUM_THREADS or online CPUs)
+ *                 - 1: Run every kernel serially
+ * @note Workers are created lazily on the first parallel call
+ */
+extern void nd_set_num_threads(size_t nthreads);
+
+/**
+ * @brief Returns the number of threads used by parallel kernels
+ * @return size_t Thread count, always at least 1
+ */
+extern size_t nd_get_num_threads(void);
+
+/**
+ * @brief Runs fn over [0, n) split into chunks of grain indices
+ * @param n Total number of indices
+ * @param grain Chunk size; chunk k covers [k*grain, min((k+1)*grain, n))
+ * @param fn Task body, called once per chunk
+ * @param ctx Context forwarded to every call of fn
+ * @note The calling thread takes part in the work and returns once every
+ *       chunk has completed
+ * @note Chunk boundaries depend only on n and grain, so fn may use
+ *       begin / grain as a stable slot index for partial results
+ * @warning fn must not write to memory shared with other chunks without
+ *          its own synchronization
+ *
+ * @code
+ * static void scale_rows(size_t begin, size_t end, void *ctx)
+ * {
+ *     ndarray_t *a = ctx;
+ *     for (size_t i = begin; i < end; i++)
+ *         for (size_t j = 0; j < a->shape[1]; j++)
+ *             a->data[i][j] *= 2.0;
+ * }
+ *
+ * nd_parallel_for(a.shape[0], 64, scale_rows, &a);
+ * @endcode
+ */
+extern void nd_parallel_for(size_t n, size_t grain, nd_task_fn fn, void *ctx);
+
+#endif // !PARALLEL
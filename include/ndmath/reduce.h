@@ -0,0 +1,231 @@
+/**
+ * @file reduce.h
+ * @brief Accurate, vectorized sum reductions, extrema and prefix scans for ndarray structures
+ *
+ * This header file provides the reduction engine behind mean(), variance(),
+ * std(), norm() and dot(). Contiguous runs of data are reduced with several
+ * independent accumulators so the compiler can keep them in SIMD registers,
+ * and the way partial sums are combined is selectable:
+ *
+ * - Pairwise (default): blocks of 128 elements are merged as a balanced tree,
+ *   the rounding error grows with O(log n) instead of O(n)
+ * - Kahan: every accumulator carries a compensation term, the error is
+ *   essentially independent of n at roughly twice the arithmetic cost
+ * - Naive: plain multi-accumulator summation, fastest and least accurate
+ *
+ * Array reductions split their input into fixed-size chunks that run on the
+ * worker pool (see parallel.h); chunk partials are combined in a fixed order,
+ * so a result never depends on the number of threads.
+ *
+ * Cumulative scans (nd_cumsum() and friends) use the classic two-pass
+ * parallel prefix scheme: chunk totals first, then every chunk rescans its
+ * data starting from the combined total of the chunks before it.
+ *
+ * @author [Your Name]
+ * @date [Date]
+ * @version 1.0
+ */
+
+#ifndef REDUCE
+#define REDUCE
+
+#include "ndarray.h"
+
+/* ========================================================================== */
+/*                              SUMMATION MODES                              */
+/* ========================================================================== */
+
+/**
+ * @brief Strategy used to combine partial sums
+ */
+typedef enum {
+    ND_SUM_PAIRWISE = 0,   /**< Blocked pairwise summation (default) */
+    ND_SUM_KAHAN,          /**< Kahan-compensated summation */
+    ND_SUM_NAIVE           /**< Uncompensated multi-accumulator summation */
+} nd_summation_t;
+
+/**
+ * @brief Element transformation applied before summing
+ */
+typedef enum {
+    ND_REDUCE_SUM = 0,     /**< Σ x */
+    ND_REDUCE_SUMSQ,       /**< Σ x² */
+    ND_REDUCE_SQDEV        /**< Σ (x - c)², c taken from a center array */
+} nd_reduce_op_t;
+
+/**
+ * @brief Selects the summation strategy used by every reduction
+ * @param mode One of ND_SUM_PAIRWISE, ND_SUM_KAHAN or ND_SUM_NAIVE
+ * @note The setting is process-wide and read once per reduction call
+ */
+extern void nd_set_summation(nd_summation_t mode);
+
+/**
+ * @brief Returns the current summation strategy
+ * @return nd_summation_t The active mode
+ */
+extern nd_summation_t nd_get_summation(void);
+
+/* ========================================================================== */
+/*                         CONTIGUOUS BUFFER KERNELS                         */
+/* ========================================================================== */
+
+/**
+ * @brief Sums n contiguous doubles
+ * @param x Pointer to the first element
+ * @param n Number of elements
+ * @return double Σ x[i], 0 when n is 0
+ */
+extern double nd_reduce_sum(const double *x, size_t n);
+
+/**
+ * @brief Sums the squares of n contiguous doubles
+ * @param x Pointer to the first element
+ * @param n Number of elements
+ * @return double Σ x[i]²
+ */
+extern double nd_reduce_sumsq(const double *x, size_t n);
+
+/**
+ * @brief Sums the squared deviations of n contiguous doubles from mu
+ * @param x Pointer to the first element
+ * @param n Number of elements
+ * @param mu Center value, typically the mean of x
+ * @return double Σ (x[i] - mu)²
+ */
+extern double nd_reduce_sqdev(const double *x, size_t n, double mu);
+
+/**
+ * @brief Inner product of two contiguous buffers
+ * @param x Pointer to the first operand
+ * @param y Pointer to the second operand
+ * @param n Number of elements in each buffer
+ * @return double Σ x[i] * y[i]
+ */
+extern double nd_reduce_dot(const double *x, const double *y, size_t n);
+
+/* ========================================================================== */
+/*                            NDARRAY REDUCTIONS                             */
+/* ========================================================================== */
+
+/**
+ * @brief Reduces an ndarray along an axis
+ * @param this Pointer to the input ndarray
+ * @param axis String specifying the reduction axis:
+ *             - "x": Reduce each row, returns (rows, 1)
+ *             - "y": Reduce each column, returns (1, cols)
+ *             - "all": Reduce every element, returns (1, 1)
+ * @param op Element transformation applied before summing
+ * @param center Array shaped like the result holding the center of each
+ *               reduced slice; required for ND_REDUCE_SQDEV, ignored otherwise
+ * @return ndarray_t New ndarray containing the reduced values
+ * @warning Exits with an axis error for any other axis string
+ *
+ * @code
+ * ndarray_t mu = mean(&data, "y");
+ * ndarray_t ss = nd_reduce_axis(&data, "y", ND_REDUCE_SQDEV, &mu);
+ * @endcode
+ */
+extern ndarray_t nd_reduce_axis(ndarray_t *this, char *axis, nd_reduce_op_t op, ndarray_t *center);
+
+/**
+ * @brief Sums array elements along an axis
+ * @param this Pointer to the input ndarray
+ * @param axis "x" (row sums), "y" (column sums) or "all" (grand total)
+ * @return ndarray_t New ndarray of shape (rows, 1), (1, cols) or (1, 1)
+ *
+ * @code
+ * nd_set_summation(ND_SUM_KAHAN);
+ * ndarray_t totals = nd_sum_axis(&series, "y");
+ * @endcode
+ */
+extern ndarray_t nd_sum_axis(ndarray_t *this, char *axis);
+
+/* ========================================================================== */
+/*                                 EXTREMA                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Minimum, maximum and their positions along an axis, in one pass
+ * @param this Pointer to the input ndarray
+ * @param axis String specifying the reduction axis:
+ *             - "x": Per row, outputs are (rows, 1) and positions are column indices
+ *             - "y": Per column, outputs are (1, cols) and positions are row indices
+ *             - "all": Whole array, outputs are (1, 1) and positions are flat
+ *               row-major indices (i * cols + j)
+ * @param min Output for the minima, or NULL to skip
+ * @param max Output for the maxima, or NULL to skip
+ * @param argmin Output for the positions of the minima, or NULL to skip
+ * @param argmax Output for the positions of the maxima, or NULL to skip
+ * @note Every requested output is allocated by the call; positions are stored
+ *       as doubles
+ * @note Ties resolve to the first occurrence; NaN values are skipped, and a
+ *       line holding only NaN reports NaN at position 0
+ * @warning Exits with an axis error for any other axis string
+ *
+ * @code
+ * ndarray_t lo, hi;
+ * nd_minmax(&signal, "x", &lo, &hi, NULL, NULL);   // row ranges for normalization
+ * @endcode
+ */
+extern void nd_minmax(ndarray_t *this, char *axis, ndarray_t *min, ndarray_t *max,
+                      ndarray_t *argmin, ndarray_t *argmax);
+
+/* ========================================================================== */
+/*                              PREFIX SCANS                                 */
+/* ========================================================================== */
+
+/**
+ * @brief Operation accumulated by a prefix scan
+ */
+typedef enum {
+    ND_SCAN_SUM = 0,       /**< Running sum */
+    ND_SCAN_PROD,          /**< Running product */
+    ND_SCAN_MIN,           /**< Running minimum */
+    ND_SCAN_MAX            /**< Running maximum */
+} nd_scan_op_t;
+
+/**
+ * @brief Cumulative scan of an ndarray along an axis
+ * @param this Pointer to the input ndarray
+ * @param out Output array of the same shape, this for an in-place scan,
+ *            or NULL to allocate a new array
+ * @param axis String specifying the scan direction:
+ *             - "x": Along each row, from the first column to the last
+ *             - "y": Down each column, from the first row to the last
+ *             - "all": Over every element in row-major order
+ * @param op Accumulated operation
+ * @return ndarray_t The scanned array (shares data with out when out is given)
+ * @note Element k of a scan combines elements 0..k, so the last element of an
+ *       "all" sum scan equals nd_sum_axis(this, "all") up to rounding
+ * @note With several threads, sums and products are assembled from chunk
+ *       totals and may differ from a serial scan in the last bits
+ */
+extern ndarray_t nd_scan(ndarray_t *this, ndarray_t *out, char *axis, nd_scan_op_t op);
+
+/**
+ * @brief Cumulative sum along an axis, see nd_scan()
+ *
+ * @code
+ * ndarray_t running = nd_cumsum(&series, NULL, "x");   // new array
+ * nd_cumsum(&series, &series, "all");                   // in place
+ * @endcode
+ */
+extern ndarray_t nd_cumsum(ndarray_t *this, ndarray_t *out, char *axis);
+
+/**
+ * @brief Cumulative product along an axis, see nd_scan()
+ */
+extern ndarray_t nd_cumprod(ndarray_t *this, ndarray_t *out, char *axis);
+
+/**
+ * @brief Cumulative minimum along an axis, see nd_scan()
+ */
+extern ndarray_t nd_cummin(ndarray_t *this, ndarray_t *out, char *axis);
+
+/**
+ * @brief Cumulative maximum along an axis, see nd_scan()
+ */
+extern ndarray_t nd_cummax(ndarray_t *this, ndarray_t *out, char *axis);
+
+#endif // !REDUCE
@@ -0,0 +1,124 @@
+/**
+ * @file sort.h
+ * @brief Sorting, ranking and selection for ndarray structures
+ *
+ * This header file provides sort, argsort, partition and top-k along an axis.
+ * Values are mapped to order-preserving 64-bit integer keys, so every
+ * algorithm compares plain integers:
+ *
+ * - Runs of up to 32 elements: insertion sort
+ * - Up to 4096 elements: bottom-up merge sort over insertion-sorted runs
+ * - Larger: LSD radix sort, 8 bits per pass, skipping passes where every key
+ *   shares the same byte
+ * - Very large lines: radix-sorted chunks on the worker pool, then parallel
+ *   merge rounds split along the merge path (see parallel.h)
+ * - Partition and top-k: introselect (median-of-three quickselect with a
+ *   sorting fallback), linear time on average
+ *
+ * Independent rows or columns are processed in parallel. All sorts are
+ * stable, so argsort returns equal values in their original order.
+ *
+ * @author [Your Name]
+ * @date [Date]
+ * @version 1.0
+ *
+ * @note NaN values sort after +inf; -0.0 sorts before +0.0
+ * @note Index results are stored as doubles, like every other ndarray
+ */
+
+#ifndef SORT
+#define SORT
+
+#include "ndarray.h"
+
+/* ========================================================================== */
+/*                           CONTIGUOUS BUFFERS                              */
+/* ========================================================================== */
+
+/**
+ * @brief Sorts n contiguous doubles in ascending order, in place
+ * @param x Pointer to the first element
+ * @param n Number of elements
+ */
+extern void nd_sort_buffer(double *x, size_t n);
+
+/* ========================================================================== */
+/*                              AXIS SORTING                                 */
+/* ========================================================================== */
+
+/**
+ * @brief Sorts an ndarray along an axis
+ * @param this Pointer to the input ndarray
+ * @param out Output array of the same shape, this for an in-place sort,
+ *            or NULL to allocate a new array
+ * @param axis String specifying the sort direction:
+ *             - "x": Sort each row
+ *             - "y": Sort each column
+ *             - "all": Sort every element, written back in row-major order
+ * @return ndarray_t The sorted array (shares data with out when out is given)
+ * @warning Exits with an axis error for any other axis string
+ *
+ * @code
+ * ndarray_t sorted = nd_sort(&data, NULL, "y");   // every column ascending
+ * nd_sort(&data, &data, "x");                      // in place
+ * @endcode
+ */
+extern ndarray_t nd_sort(ndarray_t *this, ndarray_t *out, char *axis);
+
+/**
+ * @brief Indices that sort an ndarray along an axis
+ * @param this Pointer to the input ndarray
+ * @param axis "x" (column indices per row), "y" (row indices per column) or
+ *             "all" (flat row-major indices)
+ * @return ndarray_t New ndarray shaped like this holding the indices
+ * @note The sort is stable: equal values keep their original order
+ *
+ * @code
+ * ndarray_t order = nd_argsort(&scores, "x");
+ * size_t best = (size_t)order.data[0][scores.shape[1] - 1];
+ * @endcode
+ */
+extern ndarray_t nd_argsort(ndarray_t *this, char *axis);
+
+/**
+ * @brief Partially sorts an ndarray along an axis around the kth element
+ * @param this Pointer to the input ndarray
+ * @param out Output array of the same shape, this for in place, or NULL
+ * @param kth Position, along the axis, that receives its sorted value
+ * @param axis "x", "y" or "all", as in nd_sort()
+ * @return ndarray_t Array whose kth element along the axis is the one a full
+ *         sort would put there, with no larger element before it and no
+ *         smaller element after it
+ * @warning Exits with an index error when kth is not smaller than the axis length
+ *
+ * @code
+ * size_t mid = data.shape[1] / 2;
+ * ndarray_t p = nd_partition(&data, NULL, mid, "x");   // p.data[i][mid] = row median
+ * @endcode
+ */
+extern ndarray_t nd_partition(ndarray_t *this, ndarray_t *out, size_t kth, char *axis);
+
+/**
+ * @brief The k largest (or smallest) values along an axis, sorted
+ * @param this Pointer to the input ndarray
+ * @param k Number of values to keep (1 <= k <= axis length)
+ * @param axis "x" (per row, returns (rows, k)), "y" (per column, returns
+ *             (k, cols)) or "all" (returns (1, k))
+ * @param largest true for the k largest values in descending order, false
+ *                for the k smallest in ascending order
+ * @param indices Optional output for the positions of the kept values, using
+ *                the same convention as nd_argsort(); allocated by the call
+ *                when not NULL
+ * @return ndarray_t New ndarray holding the selected values
+ * @note Runs in linear time per line plus O(k log k) for the final ordering
+ * @note Among equal values, which ones are kept and their order is unspecified
+ * @warning Exits with an index error for k == 0 or k larger than the axis length
+ *
+ * @code
+ * ndarray_t where;
+ * ndarray_t best = nd_topk(&scores, 5, "x", true, &where);
+ * @endcode
+ */
+extern ndarray_t nd_topk(ndarray_t *this, size_t k, char *axis, bool largest, ndarray_t *indices);
+
+#endif // !SORT
@@ -0,0 +1,105 @@
+/**
+ * @file sparse.h
+ * @brief Compressed sparse row matrices
+ *
+ * This header file provides a CSR (compressed sparse row) matrix type for
+ * systems too large to store densely, such as discretized PDEs and graphs:
+ *
+ * - Construction from (row, column, value) triplets, duplicates summed, or
+ *   from a dense ndarray
+ * - Conversion back to a dense ndarray
+ * - Sparse matrix-vector products on the worker pool (see parallel.h)
+ *
+ * The matrices feed the Krylov solvers and preconditioners of iterative.h.
+ *
+ * @author [Your Name]
+ * @date [Date]
+ * @version 1.0
+ *
+ * @note Matrices own their storage and must be released with nd_csr_free()
+ */
+
+#ifndef SPARSE
+#define SPARSE
+
+#include "ndarray.h"
+
+/* ========================================================================== */
+/*                                CSR TYPE                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Sparse matrix in compressed sparse row form
+ * @note The entries of row i are col[k], val[k] for k in
+ *       [row_ptr[i], row_ptr[i + 1]), with columns strictly ascending
+ */
+typedef struct {
+    size_t shape[2];    /**< Rows and columns */
+    size_t nnz;         /**< Number of stored entries */
+    size_t *row_ptr;    /**< rows + 1 offsets into col and val */
+    size_t *col;        /**< Column of each stored entry */
+    double *val;        /**< Value of each stored entry */
+} nd_csr_t;
+
+/* ========================================================================== */
+/*                              CONSTRUCTION                                 */
+/* ========================================================================== */
+
+/**
+ * @brief Builds a CSR matrix from coordinate triplets
+ * @param rows Number of rows (must be > 0)
+ * @param cols Number of columns (must be > 0)
+ * @param count Number of triplets
+ * @param ri Row of each triplet
+ * @param ci Column of each triplet
+ * @param v Value of each triplet
+ * @return nd_csr_t New matrix; triplets at the same position are summed
+ * @note Two counting sorts, O(count + rows + cols), in any input order
+ * @warning Exits with a shape error for zero dimensions and an index error
+ *          for a triplet outside the matrix
+ *
+ * @code
+ * size_t ri[] = {0, 1, 1}, ci[] = {0, 0, 1};
+ * double v[] = {4.0, -1.0, 4.0};
+ * nd_csr_t A = nd_csr_from_triplets(2, 2, 3, ri, ci, v);
+ * nd_csr_free(&A);
+ * @endcode
+ */
+extern nd_csr_t nd_csr_from_triplets(size_t rows, size_t cols, size_t count,
+                                     const size_t *ri, const size_t *ci, const double *v);
+
+/**
+ * @brief Builds a CSR matrix from the entries of a dense ndarray
+ * @param this Pointer to the ndarray
+ * @param drop Entries with |a| <= drop are not stored; 0 keeps every nonzero
+ * @return nd_csr_t New matrix
+ */
+extern nd_csr_t nd_csr_from_dense(ndarray_t *this, double drop);
+
+/**
+ * @brief Dense copy of a CSR matrix
+ * @param A Pointer to the matrix
+ * @return ndarray_t New rows x cols array, zero where nothing is stored
+ */
+extern ndarray_t nd_csr_to_dense(const nd_csr_t *A);
+
+/**
+ * @brief Releases the storage of a CSR matrix
+ * @param A Matrix to free; its pointers are reset to NULL
+ */
+extern void nd_csr_free(nd_csr_t *A);
+
+/* ========================================================================== */
+/*                                PRODUCTS                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Sparse matrix-vector product y = A x
+ * @param A Pointer to the rows x cols matrix
+ * @param x cols contiguous values
+ * @param y rows contiguous values, overwritten; must not overlap x
+ * @note Rows are split across the worker pool by stored entries
+ */
+extern void nd_csr_matvec(const nd_csr_t *A, const double *x, double *y);
+
+#endif // !SPARSE
@@ -0,0 +1,247 @@
+/**
+ * @file ufunc.h
+ * @brief Universal functions: element-wise and reduction kernels for ndarrays
+ *
+ * This header file defines the ufunc framework that backs the element-wise
+ * operations of operations.h and trig.h. A ufunc couples a kernel that works
+ * on one contiguous run of doubles with the machinery shared by every
+ * operation:
+ *
+ * - Optional output array, including in-place application (out == input)
+ * - 2D broadcasting of (1, cols), (rows, 1) and (1, 1) operands
+ * - Threaded execution over row and column chunks (see parallel.h)
+ * - Kernels compiled for several instruction sets, picked at load time
+ *
+ * Kernels are written once with the ND_*_KERNEL macros below; user code can
+ * use the same macros, register the result under a name, and get exactly the
+ * same execution path as the built-in functions.
+ *
+ * @author [Your Name]
+ * @date [Date]
+ * @version 1.0
+ *
+ * @note When an output array is supplied, the returned ndarray_t shares its
+ *       data: clean only one of them
+ */
+
+#ifndef UFUNC
+#define UFUNC
+
+#include "ndarray.h"
+#include "parallel.h"
+
+/* ========================================================================== */
+/*                              KERNEL TYPES                                 */
+/* ========================================================================== */
+
+/**
+ * @brief Element-wise kernel of one operand
+ * @param in Input run
+ * @param out Output run, may alias in
+ * @param n Number of elements
+ * @param arg Scalar parameter (exponent, scalar operand, ...) or 0
+ */
+typedef void (*nd_unary_kernel_t)(const double *in, double *out, size_t n, double arg);
+
+/**
+ * @brief Element-wise kernel of two operands
+ * @param a First operand run
+ * @param sa Stride of a: 1 for a full run, 0 for a broadcast scalar
+ * @param b Second operand run
+ * @param sb Stride of b: 1 for a full run, 0 for a broadcast scalar
+ * @param out Output run, may alias a or b when their stride is 1
+ * @param n Number of elements
+ */
+typedef void (*nd_binary_kernel_t)(const double *a, size_t sa, const double *b, size_t sb, double *out, size_t n);
+
+/**
+ * @brief Reduction kernel over one contiguous run
+ * @param in Input run
+ * @param n Number of elements
+ * @return double Reduced value, the identity when n is 0
+ */
+typedef double (*nd_reduce_kernel_t)(const double *in, size_t n);
+
+/**
+ * @brief Kind of a ufunc
+ */
+typedef enum {
+    ND_UFUNC_UNARY = 0,   /**< One operand, nd_unary_kernel_t */
+    ND_UFUNC_BINARY,      /**< Two operands, nd_binary_kernel_t */
+    ND_UFUNC_REDUCE       /**< Reduction, nd_reduce_kernel_t plus a binary combiner */
+} nd_ufunc_kind_t;
+
+/**
+ * @brief Ufunc descriptor
+ * @note Only the members matching kind need to be set
+ */
+typedef struct nd_ufunc {
+    const char *name;             /**< Registry name */
+    nd_ufunc_kind_t kind;         /**< Operand layout */
+    nd_unary_kernel_t unary;      /**< Kernel for ND_UFUNC_UNARY */
+    nd_binary_kernel_t binary;    /**< Kernel for ND_UFUNC_BINARY, combiner for ND_UFUNC_REDUCE */
+    nd_reduce_kernel_t reduce;    /**< Kernel for ND_UFUNC_REDUCE */
+} nd_ufunc_t;
+
+/* ========================================================================== */
+/*                            KERNEL DEFINITION                              */
+/* ========================================================================== */
+
+/**
+ * @brief Defines a static unary kernel from an expression of x (and arg)
+ *
+ * @code
+ * ND_UNARY_KERNEL(sigmoid_kernel, 1.0 / (1.0 + exp(-x)))
+ * static const nd_ufunc_t sigmoid = { "sigmoid", ND_UFUNC_UNARY, sigmoid_kernel, NULL, NULL };
+ * @endcode
+ */
+#define ND_UNARY_KERNEL(name, expr)                                                   \
+    ND_SIMD_CLONES static void name(const double *in, double *out, size_t n, double arg) \
+    {                                                                                 \
+        (void)arg;                                                                    \
+        for (size_t i = 0; i < n; i++)                                                \
+        {                                                                             \
+            const double x = in[i];                                                   \
+            out[i] = (expr);                                                          \
+        }                                                                             \
+    }
+
+/**
+ * @brief Defines a static binary kernel from an expression of x and y
+ * @note The four stride combinations get their own loop, so the broadcast
+ *       operand is loaded once and the loop body stays vectorizable
+ */
+#define ND_BINARY_KERNEL(name, expr)                                                  \
+    ND_SIMD_CLONES static void name(const double *a, size_t sa, const double *b,     \
+                                    size_t sb, double *out, size_t n)                 \
+    {                                                                                 \
+        if (sa && sb)                                                                 \
+            for (size_t i = 0; i < n; i++)                                            \
+            { const double x = a[i]; const double y = b[i]; out[i] = (expr); }        \
+        else if (sa)                                                                  \
+        {                                                                             \
+            const double y = b[0];                                                    \
+            for (size_t i = 0; i < n; i++)                                            \
+            { const double x = a[i]; out[i] = (expr); }                               \
+        }                                                                             \
+        else if (sb)                                                                  \
+        {                                                                             \
+            const double x = a[0];                                                    \
+            for (size_t i = 0; i < n; i++)                                            \
+            { const double y = b[i]; out[i] = (expr); }                               \
+        }                                                                             \
+        else                                                                          \
+        {                                                                             \
+            const double x = a[0]; const double y = b[0]; const double v = (expr);    \
+            for (size_t i = 0; i < n; i++)                                            \
+                out[i] = v;                                                           \
+        }                                                                             \
+    }
+
+/**
+ * @brief Defines a static reduction kernel folding x into acc
+ * @param name Kernel name
+ * @param init Identity element of the reduction
+ * @param expr New accumulator value as an expression of acc and x
+ * @note Eight independent accumulators are folded in a fixed order
+ *
+ * @code
+ * ND_REDUCE_KERNEL(maxabs_kernel, 0.0, fmax(acc, fabs(x)))
+ * @endcode
+ */
+#define ND_REDUCE_KERNEL(name, init, expr)                                            \
+    ND_SIMD_CLONES static double name(const double *in, size_t n)                     \
+    {                                                                                 \
+        double lane[8];                                                               \
+        size_t i = 0;                                                                 \
+        for (size_t k = 0; k < 8; k++)                                                \
+            lane[k] = (init);                                                         \
+        for (; i + 8 <= n; i += 8)                                                    \
+            for (size_t k = 0; k < 8; k++)                                            \
+            { const double acc = lane[k]; const double x = in[i + k]; lane[k] = (expr); } \
+        double total = (init);                                                        \
+        for (size_t k = 0; k < 8; k++)                                                \
+        { const double acc = total; const double x = lane[k]; total = (expr); }       \
+        for (; i < n; i++)                                                            \
+        { const double acc = total; const double x = in[i]; total = (expr); }         \
+        return total;                                                                 \
+    }
+
+/* ========================================================================== */
+/*                               REGISTRY                                    */
+/* ========================================================================== */
+
+/**
+ * @brief Registers a ufunc under its name
+ * @param ufunc Descriptor to register; it must stay valid while registered
+ * @note A later registration with the same name shadows earlier ones,
+ *       built-ins included
+ */
+extern void nd_ufunc_register(const nd_ufunc_t *ufunc);
+
+/**
+ * @brief Looks a ufunc up by name
+ * @param name Registered or built-in name, e.g. "exp", "add", "max"
+ * @return const nd_ufunc_t* Descriptor, or NULL when the name is unknown
+ */
+extern const nd_ufunc_t *nd_ufunc_find(const char *name);
+
+/* ========================================================================== */
+/*                               EXECUTION                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Applies a unary ufunc element-wise
+ * @param ufunc Unary descriptor
+ * @param this Input array
+ * @param out Output array of the same shape, this for in-place, or NULL to allocate
+ * @param arg Scalar parameter forwarded to the kernel
+ * @return ndarray_t The result (shares data with out when out is given)
+ */
+extern ndarray_t nd_ufunc_unary(const nd_ufunc_t *ufunc, ndarray_t *this, ndarray_t *out, double arg);
+
+/**
+ * @brief Applies a binary ufunc element-wise with broadcasting
+ * @param ufunc Binary descriptor
+ * @param a First operand
+ * @param b Second operand
+ * @param out Output of the broadcast shape, a or b for in-place, or NULL to allocate
+ * @return ndarray_t The result (shares data with out when out is given)
+ * @note Each dimension of a and b must match or be 1
+ * @warning Exits with a dimension message when the shapes do not broadcast
+ */
+extern ndarray_t nd_ufunc_binary(const nd_ufunc_t *ufunc, ndarray_t *a, ndarray_t *b, ndarray_t *out);
+
+/**
+ * @brief Applies a reduction ufunc along an axis
+ * @param ufunc Reduction descriptor
+ * @param this Input array
+ * @param axis "x" (per row, (rows, 1)), "y" (per column, (1, cols)) or "all" ((1, 1))
+ * @return ndarray_t New ndarray holding the reduced values
+ */
+extern ndarray_t nd_ufunc_reduce(const nd_ufunc_t *ufunc, ndarray_t *this, char *axis);
+
+/* ========================================================================== */
+/*                              BUILT-IN UFUNCS                              */
+/* ========================================================================== */
+
+/** @brief Binary built-ins: "add", "subtract", "multiply", "divide", "maximum", "minimum" */
+extern const nd_ufunc_t nd_ufunc_add, nd_ufunc_subtract, nd_ufunc_multiply,
+                        nd_ufunc_divide, nd_ufunc_maximum, nd_ufunc_minimum;
+
+/** @brief Scalar built-ins taking arg as the right operand: "add_scalar", "subtract_scalar", ... */
+extern const nd_ufunc_t nd_ufunc_add_scalar, nd_ufunc_subtract_scalar,
+                        nd_ufunc_multiply_scalar, nd_ufunc_divide_scalar, nd_ufunc_power;
+
+/** @brief Unary math built-ins: "negative", "abs", "sqrt", "square", "cube", "exp", "log10", "log2" */
+extern const nd_ufunc_t nd_ufunc_negative, nd_ufunc_abs, nd_ufunc_sqrt, nd_ufunc_square,
+                        nd_ufunc_cube, nd_ufunc_exp, nd_ufunc_log10, nd_ufunc_log2;
+
+/** @brief Trigonometric built-ins: "sin", "cos", "tan", "sinh", "cosh", "tanh", "sec", "cosec", "cot" */
+extern const nd_ufunc_t nd_ufunc_sin, nd_ufunc_cos, nd_ufunc_tan, nd_ufunc_sinh, nd_ufunc_cosh,
+                        nd_ufunc_tanh, nd_ufunc_sec, nd_ufunc_cosec, nd_ufunc_cot;
+
+/** @brief Reduction built-ins: "sum", "prod", "max", "min" */
+extern const nd_ufunc_t nd_ufunc_sum, nd_ufunc_prod, nd_ufunc_max, nd_ufunc_min;
+
+#endif // !UFUNC
@@ -4,6 +4,8 @@
 #include <ndmath/helper.h>
 #include <ndmath/operations.h>
 #include <ndmath/conditionals.h>
+#include <ndmath/sort.h>
+#include <ndmath/reduce.h>
 #include <math.h>
 
 
@@ -137,125 +139,18 @@
 
     ndarray_t argmin(ndarray_t *this, char *axis)
     {
-        if(this == NULL)
-        {
-            null_error();
-        }
-        if(strcmp("x", axis)==0)  // Min along rows (for each row)
-        {
-            ndarray_t result = array(this->shape[0], 1);
-
-            for(int i=0; i<(int)this->shape[0]; i++)
-            {
-                double temp = this->data[i][0];  // Initialize with first element of row
-                for(int j=1; j<(int)this->shape[1]; j++)
-                {
-                    if(this->data[i][j] < temp)
-                        temp = this->data[i][j];
-                }
-                result.data[i][0] = temp;
-            }
-            return result;
-        }
-        else if (strcmp("y", axis)==0)  // Min along columns (for each column)
-        {
-            ndarray_t result = array(1, this->shape[1]);
-
-            for(int j=0; j<(int)this->shape[1]; j++)
-            {
-                double temp = this->data[0][j];  // Initialize with first element of column
-                for(int i=1; i<(int)this->shape[0]; i++)
-                {
-                    if(this->data[i][j] < temp)
-                        temp = this->data[i][j];
-                }
-                result.data[0][j] = temp;
-            }
-            return result;
-        }
-        else if (strcmp("all", axis)==0)
-        {
-            ndarray_t result = array(1, 1);
-            result.data[0][0] = this->data[0][0];
-
-            for(int i=0; i<(int)this->shape[0]; i++)
-            {
-                for(int j=0; j<(int)this->shape[1]; j++)
-                {
-                    if(this->data[i][j] < result.data[0][0])
-                        result.data[0][0] = this->data[i][j];
-                }
-            }
-            return result;
-        }
-        else
-        { 
-            axis_error(axis);
-            exit(1);
-        } 
+        ndarray_t result = {0};
+        nd_minmax(this, axis, NULL, NULL, &result, NULL);
+        return result;
     }
 
     ndarray_t argmax(ndarray_t *this, char *axis)
     {
-        if(this == NULL)
-        {
-            null_error();
-        }
-        if(strcmp("x", axis)==0)  // Max along rows (for each row)
-        {
-            ndarray_t result = array(this->shape[0], 1);
-
-            for(int i=0; i<(int)this->shape[0]; i++)
-            {
-                double temp = this->data[i][0];  // Initialize with first element of row
-                for(int j=1; j<(int)this->shape[1]; j++)
-                {
-                    if(this->data[i][j] > temp)
-                        temp = this->data[i][j];
-                }
-                result.data[i][0] = temp;
-            }
-            return result;
-        }
-        else if (strcmp("y", axis)==0)  // Max along columns (for each column)
-        {
-            ndarray_t result = array(1, this->shape[1]);
-
-            for(int j=0; j<(int)this->shape[1]; j++)
-            {
-                double temp = this->data[0][j];  // Initialize with first element of column
-                for(int i=1; i<(int)this->shape[0]; i++)
-                {
-                    if(this->data[i][j] > temp)
-                        temp = this->data[i][j];
-                }
-                result.data[0][j] = temp;
-            }
-            return result;
-        }
-        else if (strcmp("all", axis)==0)
-        {
-            ndarray_t result = array(1, 1);
-            result.data[0][0] = this->data[0][0];
-            for(int i=0; i<(int)this->shape[0]; i++)
-            {
-                for(int j=0; j<(int)this->shape[1]; j++)
-                {
-                    if(this->data[i][j] > result.data[0][0])
-                        result.data[0][0] = this->data[i][j];
-                }
-            }
-            return result;
-        }
-        else
-        { 
-            axis_error(axis);
-            exit(1);
-        } 
+        ndarray_t result = {0};
+        nd_minmax(this, axis, NULL, NULL, NULL, &result);
+        return result;
     }
 
-
-
     ndarray_t lower_triangle(double fill, size_t rows, size_t cols)
     {
         ndarray_t result = zeros(rows, cols);  // Initialize with zeros
@@ -401,6 +296,41 @@
     
 
 
+    ndarray_t nd_view(ndarray_t *this, size_t row, size_t col, size_t rows, size_t cols)
+    {
+        if(isnull(this))
+        {
+            null_error();
+            exit(EXIT_FAILURE);
+        }
+
+        if(rows == 0 || cols == 0)
+            shape_error();
+        if(row + rows > this->shape[0] || col + cols > this->shape[1])
+            index_error();
+
+        ndarray_t view = {0};
+        view.data = (double **)malloc(sizeof(double*) * rows);
+        if(view.data == NULL)
+            malloc_error();
+
+        for(size_t i = 0; i < rows; i++)
+            view.data[i] = this->data[row + i] + col;
+
+        view.shape[0] = rows;
+        view.shape[1] = cols;
+        view.size = rows * cols;
+        return view;
+    }
+
+    void nd_view_free(ndarray_t *view)
+    {
+        if(view == NULL)
+            return;
+        free(view->data);
+        view->data = NULL;
+    }
+
     void rassign_inplace(ndarray_t *this, ndarray_t *arrayB, size_t send_row_index, size_t rec_row_index)
     {
         if (isnull(this) || isnull(arrayB))
@@ -552,15 +482,6 @@
     }
 
 
-    static int compare_double_values(const void *a, const void *b) {
-        const double *da = (const double *)a;
-        const double *db = (const double *)b;
-        
-        if (*da < *db) return -1;
-        if (*da > *db) return 1;
-        return 0;
-    }
-
     /**
      * @brief Check if two double values are approximately equal
      * @internal
@@ -663,7 +584,7 @@
         }
         
         // Sort values
-        qsort(all_values, total_elements, sizeof(double), compare_double_values);
+        nd_sort_buffer(all_values, total_elements);
         
         // Count unique values
         size_t unique_count = 1;
@@ -0,0 +1,382 @@
+#include <ndmath/backend.h>
+#include <ndmath/array.h>
+#include <ndmath/error.h>
+#include <ndmath/conditionals.h>
+#include <pthread.h>
+#include <string.h>
+#include <limits.h>
+
+#ifdef ND_USE_CBLAS
+#include <cblas.h>
+#endif
+
+#pragma GCC push_options
+#pragma GCC optimize("O3", "unroll-loops")
+
+#define BK_MIN_WORK 2097152     // m * n * k below which products stay on the built-in kernels
+#define BK_MIN_ORDER 64         // order below which factorizations stay on the built-in kernels
+
+#define ALWAYS_INLINE static inline __attribute__((always_inline))
+
+static pthread_once_t backend_once = PTHREAD_ONCE_INIT;
+static nd_backend_t selected = ND_BACKEND_BUILTIN;   // read by pool workers: accessed atomically
+
+/** Selection */
+
+    static void init_backend(void)
+    {
+#ifdef ND_USE_CBLAS
+        const char *env = getenv("NDMATH_BACKEND");
+        selected = env != NULL && strcmp(env, "builtin") == 0 ? ND_BACKEND_BUILTIN : ND_BACKEND_EXTERNAL;
+#endif
+    }
+
+    bool nd_set_backend(nd_backend_t backend)
+    {
+        pthread_once(&backend_once, init_backend);
+#ifndef ND_USE_CBLAS
+        if(backend == ND_BACKEND_EXTERNAL)
+            return false;
+#endif
+        __atomic_store_n(&selected, backend, __ATOMIC_RELAXED);
+        return true;
+    }
+
+    nd_backend_t nd_get_backend(void)
+    {
+        pthread_once(&backend_once, init_backend);
+        return __atomic_load_n(&selected, __ATOMIC_RELAXED);
+    }
+
+    const char *nd_backend_name(void)
+    {
+#if defined(ND_USE_CBLAS) && defined(OPENBLAS_VERSION)
+        return openblas_get_config();
+#elif defined(ND_USE_CBLAS)
+        return "cblas";
+#else
+        return "builtin";
+#endif
+    }
+
+#ifdef ND_USE_CBLAS
+
+/** LAPACK, through the Fortran interface; character arguments carry their hidden lengths */
+
+extern void dgetrf_(const int *m, const int *n, double *a, const int *lda, int *ipiv, int *info);
+extern void dgeqrf_(const int *m, const int *n, double *a, const int *lda, double *tau,
+                    double *work, const int *lwork, int *info);
+extern void dorgqr_(const int *m, const int *n, const int *k, double *a, const int *lda, const double *tau,
+                    double *work, const int *lwork, int *info);
+extern void dsyevd_(const char *jobz, const char *uplo, const int *n, double *a, const int *lda, double *w,
+                    double *work, const int *lwork, int *iwork, const int *liwork, int *info,
+                    size_t jobz_len, size_t uplo_len);
+extern void dgeev_(const char *jobvl, const char *jobvr, const int *n, double *a, const int *lda,
+                   double *wr, double *wi, double *vl, const int *ldvl, double *vr, const int *ldvr,
+                   double *work, const int *lwork, int *info, size_t jobvl_len, size_t jobvr_len);
+extern void dgesdd_(const char *jobz, const int *m, const int *n, double *a, const int *lda, double *s,
+                    double *u, const int *ldu, double *vt, const int *ldvt, double *work, const int *lwork,
+                    int *iwork, int *info, size_t jobz_len);
+
+/** Buffers */
+
+    ALWAYS_INLINE bool external(void)
+    {
+        return nd_get_backend() == ND_BACKEND_EXTERNAL;
+    }
+
+    // True when every extent fits the 32-bit integers of the LAPACK and CBLAS interfaces
+    ALWAYS_INLINE bool fits(size_t rows, size_t cols)
+    {
+        return rows <= INT_MAX && cols <= INT_MAX && rows * cols <= INT_MAX;
+    }
+
+    static double *buffer(size_t count)
+    {
+        double *p = malloc(sizeof(double) * (count > 0 ? count : 1));
+        if (p == NULL)
+            malloc_error();
+        return p;
+    }
+
+    // A as a contiguous row-major buffer, which LAPACK reads as the column-major Aᵀ
+    static double *pack_rows(const ndarray_t *A)
+    {
+        size_t m = A->shape[0], n = A->shape[1];
+        double *p = buffer(m * n);
+        for (size_t i = 0; i < m; i++)
+            memcpy(p + i * n, A->data[i], sizeof(double) * n);
+        return p;
+    }
+
+    // A as a contiguous column-major buffer
+    static double *pack_columns(const ndarray_t *A)
+    {
+        size_t m = A->shape[0], n = A->shape[1];
+        double *p = buffer(m * n);
+        for (size_t i = 0; i < m; i++)
+        {
+            const double *row = A->data[i];
+            for (size_t j = 0; j < n; j++)
+                p[j * m + i] = row[j];
+        }
+        return p;
+    }
+
+/** Products */
+
+    bool nd_backend_gemm(nd_transpose_t transA, nd_transpose_t transB, double alpha,
+                         ndarray_t *A, ndarray_t *B, double beta, ndarray_t *C)
+    {
+        size_t m = C->shape[0], n = C->shape[1];
+        size_t k = transA == ND_NO_TRANS ? A->shape[1] : A->shape[0];
+        if(!external() || m * n * k < BK_MIN_WORK
+           || !fits(A->shape[0], A->shape[1]) || !fits(B->shape[0], B->shape[1]) || !fits(m, n))
+            return false;
+
+        // A Aᵀ or Aᵀ A: one triangle by dsyrk, mirrored, so the result stays exactly symmetric as
+        // with the built-in kernel (symmetry tests in eig() and nd_solve_mixed() rely on it)
+        if(A->data == B->data && A->shape[0] == B->shape[0] && A->shape[1] == B->shape[1]
+           && transA != transB && beta == 0.0)
+        {
+            double *a = pack_rows(A), *c = buffer(m * m);
+            cblas_dsyrk(CblasRowMajor, CblasUpper, transA == ND_TRANS ? CblasTrans : CblasNoTrans,
+                        (int)m, (int)k, alpha, a, (int)A->shape[1], 0.0, c, (int)m);
+            for(size_t i = 0; i < m; i++)
+                for(size_t j = i; j < m; j++)
+                    C->data[i][j] = C->data[j][i] = c[i * m + j];
+            free(a);
+            free(c);
+            return true;
+        }
+
+        double *a = pack_rows(A), *b = pack_rows(B);
+        double *c = beta != 0.0 ? pack_rows(C) : buffer(m * n);
+        cblas_dgemm(CblasRowMajor, transA == ND_TRANS ? CblasTrans : CblasNoTrans,
+                    transB == ND_TRANS ? CblasTrans : CblasNoTrans, (int)m, (int)n, (int)k,
+                    alpha, a, (int)A->shape[1], b, (int)B->shape[1], beta, c, (int)n);
+        for(size_t i = 0; i < m; i++)
+            memcpy(C->data[i], c + i * n, sizeof(double) * n);
+        free(a);
+        free(b);
+        free(c);
+        return true;
+    }
+
+    bool nd_backend_sgemm(nd_transpose_t transA, nd_transpose_t transB, size_t m, size_t n, size_t k,
+                          float alpha, const float *A, size_t lda, const float *B, size_t ldb,
+                          float beta, float *C, size_t ldc)
+    {
+        if(!external() || m * n * k < BK_MIN_WORK || !fits(m, n) || k > INT_MAX
+           || lda > INT_MAX || ldb > INT_MAX || ldc > INT_MAX)
+            return false;
+
+        // The storage is already row-major with leading dimensions
+        cblas_sgemm(CblasRowMajor, transA == ND_TRANS ? CblasTrans : CblasNoTrans,
+                    transB == ND_TRANS ? CblasTrans : CblasNoTrans, (int)m, (int)n, (int)k,
+                    alpha, A, (int)lda, B, (int)ldb, beta, C, (int)ldc);
+        return true;
+    }
+
+/** Factorizations */
+
+    bool nd_backend_lu(ndarray_t *A, nd_lu_t *lu)
+    {
+        size_t n = A->shape[0];
+        if(!external() || n < BK_MIN_ORDER || !fits(n, n))
+            return false;
+
+        int N = (int)n, info = 0;
+        int *ipiv = malloc(sizeof(int) * n);
+        if(ipiv == NULL)
+            malloc_error();
+        double *a = pack_columns(A);
+        dgetrf_(&N, &N, a, &N, ipiv, &info);
+
+        // ipiv holds the row interchanges in order; applied to the identity they give perm
+        lu->LU = array(n, n);
+        lu->perm = malloc(sizeof(size_t) * n);
+        if(lu->perm == NULL)
+            malloc_error();
+        for(size_t i = 0; i < n; i++)
+            lu->perm[i] = i;
+        lu->sign = 1;
+        for(size_t i = 0; i < n; i++)
+        {
+            size_t p = (size_t)ipiv[i] - 1;
+            if(p != i)
+            {
+                size_t t = lu->perm[i];
+                lu->perm[i] = lu->perm[p];
+                lu->perm[p] = t;
+                lu->sign = -lu->sign;
+            }
+        }
+        for(size_t i = 0; i < n; i++)
+            for(size_t j = 0; j < n; j++)
+                lu->LU.data[i][j] = a[j * n + i];
+        lu->singular = info > 0;
+
+        free(a);
+        free(ipiv);
+        return true;
+    }
+
+    bool nd_backend_qr(ndarray_t *A, ndarray_t *Q, ndarray_t *R)
+    {
+        size_t m = A->shape[0], n = A->shape[1], k = m < n ? m : n;
+        if(!external() || k < BK_MIN_ORDER || !fits(m, n))
+            return false;
+
+        int M = (int)m, N = (int)n, K = (int)k, lwork = -1, info = 0;
+        double *a = pack_columns(A), *tau = buffer(k), query = 0.0;
+
+        // One workspace query covers both calls: dorgqr needs no more than dgeqrf for these shapes
+        dgeqrf_(&M, &N, a, &M, tau, &query, &lwork, &info);
+        lwork = (int)query;
+        dorgqr_(&M, &K, &K, a, &M, tau, &query, &(int){-1}, &info);
+        if((int)query > lwork)
+            lwork = (int)query;
+        double *work = buffer((size_t)lwork);
+
+        dgeqrf_(&M, &N, a, &M, tau, work, &lwork, &info);
+        *R = zeros(k, n);
+        for(size_t i = 0; i < k; i++)
+            for(size_t j = i; j < n; j++)
+                R->data[i][j] = a[j * m + i];
+        dorgqr_(&M, &K, &K, a, &M, tau, work, &lwork, &info);
+        *Q = array(m, k);
+        for(size_t i = 0; i < m; i++)
+            for(size_t j = 0; j < k; j++)
+                Q->data[i][j] = a[j * m + i];
+
+        free(a);
+        free(tau);
+        free(work);
+        return true;
+    }
+
+/** Spectra */
+
+    bool nd_backend_eigvals(ndarray_t *A, bool symmetric, ndarray_t *values)
+    {
+        size_t n = A->shape[0];
+        if(!external() || n < BK_MIN_ORDER || !fits(n, n))
+            return false;
+
+        int N = (int)n, lwork = -1, liwork = -1, info = 0, iquery = 0;
+        double query = 0.0;
+        double *w = buffer(2 * n), *a;
+        if(symmetric)
+        {
+            // Row-major storage read as column-major is Aᵀ = A
+            a = pack_rows(A);
+            dsyevd_("N", "L", &N, a, &N, w, &query, &lwork, &iquery, &liwork, &info, 1, 1);
+            lwork = (int)query;
+            liwork = iquery;
+            double *work = buffer((size_t)lwork);
+            int *iwork = malloc(sizeof(int) * (size_t)(liwork > 0 ? liwork : 1));
+            if(iwork == NULL)
+                malloc_error();
+            dsyevd_("N", "L", &N, a, &N, w, work, &lwork, iwork, &liwork, &info, 1, 1);
+            free(work);
+            free(iwork);
+        }
+        else
+        {
+            int one = 1;
+            a = pack_columns(A);
+            dgeev_("N", "N", &N, a, &N, w, w + n, NULL, &one, NULL, &one, &query, &lwork, &info, 1, 1);
+            lwork = (int)query;
+            double *work = buffer((size_t)lwork);
+            dgeev_("N", "N", &N, a, &N, w, w + n, NULL, &one, NULL, &one, work, &lwork, &info, 1, 1);
+            free(work);
+        }
+        free(a);
+
+        // A failure to converge leaves the work to the built-in kernels
+        if(info != 0)
+        {
+            free(w);
+            return false;
+        }
+        *values = array(1, n);
+        memcpy(values->data[0], w, sizeof(double) * n);
+        free(w);
+        return true;
+    }
+
+    bool nd_backend_svdvals(ndarray_t *A, ndarray_t *values)
+    {
+        size_t m = A->shape[0], n = A->shape[1], k = m < n ? m : n;
+        if(!external() || k < BK_MIN_ORDER || !fits(m, n))
+            return false;
+
+        // Row-major storage read as column-major is Aᵀ, which has the same singular values
+        int M = (int)n, N = (int)m, one = 1, lwork = -1, info = 0;
+        double *a = pack_rows(A), *s = buffer(k), query = 0.0;
+        int *iwork = malloc(sizeof(int) * 8 * k);
+        if(iwork == NULL)
+            malloc_error();
+        dgesdd_("N", &M, &N, a, &M, s, NULL, &one, NULL, &one, &query, &lwork, iwork, &info, 1);
+        lwork = (int)query;
+        double *work = buffer((size_t)lwork);
+        dgesdd_("N", &M, &N, a, &M, s, NULL, &one, NULL, &one, work, &lwork, iwork, &info, 1);
+
+        if(info == 0)
+        {
+            *values = array(1, k);
+            memcpy(values->data[0], s, sizeof(double) * k);
+        }
+        free(a);
+        free(s);
+        free(work);
+        free(iwork);
+        return info == 0;
+    }
+
+#else
+
+    bool nd_backend_gemm(nd_transpose_t transA, nd_transpose_t transB, double alpha,
+                         ndarray_t *A, ndarray_t *B, double beta, ndarray_t *C)
+    {
+        (void)transA; (void)transB; (void)alpha; (void)A; (void)B; (void)beta; (void)C;
+        return false;
+    }
+
+    bool nd_backend_sgemm(nd_transpose_t transA, nd_transpose_t transB, size_t m, size_t n, size_t k,
+                          float alpha, const float *A, size_t lda, const float *B, size_t ldb,
+                          float beta, float *C, size_t ldc)
+    {
+        (void)transA; (void)transB; (void)m; (void)n; (void)k; (void)alpha;
+        (void)A; (void)lda; (void)B; (void)ldb; (void)beta; (void)C; (void)ldc;
+        return false;
+    }
+
+    bool nd_backend_lu(ndarray_t *A, nd_lu_t *lu)
+    {
+        (void)A; (void)lu;
+        return false;
+    }
+
+    bool nd_backend_qr(ndarray_t *A, ndarray_t *Q, ndarray_t *R)
+    {
+        (void)A; (void)Q; (void)R;
+        return false;
+    }
+
+    bool nd_backend_eigvals(ndarray_t *A, bool symmetric, ndarray_t *values)
+    {
+        (void)A; (void)symmetric; (void)values;
+        return false;
+    }
+
+    bool nd_backend_svdvals(ndarray_t *A, ndarray_t *values)
+    {
+        (void)A; (void)values;
+        return false;
+    }
+
+#endif // ND_USE_CBLAS
+
+#pragma GCC pop_options
@@ -0,0 +1,199 @@
+#include <ndmath/batched.h>
+#include <ndmath/parallel.h>
+#include <ndmath/array.h>
+#include <ndmath/error.h>
+#include <ndmath/conditionals.h>
+#include <math.h>
+#include <stdint.h>
+
+#pragma GCC push_options
+#pragma GCC optimize("O3", "unroll-loops")
+
+#define BT_LANES 8              // items eliminated side by side, one per SIMD lane
+#define BT_TASK_WORK 65536      // multiply-adds per task
+
+typedef struct {
+    ndarray_t *A, *B, *X;       // B NULL: solve against the identity
+    size_t n, k;                // order of the matrices, right-hand sides per item
+    size_t count;               // items in the batch
+} batch_ctx_t;
+
+/** Elimination */
+
+    /*
+     * Entry (i, j) of the matrices of a group is a[(i * n + j) * BT_LANES + lane] and entry (i, c)
+     * of the right-hand sides is x[(i * k + c) * BT_LANES + lane], so every loop below runs over
+     * the lanes innermost. Row p takes the largest pivot of each lane by a conditional swap with
+     * every row below it, which needs no branch per lane. The diagonal is then replaced by its
+     * reciprocal for the back substitution. A zero pivot marks its lane in bad; the inf and NaN
+     * it produces stay in that lane.
+     */
+    ND_SIMD_CLONES static void batch_eliminate(double *a, double *x, size_t n, size_t k, double *bad)
+    {
+        for (size_t p = 0; p < n; p++)
+        {
+            double *ap = a + p * n * BT_LANES, *xp = x + p * k * BT_LANES;
+
+            for (size_t i = p + 1; i < n; i++)
+            {
+                double *ai = a + i * n * BT_LANES, *xi = x + i * k * BT_LANES;
+                int64_t swap[BT_LANES];
+                for (size_t l = 0; l < BT_LANES; l++)
+                    swap[l] = fabs(ai[p * BT_LANES + l]) > fabs(ap[p * BT_LANES + l]);
+
+                for (size_t e = p * BT_LANES; e < n * BT_LANES; e += BT_LANES)
+                    for (size_t l = 0; l < BT_LANES; l++)
+                    {
+                        double u = ap[e + l], v = ai[e + l];
+                        ap[e + l] = swap[l] ? v : u;
+                        ai[e + l] = swap[l] ? u : v;
+                    }
+                for (size_t e = 0; e < k * BT_LANES; e += BT_LANES)
+                    for (size_t l = 0; l < BT_LANES; l++)
+                    {
+                        double u = xp[e + l], v = xi[e + l];
+                        xp[e + l] = swap[l] ? v : u;
+                        xi[e + l] = swap[l] ? u : v;
+                    }
+            }
+
+            double inv[BT_LANES];
+            for (size_t l = 0; l < BT_LANES; l++)
+            {
+                bad[l] += ap[p * BT_LANES + l] == 0.0;
+                inv[l] = 1.0 / ap[p * BT_LANES + l];
+                ap[p * BT_LANES + l] = inv[l];
+            }
+
+            for (size_t i = p + 1; i < n; i++)
+            {
+                double *ai = a + i * n * BT_LANES, *xi = x + i * k * BT_LANES;
+                double f[BT_LANES];
+                for (size_t l = 0; l < BT_LANES; l++)
+                    f[l] = ai[p * BT_LANES + l] * inv[l];
+
+                for (size_t e = (p + 1) * BT_LANES; e < n * BT_LANES; e += BT_LANES)
+                    for (size_t l = 0; l < BT_LANES; l++)
+                        ai[e + l] -= f[l] * ap[e + l];
+                for (size_t e = 0; e < k * BT_LANES; e += BT_LANES)
+                    for (size_t l = 0; l < BT_LANES; l++)
+                        xi[e + l] -= f[l] * xp[e + l];
+            }
+        }
+
+        // U X = Y, bottom row first
+        for (size_t p = n; p-- > 0;)
+        {
+            double *ap = a + p * n * BT_LANES, *xp = x + p * k * BT_LANES;
+            for (size_t c = 0; c < k; c++)
+            {
+                double *xc = xp + c * BT_LANES;
+                for (size_t j = p + 1; j < n; j++)
+                {
+                    const double *xj = x + (j * k + c) * BT_LANES;
+                    for (size_t l = 0; l < BT_LANES; l++)
+                        xc[l] -= ap[j * BT_LANES + l] * xj[l];
+                }
+                for (size_t l = 0; l < BT_LANES; l++)
+                    xc[l] *= ap[p * BT_LANES + l];
+            }
+        }
+    }
+
+    // Groups [begin, end): gathers BT_LANES items into the lanes, eliminates, scatters the solutions
+    static void batch_task(size_t begin, size_t end, void *ctx)
+    {
+        batch_ctx_t *bc = ctx;
+        size_t n = bc->n, k = bc->k;
+        double *a = malloc(sizeof(double) * n * n * BT_LANES);
+        double *x = malloc(sizeof(double) * n * k * BT_LANES);
+        if (a == NULL || x == NULL)
+            malloc_error();
+
+        for (size_t g = begin; g < end; g++)
+        {
+            size_t first = g * BT_LANES;
+            size_t lanes = bc->count - first < BT_LANES ? bc->count - first : BT_LANES;
+
+            // Lanes past the end of the batch solve I X = 0, or I X = I for an inverse
+            for (size_t l = 0; l < BT_LANES; l++)
+            {
+                const double *Ai = l < lanes ? bc->A->data[first + l] : NULL;
+                const double *Bi = l < lanes && bc->B != NULL ? bc->B->data[first + l] : NULL;
+                for (size_t e = 0; e < n * n; e++)
+                    a[e * BT_LANES + l] = Ai != NULL ? Ai[e] : (double)(e % (n + 1) == 0);
+                for (size_t e = 0; e < n * k; e++)
+                    x[e * BT_LANES + l] = Bi != NULL ? Bi[e] : (double)(bc->B == NULL && e % (n + 1) == 0);
+            }
+
+            double bad[BT_LANES] = {0};
+            batch_eliminate(a, x, n, k, bad);
+
+            for (size_t l = 0; l < lanes; l++)
+            {
+                double *Xi = bc->X->data[first + l];
+                for (size_t e = 0; e < n * k; e++)
+                    Xi[e] = bad[l] != 0.0 ? NAN : x[e * BT_LANES + l];
+            }
+        }
+
+        free(a);
+        free(x);
+    }
+
+    static size_t batch_order(ndarray_t *A)
+    {
+        size_t m = A->shape[1], n = (size_t)sqrt((double)m);
+        while (n * n < m)
+            n++;
+        if (n == 0 || n * n != m)
+        {
+            fprintf(stderr, "Invalid dimensions %ldx%ld for a batch of square matrices\n",
+                    A->shape[0], A->shape[1]);
+            perror("Use valid ndarray_t dimesions please\n");
+            exit(1);
+        }
+        return n;
+    }
+
+    static ndarray_t batch_run(ndarray_t *A, ndarray_t *B, size_t n, size_t k)
+    {
+        size_t count = A->shape[0], groups = (count + BT_LANES - 1) / BT_LANES;
+        ndarray_t X = empty(count, n * k);
+
+        batch_ctx_t bc = {A, B, &X, n, k, count};
+        size_t work = BT_LANES * n * n * (n + k);
+        nd_parallel_for(groups, BT_TASK_WORK / work + 1, batch_task, &bc);
+
+        return X;
+    }
+
+/** Solves */
+
+    ndarray_t nd_batched_solve(ndarray_t *A_batch, ndarray_t *b_batch)
+    {
+        if(isnull(A_batch) || isnull(b_batch))
+            {null_error(); exit(EXIT_FAILURE);}
+
+        size_t n = batch_order(A_batch);
+        if(b_batch->shape[0] != A_batch->shape[0] || b_batch->shape[1] % n != 0)
+        {
+            fprintf(stderr, "Invalid dimensions %ldx%ld for the right-hand sides of a %ldx%ld batch\n",
+                    b_batch->shape[0], b_batch->shape[1], A_batch->shape[0], A_batch->shape[1]);
+            perror("Use valid ndarray_t dimesions please\n");
+            exit(1);
+        }
+
+        return batch_run(A_batch, b_batch, n, b_batch->shape[1] / n);
+    }
+
+    ndarray_t nd_batched_inv(ndarray_t *A_batch)
+    {
+        if(isnull(A_batch))
+            {null_error(); exit(EXIT_FAILURE);}
+
+        size_t n = batch_order(A_batch);
+        return batch_run(A_batch, NULL, n, n);
+    }
+
+#pragma GCC pop_options
@@ -0,0 +1,1138 @@
+#include <ndmath/blas.h>
+#include <ndmath/backend.h>
+#include <ndmath/parallel.h>
+#include <ndmath/array.h>
+#include <ndmath/error.h>
+#include <ndmath/conditionals.h>
+#include <pthread.h>
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define ND_HAVE_X86_KERNELS 1
+#endif
+
+#pragma GCC push_options
+#pragma GCC optimize("O3", "unroll-loops")
+
+#define GM_SMALL 32768          // m * n * k below which the product is computed directly
+#define GM_SERIAL 2097152       // m * n * k below which the blocked product stays on one thread
+#define GM_SCALE_WORK 32768     // elements of C per task when applying beta
+#define GM_MAX_MR 8
+#define GM_MAX_NR 24
+#define GM_MAX_SNR 48           // widest single precision tile
+#define GM_ALIGN 64
+#define GM_ROW_AHEAD 8          // rows prefetched ahead when packing through row pointers
+#define TR_LEAF 32              // triangle order handled by substitution
+#define TR_COL_WORK 256         // columns of X per task at a left-side leaf
+#define TR_ROW_WORK 8192        // triangle elements per task at a right-side leaf
+
+#define ALWAYS_INLINE static inline __attribute__((always_inline))
+
+/** Microkernels: C[0..mr)[col..col+nr) (+)= a_sliver * b_sliver over kc steps, storing without
+    reading C when store is set */
+
+typedef void (*gm_kernel_fn)(size_t kc, const double *a, const double *b, double *const *c, size_t col, bool store);
+
+typedef void (*gm_skernel_fn)(size_t kc, const float *a, const float *b, float *c, size_t ldc, bool store);
+
+typedef struct {
+    size_t mr, nr;              // register tile
+    size_t kc, mc, nc;          // cache blocking: A sliver in L1, B panel in L2, A block in L3
+    gm_kernel_fn kernel;
+} gm_arch_t;
+
+typedef struct {
+    size_t mr, nr, kc, mc, nc;
+    gm_skernel_fn kernel;
+} gm_sarch_t;
+
+#ifdef ND_HAVE_X86_KERNELS
+    __attribute__((target("avx512f")))
+    static void kernel_8x24(size_t kc, const double *a, const double *b, double *const *c, size_t col, bool store)
+    {
+        __m512d acc[8][3];
+        for (size_t r = 0; r < 8; r++)
+        {
+            _mm_prefetch((const char *)(c[r] + col), _MM_HINT_T0);
+            _mm_prefetch((const char *)(c[r] + col + 8), _MM_HINT_T0);
+            _mm_prefetch((const char *)(c[r] + col + 16), _MM_HINT_T0);
+            _mm_prefetch((const char *)(c[r] + col + 23), _MM_HINT_T0);
+            for (size_t v = 0; v < 3; v++)
+                acc[r][v] = _mm512_setzero_pd();
+        }
+
+        for (size_t p = 0; p < kc; p++)
+        {
+            __m512d b0 = _mm512_load_pd(b);
+            __m512d b1 = _mm512_load_pd(b + 8);
+            __m512d b2 = _mm512_load_pd(b + 16);
+            for (size_t r = 0; r < 8; r++)
+            {
+                __m512d ar = _mm512_set1_pd(a[r]);
+                acc[r][0] = _mm512_fmadd_pd(ar, b0, acc[r][0]);
+                acc[r][1] = _mm512_fmadd_pd(ar, b1, acc[r][1]);
+                acc[r][2] = _mm512_fmadd_pd(ar, b2, acc[r][2]);
+            }
+            a += 8;
+            b += 24;
+        }
+
+        for (size_t r = 0; r < 8; r++)
+        {
+            double *cr = c[r] + col;
+            for (size_t v = 0; v < 3; v++)
+                _mm512_storeu_pd(cr + 8 * v, store ? acc[r][v] : _mm512_add_pd(_mm512_loadu_pd(cr + 8 * v), acc[r][v]));
+        }
+    }
+
+    __attribute__((target("avx2,fma")))
+    static void kernel_6x8(size_t kc, const double *a, const double *b, double *const *c, size_t col, bool store)
+    {
+        __m256d acc[6][2];
+        for (size_t r = 0; r < 6; r++)
+        {
+            _mm_prefetch((const char *)(c[r] + col), _MM_HINT_T0);
+            _mm_prefetch((const char *)(c[r] + col + 7), _MM_HINT_T0);
+            for (size_t v = 0; v < 2; v++)
+                acc[r][v] = _mm256_setzero_pd();
+        }
+
+        for (size_t p = 0; p < kc; p++)
+        {
+            __m256d b0 = _mm256_load_pd(b);
+            __m256d b1 = _mm256_load_pd(b + 4);
+            for (size_t r = 0; r < 6; r++)
+            {
+                __m256d ar = _mm256_broadcast_sd(a + r);
+                acc[r][0] = _mm256_fmadd_pd(ar, b0, acc[r][0]);
+                acc[r][1] = _mm256_fmadd_pd(ar, b1, acc[r][1]);
+            }
+            a += 6;
+            b += 8;
+        }
+
+        for (size_t r = 0; r < 6; r++)
+        {
+            double *cr = c[r] + col;
+            for (size_t v = 0; v < 2; v++)
+                _mm256_storeu_pd(cr + 4 * v, store ? acc[r][v] : _mm256_add_pd(_mm256_loadu_pd(cr + 4 * v), acc[r][v]));
+        }
+    }
+
+    // Single precision: twice the lanes per register, so twice the tile width
+    __attribute__((target("avx512f")))
+    static void skernel_8x48(size_t kc, const float *a, const float *b, float *c, size_t ldc, bool store)
+    {
+        __m512 acc[8][3];
+        for (size_t r = 0; r < 8; r++)
+        {
+            _mm_prefetch((const char *)(c + r * ldc), _MM_HINT_T0);
+            _mm_prefetch((const char *)(c + r * ldc + 16), _MM_HINT_T0);
+            _mm_prefetch((const char *)(c + r * ldc + 47), _MM_HINT_T0);
+            for (size_t v = 0; v < 3; v++)
+                acc[r][v] = _mm512_setzero_ps();
+        }
+
+        for (size_t p = 0; p < kc; p++)
+        {
+            __m512 b0 = _mm512_load_ps(b);
+            __m512 b1 = _mm512_load_ps(b + 16);
+            __m512 b2 = _mm512_load_ps(b + 32);
+            for (size_t r = 0; r < 8; r++)
+            {
+                __m512 ar = _mm512_set1_ps(a[r]);
+                acc[r][0] = _mm512_fmadd_ps(ar, b0, acc[r][0]);
+                acc[r][1] = _mm512_fmadd_ps(ar, b1, acc[r][1]);
+                acc[r][2] = _mm512_fmadd_ps(ar, b2, acc[r][2]);
+            }
+            a += 8;
+            b += 48;
+        }
+
+        for (size_t r = 0; r < 8; r++)
+        {
+            float *cr = c + r * ldc;
+            for (size_t v = 0; v < 3; v++)
+                _mm512_storeu_ps(cr + 16 * v, store ? acc[r][v] : _mm512_add_ps(_mm512_loadu_ps(cr + 16 * v), acc[r][v]));
+        }
+    }
+
+    __attribute__((target("avx2,fma")))
+    static void skernel_6x16(size_t kc, const float *a, const float *b, float *c, size_t ldc, bool store)
+    {
+        __m256 acc[6][2];
+        for (size_t r = 0; r < 6; r++)
+        {
+            _mm_prefetch((const char *)(c + r * ldc), _MM_HINT_T0);
+            _mm_prefetch((const char *)(c + r * ldc + 15), _MM_HINT_T0);
+            for (size_t v = 0; v < 2; v++)
+                acc[r][v] = _mm256_setzero_ps();
+        }
+
+        for (size_t p = 0; p < kc; p++)
+        {
+            __m256 b0 = _mm256_load_ps(b);
+            __m256 b1 = _mm256_load_ps(b + 8);
+            for (size_t r = 0; r < 6; r++)
+            {
+                __m256 ar = _mm256_broadcast_ss(a + r);
+                acc[r][0] = _mm256_fmadd_ps(ar, b0, acc[r][0]);
+                acc[r][1] = _mm256_fmadd_ps(ar, b1, acc[r][1]);
+            }
+            a += 6;
+            b += 16;
+        }
+
+        for (size_t r = 0; r < 6; r++)
+        {
+            float *cr = c + r * ldc;
+            for (size_t v = 0; v < 2; v++)
+                _mm256_storeu_ps(cr + 8 * v, store ? acc[r][v] : _mm256_add_ps(_mm256_loadu_ps(cr + 8 * v), acc[r][v]));
+        }
+    }
+#endif
+
+    static void kernel_4x8(size_t kc, const double *a, const double *b, double *const *c, size_t col, bool store)
+    {
+        double acc[4][8] = {{0}};
+
+        for (size_t p = 0; p < kc; p++)
+        {
+            for (size_t r = 0; r < 4; r++)
+                for (size_t j = 0; j < 8; j++)
+                    acc[r][j] += a[r] * b[j];
+            a += 4;
+            b += 8;
+        }
+
+        for (size_t r = 0; r < 4; r++)
+            for (size_t j = 0; j < 8; j++)
+                c[r][col + j] = store ? acc[r][j] : c[r][col + j] + acc[r][j];
+    }
+
+    static void skernel_4x16(size_t kc, const float *a, const float *b, float *c, size_t ldc, bool store)
+    {
+        float acc[4][16] = {{0}};
+
+        for (size_t p = 0; p < kc; p++)
+        {
+            for (size_t r = 0; r < 4; r++)
+                for (size_t j = 0; j < 16; j++)
+                    acc[r][j] += a[r] * b[j];
+            a += 4;
+            b += 16;
+        }
+
+        for (size_t r = 0; r < 4; r++)
+            for (size_t j = 0; j < 16; j++)
+                c[r * ldc + j] = store ? acc[r][j] : c[r * ldc + j] + acc[r][j];
+    }
+
+static gm_arch_t arch;
+static gm_sarch_t sarch;
+static pthread_once_t arch_once = PTHREAD_ONCE_INIT;
+static pthread_key_t pack_key;
+
+typedef struct {
+    double *buf;
+    size_t cap;
+} gm_pack_t;
+
+    static void free_pack_buffer(void *p)
+    {
+        gm_pack_t *pack = p;
+        free(pack->buf);
+        free(pack);
+    }
+
+    static void select_arch(void)
+    {
+        pthread_key_create(&pack_key, free_pack_buffer);
+
+        arch = (gm_arch_t){ 4, 8, 256, 512, 512, kernel_4x8 };
+        sarch = (gm_sarch_t){ 4, 16, 256, 512, 512, skernel_4x16 };
+#ifdef ND_HAVE_X86_KERNELS
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f"))
+        {
+            arch = (gm_arch_t){ 8, 24, 384, 1536, 480, kernel_8x24 };
+            sarch = (gm_sarch_t){ 8, 48, 384, 1536, 480, skernel_8x48 };
+        }
+        else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        {
+            arch = (gm_arch_t){ 6, 8, 384, 1536, 320, kernel_6x8 };
+            sarch = (gm_sarch_t){ 6, 16, 384, 1536, 320, skernel_6x16 };
+        }
+#endif
+    }
+
+/** Packing */
+
+typedef struct {
+    nd_transpose_t transA, transB;
+    double alpha, beta;
+    ndarray_t *A, *B, *C;
+    size_t m, n, k;
+} gemm_t;
+
+    static double *aligned_buffer(size_t count)
+    {
+        size_t bytes = (count * sizeof(double) + GM_ALIGN - 1) / GM_ALIGN * GM_ALIGN;
+        double *buf = aligned_alloc(GM_ALIGN, bytes);
+        if (buf == NULL)
+            malloc_error();
+        return buf;
+    }
+
+    // Packed A buffer owned by the calling thread and kept between calls. Packing is its first
+    // touch, so on NUMA machines its pages land on the node of the thread that streams them.
+    static double *thread_pack_buffer(size_t count)
+    {
+        gm_pack_t *pack = pthread_getspecific(pack_key);
+        if (pack == NULL)
+        {
+            pack = calloc(1, sizeof(gm_pack_t));
+            if (pack == NULL)
+                malloc_error();
+            pthread_setspecific(pack_key, pack);
+        }
+        if (pack->cap < count)
+        {
+            free(pack->buf);
+            pack->buf = aligned_buffer(count);
+            pack->cap = count;
+        }
+        return pack->buf;
+    }
+
+    // alpha * op(A)[i0..i0+mb)[p0..p0+kb) as mr-tall slivers, zero padded: buf[(s * kb + p) * mr + r]
+    static void pack_a(const gemm_t *g, size_t i0, size_t mb, size_t p0, size_t kb, double *buf)
+    {
+        size_t mr = arch.mr;
+
+        for (size_t s = 0; s * mr < mb; s++)
+        {
+            double *dst = buf + s * kb * mr;
+            size_t rows = mb - s * mr < mr ? mb - s * mr : mr;
+            size_t i = i0 + s * mr;
+
+            if (g->transA == ND_NO_TRANS)
+            {
+                for (size_t r = 0; r < rows; r++)
+                {
+                    const double *src = g->A->data[i + r] + p0;
+                    for (size_t p = 0; p < kb; p++)
+                        dst[p * mr + r] = g->alpha * src[p];
+                }
+            }
+            else
+            {
+                for (size_t p = 0; p < kb; p++)
+                {
+                    const double *src = g->A->data[p0 + p] + i;
+                    if (p + GM_ROW_AHEAD < kb)
+                        __builtin_prefetch(g->A->data[p0 + p + GM_ROW_AHEAD] + i);
+                    for (size_t r = 0; r < rows; r++)
+                        dst[p * mr + r] = g->alpha * src[r];
+                }
+            }
+
+            for (size_t r = rows; r < mr; r++)
+                for (size_t p = 0; p < kb; p++)
+                    dst[p * mr + r] = 0.0;
+        }
+    }
+
+    // op(B)[p0..p0+kb)[j0..j0+nb) as nr-wide slivers, zero padded: buf[(s * kb + p) * nr + c]
+    static void pack_b(const gemm_t *g, size_t p0, size_t kb, size_t j0, size_t nb, double *buf)
+    {
+        size_t nr = arch.nr;
+
+        for (size_t s = 0; s * nr < nb; s++)
+        {
+            double *dst = buf + s * kb * nr;
+            size_t cols = nb - s * nr < nr ? nb - s * nr : nr;
+            size_t j = j0 + s * nr;
+
+            if (g->transB == ND_NO_TRANS)
+            {
+                for (size_t p = 0; p < kb; p++)
+                {
+                    const double *src = g->B->data[p0 + p] + j;
+                    double *d = dst + p * nr;
+                    if (p + GM_ROW_AHEAD < kb)
+                    {
+                        __builtin_prefetch(g->B->data[p0 + p + GM_ROW_AHEAD] + j);
+                        __builtin_prefetch(g->B->data[p0 + p + GM_ROW_AHEAD] + j + cols - 1);
+                    }
+                    for (size_t c = 0; c < cols; c++)
+                        d[c] = src[c];
+                    for (size_t c = cols; c < nr; c++)
+                        d[c] = 0.0;
+                }
+            }
+            else
+            {
+                for (size_t c = 0; c < cols; c++)
+                {
+                    const double *src = g->B->data[j + c] + p0;
+                    for (size_t p = 0; p < kb; p++)
+                        dst[p * nr + c] = src[p];
+                }
+                for (size_t p = 0; p < kb; p++)
+                    for (size_t c = cols; c < nr; c++)
+                        dst[p * nr + c] = 0.0;
+            }
+        }
+    }
+
+/** Macro kernel */
+
+    // C[i0..i0+mb)[j0..j0+nb) (+)= packed A block * packed B panel. Each A sliver stays in L1
+    // while the B slivers stream from L2, and the C rows of one sliver stay hot in the TLB.
+    static void macro_kernel(const gemm_t *g, size_t i0, size_t mb, size_t j0, size_t nb, size_t kb,
+                             const double *Ap, const double *Bp, bool store)
+    {
+        size_t mr = arch.mr, nr = arch.nr;
+        double tile[GM_MAX_MR * GM_MAX_NR];
+        double *tile_rows[GM_MAX_MR];
+        for (size_t r = 0; r < mr; r++)
+            tile_rows[r] = tile + r * nr;
+
+        for (size_t ir = 0; ir < mb; ir += mr)
+        {
+            const double *a = Ap + (ir / mr) * kb * mr;
+            size_t rows = mb - ir < mr ? mb - ir : mr;
+
+            for (size_t jr = 0; jr < nb; jr += nr)
+            {
+                const double *b = Bp + (jr / nr) * kb * nr;
+                size_t cols = nb - jr < nr ? nb - jr : nr;
+
+                if (rows == mr && cols == nr)
+                {
+                    arch.kernel(kb, a, b, g->C->data + i0 + ir, j0 + jr, store);
+                    continue;
+                }
+
+                // Edge tile: run the full kernel on a scratch tile, then apply the valid part
+                arch.kernel(kb, a, b, tile_rows, 0, true);
+                for (size_t r = 0; r < rows; r++)
+                {
+                    double *cr = g->C->data[i0 + ir + r] + j0 + jr;
+                    for (size_t c = 0; c < cols; c++)
+                        cr[c] = store ? tile[r * nr + c] : cr[c] + tile[r * nr + c];
+                }
+            }
+        }
+    }
+
+/** Driver */
+
+    ALWAYS_INLINE double op_at(ndarray_t *X, nd_transpose_t t, size_t i, size_t j)
+    {
+        return t == ND_NO_TRANS ? X->data[i][j] : X->data[j][i];
+    }
+
+    typedef struct {
+        ndarray_t *C;
+        double beta;
+    } scale_ctx_t;
+
+    static void scale_task(size_t begin, size_t end, void *ctx)
+    {
+        scale_ctx_t *sc = ctx;
+        size_t cols = sc->C->shape[1];
+
+        for (size_t i = begin; i < end; i++)
+        {
+            double *row = sc->C->data[i];
+            if (sc->beta == 0.0)
+                memset(row, 0, cols * sizeof(double));
+            else
+                for (size_t j = 0; j < cols; j++)
+                    row[j] *= sc->beta;
+        }
+    }
+
+    static void scale_c(ndarray_t *C, double beta)
+    {
+        if (beta == 1.0)
+            return;
+        scale_ctx_t sc = { C, beta };
+        size_t grain = GM_SCALE_WORK / C->shape[1] + 1;
+        nd_parallel_for(C->shape[0], grain, scale_task, &sc);
+    }
+
+    static void gemm_small(const gemm_t *g)
+    {
+        for (size_t i = 0; i < g->m; i++)
+        {
+            double *crow = g->C->data[i];
+            for (size_t p = 0; p < g->k; p++)
+            {
+                double a = g->alpha * op_at(g->A, g->transA, i, p);
+                if (g->transB == ND_NO_TRANS)
+                {
+                    const double *brow = g->B->data[p];
+                    for (size_t j = 0; j < g->n; j++)
+                        crow[j] += a * brow[j];
+                }
+                else
+                {
+                    for (size_t j = 0; j < g->n; j++)
+                        crow[j] += a * g->B->data[j][p];
+                }
+            }
+        }
+    }
+
+    /*
+     * Matrix-vector shapes (C with one column or one row). The vector operand is gathered into
+     * a contiguous buffer; each output is then either a dot product with a stored row of the
+     * matrix operand, or a segment accumulated from axpys over its rows.
+     */
+    typedef struct {
+        const gemm_t *g;
+        ndarray_t *M;           // matrix operand, read by rows
+        const double *x;        // gathered vector operand, k long
+        bool column;            // C is m x 1 (else 1 x n)
+    } vector_ctx_t;
+
+    ALWAYS_INLINE double *c_at(const vector_ctx_t *vc, size_t i)
+    {
+        return vc->column ? &vc->g->C->data[i][0] : &vc->g->C->data[0][i];
+    }
+
+    // Outputs [begin, end): C_i += alpha * dot(M row i, x)
+    static void dot_task(size_t begin, size_t end, void *ctx)
+    {
+        vector_ctx_t *vc = ctx;
+        size_t k = vc->g->k;
+
+        for (size_t i = begin; i < end; i++)
+        {
+            const double *row = vc->M->data[i];
+            // Eight independent sums, so the loop is not bound by the latency of one chain
+            double part[8] = {0};
+            size_t p = 0;
+            for (; p + 8 <= k; p += 8)
+                for (size_t l = 0; l < 8; l++)
+                    part[l] += row[p + l] * vc->x[p + l];
+
+            double s = ((part[0] + part[1]) + (part[2] + part[3])) + ((part[4] + part[5]) + (part[6] + part[7]));
+            for (; p < k; p++)
+                s += row[p] * vc->x[p];
+            *c_at(vc, i) += vc->g->alpha * s;
+        }
+    }
+
+    // Outputs [begin, end): C_i += alpha * sum_p x_p * M[p][i]
+    static void axpy_task(size_t begin, size_t end, void *ctx)
+    {
+        vector_ctx_t *vc = ctx;
+        size_t len = end - begin;
+        double *acc = calloc(len, sizeof(double));
+        if (acc == NULL)
+            malloc_error();
+
+        for (size_t p = 0; p < vc->g->k; p++)
+        {
+            const double *row = vc->M->data[p] + begin;
+            double xp = vc->x[p];
+            for (size_t i = 0; i < len; i++)
+                acc[i] += xp * row[i];
+        }
+        for (size_t i = 0; i < len; i++)
+            *c_at(vc, begin + i) += vc->g->alpha * acc[i];
+
+        free(acc);
+    }
+
+    static void gemm_vector(const gemm_t *g)
+    {
+        vector_ctx_t vc = { g, NULL, NULL, g->n == 1 };
+        nd_transpose_t trans = vc.column ? g->transA : g->transB;
+        size_t outputs = vc.column ? g->m : g->n;
+
+        // The vector operand: column 0 of op(B), or row 0 of op(A)
+        double *x = malloc(sizeof(double) * g->k);
+        if (x == NULL)
+            malloc_error();
+        for (size_t p = 0; p < g->k; p++)
+            x[p] = vc.column ? op_at(g->B, g->transB, p, 0) : op_at(g->A, g->transA, 0, p);
+        vc.x = x;
+        vc.M = vc.column ? g->A : g->B;
+
+        // Rows of M run along k for op(A) = A and op(B) = Bᵀ, and along the outputs otherwise
+        bool dots = vc.column == (trans == ND_NO_TRANS);
+        size_t grain = GM_SCALE_WORK / g->k + 1;
+        if (dots)
+            nd_parallel_for(outputs, grain, dot_task, &vc);
+        else
+            nd_parallel_for(outputs, grain < 512 ? 512 : grain, axpy_task, &vc);
+
+        free(x);
+    }
+
+    /*
+     * Threads form a tm x tn grid over C: thread (ti, tj) owns a band of rows and, inside every
+     * B panel, a band of nc columns. The panel is nc * tn wide and packed once by all threads,
+     * so each thread's share of it still fits its own L2. Each thread packs the A rows of its
+     * band into its own buffer. Tall-skinny products get a tm x 1 grid and short-wide ones
+     * 1 x tn, so both keep every thread busy.
+     */
+    typedef struct {
+        const gemm_t *g;
+        size_t tm, tn;
+        size_t jc, nb, pc, kb;
+        bool store;             // first pass over k with beta == 0: C is written, not read
+        double *Bp;
+    } gemm_ctx_t;
+
+    // [begin, end) of part `part` out of `parts` over `len` elements, split on multiples of `step`
+    ALWAYS_INLINE void split_range(size_t len, size_t step, size_t parts, size_t part, size_t *begin, size_t *end)
+    {
+        size_t units = (len + step - 1) / step;
+        size_t b = units * part / parts * step, e = units * (part + 1) / parts * step;
+        *begin = b < len ? b : len;
+        *end = e < len ? e : len;
+    }
+
+    static void choose_grid(size_t m, size_t n, size_t threads, size_t *tm, size_t *tn)
+    {
+        size_t row_units = (m + arch.mr - 1) / arch.mr, col_units = (n + arch.nr - 1) / arch.nr;
+        double best = -1.0;
+
+        *tm = 1;
+        *tn = 1;
+        for (size_t r = 1; r <= threads; r++)
+        {
+            if (threads % r != 0 || r > row_units || threads / r > col_units)
+                continue;
+            // Perimeter of one thread's block of C: what it packs and streams per step of k
+            double cost = (double)m / r + (double)n / (threads / r);
+            if (best < 0.0 || cost < best)
+            {
+                best = cost;
+                *tm = r;
+                *tn = threads / r;
+            }
+        }
+    }
+
+    static void pack_b_task(size_t begin, size_t end, void *ctx)
+    {
+        gemm_ctx_t *gc = ctx;
+        size_t nr = arch.nr;
+        size_t j0 = begin * nr, j1 = end * nr < gc->nb ? end * nr : gc->nb;
+
+        pack_b(gc->g, gc->pc, gc->kb, gc->jc + j0, j1 - j0, gc->Bp + begin * gc->kb * nr);
+    }
+
+    static void block_task(size_t begin, size_t end, void *ctx)
+    {
+        gemm_ctx_t *gc = ctx;
+        const gemm_t *g = gc->g;
+
+        for (size_t t = begin; t < end; t++)
+        {
+            size_t r0, r1, c0, c1;
+            split_range(g->m, arch.mr, gc->tm, t / gc->tn, &r0, &r1);
+            split_range(gc->nb, arch.nr, gc->tn, t % gc->tn, &c0, &c1);
+            if (r0 == r1 || c0 == c1)
+                continue;
+
+            size_t mb_max = r1 - r0 < arch.mc ? r1 - r0 : arch.mc;
+            double *Ap = thread_pack_buffer((mb_max + arch.mr) * gc->kb);
+            const double *Bp = gc->Bp + (c0 / arch.nr) * gc->kb * arch.nr;
+
+            for (size_t ic = r0; ic < r1; ic += arch.mc)
+            {
+                size_t mb = r1 - ic < arch.mc ? r1 - ic : arch.mc;
+                pack_a(g, ic, mb, gc->pc, gc->kb, Ap);
+                macro_kernel(g, ic, mb, gc->jc + c0, c1 - c0, gc->kb, Ap, Bp, gc->store);
+            }
+        }
+    }
+
+    static void gemm_blocked(const gemm_t *g)
+    {
+        size_t threads = g->m * g->n * g->k < GM_SERIAL ? 1 : nd_get_num_threads();
+        gemm_ctx_t gc = { g, 1, 1, 0, 0, 0, 0, false, NULL };
+        choose_grid(g->m, g->n, threads, &gc.tm, &gc.tn);
+
+        size_t kc = arch.kc, nc = arch.nc * gc.tn;
+        size_t nc_alloc = (g->n < nc ? g->n : nc) + arch.nr;
+        size_t kc_alloc = g->k < kc ? g->k : kc;
+        gc.Bp = aligned_buffer(kc_alloc * nc_alloc);
+
+        for (gc.jc = 0; gc.jc < g->n; gc.jc += nc)
+        {
+            gc.nb = g->n - gc.jc < nc ? g->n - gc.jc : nc;
+            size_t slivers = (gc.nb + arch.nr - 1) / arch.nr;
+
+            for (gc.pc = 0; gc.pc < g->k; gc.pc += kc)
+            {
+                gc.kb = g->k - gc.pc < kc ? g->k - gc.pc : kc;
+                gc.store = gc.pc == 0 && g->beta == 0.0;
+                nd_parallel_for(slivers, (slivers + threads - 1) / threads, pack_b_task, &gc);
+                nd_parallel_for(gc.tm * gc.tn, 1, block_task, &gc);
+            }
+        }
+
+        free(gc.Bp);
+    }
+
+    void nd_gemm(nd_transpose_t transA, nd_transpose_t transB, double alpha,
+                 ndarray_t *A, ndarray_t *B, double beta, ndarray_t *C)
+    {
+        if(isnull(A) || isnull(B) || isnull(C))
+            {null_error(); exit(EXIT_FAILURE);}
+
+        gemm_t g = { transA, transB, alpha, beta, A, B, C, 0, 0, 0 };
+        g.m = transA == ND_NO_TRANS ? A->shape[0] : A->shape[1];
+        g.k = transA == ND_NO_TRANS ? A->shape[1] : A->shape[0];
+        g.n = transB == ND_NO_TRANS ? B->shape[1] : B->shape[0];
+        size_t kb = transB == ND_NO_TRANS ? B->shape[0] : B->shape[1];
+
+        if(g.k != kb || C->shape[0] != g.m || C->shape[1] != g.n)
+        {
+            fprintf(stderr, "Invalid dimensions %ldx%ld and %ldx%ld into %ldx%ld for gemm\n",
+                    A->shape[0], A->shape[1], B->shape[0], B->shape[1], C->shape[0], C->shape[1]);
+            perror("Use valid ndarray_t dimesions please\n");
+            exit(1);
+        }
+
+        if(alpha == 0.0 || g.k == 0)
+        {
+            scale_c(C, beta);
+            return;
+        }
+
+        // A vendor BLAS, when built in and selected (see backend.h)
+        if(nd_backend_gemm(transA, transB, alpha, A, B, beta, C))
+            return;
+
+        // Matrix-vector shapes would be mostly padding in the packed path
+        if(g.m == 1 || g.n == 1)
+        {
+            scale_c(C, beta);
+            gemm_vector(&g);
+            return;
+        }
+
+        if(g.m * g.n * g.k < GM_SMALL)
+        {
+            scale_c(C, beta);
+            gemm_small(&g);
+            return;
+        }
+
+        // With beta == 0 the first pass over k overwrites C, so it is never cleared separately
+        if(beta != 0.0)
+            scale_c(C, beta);
+        pthread_once(&arch_once, select_arch);
+        gemm_blocked(&g);
+    }
+
+/** Triangular */
+
+typedef struct {
+    ndarray_t *A, *X;
+    nd_transpose_t trans;
+    bool left;                  // op(A) X, else X op(A)
+    bool upper;                 // op(A) is upper triangular
+    bool unit;
+    bool solve;                 // op(A)⁻¹, else op(A)
+    size_t a0, nb;              // diagonal block [a0, a0 + nb)² of op(A) at a leaf
+    double block[TR_LEAF * TR_LEAF];  // that block, row-major
+} tri_t;
+
+    // Rows of op(A) in the order a leaf visits them, so that no value is read after it is rewritten
+    ALWAYS_INLINE bool tri_descending(const tri_t *t)
+    {
+        return t->upper == (t->solve == t->left);
+    }
+
+    // Columns [begin, end) of X: rows [a0, a0 + nb) rewritten by substitution
+    static void tri_left_task(size_t begin, size_t end, void *ctx)
+    {
+        const tri_t *t = ctx;
+        bool down = tri_descending(t);
+        size_t nb = t->nb;
+
+        for (size_t step = 0; step < nb; step++)
+        {
+            size_t r = down ? nb - 1 - step : step;
+            size_t s0 = t->upper ? r + 1 : 0, s1 = t->upper ? nb : r;
+            const double *a = t->block + r * nb;
+            double *dst = t->X->data[t->a0 + r];
+
+            if (!t->solve && a[r] != 1.0)
+                for (size_t j = begin; j < end; j++)
+                    dst[j] *= a[r];
+            for (size_t s = s0; s < s1; s++)
+            {
+                if (a[s] == 0.0)
+                    continue;
+                double f = t->solve ? -a[s] : a[s];
+                const double *src = t->X->data[t->a0 + s];
+                for (size_t j = begin; j < end; j++)
+                    dst[j] += f * src[j];
+            }
+            if (t->solve && a[r] != 1.0)
+                for (size_t j = begin; j < end; j++)
+                    dst[j] /= a[r];
+        }
+    }
+
+    // Rows [begin, end) of X: columns [a0, a0 + nb) rewritten along the row, each finished value
+    // pushed into the columns that depend on it so the inner loop vectorizes
+    static void tri_right_task(size_t begin, size_t end, void *ctx)
+    {
+        const tri_t *t = ctx;
+        bool down = tri_descending(t);
+        size_t nb = t->nb;
+
+        for (size_t i = begin; i < end; i++)
+        {
+            double *x = t->X->data[i] + t->a0;
+            for (size_t step = 0; step < nb; step++)
+            {
+                size_t r = down ? nb - 1 - step : step;
+                size_t c0 = t->upper ? r + 1 : 0, c1 = t->upper ? nb : r;
+                const double *a = t->block + r * nb;
+
+                if (t->solve)
+                    x[r] /= a[r];
+                double f = t->solve ? -x[r] : x[r];
+                for (size_t c = c0; c < c1; c++)
+                    x[c] += f * a[c];
+                if (!t->solve)
+                    x[r] *= a[r];
+            }
+        }
+    }
+
+    // Copies the leaf block of op(A) so that a task reads it contiguously, with ones for a unit diagonal
+    static void tri_leaf(tri_t *t, size_t a0, size_t nb)
+    {
+        t->a0 = a0;
+        t->nb = nb;
+        for (size_t r = 0; r < nb; r++)
+            for (size_t c = 0; c < nb; c++)
+            {
+                double v = r == c && t->unit ? 1.0 : op_at(t->A, t->trans, a0 + r, a0 + c);
+                if (t->upper ? c < r : c > r)
+                    v = 0.0;
+                t->block[r * nb + c] = v;
+            }
+
+        if (t->left)
+            nd_parallel_for(t->X->shape[1], TR_COL_WORK, tri_left_task, t);
+        else
+            nd_parallel_for(t->X->shape[0], TR_ROW_WORK / (nb * nb) + 1, tri_right_task, t);
+    }
+
+    // View of op(A)[r0..r0+rows)[c0..c0+cols), to be used with transposition t->trans
+    static ndarray_t tri_block(const tri_t *t, size_t r0, size_t c0, size_t rows, size_t cols)
+    {
+        return t->trans == ND_TRANS ? nd_view(t->A, c0, r0, cols, rows) : nd_view(t->A, r0, c0, rows, cols);
+    }
+
+    /*
+     * Applies the diagonal block [a0, a0 + nb)² of op(A) to X. The block is halved: one half of X
+     * (src) is final before the other (dst) needs it, and the coupling between them is one GEMM,
+     * so all but the small leaf triangles run in the GEMM microkernel.
+     */
+    static void tri_apply(tri_t *t, size_t a0, size_t nb)
+    {
+        if (nb <= TR_LEAF)
+        {
+            tri_leaf(t, a0, nb);
+            return;
+        }
+
+        size_t h = nb / 2;
+        bool src_second = t->left == t->upper;
+        size_t s0 = src_second ? a0 + h : a0, sn = src_second ? nb - h : h;
+        size_t d0 = src_second ? a0 : a0 + h, dn = nb - sn;
+        size_t m = t->X->shape[0], n = t->X->shape[1];
+
+        // A solve needs src final before the GEMM; a product needs it unchanged
+        if (t->solve)
+            tri_apply(t, s0, sn);
+        else
+            tri_apply(t, d0, dn);
+
+        double sign = t->solve ? -1.0 : 1.0;
+        if (t->left)
+        {
+            ndarray_t Ab = tri_block(t, d0, s0, dn, sn);
+            ndarray_t Xs = nd_view(t->X, s0, 0, sn, n);
+            ndarray_t Xd = nd_view(t->X, d0, 0, dn, n);
+            nd_gemm(t->trans, ND_NO_TRANS, sign, &Ab, &Xs, 1.0, &Xd);
+            nd_view_free(&Ab);
+            nd_view_free(&Xs);
+            nd_view_free(&Xd);
+        }
+        else
+        {
+            ndarray_t Ab = tri_block(t, s0, d0, sn, dn);
+            ndarray_t Xs = nd_view(t->X, 0, s0, m, sn);
+            ndarray_t Xd = nd_view(t->X, 0, d0, m, dn);
+            nd_gemm(ND_NO_TRANS, t->trans, sign, &Xs, &Ab, 1.0, &Xd);
+            nd_view_free(&Ab);
+            nd_view_free(&Xs);
+            nd_view_free(&Xd);
+        }
+
+        if (t->solve)
+            tri_apply(t, d0, dn);
+        else
+            tri_apply(t, s0, sn);
+    }
+
+    // Checks the operands and sets X = alpha B; false when nothing is left to do
+    static bool tri_begin(tri_t *t, double alpha, ndarray_t *B, const char *name)
+    {
+        if(isnull(t->A) || isnull(B) || isnull(t->X))
+            {null_error(); exit(EXIT_FAILURE);}
+        if(issquare(t->A))
+            mat_error();
+
+        size_t order = t->left ? B->shape[0] : B->shape[1];
+        if(order != t->A->shape[0] || t->X->shape[0] != B->shape[0] || t->X->shape[1] != B->shape[1])
+        {
+            fprintf(stderr, "Invalid dimensions %ldx%ld and %ldx%ld into %ldx%ld for %s\n",
+                    t->A->shape[0], t->A->shape[1], B->shape[0], B->shape[1],
+                    t->X->shape[0], t->X->shape[1], name);
+            perror("Use valid ndarray_t dimesions please\n");
+            exit(1);
+        }
+
+        if(t->X != B)
+            for(size_t i = 0; i < B->shape[0]; i++)
+                memcpy(t->X->data[i], B->data[i], sizeof(double) * B->shape[1]);
+        scale_c(t->X, alpha);
+        return alpha != 0.0 && order > 0;
+    }
+
+    void nd_trsm(nd_side_t side, nd_uplo_t uplo, nd_transpose_t transA, nd_diag_t diag, double alpha,
+                 ndarray_t *A, ndarray_t *B, ndarray_t *X)
+    {
+        tri_t t = { A, X, transA, side == ND_LEFT, (uplo == ND_UPPER) != (transA == ND_TRANS),
+                    diag == ND_UNIT, true, 0, 0, {0} };
+        if(tri_begin(&t, alpha, B, "trsm"))
+            tri_apply(&t, 0, A->shape[0]);
+    }
+
+    void nd_trmm(nd_side_t side, nd_uplo_t uplo, nd_transpose_t transA, nd_diag_t diag, double alpha,
+                 ndarray_t *A, ndarray_t *B, ndarray_t *X)
+    {
+        tri_t t = { A, X, transA, side == ND_LEFT, (uplo == ND_UPPER) != (transA == ND_TRANS),
+                    diag == ND_UNIT, false, 0, 0, {0} };
+        if(tri_begin(&t, alpha, B, "trmm"))
+            tri_apply(&t, 0, A->shape[0]);
+    }
+
+/** Single precision */
+
+/*
+ * The same layers as nd_gemm() over row-major float storage with leading dimensions. Threads
+ * split C by row bands only: the callers are the float32 factorizations, whose updates are
+ * square or tall.
+ */
+typedef struct {
+    nd_transpose_t transA, transB;
+    float alpha;
+    const float *A, *B;
+    float *C;
+    size_t lda, ldb, ldc;
+    size_t m, n, k;
+    size_t pc, kb, jc, nb;
+    size_t band;                // rows of C per task, at most mc
+    float *Bp;
+} sgemm_t;
+
+    ALWAYS_INLINE float sop_at(const float *X, size_t ld, nd_transpose_t t, size_t i, size_t j)
+    {
+        return t == ND_NO_TRANS ? X[i * ld + j] : X[j * ld + i];
+    }
+
+    static void spack_a(const sgemm_t *g, size_t i0, size_t mb, float *buf)
+    {
+        size_t mr = sarch.mr, kb = g->kb, p0 = g->pc;
+
+        for (size_t s = 0; s * mr < mb; s++)
+        {
+            float *dst = buf + s * kb * mr;
+            size_t rows = mb - s * mr < mr ? mb - s * mr : mr;
+            size_t i = i0 + s * mr;
+
+            if (g->transA == ND_NO_TRANS)
+            {
+                for (size_t r = 0; r < rows; r++)
+                {
+                    const float *src = g->A + (i + r) * g->lda + p0;
+                    for (size_t p = 0; p < kb; p++)
+                        dst[p * mr + r] = g->alpha * src[p];
+                }
+            }
+            else
+            {
+                for (size_t p = 0; p < kb; p++)
+                {
+                    const float *src = g->A + (p0 + p) * g->lda + i;
+                    for (size_t r = 0; r < rows; r++)
+                        dst[p * mr + r] = g->alpha * src[r];
+                }
+            }
+
+            for (size_t r = rows; r < mr; r++)
+                for (size_t p = 0; p < kb; p++)
+                    dst[p * mr + r] = 0.0f;
+        }
+    }
+
+    static void spack_b_task(size_t begin, size_t end, void *ctx)
+    {
+        sgemm_t *g = ctx;
+        size_t nr = sarch.nr, kb = g->kb, p0 = g->pc;
+
+        for (size_t s = begin; s < end; s++)
+        {
+            float *dst = g->Bp + s * kb * nr;
+            size_t j = g->jc + s * nr;
+            size_t cols = g->jc + g->nb - j < nr ? g->jc + g->nb - j : nr;
+
+            if (g->transB == ND_NO_TRANS)
+            {
+                for (size_t p = 0; p < kb; p++)
+                {
+                    const float *src = g->B + (p0 + p) * g->ldb + j;
+                    float *d = dst + p * nr;
+                    for (size_t c = 0; c < cols; c++)
+                        d[c] = src[c];
+                    for (size_t c = cols; c < nr; c++)
+                        d[c] = 0.0f;
+                }
+            }
+            else
+            {
+                for (size_t c = 0; c < cols; c++)
+                {
+                    const float *src = g->B + (j + c) * g->ldb + p0;
+                    for (size_t p = 0; p < kb; p++)
+                        dst[p * nr + c] = src[p];
+                }
+                for (size_t p = 0; p < kb; p++)
+                    for (size_t c = cols; c < nr; c++)
+                        dst[p * nr + c] = 0.0f;
+            }
+        }
+    }
+
+    static void smacro_kernel(const sgemm_t *g, size_t i0, size_t mb, const float *Ap)
+    {
+        size_t mr = sarch.mr, nr = sarch.nr, kb = g->kb;
+        float tile[GM_MAX_MR * GM_MAX_SNR];
+
+        for (size_t ir = 0; ir < mb; ir += mr)
+        {
+            const float *a = Ap + (ir / mr) * kb * mr;
+            size_t rows = mb - ir < mr ? mb - ir : mr;
+
+            for (size_t jr = 0; jr < g->nb; jr += nr)
+            {
+                const float *b = g->Bp + (jr / nr) * kb * nr;
+                size_t cols = g->nb - jr < nr ? g->nb - jr : nr;
+                float *c = g->C + (i0 + ir) * g->ldc + g->jc + jr;
+
+                if (rows == mr && cols == nr)
+                {
+                    sarch.kernel(kb, a, b, c, g->ldc, false);
+                    continue;
+                }
+
+                sarch.kernel(kb, a, b, tile, nr, true);
+                for (size_t r = 0; r < rows; r++)
+                    for (size_t col = 0; col < cols; col++)
+                        c[r * g->ldc + col] += tile[r * nr + col];
+            }
+        }
+    }
+
+    static void sblock_task(size_t begin, size_t end, void *ctx)
+    {
+        sgemm_t *g = ctx;
+        float *Ap = (float *)thread_pack_buffer(((g->band + sarch.mr) * g->kb + 1) / 2);
+
+        for (size_t band = begin; band < end; band++)
+        {
+            size_t ic = band * g->band, mb = g->m - ic < g->band ? g->m - ic : g->band;
+            spack_a(g, ic, mb, Ap);
+            smacro_kernel(g, ic, mb, Ap);
+        }
+    }
+
+    void nd_sgemm(nd_transpose_t transA, nd_transpose_t transB, size_t m, size_t n, size_t k,
+                  float alpha, const float *A, size_t lda, const float *B, size_t ldb,
+                  float beta, float *C, size_t ldc)
+    {
+        if(m == 0 || n == 0)
+            return;
+        if(C == NULL || (k > 0 && (A == NULL || B == NULL)))
+            {null_error(); exit(EXIT_FAILURE);}
+        if(k > 0 && alpha != 0.0f && nd_backend_sgemm(transA, transB, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc))
+            return;
+
+        if(beta != 1.0f)
+            for(size_t i = 0; i < m; i++)
+                for(size_t j = 0; j < n; j++)
+                    C[i * ldc + j] = beta == 0.0f ? 0.0f : beta * C[i * ldc + j];
+        if(alpha == 0.0f || k == 0)
+            return;
+
+        if(m * n * k < GM_SMALL)
+        {
+            for(size_t i = 0; i < m; i++)
+                for(size_t p = 0; p < k; p++)
+                {
+                    float a = alpha * sop_at(A, lda, transA, i, p);
+                    for(size_t j = 0; j < n; j++)
+                        C[i * ldc + j] += a * sop_at(B, ldb, transB, p, j);
+                }
+            return;
+        }
+
+        pthread_once(&arch_once, select_arch);
+        sgemm_t g = { transA, transB, alpha, A, B, C, lda, ldb, ldc, m, n, k, 0, 0, 0, 0, 0, NULL };
+        size_t threads = m * n * k < GM_SERIAL ? 1 : nd_get_num_threads();
+        size_t kc = sarch.kc, nc = sarch.nc, mr = sarch.mr;
+
+        // At least one band per thread, each a multiple of mr rows
+        size_t share = ((m + threads - 1) / threads + mr - 1) / mr * mr;
+        g.band = share < sarch.mc ? share : sarch.mc;
+        size_t bands = (m + g.band - 1) / g.band;
+        size_t kc_alloc = k < kc ? k : kc, nc_alloc = (n < nc ? n : nc) + sarch.nr;
+        g.Bp = (float *)aligned_buffer((kc_alloc * nc_alloc + 1) / 2);
+
+        for (g.jc = 0; g.jc < n; g.jc += nc)
+        {
+            g.nb = n - g.jc < nc ? n - g.jc : nc;
+            size_t slivers = (g.nb + sarch.nr - 1) / sarch.nr;
+            for (g.pc = 0; g.pc < k; g.pc += kc)
+            {
+                g.kb = k - g.pc < kc ? k - g.pc : kc;
+                nd_parallel_for(slivers, (slivers + threads - 1) / threads, spack_b_task, &g);
+                nd_parallel_for(bands, (bands + threads - 1) / threads, sblock_task, &g);
+            }
+        }
+
+        free(g.Bp);
+    }
+
+#pragma GCC pop_options
@@ -0,0 +1,323 @@
+#include <ndmath/cache.h>
+#include <ndmath/array.h>
+#include <ndmath/helper.h>
+#include <ndmath/error.h>
+#include <ndmath/conditionals.h>
+#include <pthread.h>
+#include <string.h>
+
+#pragma GCC push_options
+#pragma GCC optimize("O3", "unroll-loops")
+
+#define CA_HASH_LANES 4         // independent hash chains per row
+#define CA_MIX 0x9E3779B97F4A7C15ULL
+
+/** A cached factorization; fact comes first so that a borrowed pointer is the entry */
+typedef struct nd_cache_entry {
+    nd_factorization_t fact;
+    uint64_t hash;              // of the shape and values of A
+    ndarray_t key;              // copy of A, compared on a hash match; no data when not cached
+    size_t shape[2];
+    size_t bytes;
+    size_t refs;                // borrowers not yet released
+    bool linked;                // in the LRU list; otherwise freed at the last release
+    struct nd_cache_entry *prev, *next;
+} nd_cache_entry_t;
+
+static pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t budget_once = PTHREAD_ONCE_INIT;
+
+static nd_cache_entry_t *head = NULL;  // most recently used
+static nd_cache_entry_t *tail = NULL;  // least recently used
+static nd_cache_stats_t stats = {0};
+
+/** Keys */
+
+    static uint64_t mix(uint64_t h, uint64_t v)
+    {
+        h = (h ^ v) * CA_MIX;
+        return h ^ (h >> 29);
+    }
+
+    // Several chains per row keep the multiplies independent, so hashing runs near memory speed
+    static uint64_t matrix_hash(ndarray_t *A)
+    {
+        uint64_t h = mix(mix(CA_MIX, A->shape[0]), A->shape[1]);
+        for (size_t i = 0; i < A->shape[0]; i++)
+        {
+            uint64_t lane[CA_HASH_LANES] = {1, 2, 3, 4};
+            const double *row = A->data[i];
+            size_t j = 0;
+            for (; j + CA_HASH_LANES <= A->shape[1]; j += CA_HASH_LANES)
+                for (size_t l = 0; l < CA_HASH_LANES; l++)
+                {
+                    uint64_t v;
+                    memcpy(&v, row + j + l, sizeof(v));
+                    lane[l] = mix(lane[l], v);
+                }
+            for (; j < A->shape[1]; j++)
+            {
+                uint64_t v;
+                memcpy(&v, row + j, sizeof(v));
+                lane[0] = mix(lane[0], v);
+            }
+            for (size_t l = 0; l < CA_HASH_LANES; l++)
+                h = mix(h, lane[l]);
+        }
+        return h;
+    }
+
+    static size_t array_bytes(const ndarray_t *A)
+    {
+        return A->shape[0] * (sizeof(double *) + sizeof(double) * A->shape[1]);
+    }
+
+/** Entries */
+
+    static void factor(nd_cache_entry_t *e, ndarray_t *A)
+    {
+        nd_factorization_t *f = &e->fact;
+        size_t m = A->shape[0], n = A->shape[1];
+        switch (f->kind)
+        {
+        case ND_FACT_LU:
+            f->lu = nd_lu(A);
+            e->bytes = array_bytes(&f->lu.LU) + sizeof(size_t) * n;
+            break;
+        case ND_FACT_CHOLESKY:
+            f->chol = nd_cholesky(A);
+            e->bytes = array_bytes(&f->chol.L);
+            break;
+        case ND_FACT_QR:
+            f->qr = nd_qr(A, true);
+            e->bytes = array_bytes(&f->qr.QR) + array_bytes(&f->qr.T)
+                     + sizeof(double) * (m < n ? m : n) + sizeof(size_t) * n;
+            break;
+        }
+        e->bytes += sizeof(*e);
+    }
+
+    static void entry_free(nd_cache_entry_t *e)
+    {
+        if (e->key.data != NULL)
+            clean(&e->key, NULL);
+        switch (e->fact.kind)
+        {
+        case ND_FACT_LU:
+            nd_lu_free(&e->fact.lu);
+            break;
+        case ND_FACT_CHOLESKY:
+            nd_cholesky_free(&e->fact.chol);
+            break;
+        case ND_FACT_QR:
+            nd_qr_free(&e->fact.qr);
+            break;
+        }
+        free(e);
+    }
+
+    // The callers below hold cache_mutex
+    static void unlink_entry(nd_cache_entry_t *e)
+    {
+        if (e->prev != NULL)
+            e->prev->next = e->next;
+        else
+            head = e->next;
+        if (e->next != NULL)
+            e->next->prev = e->prev;
+        else
+            tail = e->prev;
+        e->prev = e->next = NULL;
+        e->linked = false;
+        stats.entries--;
+        stats.bytes -= e->bytes;
+    }
+
+    static void push_front(nd_cache_entry_t *e)
+    {
+        e->prev = NULL;
+        e->next = head;
+        if (head != NULL)
+            head->prev = e;
+        head = e;
+        if (tail == NULL)
+            tail = e;
+        e->linked = true;
+        stats.entries++;
+        stats.bytes += e->bytes;
+    }
+
+    // Drops least recently used entries until bytes more fit; borrowed ones are freed at release
+    static void evict(size_t bytes)
+    {
+        while (tail != NULL && stats.bytes + bytes > stats.budget)
+        {
+            nd_cache_entry_t *e = tail;
+            unlink_entry(e);
+            stats.evictions++;
+            if (e->refs == 0)
+                entry_free(e);
+        }
+    }
+
+    // Bitwise, like the hash: a collision never serves the factorization of another matrix
+    static bool same_contents(const ndarray_t *key, ndarray_t *A)
+    {
+        for (size_t i = 0; i < A->shape[0]; i++)
+            if (memcmp(key->data[i], A->data[i], sizeof(double) * A->shape[1]) != 0)
+                return false;
+        return true;
+    }
+
+    static nd_cache_entry_t *find(uint64_t hash, ndarray_t *A, nd_fact_kind_t kind)
+    {
+        for (nd_cache_entry_t *e = head; e != NULL; e = e->next)
+            if (e->hash == hash && e->fact.kind == kind
+                && e->shape[0] == A->shape[0] && e->shape[1] == A->shape[1]
+                && same_contents(&e->key, A))
+                return e;
+        return NULL;
+    }
+
+/** Settings */
+
+    static void init_budget(void)
+    {
+        const char *env = getenv("NDMATH_FACTOR_CACHE");
+        long long bytes = env != NULL ? strtoll(env, NULL, 10) : 0;
+        stats.budget = bytes > 0 ? (size_t)bytes : 0;
+    }
+
+    void nd_cache_set_budget(size_t bytes)
+    {
+        pthread_once(&budget_once, init_budget);
+
+        pthread_mutex_lock(&cache_mutex);
+        stats.budget = bytes;
+        evict(0);
+        pthread_mutex_unlock(&cache_mutex);
+    }
+
+    void nd_cache_clear(void)
+    {
+        pthread_once(&budget_once, init_budget);
+
+        pthread_mutex_lock(&cache_mutex);
+        while (tail != NULL)
+        {
+            nd_cache_entry_t *e = tail;
+            unlink_entry(e);
+            if (e->refs == 0)
+                entry_free(e);
+        }
+        size_t budget = stats.budget;
+        memset(&stats, 0, sizeof(stats));
+        stats.budget = budget;
+        pthread_mutex_unlock(&cache_mutex);
+    }
+
+    nd_cache_stats_t nd_cache_stats(void)
+    {
+        pthread_once(&budget_once, init_budget);
+
+        pthread_mutex_lock(&cache_mutex);
+        nd_cache_stats_t s = stats;
+        pthread_mutex_unlock(&cache_mutex);
+        return s;
+    }
+
+/** Lookups */
+
+    nd_factorization_t *nd_cache_acquire(ndarray_t *A, nd_fact_kind_t kind)
+    {
+        if(isnull(A))
+            {null_error(); exit(EXIT_FAILURE);}
+        if(kind != ND_FACT_QR && issquare(A))
+            {shape_error(); exit(EXIT_FAILURE);}
+        pthread_once(&budget_once, init_budget);
+
+        uint64_t hash = 0;
+        pthread_mutex_lock(&cache_mutex);
+        bool enabled = stats.budget > 0;
+        if(enabled)
+        {
+            pthread_mutex_unlock(&cache_mutex);
+            hash = matrix_hash(A);
+            pthread_mutex_lock(&cache_mutex);
+
+            nd_cache_entry_t *e = find(hash, A, kind);
+            if(e != NULL)
+            {
+                unlink_entry(e);
+                push_front(e);
+                e->refs++;
+                stats.hits++;
+                pthread_mutex_unlock(&cache_mutex);
+                return &e->fact;
+            }
+            stats.misses++;
+        }
+        pthread_mutex_unlock(&cache_mutex);
+
+        // Factor outside the lock; another thread may cache the same matrix meanwhile
+        nd_cache_entry_t *e = calloc(1, sizeof(nd_cache_entry_t));
+        if(e == NULL)
+            malloc_error();
+        e->fact.kind = kind;
+        e->hash = hash;
+        e->shape[0] = A->shape[0];
+        e->shape[1] = A->shape[1];
+        e->refs = 1;
+        factor(e, A);
+
+        if(!enabled)
+            return &e->fact;
+        e->key = copy(A);
+        e->bytes += array_bytes(&e->key);
+
+        pthread_mutex_lock(&cache_mutex);
+        nd_cache_entry_t *other = find(hash, A, kind);
+        if(other == NULL && e->bytes <= stats.budget)
+        {
+            evict(e->bytes);
+            push_front(e);
+        }
+        pthread_mutex_unlock(&cache_mutex);
+        return &e->fact;
+    }
+
+    void nd_cache_release(nd_factorization_t *f)
+    {
+        if(f == NULL)
+            return;
+
+        nd_cache_entry_t *e = (nd_cache_entry_t *)f;
+        pthread_mutex_lock(&cache_mutex);
+        bool last = --e->refs == 0 && !e->linked;
+        pthread_mutex_unlock(&cache_mutex);
+        if(last)
+            entry_free(e);
+    }
+
+    ndarray_t nd_cache_solve(ndarray_t *A, ndarray_t *B, nd_fact_kind_t kind)
+    {
+        if(isnull(A) || isnull(B))
+            {null_error(); exit(EXIT_FAILURE);}
+        if(B->shape[0] != A->shape[0])
+        {
+            fprintf(stderr, "Invalid dimensions %ldx%ld for a solve with a %ldx%ld matrix\n",
+                    B->shape[0], B->shape[1], A->shape[0], A->shape[1]);
+            perror("Use valid ndarray_t dimesions please\n");
+            exit(1);
+        }
+
+        // The solves exit with a singular error for a singular or indefinite factorization
+        nd_factorization_t *f = nd_cache_acquire(A, kind);
+        ndarray_t X = kind == ND_FACT_LU ? nd_lu_solve(&f->lu, B)
+                    : kind == ND_FACT_CHOLESKY ? nd_cholesky_solve(&f->chol, B)
+                    : nd_qr_solve(&f->qr, B);
+        nd_cache_release(f);
+        return X;
+    }
+
+#pragma GCC pop_options
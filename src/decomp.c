@@ -0,0 +1,3414 @@
+#include <ndmath/decomp.h>
+#include <ndmath/blas.h>
+#include <ndmath/backend.h>
+#include <ndmath/parallel.h>
+#include <ndmath/array.h>
+#include <ndmath/helper.h>
+#include <ndmath/error.h>
+#include <ndmath/conditionals.h>
+#include <ndmath/reduce.h>
+#include <ndmath/operations.h>
+#include <ndmath/sort.h>
+#include <ndmath/random.h>
+#include <math.h>
+#include <float.h>
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define ND_HAVE_X86_ROTATIONS 1
+#endif
+
+#pragma GCC push_options
+#pragma GCC optimize("O3", "unroll-loops")
+
+#define LU_LEAF 16              // columns eliminated one at a time
+#define TRI_LEAF 32             // Cholesky diagonal blocks factored by plain substitution
+#define LU_ROW_WORK 16384       // panel elements per task
+#define LU_MAX_SLOTS 256        // most tasks of one panel step
+#define CH_NB 256               // Cholesky panel width
+#define QR_NB 64                // columns per blocked QR step (and per T factor)
+#define QR_LEAF 8               // columns factored one reflector per pass
+#define QR_ROW_WORK 16384       // row elements per task in QR passes
+#define QR_MAX_SLOTS 256        // most tasks of one QR pass
+#define ROW_AHEAD 8             // rows prefetched ahead in passes over row pointers
+#define EH_NB 32                // columns per tridiagonal reduction panel
+#define EH_COL_WORK 256         // trailing columns per GEMM in the tridiagonal update
+#define EH_ROW_WORK 16384       // matrix elements per task in symmetric products
+#define EH_MAX_SLOTS 64         // most partial products of one symmetric product
+#define DC_LEAF 32              // tridiagonal blocks solved directly by QL iteration
+#define QL_SWEEPS 30            // QL iterations allowed per eigenvalue
+#define SV_NB 32                // columns per bidiagonal reduction panel
+#define SV_ROW_WORK 16384       // matrix elements per task in the reduction's products
+#define SV_MAX_SLOTS 64         // most partial products of one transposed product
+#define SV_QR_FIRST 1.5         // rows per column from which R is reduced instead of A
+#define SV_ROTATIONS 262144     // rotations buffered before they are applied to the vectors
+#define SV_STRIP 64             // columns of the vectors per task when applying rotations
+#define SV_SWEEPS 6             // QR sweeps allowed, times n² rotations
+#define LS_RCOND 1e-8           // estimated 1/cond(A) below which least squares goes through the SVD
+#define LS_ESTIMATES 5          // steps of the condition number estimator
+#define MX_LEAF 16              // columns eliminated one at a time in float32
+#define MX_TRI_LEAF 32          // rows solved by plain substitution in float32
+#define MX_ITERS 30             // refinement steps before falling back to double
+
+#define ALWAYS_INLINE static inline __attribute__((always_inline))
+
+/** Panel factorization */
+
+typedef struct {
+    double **rows;
+    size_t c, end;              // column being eliminated, end of the panel
+    size_t grain;
+    double slot_max[LU_MAX_SLOTS];
+    size_t slot_row[LU_MAX_SLOTS];
+} panel_ctx_t;
+
+    // Row of the first largest |rows[i][c]| for i in [c, n)
+    static size_t pivot_search(double **rows, size_t c, size_t n)
+    {
+        size_t p = c;
+        double best = fabs(rows[c][c]);
+        for (size_t i = c + 1; i < n; i++)
+        {
+            double v = fabs(rows[i][c]);
+            if (v > best)
+            {
+                best = v;
+                p = i;
+            }
+        }
+        return p;
+    }
+
+    // Eliminates column c from rows c+1+[begin, end) of the panel, and searches the updated
+    // column c+1 of the same rows for the next pivot
+    static void panel_task(size_t begin, size_t end, void *ctx)
+    {
+        panel_ctx_t *pc = ctx;
+        size_t c = pc->c, next = c + 1;
+        const double *prow = pc->rows[c];
+        double rpiv = 1.0 / prow[c];
+        double best = -1.0;
+        size_t best_row = next;
+
+        for (size_t t = begin; t < end; t++)
+        {
+            double *row = pc->rows[next + t];
+            double l = row[c] *= rpiv;
+            for (size_t j = next; j < pc->end; j++)
+                row[j] -= l * prow[j];
+
+            if (next < pc->end && fabs(row[next]) > best)
+            {
+                best = fabs(row[next]);
+                best_row = next + t;
+            }
+        }
+
+        pc->slot_max[begin / pc->grain] = best;
+        pc->slot_row[begin / pc->grain] = best_row;
+    }
+
+    static void swap_rows(nd_lu_t *lu, size_t a, size_t b)
+    {
+        double *row = lu->LU.data[a];
+        lu->LU.data[a] = lu->LU.data[b];
+        lu->LU.data[b] = row;
+
+        size_t idx = lu->perm[a];
+        lu->perm[a] = lu->perm[b];
+        lu->perm[b] = idx;
+        lu->sign = -lu->sign;
+    }
+
+    // Unblocked LU of columns [j, j + jb) over rows [j, n)
+    static void lu_leaf(nd_lu_t *lu, size_t j, size_t jb)
+    {
+        double **rows = lu->LU.data;
+        size_t n = lu->LU.shape[0];
+        panel_ctx_t pc;
+        pc.rows = rows;
+        pc.end = j + jb;
+
+        size_t p = pivot_search(rows, j, n);
+        for (size_t c = j; c < j + jb; c++)
+        {
+            if (p != c)
+                swap_rows(lu, c, p);
+
+            size_t below = n - c - 1;
+            if (rows[c][c] == 0.0)
+            {
+                // Nothing to eliminate with: the column below is zero too
+                lu->singular = true;
+                if (c + 1 < j + jb)
+                    p = pivot_search(rows, c + 1, n);
+                continue;
+            }
+            if (below == 0)
+                break;
+
+            pc.c = c;
+            pc.grain = LU_ROW_WORK / (j + jb - c) + 1;
+            if (pc.grain < (below + LU_MAX_SLOTS - 1) / LU_MAX_SLOTS)
+                pc.grain = (below + LU_MAX_SLOTS - 1) / LU_MAX_SLOTS;
+            nd_parallel_for(below, pc.grain, panel_task, &pc);
+
+            if (c + 1 < j + jb)
+            {
+                size_t slots = (below + pc.grain - 1) / pc.grain;
+                double best = -1.0;
+                p = c + 1;
+                for (size_t s = 0; s < slots; s++)
+                {
+                    if (pc.slot_max[s] > best)
+                    {
+                        best = pc.slot_max[s];
+                        p = pc.slot_row[s];
+                    }
+                }
+            }
+        }
+    }
+
+/** Triangular updates */
+
+// Form of op(T) in a triangular solve
+#define TRI_UPPER 1             // op(T) is upper triangular (else lower)
+#define TRI_TRANS 2             // op(T) = Tᵀ
+#define TRI_UNIT 4              // unit diagonal, not stored
+
+    /*
+     * Solves op(T[t0..t0+nb)²) X = X in place for rows [x0, x0 + nb) and columns [col, col + ncols)
+     * of X with nd_trsm(); T and X may be the same array when the blocks do not overlap.
+     */
+    static void tri_solve(ndarray_t *T, size_t t0, ndarray_t *X, size_t x0, size_t nb,
+                          size_t col, size_t ncols, int form)
+    {
+        if (nb == 0 || ncols == 0)
+            return;
+        bool trans = form & TRI_TRANS;
+        ndarray_t Tv = nd_view(T, t0, t0, nb, nb);
+        ndarray_t Xv = nd_view(X, x0, col, nb, ncols);
+        nd_trsm(ND_LEFT, (form & TRI_UPPER) != trans ? ND_UPPER : ND_LOWER, trans ? ND_TRANS : ND_NO_TRANS,
+                (form & TRI_UNIT) ? ND_UNIT : ND_NON_UNIT, 1.0, &Tv, &Xv, &Xv);
+        nd_view_free(&Tv);
+        nd_view_free(&Xv);
+    }
+
+/** LU */
+
+    /*
+     * Recursive LU of columns [j, j + jb) over rows [j, n): factor the left half, update the
+     * right half (a triangular solve for its top rows, a GEMM below them), factor the right
+     * half. Row swaps exchange whole row pointers, so they reach every column at once.
+     */
+    static void lu_factor(nd_lu_t *lu, size_t j, size_t jb)
+    {
+        if (jb <= LU_LEAF)
+        {
+            lu_leaf(lu, j, jb);
+            return;
+        }
+
+        size_t h = jb / 2, below = lu->LU.shape[0] - j - h;
+        lu_factor(lu, j, h);
+
+        tri_solve(&lu->LU, j, &lu->LU, j, h, j + h, jb - h, TRI_UNIT);
+
+        ndarray_t L21 = nd_view(&lu->LU, j + h, j, below, h);
+        ndarray_t U12 = nd_view(&lu->LU, j, j + h, h, jb - h);
+        ndarray_t A22 = nd_view(&lu->LU, j + h, j + h, below, jb - h);
+        nd_gemm(ND_NO_TRANS, ND_NO_TRANS, -1.0, &L21, &U12, 1.0, &A22);
+        nd_view_free(&L21);
+        nd_view_free(&U12);
+        nd_view_free(&A22);
+
+        lu_factor(lu, j + h, jb - h);
+    }
+
+    nd_lu_t nd_lu(ndarray_t *this)
+    {
+        if(isnull(this))
+            {null_error(); exit(EXIT_FAILURE);}
+        if(issquare(this))
+            mat_error();
+
+        nd_lu_t lu = {0};
+        if(nd_backend_lu(this, &lu))
+            return lu;
+
+        size_t n = this->shape[0];
+        lu.LU = copy(this);
+        lu.perm = (size_t *)malloc(sizeof(size_t) * n);
+        if(lu.perm == NULL)
+            malloc_error();
+        for(size_t i = 0; i < n; i++)
+            lu.perm[i] = i;
+        lu.sign = 1;
+        lu.singular = false;
+
+        lu_factor(&lu, 0, n);
+
+        return lu;
+    }
+
+    ndarray_t nd_lu_solve(nd_lu_t *lu, ndarray_t *B)
+    {
+        if(lu == NULL || isnull(&lu->LU) || isnull(B))
+            {null_error(); exit(EXIT_FAILURE);}
+
+        size_t n = lu->LU.shape[0], nrhs = B->shape[1];
+        if(B->shape[0] != n)
+        {
+            fprintf(stderr, "Invalid dimensions %ldx%ld for a solve with a %ldx%ld factorization\n",
+                    B->shape[0], B->shape[1], n, n);
+            perror("Use valid ndarray_t dimesions please\n");
+            exit(1);
+        }
+        if(lu->singular)
+            singular_error();
+
+        ndarray_t X = array(n, nrhs);
+        for(size_t i = 0; i < n; i++)
+            memcpy(X.data[i], B->data[lu->perm[i]], sizeof(double) * nrhs);
+
+        tri_solve(&lu->LU, 0, &X, 0, n, 0, nrhs, TRI_UNIT);
+        tri_solve(&lu->LU, 0, &X, 0, n, 0, nrhs, TRI_UPPER);
+
+        return X;
+    }
+
+    void nd_lu_free(nd_lu_t *lu)
+    {
+        if(lu == NULL)
+            return;
+        clean(&lu->LU, NULL);
+        free(lu->perm);
+        lu->perm = NULL;
+    }
+
+/** Cholesky */
+
+    ALWAYS_INLINE double row_dot(const double *a, const double *b, size_t n)
+    {
+        double part[8] = {0};
+        size_t k = 0;
+        for (; k + 8 <= n; k += 8)
+            for (size_t l = 0; l < 8; l++)
+                part[l] += a[k + l] * b[k + l];
+
+        double s = ((part[0] + part[1]) + (part[2] + part[3])) + ((part[4] + part[5]) + (part[6] + part[7]));
+        for (; k < n; k++)
+            s += a[k] * b[k];
+        return s;
+    }
+
+    // Unblocked Cholesky of the diagonal block [j, j + jb)²; false on a pivot that is not positive
+    static bool chol_leaf(double **rows, size_t j, size_t jb)
+    {
+        for (size_t r = j; r < j + jb; r++)
+        {
+            double *lr = rows[r];
+            for (size_t s = j; s < r; s++)
+                lr[s] = (lr[s] - row_dot(lr + j, rows[s] + j, s - j)) / rows[s][s];
+
+            double d = lr[r] - row_dot(lr + j, lr + j, r - j);
+            if (!(d > 0.0))
+                return false;
+            lr[r] = sqrt(d);
+        }
+        return true;
+    }
+
+    // X[x0..x0+rows)[c0..c0+w) = X L⁻ᵀ for the lower block L[l0..l0+w)², with nd_trsm()
+    static void right_tri_solve(ndarray_t *L, size_t l0, ndarray_t *X, size_t x0, size_t rows, size_t c0, size_t w)
+    {
+        if (rows == 0 || w == 0)
+            return;
+        ndarray_t Lv = nd_view(L, l0, l0, w, w);
+        ndarray_t Xv = nd_view(X, x0, c0, rows, w);
+        nd_trsm(ND_RIGHT, ND_LOWER, ND_TRANS, ND_NON_UNIT, 1.0, &Lv, &Xv, &Xv);
+        nd_view_free(&Lv);
+        nd_view_free(&Xv);
+    }
+
+    // Trailing update of the lower trapezoid: L[r0.., r0..r0+cols) -= L[r0.., k0..k0+kb) L[r0..r0+cols, k0..k0+kb)ᵀ
+    static void chol_update(ndarray_t *L, size_t r0, size_t rows, size_t cols, size_t k0, size_t kb)
+    {
+        for (size_t c = 0; c < cols; c += CH_NB)
+        {
+            size_t w = cols - c < CH_NB ? cols - c : CH_NB;
+            ndarray_t C = nd_view(L, r0 + c, r0 + c, rows - c, w);
+            ndarray_t A = nd_view(L, r0 + c, k0, rows - c, kb);
+            ndarray_t B = nd_view(L, r0 + c, k0, w, kb);
+            nd_gemm(ND_NO_TRANS, ND_TRANS, -1.0, &A, &B, 1.0, &C);
+            nd_view_free(&C);
+            nd_view_free(&A);
+            nd_view_free(&B);
+        }
+    }
+
+    // Diagonal block [j, j + jb)², halved recursively down to chol_leaf()
+    static bool chol_diag(ndarray_t *L, size_t j, size_t jb)
+    {
+        if (jb <= TRI_LEAF)
+            return chol_leaf(L->data, j, jb);
+
+        size_t h = jb / 2;
+        if (!chol_diag(L, j, h))
+            return false;
+        right_tri_solve(L, j, L, j + h, jb - h, j, h);
+        chol_update(L, j + h, jb - h, jb - h, j, h);
+        return chol_diag(L, j + h, jb - h);
+    }
+
+    nd_cholesky_t nd_cholesky(ndarray_t *this)
+    {
+        if(isnull(this))
+            {null_error(); exit(EXIT_FAILURE);}
+        if(issquare(this))
+            mat_error();
+
+        size_t n = this->shape[0];
+        nd_cholesky_t chol = {0};
+        chol.L = copy(this);
+        chol.indefinite = false;
+
+        for(size_t j = 0; j < n; j += CH_NB)
+        {
+            size_t jb = n - j < CH_NB ? n - j : CH_NB;
+            if(!chol_diag(&chol.L, j, jb))
+            {
+                chol.indefinite = true;
+                break;
+            }
+
+            size_t rest = n - j - jb;
+            if(rest == 0)
+                break;
+
+            // L21 = A21 L11⁻ᵀ
+            right_tri_solve(&chol.L, j, &chol.L, j + jb, rest, j, jb);
+
+            // A22 -= L21 L21ᵀ, lower trapezoid only: one GEMM per block column
+            chol_update(&chol.L, j + jb, rest, rest, j, jb);
+        }
+
+        // The strict upper triangle only ever held updates that are never read
+        for(size_t i = 0; i < n; i++)
+            memset(chol.L.data[i] + i + 1, 0, sizeof(double) * (n - i - 1));
+
+        chol.logdet = 0.0;
+        for(size_t i = 0; i < n; i++)
+            chol.logdet += 2.0 * log(chol.L.data[i][i]);
+        if(chol.indefinite)
+            chol.logdet = NAN;
+
+        return chol;
+    }
+
+    ndarray_t nd_cholesky_solve(nd_cholesky_t *chol, ndarray_t *B)
+    {
+        if(chol == NULL || isnull(&chol->L) || isnull(B))
+            {null_error(); exit(EXIT_FAILURE);}
+
+        size_t n = chol->L.shape[0], nrhs = B->shape[1];
+        if(B->shape[0] != n)
+        {
+            fprintf(stderr, "Invalid dimensions %ldx%ld for a solve with a %ldx%ld factorization\n",
+                    B->shape[0], B->shape[1], n, n);
+            perror("Use valid ndarray_t dimesions please\n");
+            exit(1);
+        }
+        if(chol->indefinite)
+            spd_error();
+
+        // L Y = B, then Lᵀ X = Y
+        ndarray_t X = copy(B);
+        tri_solve(&chol->L, 0, &X, 0, n, 0, nrhs, 0);
+        tri_solve(&chol->L, 0, &X, 0, n, 0, nrhs, TRI_UPPER | TRI_TRANS);
+
+        return X;
+    }
+
+    // Checks a rank-1 modification of chol and returns the n entries of x in a new buffer
+    static double *chol_vector(nd_cholesky_t *chol, ndarray_t *x)
+    {
+        if (chol == NULL || isnull(&chol->L) || isnull(x))
+            {null_error(); exit(EXIT_FAILURE);}
+
+        size_t n = chol->L.shape[0];
+        if ((x->shape[0] != 1 && x->shape[1] != 1) || x->shape[0] * x->shape[1] != n)
+        {
+            fprintf(stderr, "Invalid dimensions %ldx%ld for a rank-1 change of a %ldx%ld factorization\n",
+                    x->shape[0], x->shape[1], n, n);
+            perror("Use valid ndarray_t dimesions please\n");
+            exit(1);
+        }
+        if (chol->indefinite)
+            spd_error();
+
+        double *v = malloc(sizeof(double) * n);
+        if (v == NULL)
+            malloc_error();
+        for (size_t i = 0; i < n; i++)
+            v[i] = x->shape[1] == 1 ? x->data[i][0] : x->data[0][i];
+        return v;
+    }
+
+    static void chol_logdet(nd_cholesky_t *chol)
+    {
+        chol->logdet = 0.0;
+        for (size_t i = 0; i < chol->L.shape[0]; i++)
+            chol->logdet += 2.0 * log(chol->L.data[i][i]);
+    }
+
+    void nd_cholesky_update(nd_cholesky_t *chol, ndarray_t *x)
+    {
+        double *v = chol_vector(chol, x);
+        size_t n = chol->L.shape[0];
+        double *c = malloc(sizeof(double) * n), *s = malloc(sizeof(double) * n);
+        if(c == NULL || s == NULL)
+            malloc_error();
+
+        // [L x] G₀ ... G_{n-1} = [L' 0]: row j meets the rotations of the rows above it,
+        // then its own rotation zeroes what is left of x[j] against the diagonal
+        for(size_t j = 0; j < n; j++)
+        {
+            double *Lj = chol->L.data[j], xj = v[j];
+            for(size_t i = 0; i < j; i++)
+            {
+                double t = c[i] * Lj[i] + s[i] * xj;
+                xj = c[i] * xj - s[i] * Lj[i];
+                Lj[i] = t;
+            }
+            double r = hypot(Lj[j], xj);
+            c[j] = Lj[j] / r;
+            s[j] = xj / r;
+            Lj[j] = r;
+        }
+
+        chol_logdet(chol);
+        free(v);
+        free(c);
+        free(s);
+    }
+
+    bool nd_cholesky_downdate(nd_cholesky_t *chol, ndarray_t *x)
+    {
+        double *p = chol_vector(chol, x);
+        size_t n = chol->L.shape[0];
+        double **L = chol->L.data;
+
+        // L p = x; A - x xᵀ = L (I - p pᵀ) Lᵀ is positive definite exactly when pᵀp < 1
+        double pp = 0.0;
+        for(size_t i = 0; i < n; i++)
+        {
+            double t = p[i];
+            for(size_t k = 0; k < i; k++)
+                t -= L[i][k] * p[k];
+            p[i] = t / L[i][i];
+            pp += p[i] * p[i];
+        }
+        if(!(pp < 1.0 - (double)n * DBL_EPSILON))
+        {
+            free(p);
+            return false;
+        }
+
+        double *c = malloc(sizeof(double) * n), *s = malloc(sizeof(double) * n);
+        if(c == NULL || s == NULL)
+            malloc_error();
+
+        // Rotations G_{n-1}, ..., G₀ taking [p; alpha] to the last unit vector
+        double alpha = sqrt(1.0 - pp);
+        for(size_t i = n; i-- > 0;)
+        {
+            double scale = alpha + fabs(p[i]);
+            double a = alpha / scale, b = p[i] / scale, r = sqrt(a * a + b * b);
+            c[i] = a / r;
+            s[i] = b / r;
+            alpha = scale * r;
+        }
+
+        // The same rotations applied to [Lᵀ; 0] give [L'ᵀ; xᵀ]: each row of L independently
+        for(size_t j = 0; j < n; j++)
+        {
+            double *Lj = L[j], carry = 0.0;
+            for(size_t i = j + 1; i-- > 0;)
+            {
+                double t = c[i] * carry + s[i] * Lj[i];
+                Lj[i] = c[i] * Lj[i] - s[i] * carry;
+                carry = t;
+            }
+        }
+
+        chol_logdet(chol);
+        free(p);
+        free(c);
+        free(s);
+        return true;
+    }
+
+    void nd_cholesky_free(nd_cholesky_t *chol)
+    {
+        if(chol == NULL)
+            return;
+        clean(&chol->L, NULL);
+    }
+
+/** QR */
+
+typedef struct {
+    double **rows;
+    size_t r0;                  // first row of the pass
+    size_t c0, end;             // columns of the leaf
+    size_t c;                   // column whose reflector is applied
+    size_t next;                // column accumulated for the following reflector
+    bool apply;
+    double scale, tau;          // v = rows[i][c] * scale below the diagonal
+    double w[QR_LEAF];          // vᵀ A for the leaf columns, zero up to c
+    double keep[QR_LEAF];       // 1, and scale at c: writes v without a separate store
+    size_t grain;
+    double slot[QR_MAX_SLOTS][2 * QR_LEAF];
+} qr_leaf_ctx_t;
+
+    /*
+     * Leaf rows r0+[begin, end): scales v below column c and applies its reflector to the rest of
+     * the leaf, then accumulates what the next reflector needs from the updated rows, so every
+     * Householder step is a single pass over the rows. Every loop runs over the whole leaf width
+     * so it vectorizes; entries that do not apply are multiplied by the zeros of w or ignored,
+     * and v is written through keep rather than a scalar store the vector loads would stall on.
+     * Per slot: u = xᵀ A for x = column next below its diagonal (so u[next] = |x|²), and Vᵀv for
+     * the T factor.
+     */
+    ALWAYS_INLINE void leaf_span(double *const *rows, size_t begin, size_t end, size_t c0, size_t lb,
+                                 const qr_leaf_ctx_t *lc, bool apply, bool accumulate, double *u, double *z)
+    {
+        size_t c = lc->c - c0, next = lc->next - c0;
+        double w[QR_LEAF], keep[QR_LEAF], scale = lc->scale, tau = lc->tau;
+        memcpy(w, lc->w, sizeof(w));
+        memcpy(keep, lc->keep, sizeof(keep));
+
+        for (size_t t = begin; t < end; t++)
+        {
+            double *a = rows[t] + c0;
+            if (t + ROW_AHEAD < end)
+            {
+                __builtin_prefetch(rows[t + ROW_AHEAD] + c0, 1);
+                __builtin_prefetch(rows[t + ROW_AHEAD] + c0 + lb - 1, 1);
+            }
+
+            if (apply)
+            {
+                double v = a[c] * scale, tv = tau * v;
+                for (size_t q = 0; q < lb; q++)
+                {
+                    z[q] += a[q] * v;
+                    a[q] = a[q] * keep[q] - tv * w[q];
+                }
+            }
+            if (accumulate)
+            {
+                double x = a[next];
+                for (size_t q = 0; q < lb; q++)
+                    u[q] += x * a[q];
+            }
+        }
+    }
+
+    ALWAYS_INLINE void leaf_rows(qr_leaf_ctx_t *lc, size_t begin, size_t end, size_t lb)
+    {
+        double *const *rows = lc->rows + lc->r0;
+        double u[QR_LEAF] = {0}, z[QR_LEAF] = {0};
+
+        // Row next is the top of the next reflector, not part of x
+        size_t first = lc->next >= lc->end ? end : lc->next - lc->r0 + 1;
+        size_t mid = first < begin ? begin : first > end ? end : first;
+
+        if (lc->apply)
+        {
+            leaf_span(rows, begin, mid, lc->c0, lb, lc, true, false, u, z);
+            leaf_span(rows, mid, end, lc->c0, lb, lc, true, true, u, z);
+        }
+        else
+            leaf_span(rows, mid, end, lc->c0, lb, lc, false, true, u, z);
+
+        double *slot = lc->slot[begin / lc->grain];
+        memcpy(slot, u, sizeof(u));
+        memcpy(slot + QR_LEAF, z, sizeof(z));
+    }
+
+    static void qr_leaf_task(size_t begin, size_t end, void *ctx)
+    {
+        qr_leaf_ctx_t *lc = ctx;
+        if (lc->end - lc->c0 == QR_LEAF)
+            leaf_rows(lc, begin, end, QR_LEAF);
+        else
+            leaf_rows(lc, begin, end, lc->end - lc->c0);
+    }
+
+    static void qr_leaf_pass(qr_leaf_ctx_t *lc, size_t m, double *sums)
+    {
+        memset(sums, 0, sizeof(double) * 2 * QR_LEAF);
+        if (lc->r0 >= m)
+            return;
+
+        size_t rows = m - lc->r0;
+        lc->grain = QR_ROW_WORK / (lc->end - lc->c0) + 1;
+        if (lc->grain < (rows + QR_MAX_SLOTS - 1) / QR_MAX_SLOTS)
+            lc->grain = (rows + QR_MAX_SLOTS - 1) / QR_MAX_SLOTS;
+        nd_parallel_for(rows, lc->grain, qr_leaf_task, lc);
+
+        size_t slots = (rows + lc->grain - 1) / lc->grain;
+        for (size_t s = 0; s < slots; s++)
+            for (size_t l = 0; l < 2 * QR_LEAF; l++)
+                sums[l] += lc->slot[s][l];
+    }
+
+    /*
+     * Reflector H = I - tau v vᵀ with v[0] = 1 mapping (alpha, x) to (beta, 0), given sigma = |x|².
+     * Returns beta; v = x * scale.
+     */
+    static double householder(double alpha, double sigma, double *tau, double *scale)
+    {
+        if (!(sigma > 0.0))
+        {
+            *tau = 0.0;
+            *scale = 0.0;
+            return alpha;
+        }
+
+        double beta = -copysign(sqrt(alpha * alpha + sigma), alpha);
+        *tau = (beta - alpha) / beta;
+        *scale = 1.0 / (alpha - beta);
+        return beta;
+    }
+
+    // Householder QR of columns [j, j + lb) over rows [j, m), and the lb x lb T factor of their reflectors
+    static void qr_leaf(nd_qr_t *qr, size_t j, size_t lb, ndarray_t *T)
+    {
+        double **rows = qr->QR.data;
+        size_t m = qr->QR.shape[0];
+        double sums[2 * QR_LEAF], z[QR_LEAF];
+        qr_leaf_ctx_t lc;
+        lc.rows = rows;
+        lc.c0 = j;
+        lc.end = j + lb;
+
+        lc.apply = false;
+        lc.c = j;
+        lc.next = j;
+        lc.r0 = j + 1;
+        qr_leaf_pass(&lc, m, sums);
+
+        for (size_t c = j; c < j + lb; c++)
+        {
+            double tau, scale;
+            rows[c][c] = householder(rows[c][c], sums[c - j], &tau, &scale);
+            qr->tau[c] = tau;
+
+            // Row c, where v is 1
+            memset(lc.w, 0, sizeof(lc.w));
+            for (size_t q = 0; q < QR_LEAF; q++)
+                lc.keep[q] = q == c - j ? scale : 1.0;
+            for (size_t q = c + 1; q < j + lb; q++)
+            {
+                lc.w[q - j] = rows[c][q] + scale * sums[q - j];
+                rows[c][q] -= tau * lc.w[q - j];
+            }
+            for (size_t p = j; p < c; p++)
+                z[p - j] = rows[c][p];
+
+            lc.apply = true;
+            lc.c = c;
+            lc.next = c + 1;
+            lc.r0 = c + 1;
+            lc.scale = scale;
+            lc.tau = tau;
+            qr_leaf_pass(&lc, m, sums);
+
+            // T[0:k, k] = -tau T[0:k, 0:k] Vᵀv
+            size_t k = c - j;
+            for (size_t p = 0; p < k; p++)
+                z[p] += sums[QR_LEAF + p];
+            for (size_t p = 0; p < k; p++)
+            {
+                double t = 0.0;
+                for (size_t q = p; q < k; q++)
+                    t += T->data[p][q] * z[q];
+                T->data[p][k] = -tau * t;
+            }
+            T->data[k][k] = tau;
+        }
+    }
+
+    // kb x kb copy of the top of a block of reflectors: unit diagonal, V below it, zeros above
+    static ndarray_t unit_lower(ndarray_t *A, size_t r0, size_t c0, size_t kb)
+    {
+        ndarray_t V = zeros(kb, kb);
+        for (size_t i = 0; i < kb; i++)
+        {
+            memcpy(V.data[i], A->data[r0 + i] + c0, sizeof(double) * i);
+            V.data[i][i] = 1.0;
+        }
+        return V;
+    }
+
+    /*
+     * C = Hᵀ C (trans) or H C for the block reflector H = I - V T Vᵀ whose kb reflectors are stored
+     * in rows [r0, m) and columns [c0, c0 + kb) of A. C holds the same m - r0 rows. Four GEMMs and
+     * one small triangular product.
+     */
+    static void apply_block(ndarray_t *A, size_t r0, size_t c0, size_t kb, ndarray_t *T, ndarray_t *C, bool trans)
+    {
+        size_t rows = A->shape[0] - r0, nc = C->shape[1];
+        bool below = rows > kb;
+
+        ndarray_t Vt = unit_lower(A, r0, c0, kb);
+        ndarray_t W = array(kb, nc);
+        ndarray_t TW = array(kb, nc);
+        ndarray_t Ct = nd_view(C, 0, 0, kb, nc);
+        ndarray_t Vb = {0}, Cb = {0};
+        if (below)
+        {
+            Vb = nd_view(A, r0 + kb, c0, rows - kb, kb);
+            Cb = nd_view(C, kb, 0, rows - kb, nc);
+        }
+
+        // W = Vᵀ C, TW = op(T) W, C -= V TW
+        nd_gemm(ND_TRANS, ND_NO_TRANS, 1.0, &Vt, &Ct, 0.0, &W);
+        if (below)
+            nd_gemm(ND_TRANS, ND_NO_TRANS, 1.0, &Vb, &Cb, 1.0, &W);
+        nd_gemm(trans ? ND_TRANS : ND_NO_TRANS, ND_NO_TRANS, 1.0, T, &W, 0.0, &TW);
+        nd_gemm(ND_NO_TRANS, ND_NO_TRANS, -1.0, &Vt, &TW, 1.0, &Ct);
+        if (below)
+            nd_gemm(ND_NO_TRANS, ND_NO_TRANS, -1.0, &Vb, &TW, 1.0, &Cb);
+
+        if (below)
+        {
+            nd_view_free(&Vb);
+            nd_view_free(&Cb);
+        }
+        nd_view_free(&Ct);
+        clean(&Vt, &W, &TW, NULL);
+    }
+
+    /*
+     * Recursive panel QR of columns [j, j + jb) over rows [j, m): factor the left half, apply its
+     * block reflector to the right half, factor the right half, and join the two T factors with
+     * T12 = -T1 (V1ᵀ V2) T2.
+     */
+    static void qr_panel(nd_qr_t *qr, size_t j, size_t jb, ndarray_t *T)
+    {
+        if (jb <= QR_LEAF)
+        {
+            qr_leaf(qr, j, jb, T);
+            return;
+        }
+
+        size_t m = qr->QR.shape[0], h = jb / 2;
+        ndarray_t T1 = nd_view(T, 0, 0, h, h);
+        ndarray_t T2 = nd_view(T, h, h, jb - h, jb - h);
+        ndarray_t T12 = nd_view(T, 0, h, h, jb - h);
+
+        qr_panel(qr, j, h, &T1);
+        ndarray_t C = nd_view(&qr->QR, j, j + h, m - j, jb - h);
+        apply_block(&qr->QR, j, j, h, &T1, &C, true);
+        nd_view_free(&C);
+        qr_panel(qr, j + h, jb - h, &T2);
+
+        ndarray_t V2t = unit_lower(&qr->QR, j + h, j + h, jb - h);
+        ndarray_t V1m = nd_view(&qr->QR, j + h, j, jb - h, h);
+        ndarray_t S = array(h, jb - h);
+        ndarray_t U = array(h, jb - h);
+        nd_gemm(ND_TRANS, ND_NO_TRANS, 1.0, &V1m, &V2t, 0.0, &S);
+        if (m > j + jb)
+        {
+            ndarray_t V1b = nd_view(&qr->QR, j + jb, j, m - j - jb, h);
+            ndarray_t V2b = nd_view(&qr->QR, j + jb, j + h, m - j - jb, jb - h);
+            nd_gemm(ND_TRANS, ND_NO_TRANS, 1.0, &V1b, &V2b, 1.0, &S);
+            nd_view_free(&V1b);
+            nd_view_free(&V2b);
+        }
+        nd_gemm(ND_NO_TRANS, ND_NO_TRANS, 1.0, &T1, &S, 0.0, &U);
+        nd_gemm(ND_NO_TRANS, ND_NO_TRANS, -1.0, &U, &T2, 0.0, &T12);
+
+        nd_view_free(&V1m);
+        nd_view_free(&T1);
+        nd_view_free(&T2);
+        nd_view_free(&T12);
+        clean(&V2t, &S, &U, NULL);
+    }
+
+    // T factor of the jb reflectors stored from row r0 and column c0 of A, from S = VᵀV
+    static void build_t(ndarray_t *A, size_t r0, size_t c0, size_t jb, const double *taus, ndarray_t *T)
+    {
+        size_t m = A->shape[0];
+        ndarray_t Vt = unit_lower(A, r0, c0, jb);
+        ndarray_t S = array(jb, jb);
+        nd_gemm(ND_TRANS, ND_NO_TRANS, 1.0, &Vt, &Vt, 0.0, &S);
+        if (m > r0 + jb)
+        {
+            ndarray_t Vb = nd_view(A, r0 + jb, c0, m - r0 - jb, jb);
+            nd_gemm(ND_TRANS, ND_NO_TRANS, 1.0, &Vb, &Vb, 1.0, &S);
+            nd_view_free(&Vb);
+        }
+
+        for (size_t k = 0; k < jb; k++)
+        {
+            double tau = taus[k];
+            for (size_t p = 0; p < k; p++)
+            {
+                double t = 0.0;
+                for (size_t q = p; q < k; q++)
+                    t += T->data[p][q] * S.data[q][k];
+                T->data[p][k] = -tau * t;
+            }
+            T->data[k][k] = tau;
+        }
+        clean(&Vt, &S, NULL);
+    }
+
+/** Column-pivoted QR */
+
+typedef struct {
+    double **rows;
+    size_t r0;                  // first row of the pass
+    size_t j, k, col, n;        // block start, reflectors done in the block, current column, width
+    const double *fk;           // row of F for col
+    double scale;
+    size_t grain, width;
+    double *slot;               // per slot: F products over (col, n), then Vᵀv over the block
+    double sigma[QR_MAX_SLOTS];
+} qp3_ctx_t;
+
+    // Applies the block's pending update to column col and sums its square below the diagonal
+    static void qp3_column_task(size_t begin, size_t end, void *ctx)
+    {
+        qp3_ctx_t *pc = ctx;
+        double sigma = 0.0;
+
+        for (size_t t = begin; t < end; t++)
+        {
+            double *row = pc->rows[pc->r0 + t];
+            if (t + ROW_AHEAD < end)
+                __builtin_prefetch(pc->rows[pc->r0 + t + ROW_AHEAD] + pc->col, 1);
+            row[pc->col] -= row_dot(row + pc->j, pc->fk, pc->k);
+            if (pc->r0 + t > pc->col)
+                sigma += row[pc->col] * row[pc->col];
+        }
+        pc->sigma[begin / pc->grain] = sigma;
+    }
+
+    // Scales v and accumulates Aᵀv over the columns after col and Vᵀv over the block's reflectors
+    static void qp3_product_task(size_t begin, size_t end, void *ctx)
+    {
+        qp3_ctx_t *pc = ctx;
+        size_t col = pc->col, rest = pc->n - col - 1;
+        double *f = pc->slot + (begin / pc->grain) * pc->width;
+        double *aux = f + rest;
+        memset(f, 0, sizeof(double) * pc->width);
+
+        for (size_t t = begin; t < end; t++)
+        {
+            double *row = pc->rows[pc->r0 + t];
+            double v = 1.0;
+            if (pc->r0 + t > col)
+                v = row[col] *= pc->scale;
+
+            const double *a = row + col + 1;
+            for (size_t q = 0; q < rest; q++)
+                f[q] += v * a[q];
+            for (size_t p = 0; p < pc->k; p++)
+                aux[p] += row[pc->j + p] * v;
+        }
+    }
+
+    static size_t qp3_grain(size_t rows, size_t width)
+    {
+        size_t grain = QR_ROW_WORK / (width + 1) + 1;
+        if (grain < (rows + QR_MAX_SLOTS - 1) / QR_MAX_SLOTS)
+            grain = (rows + QR_MAX_SLOTS - 1) / QR_MAX_SLOTS;
+        return grain;
+    }
+
+    static void swap_columns(nd_qr_t *qr, ndarray_t *F, size_t j, size_t a, size_t b)
+    {
+        for (size_t i = 0; i < qr->QR.shape[0]; i++)
+        {
+            double t = qr->QR.data[i][a];
+            qr->QR.data[i][a] = qr->QR.data[i][b];
+            qr->QR.data[i][b] = t;
+        }
+
+        double *row = F->data[a - j];
+        F->data[a - j] = F->data[b - j];
+        F->data[b - j] = row;
+
+        size_t idx = qr->perm[a];
+        qr->perm[a] = qr->perm[b];
+        qr->perm[b] = idx;
+    }
+
+    /*
+     * QR with column pivoting in the style of LAPACK's xLAQPS: within a block of QR_NB columns the
+     * trailing matrix is updated lazily through F (A -= V Fᵀ), so each step costs one column update
+     * and one pass forming Aᵀv, and the block ends with a single GEMM. Partial column norms are
+     * downdated and recomputed once cancellation makes them unreliable.
+     */
+    static void qr_pivoted(nd_qr_t *qr)
+    {
+        double **rows = qr->QR.data;
+        size_t m = qr->QR.shape[0], n = qr->QR.shape[1], kmax = m < n ? m : n;
+        const double tol = sqrt(DBL_EPSILON);
+
+        ndarray_t sumsq = nd_reduce_axis(&qr->QR, "y", ND_REDUCE_SUMSQ, NULL);
+        double *vn1 = (double *)malloc(sizeof(double) * n);
+        double *vn2 = (double *)malloc(sizeof(double) * n);
+        bool *stale = (bool *)malloc(sizeof(bool) * n);
+        ndarray_t F = zeros(n, QR_NB);
+        qp3_ctx_t pc;
+        pc.rows = rows;
+        pc.n = n;
+        pc.slot = (double *)malloc(sizeof(double) * QR_MAX_SLOTS * (n + QR_NB));
+        if (vn1 == NULL || vn2 == NULL || stale == NULL || pc.slot == NULL)
+            malloc_error();
+
+        for (size_t c = 0; c < n; c++)
+        {
+            vn1[c] = vn2[c] = sqrt(sumsq.data[0][c]);
+            stale[c] = false;
+        }
+        clean(&sumsq, NULL);
+
+        size_t j = 0;
+        while (j < kmax)
+        {
+            size_t nb = kmax - j < QR_NB ? kmax - j : QR_NB, kb = 0;
+            bool recompute = false;
+            pc.j = j;
+
+            while (kb < nb && !recompute)
+            {
+                size_t col = j + kb, p = col;
+                for (size_t c = col + 1; c < n; c++)
+                    if (vn1[c] > vn1[p])
+                        p = c;
+                if (p != col)
+                {
+                    swap_columns(qr, &F, j, col, p);
+                    vn1[p] = vn1[col];
+                    vn2[p] = vn2[col];
+                }
+
+                // Column col with the block's pending update, and its reflector
+                pc.k = kb;
+                pc.col = col;
+                pc.r0 = col;
+                pc.fk = F.data[kb];
+                pc.grain = qp3_grain(m - col, kb);
+                nd_parallel_for(m - col, pc.grain, qp3_column_task, &pc);
+                double sigma = 0.0, tau, scale;
+                for (size_t s = 0; s < (m - col + pc.grain - 1) / pc.grain; s++)
+                    sigma += pc.sigma[s];
+                double beta = householder(rows[col][col], sigma, &tau, &scale);
+                qr->tau[col] = tau;
+
+                // F[:, kb] = tau Aᵀv - tau F (Vᵀv)
+                size_t rest = n - col - 1;
+                pc.scale = scale;
+                pc.width = rest + kb;
+                pc.grain = qp3_grain(m - col, pc.width);
+                rows[col][col] = 1.0;
+                nd_parallel_for(m - col, pc.grain, qp3_product_task, &pc);
+
+                size_t slots = (m - col + pc.grain - 1) / pc.grain;
+                double aux[QR_NB];
+                for (size_t r = 0; r <= kb; r++)
+                    F.data[r][kb] = 0.0;
+                for (size_t q = 0; q < rest; q++)
+                {
+                    double f = 0.0;
+                    for (size_t s = 0; s < slots; s++)
+                        f += pc.slot[s * pc.width + q];
+                    F.data[kb + 1 + q][kb] = tau * f;
+                }
+                for (size_t p = 0; p < kb; p++)
+                {
+                    double a = 0.0;
+                    for (size_t s = 0; s < slots; s++)
+                        a += pc.slot[s * pc.width + rest + p];
+                    aux[p] = -tau * a;
+                }
+                if (kb > 0)
+                    for (size_t r = 0; r < n - j; r++)
+                        F.data[r][kb] += row_dot(F.data[r], aux, kb);
+
+                // Row col of the trailing columns, then the partial norms it changes
+                for (size_t q = col + 1; q < n; q++)
+                {
+                    rows[col][q] -= row_dot(rows[col] + j, F.data[q - j], kb + 1);
+                    if (vn1[q] == 0.0)
+                        continue;
+
+                    double t = fabs(rows[col][q]) / vn1[q];
+                    t = (1.0 + t) * (1.0 - t);
+                    if (t < 0.0)
+                        t = 0.0;
+                    double ratio = vn1[q] / vn2[q];
+                    if (t * ratio * ratio <= tol)
+                    {
+                        stale[q] = true;
+                        recompute = true;
+                    }
+                    else
+                        vn1[q] *= sqrt(t);
+                }
+                rows[col][col] = beta;
+                kb++;
+            }
+
+            // A22 -= V Fᵀ for the rows and columns after the block
+            size_t done = j + kb;
+            if (done < m && done < n)
+            {
+                ndarray_t V = nd_view(&qr->QR, done, j, m - done, kb);
+                ndarray_t Fv = nd_view(&F, kb, 0, n - done, kb);
+                ndarray_t A22 = nd_view(&qr->QR, done, done, m - done, n - done);
+                nd_gemm(ND_NO_TRANS, ND_TRANS, -1.0, &V, &Fv, 1.0, &A22);
+                nd_view_free(&V);
+                nd_view_free(&Fv);
+                nd_view_free(&A22);
+            }
+
+            if (recompute)
+            {
+                for (size_t c = done; c < n; c++)
+                {
+                    if (!stale[c])
+                        continue;
+                    double s = 0.0;
+                    for (size_t i = done; i < m; i++)
+                        s += rows[i][c] * rows[i][c];
+                    vn1[c] = vn2[c] = sqrt(s);
+                    stale[c] = false;
+                }
+            }
+            j = done;
+        }
+
+        // The reflectors are final, so T can use the same QR_NB blocks as the unpivoted path
+        for (j = 0; j < kmax; j += QR_NB)
+        {
+            size_t jb = kmax - j < QR_NB ? kmax - j : QR_NB;
+            ndarray_t T = nd_view(&qr->T, 0, j, jb, jb);
+            build_t(&qr->QR, j, j, jb, qr->tau + j, &T);
+            nd_view_free(&T);
+        }
+
+        free(vn1);
+        free(vn2);
+        free(stale);
+        free(pc.slot);
+        clean(&F, NULL);
+    }
+
+/** QR interface */
+
+    nd_qr_t nd_qr(ndarray_t *this, bool pivot)
+    {
+        if(isnull(this))
+            {null_error(); exit(EXIT_FAILURE);}
+
+        size_t m = this->shape[0], n = this->shape[1], k = m < n ? m : n;
+        nd_qr_t qr = {0};
+        qr.QR = copy(this);
+        qr.T = zeros(k < QR_NB ? k : QR_NB, k);
+        qr.tau = (double *)malloc(sizeof(double) * k);
+        qr.perm = (size_t *)malloc(sizeof(size_t) * n);
+        if(qr.tau == NULL || qr.perm == NULL)
+            malloc_error();
+        for(size_t c = 0; c < n; c++)
+            qr.perm[c] = c;
+        qr.pivoted = pivot;
+
+        if(pivot)
+        {
+            qr_pivoted(&qr);
+            return qr;
+        }
+
+        // Right-looking: recursive panel, then its block reflector on the columns to the right
+        for(size_t j = 0; j < k; j += QR_NB)
+        {
+            size_t jb = k - j < QR_NB ? k - j : QR_NB;
+            ndarray_t T = nd_view(&qr.T, 0, j, jb, jb);
+            qr_panel(&qr, j, jb, &T);
+
+            if(j + jb < n)
+            {
+                ndarray_t C = nd_view(&qr.QR, j, j + jb, m - j, n - j - jb);
+                apply_block(&qr.QR, j, j, jb, &T, &C, true);
+                nd_view_free(&C);
+            }
+            nd_view_free(&T);
+        }
+
+        return qr;
+    }
+
+    // B = Qᵀ B (trans) or Q B, one block reflector at a time
+    static void qr_apply(nd_qr_t *qr, ndarray_t *B, bool trans)
+    {
+        size_t m = qr->QR.shape[0], n = qr->QR.shape[1], k = m < n ? m : n;
+        size_t blocks = (k + QR_NB - 1) / QR_NB;
+
+        for (size_t b = 0; b < blocks; b++)
+        {
+            size_t j = (trans ? b : blocks - 1 - b) * QR_NB;
+            size_t jb = k - j < QR_NB ? k - j : QR_NB;
+            ndarray_t T = nd_view(&qr->T, 0, j, jb, jb);
+            ndarray_t C = nd_view(B, j, 0, m - j, B->shape[1]);
+            apply_block(&qr->QR, j, j, jb, &T, &C, trans);
+            nd_view_free(&T);
+            nd_view_free(&C);
+        }
+    }
+
+    static void qr_check_rows(nd_qr_t *qr, ndarray_t *B)
+    {
+        if(qr == NULL || isnull(&qr->QR) || isnull(B))
+            {null_error(); exit(EXIT_FAILURE);}
+        if(B->shape[0] != qr->QR.shape[0])
+        {
+            fprintf(stderr, "Invalid dimensions %ldx%ld for a %ldx%ld QR factorization\n",
+                    B->shape[0], B->shape[1], qr->QR.shape[0], qr->QR.shape[1]);
+            perror("Use valid ndarray_t dimesions please\n");
+            exit(1);
+        }
+    }
+
+    void nd_qr_apply_qt(nd_qr_t *qr, ndarray_t *B)
+    {
+        qr_check_rows(qr, B);
+        qr_apply(qr, B, true);
+    }
+
+    void nd_qr_apply_q(nd_qr_t *qr, ndarray_t *B)
+    {
+        qr_check_rows(qr, B);
+        qr_apply(qr, B, false);
+    }
+
+    ndarray_t nd_qr_r(nd_qr_t *qr)
+    {
+        if(qr == NULL || isnull(&qr->QR))
+            {null_error(); exit(EXIT_FAILURE);}
+
+        size_t m = qr->QR.shape[0], n = qr->QR.shape[1], k = m < n ? m : n;
+        ndarray_t R = zeros(k, n);
+        for(size_t i = 0; i < k; i++)
+            memcpy(R.data[i] + i, qr->QR.data[i] + i, sizeof(double) * (n - i));
+        return R;
+    }
+
+    ndarray_t nd_qr_q(nd_qr_t *qr, bool economy)
+    {
+        if(qr == NULL || isnull(&qr->QR))
+            {null_error(); exit(EXIT_FAILURE);}
+
+        size_t m = qr->QR.shape[0], n = qr->QR.shape[1];
+        size_t cols = economy && n < m ? n : m;
+        ndarray_t Q = zeros(m, cols);
+        for(size_t i = 0; i < cols; i++)
+            Q.data[i][i] = 1.0;
+
+        qr_apply(qr, &Q, false);
+        return Q;
+    }
+
+    ndarray_t nd_qr_solve(nd_qr_t *qr, ndarray_t *B)
+    {
+        qr_check_rows(qr, B);
+
+        size_t m = qr->QR.shape[0], n = qr->QR.shape[1], nrhs = B->shape[1];
+        if(m < n)
+        {
+            fprintf(stderr, "Invalid dimensions %ldx%ld for a least-squares solve, need rows >= cols\n", m, n);
+            perror("Use valid ndarray_t dimesions please\n");
+            exit(1);
+        }
+        for(size_t i = 0; i < n; i++)
+            if(qr->QR.data[i][i] == 0.0)
+                singular_error();
+
+        // min |A x - b|: x = P R⁻¹ (Qᵀ b)[0:n]
+        ndarray_t QtB = copy(B);
+        qr_apply(qr, &QtB, true);
+        tri_solve(&qr->QR, 0, &QtB, 0, n, 0, nrhs, TRI_UPPER);
+
+        ndarray_t X = array(n, nrhs);
+        for(size_t i = 0; i < n; i++)
+            memcpy(X.data[qr->perm[i]], QtB.data[i], sizeof(double) * nrhs);
+        clean(&QtB, NULL);
+        return X;
+    }
+
+    void nd_qr_free(nd_qr_t *qr)
+    {
+        if(qr == NULL)
+            return;
+        clean(&qr->QR, &qr->T, NULL);
+        free(qr->tau);
+        free(qr->perm);
+        qr->tau = NULL;
+        qr->perm = NULL;
+    }
+/** Tridiagonal reduction */
+
+typedef struct {
+    double **rows;
+    size_t r0, n;               // the product covers rows and columns [r0, n)
+    const double *v;
+    size_t grain;
+    double *slot;               // per slot: a partial product over [r0, n)
+} symv_ctx_t;
+
+    /*
+     * Symmetric product with the lower triangle: row r adds its dot with v to y[r] and, for the
+     * upper triangle it mirrors, its entries times v[r] to y[c] for c < r, so the triangle is read
+     * once. Task index p covers rows p and len - 1 - p, which gives every task the same work.
+     */
+    static void symv_task(size_t begin, size_t end, void *ctx)
+    {
+        symv_ctx_t *sc = ctx;
+        size_t len = sc->n - sc->r0;
+        const double *v = sc->v + sc->r0;
+        double *y = sc->slot + (begin / sc->grain) * len;
+        memset(y, 0, sizeof(double) * len);
+
+        for (size_t p = begin; p < end; p++)
+        {
+            for (size_t r = p; ; r = len - 1 - p)
+            {
+                const double *a = sc->rows[sc->r0 + r] + sc->r0;
+                double x = v[r], part[8] = {0};
+                size_t c = 0;
+                for (; c + 8 <= r; c += 8)
+                    for (size_t l = 0; l < 8; l++)
+                    {
+                        part[l] += a[c + l] * v[c + l];
+                        y[c + l] += a[c + l] * x;
+                    }
+
+                double s = ((part[0] + part[1]) + (part[2] + part[3])) + ((part[4] + part[5]) + (part[6] + part[7]));
+                for (; c < r; c++)
+                {
+                    s += a[c] * v[c];
+                    y[c] += a[c] * x;
+                }
+                y[r] += s + a[r] * x;
+
+                if (r != p || len - 1 - p == p)
+                    break;
+            }
+        }
+    }
+
+    // y[r0, n) = A v over the trailing block [r0, n)² of the symmetric matrix in the lower triangle of A
+    static void symv(symv_ctx_t *sc, size_t r0, double *y)
+    {
+        size_t len = sc->n - r0, pairs = (len + 1) / 2;
+        sc->r0 = r0;
+        sc->grain = EH_ROW_WORK / len + 1;
+        if (sc->grain < (pairs + EH_MAX_SLOTS - 1) / EH_MAX_SLOTS)
+            sc->grain = (pairs + EH_MAX_SLOTS - 1) / EH_MAX_SLOTS;
+        nd_parallel_for(pairs, sc->grain, symv_task, sc);
+
+        size_t slots = (pairs + sc->grain - 1) / sc->grain;
+        memcpy(y + r0, sc->slot, sizeof(double) * len);
+        for (size_t s = 1; s < slots; s++)
+        {
+            const double *part = sc->slot + s * len;
+            for (size_t i = 0; i < len; i++)
+                y[r0 + i] += part[i];
+        }
+    }
+
+    /*
+     * Reduces the symmetric matrix in the lower triangle of A to tridiagonal form QᵀAQ with
+     * Householder reflectors, EH_NB columns at a time as in LAPACK's xSYTRD. Within a panel only
+     * the current column is brought up to date, and its product with the trailing matrix is
+     * corrected through the panel's V and W = tau (A v - ...), so the trailing matrix receives
+     * a single A -= V Wᵀ + W Vᵀ per panel, in nd_gemm() block columns of its lower triangle.
+     * Reflector j is stored below column j with its unit on the subdiagonal; d and e receive the
+     * diagonal and the subdiagonal.
+     */
+    static void tridiagonalize(ndarray_t *A, double *d, double *e, double *tau)
+    {
+        size_t n = A->shape[0];
+        double **rows = A->data;
+        double *v = malloc(sizeof(double) * n);
+        double *y = malloc(sizeof(double) * n);
+        double *s = malloc(sizeof(double) * 2 * EH_NB);
+        symv_ctx_t sc;
+        sc.rows = rows;
+        sc.n = n;
+        sc.v = v;
+        sc.slot = malloc(sizeof(double) * EH_MAX_SLOTS * n);
+        if (v == NULL || y == NULL || s == NULL || sc.slot == NULL)
+            malloc_error();
+        ndarray_t W = zeros(n, EH_NB);
+
+        for (size_t k = 0; k + 1 < n; k += EH_NB)
+        {
+            size_t nb = n - 1 - k < EH_NB ? n - 1 - k : EH_NB;
+            for (size_t i = 0; i < nb; i++)
+            {
+                size_t j = k + i;
+
+                // Column j from the diagonal down: A - V Wᵀ - W Vᵀ over the panel so far
+                if (i > 0)
+                {
+                    const double *wj = W.data[j], *vj = rows[j] + k;
+                    for (size_t r = j; r < n; r++)
+                        rows[r][j] -= row_dot(rows[r] + k, wj, i) + row_dot(W.data[r], vj, i);
+                }
+                d[j] = rows[j][j];
+
+                double sigma = 0.0, t, scale;
+                for (size_t r = j + 2; r < n; r++)
+                    sigma += rows[r][j] * rows[r][j];
+                e[j] = householder(rows[j + 1][j], sigma, &t, &scale);
+                tau[j] = t;
+                rows[j + 1][j] = v[j + 1] = 1.0;
+                for (size_t r = j + 2; r < n; r++)
+                    v[r] = rows[r][j] *= scale;
+
+                // w = t (A v - V Wᵀv - W Vᵀv), then w -= (t/2)(wᵀv) v
+                symv(&sc, j + 1, y);
+                double *s1 = s, *s2 = s + EH_NB;
+                memset(s, 0, sizeof(double) * 2 * EH_NB);
+                for (size_t r = j + 1; r < n; r++)
+                    for (size_t p = 0; p < i; p++)
+                    {
+                        s1[p] += W.data[r][p] * v[r];
+                        s2[p] += rows[r][k + p] * v[r];
+                    }
+
+                double wv = 0.0;
+                for (size_t r = j + 1; r < n; r++)
+                {
+                    double w = t * (y[r] - row_dot(rows[r] + k, s1, i) - row_dot(W.data[r], s2, i));
+                    W.data[r][i] = w;
+                    wv += w * v[r];
+                }
+                double alpha = -0.5 * t * wv;
+                for (size_t r = j + 1; r < n; r++)
+                    W.data[r][i] += alpha * v[r];
+            }
+
+            // Lower triangle of the trailing matrix, one block column at a time
+            for (size_t c = k + nb; c < n; c += EH_COL_WORK)
+            {
+                size_t cb = n - c < EH_COL_WORK ? n - c : EH_COL_WORK;
+                ndarray_t C = nd_view(A, c, c, n - c, cb);
+                ndarray_t Vr = nd_view(A, c, k, n - c, nb);
+                ndarray_t Wr = nd_view(&W, c, 0, n - c, nb);
+                ndarray_t Vc = nd_view(A, c, k, cb, nb);
+                ndarray_t Wc = nd_view(&W, c, 0, cb, nb);
+                nd_gemm(ND_NO_TRANS, ND_TRANS, -1.0, &Vr, &Wc, 1.0, &C);
+                nd_gemm(ND_NO_TRANS, ND_TRANS, -1.0, &Wr, &Vc, 1.0, &C);
+                nd_view_free(&C);
+                nd_view_free(&Vr);
+                nd_view_free(&Wr);
+                nd_view_free(&Vc);
+                nd_view_free(&Wc);
+            }
+        }
+        d[n - 1] = rows[n - 1][n - 1];
+        e[n - 1] = 0.0;
+
+        free(v);
+        free(y);
+        free(s);
+        free(sc.slot);
+        clean(&W, NULL);
+    }
+
+    /*
+     * Z = Q Z for the product Q = H_0 ... H_(count-1) of reflectors stored column by column in A,
+     * reflector j from row j + shift down with its unit there: shift 1 for tridiagonalize(), 0 for
+     * the left reflectors of QR and bidiagonalize(). Z has as many rows as A; block reflectors
+     * are applied last to first.
+     */
+    static void back_transform(ndarray_t *A, size_t shift, size_t count, const double *tau, ndarray_t *Z)
+    {
+        size_t m = A->shape[0];
+        if (count == 0)
+            return;
+
+        ndarray_t T = zeros(QR_NB, QR_NB);
+        size_t blocks = (count + QR_NB - 1) / QR_NB;
+        for (size_t b = blocks; b-- > 0;)
+        {
+            size_t j = b * QR_NB;
+            size_t jb = count - j < QR_NB ? count - j : QR_NB;
+            ndarray_t Tb = nd_view(&T, 0, 0, jb, jb);
+            ndarray_t C = nd_view(Z, j + shift, 0, m - j - shift, Z->shape[1]);
+            build_t(A, j + shift, j, jb, tau + j, &Tb);
+            apply_block(A, j + shift, j, jb, &Tb, &C, false);
+            nd_view_free(&Tb);
+            nd_view_free(&C);
+        }
+        clean(&T, NULL);
+    }
+
+/** Tridiagonal eigensolvers */
+
+typedef struct {
+    double value;
+    size_t index;
+} eigen_pair_t;
+
+    static int compare_pairs(const void *a, const void *b)
+    {
+        double x = ((const eigen_pair_t *)a)->value, y = ((const eigen_pair_t *)b)->value;
+        return (x > y) - (x < y);
+    }
+
+    // Rows a, b = c a - s b, s a + c b
+    ALWAYS_INLINE void rotate_rows(double *a, double *b, size_t n, double c, double s)
+    {
+        for (size_t k = 0; k < n; k++)
+        {
+            double x = a[k], y = b[k];
+            a[k] = c * x - s * y;
+            b[k] = s * x + c * y;
+        }
+    }
+
+    /*
+     * Implicit QL iteration with Wilkinson shifts on the tridiagonal matrix with diagonal d and
+     * off-diagonal e (e[i] couples i and i + 1; e[n - 1] is scratch). When zt is given, its rows
+     * receive the rotations, so row i ends up as eigenvector i in the coordinates zt started in;
+     * rows are contiguous, so every rotation is two vector sweeps. The eigenvalues are left in
+     * the order they converge. False when one takes more than QL_SWEEPS iterations (NaN input).
+     */
+    static bool tridiagonal_ql(double *d, double *e, size_t n, double **zt, size_t nz)
+    {
+        e[n - 1] = 0.0;
+        for (size_t l = 0; l < n; l++)
+        {
+            for (size_t iter = 0; ; iter++)
+            {
+                size_t m = l;
+                for (; m + 1 < n; m++)
+                    if (fabs(e[m]) <= DBL_EPSILON * (fabs(d[m]) + fabs(d[m + 1])))
+                        break;
+                if (m == l)
+                    break;
+                if (iter == QL_SWEEPS)
+                    return false;
+
+                double g = (d[l + 1] - d[l]) / (2.0 * e[l]);
+                double r = hypot(g, 1.0);
+                g = d[m] - d[l] + e[l] / (g + copysign(r, g));
+
+                double s = 1.0, c = 1.0, p = 0.0;
+                bool split = false;
+                for (size_t i = m; i-- > l;)
+                {
+                    double f = s * e[i], b = c * e[i];
+                    e[i + 1] = r = hypot(f, g);
+                    if (r == 0.0)
+                    {
+                        // Underflow: the matrix splits at i + 1
+                        d[i + 1] -= p;
+                        e[m] = 0.0;
+                        split = true;
+                        break;
+                    }
+                    s = f / r;
+                    c = g / r;
+                    g = d[i + 1] - p;
+                    r = (d[i] - g) * s + 2.0 * c * b;
+                    p = s * r;
+                    d[i + 1] = g + p;
+                    g = c * r - b;
+                    if (zt != NULL)
+                        rotate_rows(zt[i], zt[i + 1], nz, c, s);
+                }
+                if (split)
+                    continue;
+                d[l] -= p;
+                e[l] = g;
+                e[m] = 0.0;
+            }
+        }
+        return true;
+    }
+
+    // Small divide-and-conquer block: QL iteration from the identity, sorted into the columns of Q
+    static bool dc_leaf(double *d, double *e, size_t n, ndarray_t *Q)
+    {
+        ndarray_t Zt = identity(n, n);
+        bool ok = tridiagonal_ql(d, e, n, Zt.data, n);
+
+        eigen_pair_t order[DC_LEAF];
+        for (size_t i = 0; i < n; i++)
+            order[i] = (eigen_pair_t){d[i], i};
+        qsort(order, n, sizeof(eigen_pair_t), compare_pairs);
+        for (size_t p = 0; p < n; p++)
+        {
+            d[p] = order[p].value;
+            for (size_t r = 0; r < n; r++)
+                Q->data[r][p] = Zt.data[order[p].index][r];
+        }
+        clean(&Zt, NULL);
+        return ok;
+    }
+
+    /*
+     * Root j of 1 + rho Σ z_i² / (d_i - λ) for increasing d, as λ = d[origin] + tau with the origin
+     * the nearer pole, so that d_i - λ = (d_i - d[origin]) - tau keeps its accuracy for the
+     * eigenvectors. Every step models the sums over the poles left and right of the root with one
+     * pole each, the nearest ones, and moves to the root of the model, falling back to bisection
+     * when that leaves the bracket.
+     */
+    static void secular_root(const double *d, const double *z, size_t k, double rho, size_t j,
+                             size_t *origin, double *tau)
+    {
+        size_t o = j;
+        double lo = 0.0, hi;
+        if (j + 1 < k)
+        {
+            double mid = 0.5 * (d[j + 1] - d[j]), f = 1.0;
+            for (size_t i = 0; i < k; i++)
+                f += rho * z[i] * z[i] / ((d[i] - d[j]) - mid);
+            hi = mid;
+            if (f < 0.0)
+            {
+                o = j + 1;
+                lo = -mid;
+                hi = 0.0;
+            }
+        }
+        else
+        {
+            double zz = 0.0;
+            for (size_t i = 0; i < k; i++)
+                zz += z[i] * z[i];
+            hi = rho * zz;
+        }
+
+        double t = 0.5 * (lo + hi);
+        for (size_t iter = 0; iter < 100; iter++)
+        {
+            double psi = 0.0, dpsi = 0.0, phi = 0.0, dphi = 0.0;
+            for (size_t i = 0; i < k; i++)
+            {
+                double q = z[i] / ((d[i] - d[o]) - t), term = rho * z[i] * q, slope = rho * q * q;
+                if (i <= j)
+                {
+                    psi += term;
+                    dpsi += slope;
+                }
+                else
+                {
+                    phi += term;
+                    dphi += slope;
+                }
+            }
+
+            double g = 1.0 + psi + phi;
+            double err = DBL_EPSILON * (8.0 * (phi - psi) + 2.0 + 3.0 * fabs(g) + fabs(t) * (dpsi + dphi));
+            if (fabs(g) <= err)
+                break;
+            if (g < 0.0)
+                lo = t;
+            else
+                hi = t;
+
+            // g ≈ c + P / (dl - η) + Q / (du - η), exact in value and slope at η = 0
+            double dl = (d[j] - d[o]) - t, P = dpsi * dl * dl, step = NAN;
+            if (j + 1 < k)
+            {
+                double du = (d[j + 1] - d[o]) - t, Q = dphi * du * du;
+                double c = g - P / dl - Q / du;
+                double a1 = c * (dl + du) + P + Q, a0 = dl * du * g;
+                double disc = a1 * a1 - 4.0 * c * a0;
+                if (disc >= 0.0)
+                {
+                    double q = 0.5 * (a1 + copysign(sqrt(disc), a1));
+                    double r1 = c != 0.0 ? q / c : NAN, r2 = q != 0.0 ? a0 / q : NAN;
+                    step = r1 > dl && r1 < du ? r1 : r2;
+                }
+            }
+            else
+            {
+                double c = g - P / dl;
+                if (c > 0.0)
+                    step = dl + P / c;
+            }
+
+            double next = t + step;
+            if (!(next > lo && next < hi))
+                next = 0.5 * (lo + hi);
+            if (next == t)
+                break;
+            t = next;
+        }
+        *origin = o;
+        *tau = t;
+    }
+
+    /*
+     * Solves D + rho z zᵀ for the k poles of d and z that survived deflation, writing the
+     * eigenvalues to lambda and the unit eigenvectors to the columns of U (k x k). The vectors
+     * use the z that the computed eigenvalues are exact for (Gu and Eisenstat), so they come out
+     * orthogonal however close the eigenvalues are.
+     */
+    static void secular_solve(const double *d, const double *z, size_t k, double rho, double *lambda, ndarray_t *U)
+    {
+        size_t *origin = malloc(sizeof(size_t) * k);
+        double *tau = malloc(sizeof(double) * k);
+        double *norms = calloc(k, sizeof(double));
+        if (origin == NULL || tau == NULL || norms == NULL)
+            malloc_error();
+
+        for (size_t j = 0; j < k; j++)
+        {
+            secular_root(d, z, k, rho, j, origin + j, tau + j);
+            lambda[j] = d[origin[j]] + tau[j];
+        }
+
+        for (size_t i = 0; i < k; i++)
+        {
+            double *u = U->data[i];
+            for (size_t j = 0; j < k; j++)
+                u[j] = (d[i] - d[origin[j]]) - tau[j];
+
+            // ẑ_i² = Π_j (λ_j - d_i) / (rho Π_{j≠i} (d_j - d_i)), one ratio at a time
+            double w = -u[k - 1] / rho;
+            for (size_t j = 0; j + 1 < k; j++)
+                w *= -u[j] / (d[j < i ? j : j + 1] - d[i]);
+            w = copysign(sqrt(fabs(w)), z[i]);
+
+            for (size_t j = 0; j < k; j++)
+            {
+                u[j] = w / u[j];
+                norms[j] += u[j] * u[j];
+            }
+        }
+        for (size_t j = 0; j < k; j++)
+            norms[j] = 1.0 / sqrt(norms[j]);
+        for (size_t i = 0; i < k; i++)
+            for (size_t j = 0; j < k; j++)
+                U->data[i][j] *= norms[j];
+
+        free(origin);
+        free(tau);
+        free(norms);
+    }
+
+    // Columns listed in cols, restricted to rows [r0, r0 + rows) of Q
+    static ndarray_t gather_columns(ndarray_t *Q, size_t r0, size_t rows, const size_t *cols, size_t count)
+    {
+        ndarray_t G = array(rows, count);
+        for (size_t r = 0; r < rows; r++)
+            for (size_t c = 0; c < count; c++)
+                G.data[r][c] = Q->data[r0 + r][cols[c]];
+        return G;
+    }
+
+    /*
+     * Joins the eigensystems of the two halves [0, m) and [m, n), sorted in d and Q, into that of
+     * the whole after the rank-one tear rho (LAPACK's xLAED1). Eigenpairs whose z entry is
+     * negligible, and one of every pair of nearly equal eigenvalues after a rotation, deflate:
+     * they carry over unchanged. The rest go through the secular equation, and their vectors are
+     * the old ones times U, two nd_gemm() calls that skip the zero blocks of Q: a column from one
+     * half is zero in the other unless a deflating rotation mixed it with the other half.
+     */
+    static void dc_merge(double *d, size_t n, size_t m, double rho, ndarray_t *Q)
+    {
+        enum { TOP = 1, BOTTOM = 2 };
+        size_t *col = malloc(sizeof(size_t) * n);
+        size_t *kept = malloc(sizeof(size_t) * n);
+        size_t *deflated = malloc(sizeof(size_t) * n);
+        int *half = malloc(sizeof(int) * n);
+        double *D = malloc(sizeof(double) * n);
+        double *z = malloc(sizeof(double) * n);
+        if (col == NULL || kept == NULL || deflated == NULL || half == NULL || D == NULL || z == NULL)
+            malloc_error();
+
+        // Merge the two sorted halves; z = (last row of Q1, sign(rho) first row of Q2) / √2
+        double sign = rho < 0.0 ? -1.0 : 1.0, dmax = 0.0, zmax = 0.0;
+        rho = 2.0 * fabs(rho);
+        for (size_t i = 0, a = 0, b = m; i < n; i++)
+        {
+            size_t c = b == n || (a < m && d[a] <= d[b]) ? a++ : b++;
+            col[i] = c;
+            half[i] = c < m ? TOP : BOTTOM;
+            D[i] = d[c];
+            z[i] = (c < m ? Q->data[m - 1][c] : sign * Q->data[m][c]) * M_SQRT1_2;
+            dmax = fmax(dmax, fabs(D[i]));
+            zmax = fmax(zmax, fabs(z[i]));
+        }
+
+        double tol = 8.0 * DBL_EPSILON * fmax(dmax, zmax);
+        size_t k = 0, nd = 0, pending = n;
+        for (size_t i = 0; i < n; i++)
+        {
+            if (rho * fabs(z[i]) <= tol)
+            {
+                deflated[nd++] = i;
+                continue;
+            }
+            if (pending == n)
+            {
+                pending = i;
+                continue;
+            }
+
+            // Close to the pending eigenvalue: rotate z[pending] into z[i] and deflate pending
+            double r = hypot(z[pending], z[i]), c = z[i] / r, s = z[pending] / r;
+            if (fabs((D[i] - D[pending]) * c * s) <= tol)
+            {
+                size_t p = col[pending], q = col[i];
+                for (size_t row = 0; row < n; row++)
+                {
+                    double x = Q->data[row][p], y = Q->data[row][q];
+                    Q->data[row][p] = c * x - s * y;
+                    Q->data[row][q] = s * x + c * y;
+                }
+                if (half[pending] != half[i])
+                    half[pending] = half[i] = TOP | BOTTOM;
+
+                double t = D[pending] * c * c + D[i] * s * s;
+                D[i] = D[pending] * s * s + D[i] * c * c;
+                D[pending] = t;
+                z[i] = r;
+                z[pending] = 0.0;
+                deflated[nd++] = pending;
+            }
+            else
+                kept[k++] = pending;
+            pending = i;
+        }
+        if (pending != n)
+            kept[k++] = pending;
+
+        // Secular equation for the survivors, then their vectors: Q_top U_top and Q_bottom U_bottom
+        double *lambda = malloc(sizeof(double) * (k + 1));
+        double *Dk = malloc(sizeof(double) * (k + 1));
+        double *zk = malloc(sizeof(double) * (k + 1));
+        size_t *top = malloc(sizeof(size_t) * (k + 1));
+        size_t *bottom = malloc(sizeof(size_t) * (k + 1));
+        if (lambda == NULL || Dk == NULL || zk == NULL || top == NULL || bottom == NULL)
+            malloc_error();
+
+        ndarray_t Rt = {0}, Rb = {0}, Dv = {0};
+        if (k > 0)
+        {
+            for (size_t i = 0; i < k; i++)
+            {
+                Dk[i] = D[kept[i]];
+                zk[i] = z[kept[i]];
+            }
+            ndarray_t U = array(k, k);
+            secular_solve(Dk, zk, k, rho, lambda, &U);
+
+            size_t kt = 0, kb = 0;
+            for (size_t i = 0; i < k; i++)
+            {
+                if (half[kept[i]] & TOP)
+                    top[kt++] = i;
+                if (half[kept[i]] & BOTTOM)
+                    bottom[kb++] = i;
+            }
+
+            for (int h = 0; h < 2; h++)
+            {
+                size_t *which = h == 0 ? top : bottom, count = h == 0 ? kt : kb;
+                size_t r0 = h == 0 ? 0 : m, rows = h == 0 ? m : n - m;
+                if (count == 0)
+                    continue;
+
+                size_t *cols = malloc(sizeof(size_t) * count);
+                if (cols == NULL)
+                    malloc_error();
+                ndarray_t Us = array(count, k);
+                for (size_t c = 0; c < count; c++)
+                {
+                    cols[c] = col[kept[which[c]]];
+                    memcpy(Us.data[c], U.data[which[c]], sizeof(double) * k);
+                }
+                ndarray_t G = gather_columns(Q, r0, rows, cols, count);
+                ndarray_t R = array(rows, k);
+                nd_gemm(ND_NO_TRANS, ND_NO_TRANS, 1.0, &G, &Us, 0.0, &R);
+                if (h == 0)
+                    Rt = R;
+                else
+                    Rb = R;
+                clean(&G, &Us, NULL);
+                free(cols);
+            }
+            clean(&U, NULL);
+        }
+
+        eigen_pair_t *order = malloc(sizeof(eigen_pair_t) * n);
+        if (order == NULL)
+            malloc_error();
+        for (size_t i = 0; i < k; i++)
+            order[i] = (eigen_pair_t){lambda[i], i};
+        if (nd > 0)
+        {
+            size_t *cols = malloc(sizeof(size_t) * nd);
+            if (cols == NULL)
+                malloc_error();
+            for (size_t i = 0; i < nd; i++)
+            {
+                cols[i] = col[deflated[i]];
+                order[k + i] = (eigen_pair_t){D[deflated[i]], k + i};
+            }
+            Dv = gather_columns(Q, 0, n, cols, nd);
+            free(cols);
+        }
+        qsort(order, n, sizeof(eigen_pair_t), compare_pairs);
+
+        for (size_t p = 0; p < n; p++)
+            d[p] = order[p].value;
+        for (size_t r = 0; r < n; r++)
+        {
+            ndarray_t *R = r < m ? &Rt : &Rb;
+            size_t rr = r < m ? r : r - m;
+            for (size_t p = 0; p < n; p++)
+            {
+                size_t src = order[p].index;
+                if (src >= k)
+                    Q->data[r][p] = Dv.data[r][src - k];
+                else
+                    Q->data[r][p] = R->data != NULL ? R->data[rr][src] : 0.0;
+            }
+        }
+
+        clean(&Rt, &Rb, &Dv, NULL);
+        free(order);
+        free(lambda);
+        free(Dk);
+        free(zk);
+        free(top);
+        free(bottom);
+        free(col);
+        free(kept);
+        free(deflated);
+        free(half);
+        free(D);
+        free(z);
+    }
+
+    /*
+     * Eigenvalues (ascending, in d) and eigenvectors (columns of Q, n x n and zero on entry) of the
+     * tridiagonal matrix (d, e) by divide and conquer: tear off the coupling in the middle, solve
+     * both halves, and join them with dc_merge(). Nearly all of the work is in the joins' GEMMs.
+     */
+    static bool dc_solve(double *d, double *e, size_t n, ndarray_t *Q)
+    {
+        if (n <= DC_LEAF)
+            return dc_leaf(d, e, n, Q);
+
+        size_t m = n / 2;
+        double rho = e[m - 1];
+        d[m - 1] -= fabs(rho);
+        d[m] -= fabs(rho);
+
+        ndarray_t Q1 = nd_view(Q, 0, 0, m, m);
+        ndarray_t Q2 = nd_view(Q, m, m, n - m, n - m);
+        bool ok = dc_solve(d, e, m, &Q1);
+        ok = dc_solve(d + m, e + m, n - m, &Q2) && ok;
+        nd_view_free(&Q1);
+        nd_view_free(&Q2);
+
+        dc_merge(d, n, m, rho, Q);
+        return ok;
+    }
+
+/** Tridiagonal subsets */
+
+typedef struct {
+    const double *d, *e;
+    size_t n, first;
+    double low, high, pivmin, tol;
+    double *values;
+} bisect_ctx_t;
+
+    // Eigenvalues of the tridiagonal matrix (d, e) below x, from the signs of the LDLᵀ pivots
+    static size_t sturm_count(const double *d, const double *e, size_t n, double x, double pivmin)
+    {
+        size_t count = 0;
+        double q = 1.0;
+        for (size_t i = 0; i < n; i++)
+        {
+            q = d[i] - x - (i > 0 ? e[i - 1] * e[i - 1] / q : 0.0);
+            if (fabs(q) < pivmin)
+                q = -pivmin;
+            count += q < 0.0;
+        }
+        return count;
+    }
+
+    static void bisect_task(size_t begin, size_t end, void *ctx)
+    {
+        bisect_ctx_t *bc = ctx;
+        for (size_t t = begin; t < end; t++)
+        {
+            size_t index = bc->first + t;
+            double lo = bc->low, hi = bc->high;
+            while (hi - lo > 2.0 * DBL_EPSILON * fmax(fabs(lo), fabs(hi)) + bc->tol)
+            {
+                double mid = 0.5 * (lo + hi);
+                if (mid <= lo || mid >= hi)
+                    break;
+                if (sturm_count(bc->d, bc->e, bc->n, mid, bc->pivmin) > index)
+                    hi = mid;
+                else
+                    lo = mid;
+            }
+            bc->values[t] = 0.5 * (lo + hi);
+        }
+    }
+
+    // Solves (T - shift) x = b in place with the pivoted LU of the tridiagonal matrix (d, e)
+    static void shifted_solve(const double *d, const double *e, size_t n, double shift, double tiny,
+                              double *u, double *mult, bool *swapped, double *x)
+    {
+        double *u0 = u, *u1 = u + n, *u2 = u + 2 * n;
+        u0[0] = d[0] - shift;
+        u1[0] = n > 1 ? e[0] : 0.0;
+        for (size_t i = 0; i + 1 < n; i++)
+        {
+            double b = e[i], a = d[i + 1] - shift, c = i + 2 < n ? e[i + 1] : 0.0;
+            u2[i] = 0.0;
+            swapped[i] = fabs(b) > fabs(u0[i]);
+            if (swapped[i])
+            {
+                double l = u0[i] / b, up = u1[i];
+                u0[i] = b;
+                u1[i] = a;
+                u2[i] = c;
+                u0[i + 1] = up - l * a;
+                u1[i + 1] = -l * c;
+                mult[i] = l;
+            }
+            else
+            {
+                double l = u0[i] != 0.0 ? b / u0[i] : 0.0;
+                u0[i + 1] = a - l * u1[i];
+                u1[i + 1] = c;
+                mult[i] = l;
+            }
+        }
+        u2[n - 1] = 0.0;
+
+        for (size_t i = 0; i + 1 < n; i++)
+        {
+            if (swapped[i])
+            {
+                double t = x[i];
+                x[i] = x[i + 1];
+                x[i + 1] = t;
+            }
+            x[i + 1] -= mult[i] * x[i];
+        }
+        for (size_t i = n; i-- > 0;)
+        {
+            double s = x[i];
+            if (i + 1 < n)
+                s -= u1[i] * x[i + 1];
+            if (i + 2 < n)
+                s -= u2[i] * x[i + 2];
+            double p = fabs(u0[i]) > tiny ? u0[i] : copysign(tiny, u0[i]);
+            x[i] = s / p;
+        }
+    }
+
+    /*
+     * Eigenvectors of the tridiagonal matrix (d, e) for the ascending eigenvalues in values, by
+     * inverse iteration as in LAPACK's xSTEIN: each is solved from a fixed pseudo-random start
+     * and, within a cluster of close eigenvalues, kept orthogonal to the cluster's earlier vectors.
+     * Row j of Xt receives vector j.
+     */
+    static void inverse_iteration(const double *d, const double *e, size_t n, const double *values,
+                                  size_t count, double tnorm, ndarray_t *Xt)
+    {
+        double *u = malloc(sizeof(double) * 3 * n);
+        double *mult = malloc(sizeof(double) * n);
+        bool *swapped = malloc(sizeof(bool) * n);
+        if (u == NULL || mult == NULL || swapped == NULL)
+            malloc_error();
+
+        double ortol = 1e-3 * tnorm, tiny = DBL_EPSILON * tnorm, shift = 0.0;
+        size_t cluster = 0;
+        for (size_t j = 0; j < count; j++)
+        {
+            double *x = Xt->data[j], sep = 10.0 * DBL_EPSILON * fabs(values[j]) + tiny;
+            if (j == 0 || values[j] - values[j - 1] > ortol)
+            {
+                cluster = j;
+                shift = values[j];
+            }
+            else
+                shift = fmax(values[j], shift + sep);   // equal eigenvalues get distinct shifts
+
+            uint64_t state = 0x9E3779B97F4A7C15ULL * (j + 1);
+            for (size_t i = 0; i < n; i++)
+            {
+                state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+                x[i] = (double)(state >> 11) / 9007199254740992.0 - 0.5;
+            }
+
+            for (size_t iter = 0, extra = 0; iter < 5 && extra < 2; iter++)
+            {
+                for (size_t p = cluster; p < j; p++)
+                {
+                    double proj = row_dot(x, Xt->data[p], n);
+                    for (size_t i = 0; i < n; i++)
+                        x[i] -= proj * Xt->data[p][i];
+                }
+                double before = sqrt(row_dot(x, x, n));
+                shifted_solve(d, e, n, shift, tiny, u, mult, swapped, x);
+
+                // The growth of the solve is 1 / residual: converged once that reaches rounding
+                double after = sqrt(row_dot(x, x, n));
+                if (!(after > 0.0) || !isfinite(after))
+                    break;
+                for (size_t i = 0; i < n; i++)
+                    x[i] /= after;
+                if (before / after <= (double)n * DBL_EPSILON * tnorm)
+                    extra++;
+            }
+
+            for (size_t p = cluster; p < j; p++)
+            {
+                double proj = row_dot(x, Xt->data[p], n);
+                for (size_t i = 0; i < n; i++)
+                    x[i] -= proj * Xt->data[p][i];
+            }
+            double norm = sqrt(row_dot(x, x, n));
+            for (size_t i = 0; i < n; i++)
+                x[i] /= norm;
+        }
+
+        free(u);
+        free(mult);
+        free(swapped);
+    }
+
+/** Symmetric eigensolver interface */
+
+    static void eigh_check(ndarray_t *this)
+    {
+        if(isnull(this))
+            {null_error(); exit(EXIT_FAILURE);}
+        if(issquare(this))
+            mat_error();
+    }
+
+    nd_eigh_t nd_eigh(ndarray_t *this, bool vectors)
+    {
+        eigh_check(this);
+
+        size_t n = this->shape[0];
+        nd_eigh_t eig = {0};
+        ndarray_t A = copy(this);
+        double *d = malloc(sizeof(double) * n);
+        double *e = malloc(sizeof(double) * n);
+        double *tau = malloc(sizeof(double) * n);
+        if(d == NULL || e == NULL || tau == NULL)
+            malloc_error();
+
+        tridiagonalize(&A, d, e, tau);
+        if(vectors)
+        {
+            eig.vectors = zeros(n, n);
+            eig.converged = dc_solve(d, e, n, &eig.vectors);
+            back_transform(&A, 1, n - 1, tau, &eig.vectors);
+        }
+        else
+        {
+            eig.converged = tridiagonal_ql(d, e, n, NULL, 0);
+            nd_sort_buffer(d, n);
+        }
+
+        eig.values = array(1, n);
+        memcpy(eig.values.data[0], d, sizeof(double) * n);
+
+        clean(&A, NULL);
+        free(d);
+        free(e);
+        free(tau);
+        return eig;
+    }
+
+    nd_eigh_t nd_eigh_range(ndarray_t *this, size_t first, size_t count, bool vectors)
+    {
+        eigh_check(this);
+        size_t n = this->shape[0];
+        if(count == 0 || first >= n || count > n - first)
+            index_error();
+
+        nd_eigh_t eig = {0};
+        eig.converged = true;
+        ndarray_t A = copy(this);
+        double *d = malloc(sizeof(double) * n);
+        double *e = malloc(sizeof(double) * n);
+        double *tau = malloc(sizeof(double) * n);
+        if(d == NULL || e == NULL || tau == NULL)
+            malloc_error();
+        tridiagonalize(&A, d, e, tau);
+
+        // Gershgorin bounds for the bisection, widened by the rounding of the Sturm counts
+        bisect_ctx_t bc = {0};
+        double tnorm = 0.0, e2max = 0.0;
+        bc.low = INFINITY;
+        bc.high = -INFINITY;
+        for(size_t i = 0; i < n; i++)
+        {
+            double radius = (i > 0 ? fabs(e[i - 1]) : 0.0) + (i + 1 < n ? fabs(e[i]) : 0.0);
+            bc.low = fmin(bc.low, d[i] - radius);
+            bc.high = fmax(bc.high, d[i] + radius);
+            if(i + 1 < n)
+                e2max = fmax(e2max, e[i] * e[i]);
+        }
+        tnorm = fmax(fabs(bc.low), fabs(bc.high));
+        bc.pivmin = DBL_MIN * fmax(1.0, e2max);
+        bc.low -= 2.1 * DBL_EPSILON * tnorm * n + 4.2 * bc.pivmin;
+        bc.high += 2.1 * DBL_EPSILON * tnorm * n + 4.2 * bc.pivmin;
+        bc.tol = DBL_EPSILON * tnorm;
+        bc.d = d;
+        bc.e = e;
+        bc.n = n;
+        bc.first = first;
+
+        eig.values = array(1, count);
+        bc.values = eig.values.data[0];
+        nd_parallel_for(count, EH_ROW_WORK / n + 1, bisect_task, &bc);
+
+        if(vectors)
+        {
+            ndarray_t Xt = array(count, n);
+            inverse_iteration(d, e, n, bc.values, count, tnorm > 0.0 ? tnorm : 1.0, &Xt);
+            eig.vectors = transpose(&Xt);
+            back_transform(&A, 1, n - 1, tau, &eig.vectors);
+            clean(&Xt, NULL);
+        }
+
+        clean(&A, NULL);
+        free(d);
+        free(e);
+        free(tau);
+        return eig;
+    }
+
+    void nd_eigh_free(nd_eigh_t *eig)
+    {
+        if(eig == NULL)
+            return;
+        clean(&eig->values, &eig->vectors, NULL);
+    }
+
+/** Bidiagonal reduction */
+
+typedef struct {
+    double **rows;
+    size_t r0, c0, c1;          // the product covers rows from r0 and columns [c0, c1)
+    const double *x;
+    double *y;
+    size_t grain;
+    double *slot;               // per slot: a partial transposed product over [c0, c1)
+} gemv_ctx_t;
+
+    // Partial Aᵀx over rows r0 + [begin, end), four rows per pass over the task's slot
+    static void gemv_t_task(size_t begin, size_t end, void *ctx)
+    {
+        gemv_ctx_t *gc = ctx;
+        size_t len = gc->c1 - gc->c0;
+        double *y = gc->slot + (begin / gc->grain) * len;
+        memset(y, 0, sizeof(double) * len);
+
+        size_t r = gc->r0 + begin, r1 = gc->r0 + end;
+        for (; r + 4 <= r1; r += 4)
+        {
+            const double *a0 = gc->rows[r] + gc->c0, *a1 = gc->rows[r + 1] + gc->c0;
+            const double *a2 = gc->rows[r + 2] + gc->c0, *a3 = gc->rows[r + 3] + gc->c0;
+            double x0 = gc->x[r], x1 = gc->x[r + 1], x2 = gc->x[r + 2], x3 = gc->x[r + 3];
+            for (size_t c = 0; c < len; c++)
+                y[c] += (a0[c] * x0 + a1[c] * x1) + (a2[c] * x2 + a3[c] * x3);
+        }
+        for (; r < r1; r++)
+        {
+            const double *a = gc->rows[r] + gc->c0;
+            double x = gc->x[r];
+            for (size_t c = 0; c < len; c++)
+                y[c] += a[c] * x;
+        }
+    }
+
+    // y[r] = A(r, c0:c1) x for rows r0 + [begin, end)
+    static void gemv_n_task(size_t begin, size_t end, void *ctx)
+    {
+        gemv_ctx_t *gc = ctx;
+        for (size_t r = gc->r0 + begin; r < gc->r0 + end; r++)
+            gc->y[r] = row_dot(gc->rows[r] + gc->c0, gc->x, gc->c1 - gc->c0);
+    }
+
+    // y[c0, c1) = A(r0:m, c0:c1)ᵀ x[r0, m)
+    static void gemv_t(gemv_ctx_t *gc, size_t r0, size_t m, size_t c0, size_t c1, const double *x, double *y)
+    {
+        size_t rows = m - r0, len = c1 - c0;
+        gc->r0 = r0;
+        gc->c0 = c0;
+        gc->c1 = c1;
+        gc->x = x;
+        gc->grain = SV_ROW_WORK / len + 1;
+        if (gc->grain < (rows + SV_MAX_SLOTS - 1) / SV_MAX_SLOTS)
+            gc->grain = (rows + SV_MAX_SLOTS - 1) / SV_MAX_SLOTS;
+        nd_parallel_for(rows, gc->grain, gemv_t_task, gc);
+
+        size_t slots = (rows + gc->grain - 1) / gc->grain;
+        memcpy(y + c0, gc->slot, sizeof(double) * len);
+        for (size_t s = 1; s < slots; s++)
+        {
+            const double *part = gc->slot + s * len;
+            for (size_t i = 0; i < len; i++)
+                y[c0 + i] += part[i];
+        }
+    }
+
+    // y[r0, m) = A(r0:m, c0:c1) x, with x indexed from c0
+    static void gemv_n(gemv_ctx_t *gc, size_t r0, size_t m, size_t c0, size_t c1, const double *x, double *y)
+    {
+        gc->r0 = r0;
+        gc->c0 = c0;
+        gc->c1 = c1;
+        gc->x = x;
+        gc->y = y;
+        nd_parallel_for(m - r0, SV_ROW_WORK / (c1 - c0) + 1, gemv_n_task, gc);
+    }
+
+    /*
+     * Reduces the m x n matrix A, m >= n, to upper bidiagonal form QᵀAP with Householder
+     * reflectors from both sides, SV_NB columns at a time as in LAPACK's xGEBRD. Within a panel
+     * only the current column and row are brought up to date, and their products with the
+     * trailing matrix are corrected through the panel's X and Y, so the trailing matrix receives
+     * a single A -= V Yᵀ + X U per panel from two nd_gemm() calls. Left reflector j is stored
+     * below the diagonal of column j, right reflector j right of the superdiagonal of row j, both
+     * with their units in place; d and e receive the diagonal and the superdiagonal.
+     */
+    static void bidiagonalize(ndarray_t *A, double *d, double *e, double *tauq, double *taup)
+    {
+        size_t m = A->shape[0], n = A->shape[1];
+        double **rows = A->data;
+        double *v = malloc(sizeof(double) * m);
+        double *x = malloc(sizeof(double) * m);
+        double *y = malloc(sizeof(double) * n);
+        double *s = malloc(sizeof(double) * 4 * SV_NB);
+        gemv_ctx_t gc;
+        gc.rows = rows;
+        gc.slot = malloc(sizeof(double) * SV_MAX_SLOTS * n);
+        if (v == NULL || x == NULL || y == NULL || s == NULL || gc.slot == NULL)
+            malloc_error();
+        ndarray_t X = zeros(m, SV_NB);
+        ndarray_t Y = zeros(n, SV_NB);
+        e[n - 1] = 0.0;
+        taup[n - 1] = 0.0;
+
+        for (size_t k = 0; k < n; k += SV_NB)
+        {
+            size_t nb = n - k < SV_NB ? n - k : SV_NB;
+            for (size_t i = 0; i < nb; i++)
+            {
+                size_t j = k + i;
+                double *aj = rows[j];
+                double sigma = 0.0, t, scale;
+
+                // Column j from the diagonal down: A - V Yᵀ - X U over the panel so far
+                if (i > 0)
+                {
+                    for (size_t p = 0; p < i; p++)
+                        s[p] = rows[k + p][j];
+                    for (size_t r = j; r < m; r++)
+                        rows[r][j] -= row_dot(rows[r] + k, Y.data[j], i) + row_dot(X.data[r], s, i);
+                }
+
+                for (size_t r = j + 1; r < m; r++)
+                    sigma += rows[r][j] * rows[r][j];
+                d[j] = householder(aj[j], sigma, &t, &scale);
+                tauq[j] = t;
+                aj[j] = v[j] = 1.0;
+                for (size_t r = j + 1; r < m; r++)
+                    v[r] = rows[r][j] *= scale;
+                if (j + 1 == n)
+                    break;
+
+                // Y[:, i] = t (Aᵀv - Y Vᵀv - Uᵀ Xᵀv) over columns (j, n)
+                gemv_t(&gc, j, m, j + 1, n, v, y);
+                double *s1 = s, *s2 = s + SV_NB;
+                memset(s, 0, sizeof(double) * 2 * SV_NB);
+                for (size_t r = j; r < m; r++)
+                    for (size_t p = 0; p < i; p++)
+                    {
+                        s1[p] += rows[r][k + p] * v[r];
+                        s2[p] += X.data[r][p] * v[r];
+                    }
+                for (size_t p = 0; p < i; p++)
+                    for (size_t c = j + 1; c < n; c++)
+                        y[c] -= rows[k + p][c] * s2[p];
+                for (size_t c = j + 1; c < n; c++)
+                    Y.data[c][i] = t * (y[c] - row_dot(Y.data[c], s1, i));
+
+                // Row j right of the diagonal, now including this column's reflector
+                for (size_t c = j + 1; c < n; c++)
+                    aj[c] -= row_dot(Y.data[c], aj + k, i + 1);
+                for (size_t p = 0; p < i; p++)
+                    for (size_t c = j + 1; c < n; c++)
+                        aj[c] -= X.data[j][p] * rows[k + p][c];
+
+                sigma = 0.0;
+                for (size_t c = j + 2; c < n; c++)
+                    sigma += aj[c] * aj[c];
+                e[j] = householder(aj[j + 1], sigma, &t, &scale);
+                taup[j] = t;
+                aj[j + 1] = 1.0;
+                for (size_t c = j + 2; c < n; c++)
+                    aj[c] *= scale;
+
+                // X[:, i] = t (A u - V Yᵀu - X U u) over rows (j, m)
+                const double *u = aj + j + 1;
+                gemv_n(&gc, j + 1, m, j + 1, n, u, x);
+                double *s3 = s + 2 * SV_NB, *s4 = s + 3 * SV_NB;
+                memset(s3, 0, sizeof(double) * (i + 1));
+                for (size_t c = j + 1; c < n; c++)
+                    for (size_t p = 0; p <= i; p++)
+                        s3[p] += Y.data[c][p] * aj[c];
+                for (size_t p = 0; p < i; p++)
+                    s4[p] = row_dot(rows[k + p] + j + 1, u, n - j - 1);
+                for (size_t r = j + 1; r < m; r++)
+                    X.data[r][i] = t * (x[r] - row_dot(rows[r] + k, s3, i + 1) - row_dot(X.data[r], s4, i));
+            }
+
+            if (k + nb < n)
+            {
+                size_t r0 = k + nb;
+                ndarray_t C = nd_view(A, r0, r0, m - r0, n - r0);
+                ndarray_t V = nd_view(A, r0, k, m - r0, nb);
+                ndarray_t U = nd_view(A, k, r0, nb, n - r0);
+                ndarray_t Xb = nd_view(&X, r0, 0, m - r0, nb);
+                ndarray_t Yb = nd_view(&Y, r0, 0, n - r0, nb);
+                nd_gemm(ND_NO_TRANS, ND_TRANS, -1.0, &V, &Yb, 1.0, &C);
+                nd_gemm(ND_NO_TRANS, ND_NO_TRANS, -1.0, &Xb, &U, 1.0, &C);
+                nd_view_free(&C);
+                nd_view_free(&V);
+                nd_view_free(&U);
+                nd_view_free(&Xb);
+                nd_view_free(&Yb);
+            }
+        }
+
+        free(v);
+        free(x);
+        free(y);
+        free(s);
+        free(gc.slot);
+        clean(&X, &Y, NULL);
+    }
+
+/** Bidiagonal SVD */
+
+typedef struct {
+    size_t i;
+    double c, s;
+} plane_rotation_t;
+
+typedef struct {
+    double **rows;              // NULL when the rotations are not wanted
+    size_t len;
+    plane_rotation_t *pending;
+    size_t count;
+    size_t lo, hi;              // rows the pending rotations touch
+} rotation_log_t;
+
+    // Rotations (i, c, s) in order, rows i, i + 1 = c x + s y, c y - s x, over w columns of a strip
+    ALWAYS_INLINE void rotate_strip(const rotation_log_t *log, double *strip, size_t w)
+    {
+        for (size_t r = 0; r < log->count; r++)
+        {
+            const plane_rotation_t *g = log->pending + r;
+            double *a = strip + (g->i - log->lo) * SV_STRIP;
+            rotate_rows(a, a + SV_STRIP, w, g->c, -g->s);
+        }
+    }
+
+    static void rotate_strip_generic(const rotation_log_t *log, double *strip, size_t w)
+    {
+        rotate_strip(log, strip, w);
+    }
+
+#ifdef ND_HAVE_X86_ROTATIONS
+    __attribute__((target("avx512f")))
+    static void rotate_strip_avx512(const rotation_log_t *log, double *strip, size_t w)
+    {
+        rotate_strip(log, strip, w);
+    }
+
+    __attribute__((target("avx2,fma")))
+    static void rotate_strip_avx2(const rotation_log_t *log, double *strip, size_t w)
+    {
+        rotate_strip(log, strip, w);
+    }
+#endif
+
+    /*
+     * Applies the log to strips of SV_STRIP columns. Each strip is copied to a contiguous buffer
+     * first, which stays in cache for the whole log, where its pieces of separately allocated
+     * rows would each take a page of the TLB.
+     */
+    static void rotation_task(size_t begin, size_t end, void *ctx)
+    {
+        rotation_log_t *log = ctx;
+        void (*apply)(const rotation_log_t *, double *, size_t) = rotate_strip_generic;
+#ifdef ND_HAVE_X86_ROTATIONS
+        if (__builtin_cpu_supports("avx512f"))
+            apply = rotate_strip_avx512;
+        else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+            apply = rotate_strip_avx2;
+#endif
+        size_t rows = log->hi - log->lo + 1;
+        double *strip = malloc(sizeof(double) * rows * SV_STRIP);
+        if (strip == NULL)
+            malloc_error();
+
+        for (size_t k = begin; k < end; k++)
+        {
+            size_t c0 = k * SV_STRIP;
+            size_t w = log->len - c0 < SV_STRIP ? log->len - c0 : SV_STRIP;
+            for (size_t r = 0; r < rows; r++)
+                memcpy(strip + r * SV_STRIP, log->rows[log->lo + r] + c0, sizeof(double) * w);
+            apply(log, strip, w);
+            for (size_t r = 0; r < rows; r++)
+                memcpy(log->rows[log->lo + r] + c0, strip + r * SV_STRIP, sizeof(double) * w);
+        }
+        free(strip);
+    }
+
+    // Applies the buffered rotations, one run of strips per thread
+    static void rotation_flush(rotation_log_t *log)
+    {
+        size_t strips = (log->len + SV_STRIP - 1) / SV_STRIP, threads = nd_get_num_threads();
+        if (log->count > 0)
+            nd_parallel_for(strips, (strips + threads - 1) / threads, rotation_task, log);
+        log->count = 0;
+    }
+
+    ALWAYS_INLINE void rotation_record(rotation_log_t *log, size_t i, double c, double s)
+    {
+        if (log->rows == NULL)
+            return;
+        if (log->count == SV_ROTATIONS)
+            rotation_flush(log);
+        if (log->count == 0 || i < log->lo)
+            log->lo = i;
+        if (log->count == 0 || i + 1 > log->hi)
+            log->hi = i + 1;
+        log->pending[log->count++] = (plane_rotation_t){i, c, s};
+    }
+
+    // c, s and r = c f + s g with -s f + c g = 0, as LAPACK's xLARTG
+    ALWAYS_INLINE void givens(double f, double g, double *c, double *s, double *r)
+    {
+        if (g == 0.0)
+        {
+            *c = 1.0;
+            *s = 0.0;
+            *r = f;
+        }
+        else if (f == 0.0)
+        {
+            *c = 0.0;
+            *s = 1.0;
+            *r = g;
+        }
+        else
+        {
+            *r = hypot(f, g);
+            *c = f / *r;
+            *s = g / *r;
+        }
+    }
+
+    // Smaller singular value of the upper triangular [[f, g], [0, h]], as LAPACK's xLAS2
+    static double smaller_singular_value(double f, double g, double h)
+    {
+        double fa = fabs(f), ga = fabs(g), ha = fabs(h);
+        double fhmin = fa < ha ? fa : ha, fhmax = fa > ha ? fa : ha;
+        if (fhmin == 0.0)
+            return 0.0;
+        if (ga < fhmax)
+        {
+            double as = 1.0 + fhmin / fhmax, at = (fhmax - fhmin) / fhmax, au = (ga / fhmax) * (ga / fhmax);
+            return fhmin * 2.0 / (sqrt(as * as + au) + sqrt(at * at + au));
+        }
+        double au = fhmax / ga;
+        if (au == 0.0)
+            return fhmin * fhmax / ga;
+        double as = 1.0 + fhmin / fhmax, at = (fhmax - fhmin) / fhmax;
+        return 2.0 * fhmin * au / (sqrt(1.0 + (as * au) * (as * au)) + sqrt(1.0 + (at * au) * (at * au)));
+    }
+
+    /*
+     * One implicit QR sweep over the block [l, h] of the bidiagonal matrix, chasing the bulge
+     * from the top as in LAPACK's xBDSQR. The zero-shift variant of Demmel and Kahan keeps tiny
+     * singular values accurate. Right rotations go to the log of Vᵀ, left ones to that of Uᵀ.
+     */
+    static void bidiagonal_sweep(double *d, double *e, size_t l, size_t h, double shift,
+                                 rotation_log_t *left, rotation_log_t *right)
+    {
+        if (shift == 0.0)
+        {
+            double cs = 1.0, sn, oldcs = 1.0, oldsn = 0.0, r;
+            for (size_t i = l; i < h; i++)
+            {
+                givens(d[i] * cs, e[i], &cs, &sn, &r);
+                if (i > l)
+                    e[i - 1] = oldsn * r;
+                givens(oldcs * r, d[i + 1] * sn, &oldcs, &oldsn, &d[i]);
+                rotation_record(right, i, cs, sn);
+                rotation_record(left, i, oldcs, oldsn);
+            }
+            double last = d[h] * cs;
+            d[h] = last * oldcs;
+            e[h - 1] = last * oldsn;
+            return;
+        }
+
+        double f = (fabs(d[l]) - shift) * (copysign(1.0, d[l]) + shift / d[l]);
+        double g = e[l];
+        for (size_t i = l; i < h; i++)
+        {
+            double cr, sr, cl, sl, r;
+            givens(f, g, &cr, &sr, &r);
+            if (i > l)
+                e[i - 1] = r;
+            f = cr * d[i] + sr * e[i];
+            e[i] = cr * e[i] - sr * d[i];
+            g = sr * d[i + 1];
+            d[i + 1] = cr * d[i + 1];
+            givens(f, g, &cl, &sl, &r);
+            d[i] = r;
+            f = cl * e[i] + sl * d[i + 1];
+            d[i + 1] = cl * d[i + 1] - sl * e[i];
+            if (i + 1 < h)
+            {
+                g = sl * e[i + 1];
+                e[i + 1] = cl * e[i + 1];
+            }
+            rotation_record(right, i, cr, sr);
+            rotation_record(left, i, cl, sl);
+        }
+        e[h - 1] = f;
+    }
+
+    /*
+     * Singular values of the upper bidiagonal matrix with diagonal d and superdiagonal e by
+     * implicit QR, with the shift from the trailing 2 x 2 block and no shift when it would cost
+     * relative accuracy. Superdiagonal entries below eps times their neighbours, or below eps
+     * times the largest entry, split the matrix. The values are left in d, unsorted and possibly
+     * negative. False after SV_SWEEPS n² rotations (NaN input).
+     */
+    static bool bidiagonal_qr(double *d, double *e, size_t n, rotation_log_t *left, rotation_log_t *right)
+    {
+        double big = 0.0;
+        for (size_t i = 0; i < n; i++)
+        {
+            big = fmax(big, fabs(d[i]));
+            if (i + 1 < n)
+                big = fmax(big, fabs(e[i]));
+        }
+        double tiny = DBL_EPSILON * big;
+        size_t budget = SV_SWEEPS * n * n, spent = 0;
+
+        for (size_t h = n - 1; h > 0;)
+        {
+            size_t l = h;
+            for (; l > 0; l--)
+            {
+                double off = fabs(e[l - 1]);
+                if (off <= tiny || off <= DBL_EPSILON * (fabs(d[l - 1]) + fabs(d[l])))
+                {
+                    e[l - 1] = 0.0;
+                    break;
+                }
+            }
+            if (l == h)
+            {
+                h--;
+                continue;
+            }
+            if (spent > budget || isnan(e[h - 1]))
+                return false;
+            spent += h - l;
+
+            double small = fabs(d[l]);
+            for (size_t i = l + 1; i <= h; i++)
+                small = fmin(small, fabs(d[i]));
+            double shift = 0.0;
+            if (small > tiny)
+            {
+                shift = smaller_singular_value(d[h - 1], e[h - 1], d[h]);
+                double ratio = shift / fabs(d[l]);
+                if (ratio * ratio < DBL_EPSILON)
+                    shift = 0.0;
+            }
+            bidiagonal_sweep(d, e, l, h, shift, left, right);
+        }
+        return true;
+    }
+
+/** SVD interface */
+
+    /*
+     * SVD of a matrix with m >= n. Bidiagonalization A = Q B Pᵀ, of R from an nd_qr() first when
+     * A is tall enough for the QR to pay for itself; implicit QR on B gives B = U_B Σ V_Bᵀ, whose
+     * rotations are logged and applied to Uᵀ and Vᵀ in strips; then U = Q U_B and V = P V_B by
+     * block reflectors.
+     */
+    static nd_svd_t svd_tall(ndarray_t *A, nd_svd_mode_t mode)
+    {
+        size_t m = A->shape[0], n = A->shape[1];
+        bool vectors = mode != ND_SVD_VALUES, tall = m >= SV_QR_FIRST * n;
+        nd_svd_t svd = {0};
+        nd_qr_t qr = {0};
+        ndarray_t B;
+        if(tall)
+        {
+            qr = nd_qr(A, false);
+            B = nd_qr_r(&qr);
+        }
+        else
+            B = copy(A);
+
+        double *d = malloc(sizeof(double) * n);
+        double *e = malloc(sizeof(double) * n);
+        double *tauq = malloc(sizeof(double) * n);
+        double *taup = malloc(sizeof(double) * n);
+        if(d == NULL || e == NULL || tauq == NULL || taup == NULL)
+            malloc_error();
+        bidiagonalize(&B, d, e, tauq, taup);
+
+        ndarray_t Ut = {0}, Vt = {0};
+        rotation_log_t left = {0}, right = {0};
+        if(vectors)
+        {
+            Ut = identity(n, n);
+            Vt = identity(n, n);
+            left = (rotation_log_t){Ut.data, n, malloc(sizeof(plane_rotation_t) * SV_ROTATIONS), 0, 0, 0};
+            right = (rotation_log_t){Vt.data, n, malloc(sizeof(plane_rotation_t) * SV_ROTATIONS), 0, 0, 0};
+            if(left.pending == NULL || right.pending == NULL)
+                malloc_error();
+        }
+        svd.converged = bidiagonal_qr(d, e, n, &left, &right);
+
+        // Positive values in descending order; the rows of Uᵀ and Vᵀ follow by pointer swaps
+        if(vectors)
+        {
+            rotation_flush(&left);
+            rotation_flush(&right);
+        }
+        for(size_t i = 0; i < n; i++)
+            if(d[i] < 0.0)
+            {
+                d[i] = -d[i];
+                for(size_t c = 0; vectors && c < n; c++)
+                    Vt.data[i][c] = -Vt.data[i][c];
+            }
+        svd.S = array(1, n);
+        for(size_t i = 0; i < n; i++)
+        {
+            size_t best = i;
+            for(size_t k = i + 1; k < n; k++)
+                if(d[k] > d[best])
+                    best = k;
+            double value = d[best];
+            d[best] = d[i];
+            svd.S.data[0][i] = d[i] = value;
+            if(vectors && best != i)
+            {
+                double *row = Ut.data[i];
+                Ut.data[i] = Ut.data[best];
+                Ut.data[best] = row;
+                row = Vt.data[i];
+                Vt.data[i] = Vt.data[best];
+                Vt.data[best] = row;
+            }
+        }
+
+        if(vectors)
+        {
+            // Vᵀ = (P V_B)ᵀ, with the right reflectors moved from the rows of B to columns
+            ndarray_t P = zeros(n, n);
+            for(size_t j = 0; j + 1 < n; j++)
+                for(size_t c = j + 1; c < n; c++)
+                    P.data[c][j] = B.data[j][c];
+            ndarray_t V = transpose(&Vt);
+            back_transform(&P, 1, n - 1, taup, &V);
+            svd.Vt = transpose(&V);
+
+            // U = Q [U_B; 0], or Q diag(U_B, I) for the full m x m U, with the QR's Q in front
+            size_t cols = mode == ND_SVD_FULL ? m : n;
+            svd.U = zeros(m, cols);
+            for(size_t i = 0; i < n; i++)
+                for(size_t r = 0; r < n; r++)
+                    svd.U.data[r][i] = Ut.data[i][r];
+            for(size_t i = n; i < cols; i++)
+                svd.U.data[i][i] = 1.0;
+            if(tall)
+            {
+                ndarray_t top = nd_view(&svd.U, 0, 0, n, n);
+                back_transform(&B, 0, n, tauq, &top);
+                nd_view_free(&top);
+                nd_qr_apply_q(&qr, &svd.U);
+            }
+            else
+                back_transform(&B, 0, n, tauq, &svd.U);
+
+            free(left.pending);
+            free(right.pending);
+            clean(&P, &V, &Ut, &Vt, NULL);
+        }
+
+        free(d);
+        free(e);
+        free(tauq);
+        free(taup);
+        clean(&B, NULL);
+        if(tall)
+            nd_qr_free(&qr);
+        return svd;
+    }
+
+    nd_svd_t nd_svd(ndarray_t *this, nd_svd_mode_t mode)
+    {
+        if(isnull(this))
+            {null_error(); exit(EXIT_FAILURE);}
+        if(this->shape[0] >= this->shape[1])
+            return svd_tall(this, mode);
+
+        // Wide: A = (Aᵀ)ᵀ, so U and Vᵀ swap roles
+        ndarray_t At = transpose(this);
+        nd_svd_t swapped = svd_tall(&At, mode);
+        nd_svd_t svd = {0};
+        svd.S = swapped.S;
+        svd.converged = swapped.converged;
+        if(mode != ND_SVD_VALUES)
+        {
+            svd.U = transpose(&swapped.Vt);
+            svd.Vt = transpose(&swapped.U);
+        }
+        clean(&At, &swapped.U, &swapped.Vt, NULL);
+        return svd;
+    }
+
+    void nd_svd_free(nd_svd_t *svd)
+    {
+        if(svd == NULL)
+            return;
+        clean(&svd->U, &svd->S, &svd->Vt, NULL);
+    }
+
+/** Randomized SVD */
+
+    // Orthonormal basis of the columns of Y (rows >= cols) from its Householder QR
+    static ndarray_t orthonormal_columns(ndarray_t *Y)
+    {
+        nd_qr_t f = nd_qr(Y, false);
+        ndarray_t Q = nd_qr_q(&f, true);
+        nd_qr_free(&f);
+        return Q;
+    }
+
+    nd_svd_t nd_svd_randomized(ndarray_t *this, size_t k, size_t oversample, size_t power_iters, uint64_t seed)
+    {
+        if(isnull(this))
+            {null_error(); exit(EXIT_FAILURE);}
+        size_t m = this->shape[0], n = this->shape[1], small = m < n ? m : n;
+        if(k == 0 || k > small)
+            index_error();
+        size_t l = oversample < small - k ? k + oversample : small;
+
+        // Gaussian test matrix Ω (n x l), Box-Muller on the seeded generator
+        lcg64_t gen;
+        lcg64_seed(&gen, seed);
+        ndarray_t Omega = array(n, l);
+        for(size_t i = 0; i < n; i++)
+            for(size_t j = 0; j < l; j += 2)
+            {
+                double u1 = 1.0 - lcg64_next_uniform(&gen), u2 = lcg64_next_uniform(&gen);
+                double radius = sqrt(-2.0 * log(u1)), angle = 2.0 * M_PI * u2;
+                Omega.data[i][j] = radius * cos(angle);
+                if(j + 1 < l)
+                    Omega.data[i][j + 1] = radius * sin(angle);
+            }
+
+        // Range of A: Q = orth(A Ω), then Q = orth(A orth(Aᵀ Q)) per power iteration
+        ndarray_t Y = array(m, l);
+        nd_gemm(ND_NO_TRANS, ND_NO_TRANS, 1.0, this, &Omega, 0.0, &Y);
+        ndarray_t Q = orthonormal_columns(&Y);
+        for(size_t it = 0; it < power_iters; it++)
+        {
+            nd_gemm(ND_TRANS, ND_NO_TRANS, 1.0, this, &Q, 0.0, &Omega);
+            ndarray_t Z = orthonormal_columns(&Omega);
+            nd_gemm(ND_NO_TRANS, ND_NO_TRANS, 1.0, this, &Z, 0.0, &Y);
+            clean(&Q, &Z, NULL);
+            Q = orthonormal_columns(&Y);
+        }
+
+        // A ≈ Q B with B = Qᵀ A (l x n); the SVD of B gives Σ and Vᵀ, and U = Q U_B
+        ndarray_t B = array(l, n);
+        nd_gemm(ND_TRANS, ND_NO_TRANS, 1.0, &Q, this, 0.0, &B);
+        nd_svd_t sb = nd_svd(&B, ND_SVD_THIN);
+
+        nd_svd_t svd = {0};
+        svd.converged = sb.converged;
+        svd.S = array(1, k);
+        memcpy(svd.S.data[0], sb.S.data[0], sizeof(double) * k);
+        svd.Vt = array(k, n);
+        for(size_t i = 0; i < k; i++)
+            memcpy(svd.Vt.data[i], sb.Vt.data[i], sizeof(double) * n);
+        svd.U = array(m, k);
+        ndarray_t Ub = nd_view(&sb.U, 0, 0, l, k);
+        nd_gemm(ND_NO_TRANS, ND_NO_TRANS, 1.0, &Q, &Ub, 0.0, &svd.U);
+
+        nd_view_free(&Ub);
+        nd_svd_free(&sb);
+        clean(&Omega, &Y, &Q, &B, NULL);
+        return svd;
+    }
+
+/** Least squares */
+
+    // x = R⁻¹ x, or R⁻ᵀ x with trans, for upper triangular R in the first n rows
+    static void tri_vec_solve(double **R, size_t n, double *x, bool trans)
+    {
+        if (!trans)
+        {
+            for (size_t i = n; i-- > 0;)
+            {
+                double s = x[i];
+                for (size_t j = i + 1; j < n; j++)
+                    s -= R[i][j] * x[j];
+                x[i] = s / R[i][i];
+            }
+            return;
+        }
+        for (size_t i = 0; i < n; i++)
+        {
+            double xi = x[i] /= R[i][i];
+            for (size_t j = i + 1; j < n; j++)
+                x[j] -= R[i][j] * xi;
+        }
+    }
+
+    // Reciprocal 1-norm condition number of upper triangular R: |R⁻¹|₁ comes from
+    // Hager's estimator, with Higham's alternating vector as a lower bound, in
+    // O(n²) instead of the O(n³) of an inverse
+    static double tri_rcond(double **R, size_t n)
+    {
+        for (size_t i = 0; i < n; i++)
+            if (R[i][i] == 0.0)
+                return 0.0;
+
+        double *w = calloc(4 * n, sizeof(double));
+        if (w == NULL)
+            malloc_error();
+        double *colsum = w, *x = w + n, *y = x + n, *z = y + n;
+        for (size_t i = 0; i < n; i++)
+            for (size_t j = i; j < n; j++)
+                colsum[j] += fabs(R[i][j]);
+        double norm = 0.0;
+        for (size_t j = 0; j < n; j++)
+            norm = colsum[j] > norm ? colsum[j] : norm;
+
+        double est = 0.0;
+        for (size_t i = 0; i < n; i++)
+            x[i] = 1.0 / (double)n;
+        for (size_t it = 0; it < LS_ESTIMATES; it++)
+        {
+            memcpy(y, x, sizeof(double) * n);
+            tri_vec_solve(R, n, y, false);
+            double ny = 0.0;
+            for (size_t i = 0; i < n; i++)
+                ny += fabs(y[i]);
+            if (it > 0 && ny <= est)
+                break;
+            est = ny;
+
+            // The gradient sign(y)ᵀ R⁻¹ points to the column of R⁻¹ to try next
+            for (size_t i = 0; i < n; i++)
+                z[i] = y[i] >= 0.0 ? 1.0 : -1.0;
+            tri_vec_solve(R, n, z, true);
+            size_t jmax = 0;
+            double zx = 0.0;
+            for (size_t i = 0; i < n; i++)
+            {
+                zx += z[i] * x[i];
+                if (fabs(z[i]) > fabs(z[jmax]))
+                    jmax = i;
+            }
+            if (it > 0 && fabs(z[jmax]) <= zx)
+                break;
+            memset(x, 0, sizeof(double) * n);
+            x[jmax] = 1.0;
+        }
+
+        for (size_t i = 0; i < n; i++)
+            y[i] = (i % 2 ? -1.0 : 1.0) * (1.0 + (double)i / (double)(n > 1 ? n - 1 : 1));
+        tri_vec_solve(R, n, y, false);
+        double alt = 0.0;
+        for (size_t i = 0; i < n; i++)
+            alt += fabs(y[i]);
+        alt = 2.0 * alt / (3.0 * (double)n);
+        est = alt > est ? alt : est;
+
+        free(w);
+        return 1.0 / (norm * est);
+    }
+
+    nd_lstsq_t nd_lstsq(ndarray_t *this, ndarray_t *B)
+    {
+        if(isnull(this) || isnull(B))
+            {null_error(); exit(EXIT_FAILURE);}
+
+        size_t m = this->shape[0], n = this->shape[1], nrhs = B->shape[1];
+        if(B->shape[0] != m)
+        {
+            fprintf(stderr, "Invalid dimensions %ldx%ld for a least-squares solve with a %ldx%ld matrix\n",
+                    B->shape[0], B->shape[1], m, n);
+            perror("Use valid ndarray_t dimesions please\n");
+            exit(1);
+        }
+
+        nd_lstsq_t ls = {0};
+        nd_qr_t f = nd_qr(this, false);
+        if(m >= n)
+        {
+            ls.rcond = tri_rcond(f.QR.data, n);
+            if(ls.rcond > LS_RCOND)
+            {
+                ls.x = nd_qr_solve(&f, B);
+                ls.rank = n;
+                nd_qr_free(&f);
+                return ls;
+            }
+        }
+
+        // Ill-conditioned or wide: A = Q R with R = U_R diag(S) V_Rᵀ, and the
+        // minimum-norm solution is X = V_R diag(S)⁺ U_Rᵀ (Qᵀ B)[0:k], with
+        // singular values below max(m, n) ε S[0] treated as zero
+        size_t k = m < n ? m : n;
+        ndarray_t QtB = copy(B);
+        nd_qr_apply_qt(&f, &QtB);
+        ndarray_t R = nd_qr_r(&f);
+        nd_svd_t sv = nd_svd(&R, ND_SVD_THIN);
+
+        ndarray_t top = nd_view(&QtB, 0, 0, k, nrhs);
+        ndarray_t C = array(k, nrhs);
+        nd_gemm(ND_TRANS, ND_NO_TRANS, 1.0, &sv.U, &top, 0.0, &C);
+
+        const double *s = sv.S.data[0];
+        double cutoff = (double)(m > n ? m : n) * DBL_EPSILON * s[0];
+        for(size_t i = 0; i < k; i++)
+        {
+            double scale = s[i] > cutoff ? 1.0 / s[i] : 0.0;
+            ls.rank += s[i] > cutoff;
+            for(size_t j = 0; j < nrhs; j++)
+                C.data[i][j] *= scale;
+        }
+        ls.x = array(n, nrhs);
+        nd_gemm(ND_TRANS, ND_NO_TRANS, 1.0, &sv.Vt, &C, 0.0, &ls.x);
+        ls.rcond = s[k - 1] > 0.0 ? s[k - 1] / s[0] : 0.0;
+        ls.used_svd = true;
+
+        nd_view_free(&top);
+        nd_svd_free(&sv);
+        nd_qr_free(&f);
+        clean(&QtB, &R, &C, NULL);
+        return ls;
+    }
+
+    void nd_lstsq_free(nd_lstsq_t *ls)
+    {
+        if(ls == NULL)
+            return;
+        clean(&ls->x, NULL);
+    }
+
+    nd_normal_eq_t nd_normal_eq(size_t n, size_t nrhs)
+    {
+        if(n == 0 || nrhs == 0)
+            shape_error();
+
+        nd_normal_eq_t ne = {0};
+        ne.AtA = zeros(n, n);
+        ne.AtB = zeros(n, nrhs);
+        return ne;
+    }
+
+    void nd_normal_eq_add(nd_normal_eq_t *ne, ndarray_t *A, ndarray_t *B)
+    {
+        if(ne == NULL || isnull(&ne->AtA) || isnull(A) || isnull(B))
+            {null_error(); exit(EXIT_FAILURE);}
+
+        size_t n = ne->AtA.shape[0], nrhs = ne->AtB.shape[1];
+        if(A->shape[1] != n || B->shape[1] != nrhs || B->shape[0] != A->shape[0])
+        {
+            fprintf(stderr, "Invalid dimensions %ldx%ld and %ldx%ld for normal equations with %ld columns and %ld right-hand sides\n",
+                    A->shape[0], A->shape[1], B->shape[0], B->shape[1], n, nrhs);
+            perror("Use valid ndarray_t dimesions please\n");
+            exit(1);
+        }
+
+        nd_gemm(ND_TRANS, ND_NO_TRANS, 1.0, A, A, 1.0, &ne->AtA);
+        nd_gemm(ND_TRANS, ND_NO_TRANS, 1.0, A, B, 1.0, &ne->AtB);
+        ne->rows += A->shape[0];
+    }
+
+    nd_lstsq_t nd_normal_eq_solve(nd_normal_eq_t *ne)
+    {
+        if(ne == NULL || isnull(&ne->AtA))
+            {null_error(); exit(EXIT_FAILURE);}
+        return nd_lstsq(&ne->AtA, &ne->AtB);
+    }
+
+    void nd_normal_eq_free(nd_normal_eq_t *ne)
+    {
+        if(ne == NULL)
+            return;
+        clean(&ne->AtA, &ne->AtB, NULL);
+    }
+
+/** Mixed precision */
+
+    /*
+     * The float32 factorizations follow lu_factor() and the triangular solves above on one
+     * contiguous row-major n x n buffer, with nd_sgemm() for every update between halves.
+     */
+
+    // Solves L X = X for unit lower L in rows [t, t + nb) and X in the same rows, columns [c, c + nc)
+    static void tri_f32(float *a, size_t n, size_t t, size_t nb, size_t c, size_t nc)
+    {
+        if (nb <= MX_TRI_LEAF)
+        {
+            for (size_t r = t + 1; r < t + nb; r++)
+            {
+                float *dst = a + r * n;
+                for (size_t s = t; s < r; s++)
+                {
+                    const float *src = a + s * n;
+                    float l = dst[s];
+                    for (size_t k = c; k < c + nc; k++)
+                        dst[k] -= l * src[k];
+                }
+            }
+            return;
+        }
+
+        size_t h = nb / 2;
+        tri_f32(a, n, t, h, c, nc);
+        nd_sgemm(ND_NO_TRANS, ND_NO_TRANS, nb - h, nc, h, -1.0f,
+                 a + (t + h) * n + t, n, a + t * n + c, n, 1.0f, a + (t + h) * n + c, n);
+        tri_f32(a, n, t + h, nb - h, c, nc);
+    }
+
+    // LU of columns [j, j + jb) over rows [j, n), whole rows swapped; false on a zero or non-finite pivot
+    static bool lu_f32(float *a, size_t n, size_t *perm, size_t j, size_t jb)
+    {
+        if (jb <= MX_LEAF)
+        {
+            for (size_t c = j; c < j + jb; c++)
+            {
+                size_t piv = c;
+                float best = fabsf(a[c * n + c]);
+                for (size_t i = c + 1; i < n; i++)
+                    if (fabsf(a[i * n + c]) > best)
+                    {
+                        best = fabsf(a[i * n + c]);
+                        piv = i;
+                    }
+                if (!(best > 0.0f) || !isfinite(best))
+                    return false;
+                if (piv != c)
+                {
+                    float *x = a + c * n, *y = a + piv * n;
+                    for (size_t k = 0; k < n; k++)
+                    {
+                        float t = x[k];
+                        x[k] = y[k];
+                        y[k] = t;
+                    }
+                    size_t t = perm[c];
+                    perm[c] = perm[piv];
+                    perm[piv] = t;
+                }
+
+                const float *rc = a + c * n;
+                float inv = 1.0f / rc[c];
+                for (size_t i = c + 1; i < n; i++)
+                {
+                    float *ri = a + i * n;
+                    float l = ri[c] *= inv;
+                    for (size_t k = c + 1; k < j + jb; k++)
+                        ri[k] -= l * rc[k];
+                }
+            }
+            return true;
+        }
+
+        size_t h = jb / 2;
+        if (!lu_f32(a, n, perm, j, h))
+            return false;
+        tri_f32(a, n, j, h, j + h, jb - h);
+        nd_sgemm(ND_NO_TRANS, ND_NO_TRANS, n - j - h, jb - h, h, -1.0f,
+                 a + (j + h) * n + j, n, a + j * n + j + h, n, 1.0f, a + (j + h) * n + j + h, n);
+        return lu_f32(a, n, perm, j + h, jb - h);
+    }
+
+    // Cholesky of columns [j, j + jb) of the lower triangle over rows [j, n); false when a pivot is
+    // not positive and finite. Updates also write above the diagonal, which is never read
+    static bool cholesky_f32(float *a, size_t n, size_t j, size_t jb)
+    {
+        if (jb <= MX_LEAF)
+        {
+            for (size_t i = j; i < n; i++)
+            {
+                float *ri = a + i * n;
+                size_t end = i < j + jb ? i : j + jb;
+                for (size_t c = j; c < end; c++)
+                {
+                    const float *rc = a + c * n;
+                    float s = ri[c];
+                    for (size_t p = j; p < c; p++)
+                        s -= ri[p] * rc[p];
+                    ri[c] = s / rc[c];
+                }
+                if (i < j + jb)
+                {
+                    float d = ri[i];
+                    for (size_t p = j; p < i; p++)
+                        d -= ri[p] * ri[p];
+                    if (!(d > 0.0f) || !isfinite(d))
+                        return false;
+                    ri[i] = sqrtf(d);
+                }
+            }
+            return true;
+        }
+
+        size_t h = jb / 2;
+        if (!cholesky_f32(a, n, j, h))
+            return false;
+        nd_sgemm(ND_NO_TRANS, ND_TRANS, n - j - h, jb - h, h, -1.0f,
+                 a + (j + h) * n + j, n, a + (j + h) * n + j, n, 1.0f, a + (j + h) * n + j + h, n);
+        return cholesky_f32(a, n, j + h, jb - h);
+    }
+
+    // Eight running sums, so the float dot product vectorizes without reassociation
+    static float sdot(const float *x, const float *y, size_t len)
+    {
+        float acc[8] = {0};
+        size_t k = 0;
+        for (; k + 8 <= len; k += 8)
+            for (size_t l = 0; l < 8; l++)
+                acc[l] += x[k + l] * y[k + l];
+        float s = 0.0f;
+        for (; k < len; k++)
+            s += x[k] * y[k];
+        for (size_t l = 0; l < 8; l++)
+            s += acc[l];
+        return s;
+    }
+
+    // w = A⁻¹ w for one contiguous right-hand side, with the float32 factors in a
+    static void solve_f32(const float *a, size_t n, const size_t *perm, bool cholesky,
+                          float *w, float *tmp)
+    {
+        if (cholesky)
+        {
+            for (size_t i = 0; i < n; i++)
+                w[i] = (w[i] - sdot(a + i * n, w, i)) / a[i * n + i];
+            // Lᵀ x = y by columns of Lᵀ, which are rows of L
+            for (size_t i = n; i-- > 0;)
+            {
+                const float *ri = a + i * n;
+                float x = w[i] /= ri[i];
+                for (size_t p = 0; p < i; p++)
+                    w[p] -= x * ri[p];
+            }
+            return;
+        }
+
+        for (size_t i = 0; i < n; i++)
+            tmp[i] = w[perm[i]];
+        for (size_t i = 0; i < n; i++)
+            tmp[i] -= sdot(a + i * n, tmp, i);
+        for (size_t i = n; i-- > 0;)
+        {
+            const float *ri = a + i * n;
+            w[i] = (tmp[i] - sdot(ri + i + 1, w + i + 1, n - i - 1)) / ri[i];
+        }
+    }
+
+    // Float copy of A; false when an entry does not fit in a float
+    static bool copy_f32(ndarray_t *A, float *a)
+    {
+        size_t n = A->shape[0];
+        for (size_t i = 0; i < n; i++)
+            for (size_t j = 0; j < n; j++)
+            {
+                double v = A->data[i][j];
+                if (!(fabs(v) <= FLT_MAX))
+                    return false;
+                a[i * n + j] = (float)v;
+            }
+        return true;
+    }
+
+    static double max_abs(ndarray_t *X)
+    {
+        double m = 0.0;
+        for (size_t i = 0; i < X->shape[0]; i++)
+            for (size_t j = 0; j < X->shape[1]; j++)
+                m = fabs(X->data[i][j]) > m || isnan(X->data[i][j]) ? fabs(X->data[i][j]) : m;
+        return m;
+    }
+
+    nd_mixed_t nd_solve_mixed(ndarray_t *this, ndarray_t *B)
+    {
+        if(isnull(this) || isnull(B))
+            {null_error(); exit(EXIT_FAILURE);}
+        if(issquare(this))
+            mat_error();
+
+        size_t n = this->shape[0], nrhs = B->shape[1];
+        if(B->shape[0] != n)
+        {
+            fprintf(stderr, "Invalid dimensions %ldx%ld for a solve with a %ldx%ld matrix\n",
+                    B->shape[0], B->shape[1], n, n);
+            perror("Use valid ndarray_t dimesions please\n");
+            exit(1);
+        }
+
+        nd_mixed_t res = {0};
+        bool symmetric = true;
+        double anorm = 0.0;
+        for(size_t i = 0; i < n; i++)
+        {
+            double row = 0.0;
+            for(size_t j = 0; j < n; j++)
+            {
+                row += fabs(this->data[i][j]);
+                symmetric = symmetric && this->data[i][j] == this->data[j][i];
+            }
+            anorm = row > anorm ? row : anorm;
+        }
+
+        float *a = malloc(sizeof(float) * n * n);
+        float *w = malloc(sizeof(float) * n * 2);
+        size_t *perm = malloc(sizeof(size_t) * n);
+        if(a == NULL || w == NULL || perm == NULL)
+            malloc_error();
+
+        // Cholesky for symmetric A, LU when that fails or A is not symmetric
+        bool factored = copy_f32(this, a);
+        if(factored && symmetric)
+            res.cholesky = cholesky_f32(a, n, 0, n);
+        if(factored && !res.cholesky)
+        {
+            for(size_t i = 0; i < n; i++)
+                perm[i] = i;
+            factored = (!symmetric || copy_f32(this, a)) && lu_f32(a, n, perm, 0, n);
+        }
+
+        // X += A⁻¹ (B - A X) in float32 until the double residual is at the level of
+        // rounding: |R| <= |X| |A| ε √n in the max norm (as LAPACK's dsgesv)
+        res.x = zeros(n, nrhs);
+        bool converged = false;
+        if(factored)
+        {
+            ndarray_t R = copy(B);
+            double tol = anorm * DBL_EPSILON * sqrt((double)n), previous = INFINITY;
+            for(size_t it = 0; ; it++)
+            {
+                if(it > 0)
+                {
+                    for(size_t i = 0; i < n; i++)
+                        memcpy(R.data[i], B->data[i], sizeof(double) * nrhs);
+                    nd_gemm(ND_NO_TRANS, ND_NO_TRANS, -1.0, this, &res.x, 1.0, &R);
+                }
+                double rnorm = max_abs(&R);
+                if(rnorm <= max_abs(&res.x) * tol)
+                {
+                    converged = true;
+                    break;
+                }
+                if(it == MX_ITERS || !isfinite(rnorm) || rnorm > 0.5 * previous)
+                    break;
+                previous = rnorm;
+
+                // The residual is scaled to 1 so that float32 neither under- nor overflows
+                for(size_t j = 0; j < nrhs; j++)
+                {
+                    for(size_t i = 0; i < n; i++)
+                        w[i] = (float)(R.data[i][j] / rnorm);
+                    solve_f32(a, n, perm, res.cholesky, w, w + n);
+                    for(size_t i = 0; i < n; i++)
+                        res.x.data[i][j] += rnorm * (double)w[i];
+                }
+                res.iterations = it + 1;
+            }
+            clean(&R, NULL);
+        }
+        free(a);
+        free(w);
+        free(perm);
+        if(converged)
+            return res;
+
+        // Too ill-conditioned for float32, or out of its range: solve in double
+        clean(&res.x, NULL);
+        res.fallback = true;
+        if(symmetric)
+        {
+            nd_cholesky_t chol = nd_cholesky(this);
+            res.cholesky = !chol.indefinite;
+            if(res.cholesky)
+                res.x = nd_cholesky_solve(&chol, B);
+            nd_cholesky_free(&chol);
+            if(res.cholesky)
+                return res;
+        }
+        nd_lu_t lu = nd_lu(this);
+        res.x = nd_lu_solve(&lu, B);
+        nd_lu_free(&lu);
+        return res;
+    }
+
+    void nd_mixed_free(nd_mixed_t *mixed)
+    {
+        if(mixed == NULL)
+            return;
+        clean(&mixed->x, NULL);
+    }
+
+#pragma GCC pop_options
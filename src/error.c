@@ -165,3 +165,27 @@ void zero_error()
     // Exit the program with failure status
     exit(EXIT_FAILURE);
 }
+
+// Function to handle singular matrix error
+void singular_error()
+{
+    // Print error message for singular matrix error
+    TRACE();
+    fprintf(stderr, "SINGULAR MATRIX ERROR in %s\n", __func__);
+    // Print details about why the matrix has no unique solution
+    perror("MATRIX IS SINGULAR TO WORKING PRECISION\n");
+    // Exit the program with failure status
+    exit(EXIT_FAILURE);
+}
+
+// Function to handle non positive definite matrix error
+void spd_error()
+{
+    // Print error message for non positive definite matrix error
+    TRACE();
+    fprintf(stderr, "MATRIX ERROR in %s\n", __func__);
+    // Print details about why the factorization failed
+    perror("MATRIX IS NOT SYMMETRIC POSITIVE DEFINITE\n");
+    // Exit the program with failure status
+    exit(EXIT_FAILURE);
+}
@@ -0,0 +1,1406 @@
+#include <ndmath/iterative.h>
+#include <ndmath/parallel.h>
+#include <ndmath/array.h>
+#include <ndmath/helper.h>
+#include <ndmath/error.h>
+#include <ndmath/conditionals.h>
+#include <ndmath/blas.h>
+#include <ndmath/decomp.h>
+#include <ndmath/random.h>
+#include <math.h>
+#include <float.h>
+#include <complex.h>
+#include <string.h>
+#include <stdint.h>
+
+#pragma GCC push_options
+#pragma GCC optimize("O3", "unroll-loops")
+
+#define KR_CHUNK 8192           // vector elements per task in dot products and updates
+#define KR_ROW_WORK 16384       // matrix elements per task in dense products
+#define KR_TOL 1e-8             // default relative residual
+#define KR_MAX_ITERS 1000       // default iteration limit
+#define KR_RESTART 30           // default GMRES basis size
+#define EG_TOL 1e-10            // default Ritz residual, relative to |λ|
+#define EG_MAX_RESTARTS 300     // default restart limit
+#define EG_MIN_BASIS 20         // smallest default Krylov basis
+#define EG_BREAKDOWN 1e-12      // |w| after orthogonalization, relative to |A v|, below which A v adds nothing
+#define EG_QR_ITERS 60          // Hessenberg QR sweeps allowed per eigenvalue
+
+/** Operators */
+
+typedef struct {
+    ndarray_t *A;
+    const double *x;
+    double *y;
+} dense_matvec_ctx_t;
+
+    static void dense_matvec_task(size_t begin, size_t end, void *ctx)
+    {
+        dense_matvec_ctx_t *mc = ctx;
+        size_t n = mc->A->shape[1];
+        const double *x = mc->x;
+        for (size_t i = begin; i < end; i++)
+        {
+            const double *a = mc->A->data[i];
+            double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+            size_t j = 0;
+            for (; j + 4 <= n; j += 4)
+            {
+                s0 += a[j] * x[j];
+                s1 += a[j + 1] * x[j + 1];
+                s2 += a[j + 2] * x[j + 2];
+                s3 += a[j + 3] * x[j + 3];
+            }
+            for (; j < n; j++)
+                s0 += a[j] * x[j];
+            mc->y[i] = (s0 + s1) + (s2 + s3);
+        }
+    }
+
+    static void dense_apply(const double *x, double *y, void *ctx)
+    {
+        dense_matvec_ctx_t mc = {ctx, x, y};
+        size_t n = mc.A->shape[0];
+        nd_parallel_for(n, KR_ROW_WORK / n + 1, dense_matvec_task, &mc);
+    }
+
+    static void csr_apply(const double *x, double *y, void *ctx)
+    {
+        nd_csr_matvec(ctx, x, y);
+    }
+
+    nd_operator_t nd_operator_dense(ndarray_t *A)
+    {
+        if(isnull(A))
+            {null_error(); exit(EXIT_FAILURE);}
+        if(issquare(A))
+            mat_error();
+
+        nd_operator_t op = {A->shape[0], dense_apply, A};
+        return op;
+    }
+
+    nd_operator_t nd_operator_csr(const nd_csr_t *A)
+    {
+        if(A == NULL || A->row_ptr == NULL)
+            {null_error(); exit(EXIT_FAILURE);}
+        if(A->shape[0] != A->shape[1])
+            mat_error();
+
+        nd_operator_t op = {A->shape[0], csr_apply, (void *)A};
+        return op;
+    }
+
+    nd_operator_t nd_operator_callback(size_t n, nd_matvec_fn apply, void *ctx)
+    {
+        if(apply == NULL)
+            {null_error(); exit(EXIT_FAILURE);}
+        if(n == 0)
+            shape_error();
+
+        nd_operator_t op = {n, apply, ctx};
+        return op;
+    }
+
+/** Preconditioners */
+
+    // Position of every diagonal entry of a square CSR matrix
+    static size_t *csr_diagonal(const nd_csr_t *A)
+    {
+        if(A == NULL || A->row_ptr == NULL)
+            {null_error(); exit(EXIT_FAILURE);}
+        if(A->shape[0] != A->shape[1])
+            mat_error();
+
+        size_t n = A->shape[0];
+        size_t *diag = malloc(sizeof(size_t) * n);
+        if (diag == NULL)
+            malloc_error();
+        for (size_t i = 0; i < n; i++)
+        {
+            size_t k = A->row_ptr[i], k1 = A->row_ptr[i + 1];
+            while (k < k1 && A->col[k] < i)
+                k++;
+            if (k == k1 || A->col[k] != i || A->val[k] == 0.0)
+                singular_error();
+            diag[i] = k;
+        }
+        return diag;
+    }
+
+    nd_precond_t nd_precond_jacobi(const nd_csr_t *A)
+    {
+        size_t *diag = csr_diagonal(A);
+        size_t n = A->shape[0];
+
+        nd_precond_t M = {0};
+        M.kind = ND_PRECOND_JACOBI;
+        M.n = n;
+        M.inv_diag = malloc(sizeof(double) * n);
+        if(M.inv_diag == NULL)
+            malloc_error();
+        for(size_t i = 0; i < n; i++)
+            M.inv_diag[i] = 1.0 / A->val[diag[i]];
+        free(diag);
+        return M;
+    }
+
+    nd_precond_t nd_precond_ilu0(const nd_csr_t *A)
+    {
+        size_t *diag = csr_diagonal(A);
+        size_t n = A->shape[0];
+
+        nd_precond_t M = {0};
+        M.kind = ND_PRECOND_ILU0;
+        M.n = n;
+        M.diag = diag;
+        M.lu.shape[0] = n;
+        M.lu.shape[1] = n;
+        M.lu.nnz = A->nnz;
+        M.lu.row_ptr = malloc(sizeof(size_t) * (n + 1));
+        M.lu.col = malloc(sizeof(size_t) * (A->nnz > 0 ? A->nnz : 1));
+        M.lu.val = malloc(sizeof(double) * (A->nnz > 0 ? A->nnz : 1));
+        size_t *where = malloc(sizeof(size_t) * n);
+        if(M.lu.row_ptr == NULL || M.lu.col == NULL || M.lu.val == NULL || where == NULL)
+            malloc_error();
+        memcpy(M.lu.row_ptr, A->row_ptr, sizeof(size_t) * (n + 1));
+        memcpy(M.lu.col, A->col, sizeof(size_t) * A->nnz);
+        memcpy(M.lu.val, A->val, sizeof(double) * A->nnz);
+
+        // IKJ elimination restricted to the pattern of A; where[] maps a column
+        // of row i to its position, or SIZE_MAX when row i does not store it
+        const size_t *row_ptr = M.lu.row_ptr, *col = M.lu.col;
+        double *val = M.lu.val;
+        for(size_t j = 0; j < n; j++)
+            where[j] = SIZE_MAX;
+        for(size_t i = 0; i < n; i++)
+        {
+            for(size_t k = row_ptr[i]; k < row_ptr[i + 1]; k++)
+                where[col[k]] = k;
+            for(size_t k = row_ptr[i]; k < diag[i]; k++)
+            {
+                size_t j = col[k];
+                double l = val[k] / val[diag[j]];
+                val[k] = l;
+                for(size_t kk = diag[j] + 1; kk < row_ptr[j + 1]; kk++)
+                {
+                    size_t w = where[col[kk]];
+                    if(w != SIZE_MAX)
+                        val[w] -= l * val[kk];
+                }
+            }
+            if(val[diag[i]] == 0.0)
+                singular_error();
+            for(size_t k = row_ptr[i]; k < row_ptr[i + 1]; k++)
+                where[col[k]] = SIZE_MAX;
+        }
+        free(where);
+        return M;
+    }
+
+    void nd_precond_apply(const nd_precond_t *M, const double *r, double *z)
+    {
+        if(M == NULL || r == NULL || z == NULL)
+            {null_error(); exit(EXIT_FAILURE);}
+
+        size_t n = M->n;
+        if(M->kind == ND_PRECOND_NONE)
+        {
+            memcpy(z, r, sizeof(double) * n);
+            return;
+        }
+        if(M->kind == ND_PRECOND_JACOBI)
+        {
+            for(size_t i = 0; i < n; i++)
+                z[i] = M->inv_diag[i] * r[i];
+            return;
+        }
+
+        // L y = r with unit L, then U z = y, both in place in z
+        const size_t *row_ptr = M->lu.row_ptr, *col = M->lu.col, *diag = M->diag;
+        const double *val = M->lu.val;
+        for(size_t i = 0; i < n; i++)
+        {
+            double s = r[i];
+            for(size_t k = row_ptr[i]; k < diag[i]; k++)
+                s -= val[k] * z[col[k]];
+            z[i] = s;
+        }
+        for(size_t i = n; i-- > 0;)
+        {
+            double s = z[i];
+            for(size_t k = diag[i] + 1; k < row_ptr[i + 1]; k++)
+                s -= val[k] * z[col[k]];
+            z[i] = s / val[diag[i]];
+        }
+    }
+
+    void nd_precond_free(nd_precond_t *M)
+    {
+        if(M == NULL)
+            return;
+        free(M->inv_diag);
+        free(M->diag);
+        nd_csr_free(&M->lu);
+        M->inv_diag = NULL;
+        M->diag = NULL;
+    }
+
+/** Vector kernels */
+
+typedef struct {
+    size_t n;
+    double a;
+    const double *x;
+    double *y;
+    double *part;
+} vector_ctx_t;
+
+    // part[c] = x . y over chunk c; summed in chunk order, so results do not
+    // depend on the thread count
+    static void dot_task(size_t begin, size_t end, void *ctx)
+    {
+        vector_ctx_t *vc = ctx;
+        for (size_t c = begin; c < end; c++)
+        {
+            size_t lo = c * KR_CHUNK, hi = lo + KR_CHUNK < vc->n ? lo + KR_CHUNK : vc->n;
+            double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+            size_t i = lo;
+            for (; i + 4 <= hi; i += 4)
+            {
+                s0 += vc->x[i] * vc->y[i];
+                s1 += vc->x[i + 1] * vc->y[i + 1];
+                s2 += vc->x[i + 2] * vc->y[i + 2];
+                s3 += vc->x[i + 3] * vc->y[i + 3];
+            }
+            for (; i < hi; i++)
+                s0 += vc->x[i] * vc->y[i];
+            vc->part[c] = (s0 + s1) + (s2 + s3);
+        }
+    }
+
+    static double dot(size_t n, const double *x, const double *y, double *part)
+    {
+        size_t chunks = (n + KR_CHUNK - 1) / KR_CHUNK;
+        vector_ctx_t vc = {n, 0.0, x, (double *)y, part};
+        if (chunks == 1)
+            dot_task(0, 1, &vc);
+        else
+            nd_parallel_for(chunks, 1, dot_task, &vc);
+
+        double s = 0.0;
+        for (size_t c = 0; c < chunks; c++)
+            s += part[c];
+        return s;
+    }
+
+    static void axpy_task(size_t begin, size_t end, void *ctx)
+    {
+        vector_ctx_t *vc = ctx;
+        for (size_t i = begin; i < end; i++)
+            vc->y[i] += vc->a * vc->x[i];
+    }
+
+    static void xpay_task(size_t begin, size_t end, void *ctx)
+    {
+        vector_ctx_t *vc = ctx;
+        for (size_t i = begin; i < end; i++)
+            vc->y[i] = vc->x[i] + vc->a * vc->y[i];
+    }
+
+    // y += a x
+    static void axpy(size_t n, double a, const double *x, double *y)
+    {
+        vector_ctx_t vc = {n, a, x, y, NULL};
+        nd_parallel_for(n, KR_CHUNK, axpy_task, &vc);
+    }
+
+    // y = x + a y
+    static void xpay(size_t n, const double *x, double a, double *y)
+    {
+        vector_ctx_t vc = {n, a, x, y, NULL};
+        nd_parallel_for(n, KR_CHUNK, xpay_task, &vc);
+    }
+
+/** Solver workspace */
+
+typedef struct {
+    const nd_operator_t *A;
+    const nd_precond_t *M;      // NULL for the identity
+    nd_krylov_opts_t opts;
+    size_t n;
+    double *work;               // the solve's only allocation
+    double *x, *b;
+    double *trace, *part;
+    size_t count;               // trace entries recorded
+    double bnorm;
+} krylov_t;
+
+    // Copies an n x 1 or 1 x n ndarray into contiguous storage
+    static void gather(ndarray_t *v, size_t n, double *out)
+    {
+        if (v->shape[0] == n && v->shape[1] == 1)
+            for (size_t i = 0; i < n; i++)
+                out[i] = v->data[i][0];
+        else if (v->shape[0] == 1 && v->shape[1] == n)
+            memcpy(out, v->data[0], sizeof(double) * n);
+        else
+        {
+            fprintf(stderr, "Invalid dimensions %ldx%ld for a Krylov solve with a %ldx%ld operator\n",
+                    v->shape[0], v->shape[1], n, n);
+            perror("Use valid ndarray_t dimesions please\n");
+            exit(1);
+        }
+    }
+
+    // Checks the arguments, allocates x, b, `vectors` n-vectors plus `extra`
+    // values, the trace and the dot product partials at once, and returns the
+    // vectors
+    static double *krylov_begin(krylov_t *kr, const nd_operator_t *A, ndarray_t *b,
+                                ndarray_t *x0, const nd_krylov_opts_t *opts,
+                                size_t vectors, size_t extra)
+    {
+        if (A == NULL || A->apply == NULL || isnull(b))
+            {null_error(); exit(EXIT_FAILURE);}
+        if (x0 != NULL && isnull(x0))
+            {null_error(); exit(EXIT_FAILURE);}
+
+        memset(kr, 0, sizeof(*kr));
+        kr->A = A;
+        kr->n = A->n;
+        kr->opts = opts != NULL ? *opts : nd_krylov_defaults();
+        if (kr->opts.precond != NULL && kr->opts.precond->kind != ND_PRECOND_NONE)
+        {
+            if (kr->opts.precond->n != kr->n)
+                mat_error();
+            kr->M = kr->opts.precond;
+        }
+
+        size_t n = kr->n, chunks = (n + KR_CHUNK - 1) / KR_CHUNK;
+        size_t scratch = vectors * n + extra;
+        size_t total = 2 * n + scratch + (kr->opts.max_iters + 1) + chunks;
+        kr->work = malloc(sizeof(double) * total);
+        if (kr->work == NULL)
+            malloc_error();
+        kr->x = kr->work;
+        kr->b = kr->x + n;
+        kr->trace = kr->b + n + scratch;
+        kr->part = kr->trace + kr->opts.max_iters + 1;
+
+        gather(b, n, kr->b);
+        if (x0 != NULL)
+            gather(x0, n, kr->x);
+        else
+            memset(kr->x, 0, sizeof(double) * n);
+        kr->bnorm = sqrt(dot(n, kr->b, kr->b, kr->part));
+        return kr->b + n;
+    }
+
+    // r = b - A x, or b itself for a zero initial guess
+    static void krylov_residual(krylov_t *kr, bool zero_guess, double *r)
+    {
+        if (zero_guess)
+        {
+            memcpy(r, kr->b, sizeof(double) * kr->n);
+            return;
+        }
+        kr->A->apply(kr->x, r, kr->A->ctx);
+        for (size_t i = 0; i < kr->n; i++)
+            r[i] = kr->b[i] - r[i];
+    }
+
+    static void krylov_precond(krylov_t *kr, const double *r, double *z)
+    {
+        if (kr->M != NULL)
+            nd_precond_apply(kr->M, r, z);
+        else if (z != r)
+            memcpy(z, r, sizeof(double) * kr->n);
+    }
+
+    // Appends ||r|| / ||b|| to the trace; true once it is within tolerance
+    static bool krylov_record(krylov_t *kr, double rnorm)
+    {
+        double rel = kr->bnorm > 0.0 ? rnorm / kr->bnorm : 0.0;
+        kr->trace[kr->count] = rel;
+        if (kr->opts.monitor != NULL)
+            kr->opts.monitor(kr->count, rel, kr->opts.monitor_ctx);
+        kr->count++;
+        return rel <= kr->opts.tol;
+    }
+
+    // Recurrences drift from b - A x in finite precision, so a converged one is
+    // checked against the true residual, left in r and in the last trace entry
+    static bool krylov_confirm(krylov_t *kr, double *r)
+    {
+        krylov_residual(kr, false, r);
+        double rel = sqrt(dot(kr->n, r, r, kr->part)) / kr->bnorm;
+        kr->trace[kr->count - 1] = rel;
+        return rel <= kr->opts.tol;
+    }
+
+    static nd_krylov_t krylov_end(krylov_t *kr, ndarray_t *b, bool converged)
+    {
+        nd_krylov_t result = {0};
+        size_t n = kr->n;
+        result.x = array(b->shape[0], b->shape[1]);
+        if (b->shape[1] == 1)
+            for (size_t i = 0; i < n; i++)
+                result.x.data[i][0] = kr->x[i];
+        else
+            memcpy(result.x.data[0], kr->x, sizeof(double) * n);
+
+        result.trace = array(1, kr->count);
+        memcpy(result.trace.data[0], kr->trace, sizeof(double) * kr->count);
+        result.iterations = kr->count - 1;
+        result.residual = kr->trace[kr->count - 1];
+        result.converged = converged;
+        free(kr->work);
+        return result;
+    }
+
+/** Solvers */
+
+    nd_krylov_opts_t nd_krylov_defaults(void)
+    {
+        nd_krylov_opts_t opts = {0};
+        opts.tol = KR_TOL;
+        opts.max_iters = KR_MAX_ITERS;
+        opts.restart = KR_RESTART;
+        return opts;
+    }
+
+    nd_krylov_t nd_cg(const nd_operator_t *A, ndarray_t *b, ndarray_t *x0,
+                      const nd_krylov_opts_t *opts)
+    {
+        krylov_t kr;
+        double *r = krylov_begin(&kr, A, b, x0, opts, 4, 0);
+        size_t n = kr.n;
+        double *p = r + n, *q = p + n;
+        double *z = kr.M != NULL ? q + n : r;
+
+        krylov_residual(&kr, x0 == NULL, r);
+        bool converged = krylov_record(&kr, sqrt(dot(n, r, r, kr.part)));
+        if(converged || kr.bnorm == 0.0)
+            return krylov_end(&kr, b, true);
+
+        krylov_precond(&kr, r, z);
+        memcpy(p, z, sizeof(double) * n);
+        double rz = dot(n, r, z, kr.part);
+        for(size_t it = 0; it < kr.opts.max_iters; it++)
+        {
+            A->apply(p, q, A->ctx);
+            double pq = dot(n, p, q, kr.part);
+            if(!(pq > 0.0))
+                break;      // A or M is not positive definite
+
+            double alpha = rz / pq;
+            axpy(n, alpha, p, kr.x);
+            axpy(n, -alpha, q, r);
+            // A recurrence that converged falsely restarts from the true residual
+            bool restart = false;
+            if(krylov_record(&kr, sqrt(dot(n, r, r, kr.part))))
+            {
+                if((converged = krylov_confirm(&kr, r)))
+                    break;
+                restart = true;
+            }
+
+            krylov_precond(&kr, r, z);
+            double rz_next = dot(n, r, z, kr.part);
+            xpay(n, z, restart ? 0.0 : rz_next / rz, p);
+            rz = rz_next;
+        }
+        return krylov_end(&kr, b, converged);
+    }
+
+    nd_krylov_t nd_bicgstab(const nd_operator_t *A, ndarray_t *b, ndarray_t *x0,
+                            const nd_krylov_opts_t *opts)
+    {
+        krylov_t kr;
+        double *r = krylov_begin(&kr, A, b, x0, opts, 7, 0);
+        size_t n = kr.n;
+        double *r0 = r + n, *p = r0 + n, *v = p + n, *t = v + n;
+        double *p_hat = kr.M != NULL ? t + n : p;
+        double *s_hat = kr.M != NULL ? p_hat + n : r;
+
+        krylov_residual(&kr, x0 == NULL, r);
+        bool converged = krylov_record(&kr, sqrt(dot(n, r, r, kr.part)));
+        if(converged || kr.bnorm == 0.0)
+            return krylov_end(&kr, b, true);
+
+        // fresh: r0 and p start over from r, initially and after a false
+        // convergence of the recurrence
+        bool fresh = true;
+        double rho = 1.0, alpha = 1.0, omega = 1.0;
+        for(size_t it = 0; it < kr.opts.max_iters; it++)
+        {
+            if(fresh)
+                memcpy(r0, r, sizeof(double) * n);
+            double rho_next = dot(n, r0, r, kr.part);
+            if(rho_next == 0.0)
+                break;
+            if(fresh)
+                memcpy(p, r, sizeof(double) * n);
+            else
+            {
+                axpy(n, -omega, v, p);
+                xpay(n, r, (rho_next / rho) * (alpha / omega), p);
+            }
+            rho = rho_next;
+            fresh = false;
+
+            krylov_precond(&kr, p, p_hat);
+            A->apply(p_hat, v, A->ctx);
+            double r0v = dot(n, r0, v, kr.part);
+            if(r0v == 0.0)
+                break;
+            alpha = rho / r0v;
+
+            // s = r - alpha v overwrites r; stop early when it is already small
+            axpy(n, -alpha, v, r);
+            double s_norm = sqrt(dot(n, r, r, kr.part));
+            if(s_norm <= kr.opts.tol * kr.bnorm)
+            {
+                axpy(n, alpha, p_hat, kr.x);
+                krylov_record(&kr, s_norm);
+                if((converged = krylov_confirm(&kr, r)))
+                    break;
+                fresh = true;
+                continue;
+            }
+
+            krylov_precond(&kr, r, s_hat);
+            A->apply(s_hat, t, A->ctx);
+            double tt = dot(n, t, t, kr.part);
+            omega = tt > 0.0 ? dot(n, t, r, kr.part) / tt : 0.0;
+            axpy(n, alpha, p_hat, kr.x);
+            axpy(n, omega, s_hat, kr.x);
+            axpy(n, -omega, t, r);
+            if(krylov_record(&kr, sqrt(dot(n, r, r, kr.part))))
+            {
+                if((converged = krylov_confirm(&kr, r)))
+                    break;
+                fresh = true;
+            }
+            else if(omega == 0.0)
+                break;
+        }
+        return krylov_end(&kr, b, converged);
+    }
+
+    nd_krylov_t nd_gmres(const nd_operator_t *A, ndarray_t *b, ndarray_t *x0,
+                         const nd_krylov_opts_t *opts)
+    {
+        if(A == NULL)
+            {null_error(); exit(EXIT_FAILURE);}
+
+        size_t n = A->n;
+        size_t m = opts != NULL ? opts->restart : KR_RESTART;
+        if(m == 0)
+            index_error();
+        if(m > n)
+            m = n;
+
+        // Basis V (m + 1 vectors), one preconditioned vector, Hessenberg H
+        // by columns, rotations, the rotated right-hand side g and the coefficients y
+        krylov_t kr;
+        double *V = krylov_begin(&kr, A, b, x0, opts, m + 2, (m + 1) * m + 4 * m + 1);
+        double *z = V + (m + 1) * n, *H = z + n;
+        double *cs = H + (m + 1) * m, *sn = cs + m, *g = sn + m, *y = g + m + 1;
+
+        krylov_residual(&kr, x0 == NULL, V);
+        double beta = sqrt(dot(n, V, V, kr.part));
+        bool converged = krylov_record(&kr, beta);
+        if(converged || kr.bnorm == 0.0)
+            return krylov_end(&kr, b, true);
+
+        size_t steps = 0;
+        while(steps < kr.opts.max_iters && beta > 0.0)
+        {
+            for(size_t i = 0; i < n; i++)
+                V[i] /= beta;
+            memset(g, 0, sizeof(double) * (m + 1));
+            g[0] = beta;
+
+            size_t k = 0;
+            bool happy = false;
+            while(k < m && steps < kr.opts.max_iters)
+            {
+                double *w = V + (k + 1) * n, *h = H + k * (m + 1);
+                if(kr.M != NULL)
+                {
+                    nd_precond_apply(kr.M, V + k * n, z);
+                    A->apply(z, w, A->ctx);
+                }
+                else
+                    A->apply(V + k * n, w, A->ctx);
+
+                for(size_t i = 0; i <= k; i++)
+                {
+                    h[i] = dot(n, V + i * n, w, kr.part);
+                    axpy(n, -h[i], V + i * n, w);
+                }
+                h[k + 1] = sqrt(dot(n, w, w, kr.part));
+                happy = h[k + 1] == 0.0;
+                if(!happy)
+                    for(size_t i = 0; i < n; i++)
+                        w[i] /= h[k + 1];
+
+                for(size_t i = 0; i < k; i++)
+                {
+                    double hi = h[i];
+                    h[i] = cs[i] * hi + sn[i] * h[i + 1];
+                    h[i + 1] = -sn[i] * hi + cs[i] * h[i + 1];
+                }
+                double rho = hypot(h[k], h[k + 1]);
+                cs[k] = rho > 0.0 ? h[k] / rho : 1.0;
+                sn[k] = rho > 0.0 ? h[k + 1] / rho : 0.0;
+                h[k] = rho;
+                h[k + 1] = 0.0;
+                g[k + 1] = -sn[k] * g[k];
+                g[k] = cs[k] * g[k];
+
+                k++;
+                steps++;
+                converged = krylov_record(&kr, fabs(g[k]));
+                if(converged || happy)
+                    break;
+            }
+
+            // x += M^-1 V y, with H y = g solved by back substitution
+            for(size_t i = k; i-- > 0;)
+            {
+                double s = g[i];
+                for(size_t j = i + 1; j < k; j++)
+                    s -= H[j * (m + 1) + i] * y[j];
+                y[i] = H[i * (m + 1) + i] != 0.0 ? s / H[i * (m + 1) + i] : 0.0;
+            }
+            double *u = V + k * n;
+            memset(u, 0, sizeof(double) * n);
+            for(size_t i = 0; i < k; i++)
+                axpy(n, y[i], V + i * n, u);
+            if(kr.M != NULL)
+            {
+                nd_precond_apply(kr.M, u, z);
+                axpy(n, 1.0, z, kr.x);
+            }
+            else
+                axpy(n, 1.0, u, kr.x);
+
+            if(converged)
+            {
+                if((converged = krylov_confirm(&kr, V)))
+                    break;
+                beta = kr.trace[kr.count - 1] * kr.bnorm;
+            }
+            else
+            {
+                if(steps >= kr.opts.max_iters)
+                    break;
+                krylov_residual(&kr, false, V);
+                beta = sqrt(dot(n, V, V, kr.part));
+            }
+        }
+        return krylov_end(&kr, b, converged);
+    }
+
+    void nd_krylov_free(nd_krylov_t *result)
+    {
+        if(result == NULL)
+            return;
+        clean(&result->x, &result->trace, NULL);
+    }
+
+/** Small dense eigenproblems */
+
+    // Householder reduction of the row-major m x m matrix a to upper Hessenberg form, similarity
+    // only (the transformations are not kept)
+    static void hessenberg(double *a, size_t m, double *v)
+    {
+        for (size_t k = 0; k + 2 < m; k++)
+        {
+            double alpha = 0.0;
+            for (size_t i = k + 1; i < m; i++)
+                alpha += a[i * m + k] * a[i * m + k];
+            alpha = sqrt(alpha);
+            if (alpha == 0.0)
+                continue;
+            if (a[(k + 1) * m + k] > 0.0)
+                alpha = -alpha;
+
+            double vv = 0.0;
+            for (size_t i = k + 1; i < m; i++)
+            {
+                v[i] = a[i * m + k] - (i == k + 1 ? alpha : 0.0);
+                vv += v[i] * v[i];
+            }
+
+            // a = (I - 2 v vᵀ / vᵀv) a (I - 2 v vᵀ / vᵀv)
+            for (size_t j = k; j < m; j++)
+            {
+                double s = 0.0;
+                for (size_t i = k + 1; i < m; i++)
+                    s += v[i] * a[i * m + j];
+                s *= 2.0 / vv;
+                for (size_t i = k + 1; i < m; i++)
+                    a[i * m + j] -= s * v[i];
+            }
+            for (size_t i = 0; i < m; i++)
+            {
+                double *row = a + i * m;
+                double s = 0.0;
+                for (size_t j = k + 1; j < m; j++)
+                    s += row[j] * v[j];
+                s *= 2.0 / vv;
+                for (size_t j = k + 1; j < m; j++)
+                    row[j] -= s * v[j];
+            }
+            a[(k + 1) * m + k] = alpha;
+            for (size_t i = k + 2; i < m; i++)
+                a[i * m + k] = 0.0;
+        }
+    }
+
+    /*
+     * Eigenvalues of the row-major upper Hessenberg m x m matrix a by the Francis double-shift
+     * QR iteration (EISPACK hqr), with exceptional shifts every 10 sweeps; a is destroyed.
+     * Complex pairs are stored next to each other, positive imaginary part first. False when an
+     * eigenvalue did not converge; the ones left are then the remaining diagonal entries.
+     */
+    #define HQ(i, j) a[((i) - 1) * m + (j) - 1]
+    static bool hessenberg_qr(double *a, size_t m, double *wr, double *wi)
+    {
+        double anorm = 0.0;
+        for (size_t i = 1; i <= m; i++)
+            for (size_t j = (i > 1 ? i - 1 : 1); j <= m; j++)
+                anorm += fabs(HQ(i, j));
+
+        long nn = (long)m, l;
+        double t = 0.0, p = 0.0, q = 0.0, r = 0.0, x, y, z, w, s;
+        while (nn >= 1)
+        {
+            int its = 0;
+            do
+            {
+                for (l = nn; l >= 2; l--)
+                {
+                    s = fabs(HQ(l - 1, l - 1)) + fabs(HQ(l, l));
+                    if (s == 0.0)
+                        s = anorm;
+                    if (fabs(HQ(l, l - 1)) + s == s)
+                    {
+                        HQ(l, l - 1) = 0.0;
+                        break;
+                    }
+                }
+                x = HQ(nn, nn);
+                if (l == nn)
+                {
+                    wr[nn - 1] = x + t;
+                    wi[nn - 1] = 0.0;
+                    nn--;
+                }
+                else
+                {
+                    y = HQ(nn - 1, nn - 1);
+                    w = HQ(nn, nn - 1) * HQ(nn - 1, nn);
+                    if (l == nn - 1)
+                    {
+                        p = 0.5 * (y - x);
+                        q = p * p + w;
+                        z = sqrt(fabs(q));
+                        x += t;
+                        if (q >= 0.0)
+                        {
+                            z = p + copysign(z, p);
+                            wr[nn - 2] = wr[nn - 1] = x + z;
+                            if (z != 0.0)
+                                wr[nn - 1] = x - w / z;
+                            wi[nn - 2] = wi[nn - 1] = 0.0;
+                        }
+                        else
+                        {
+                            wr[nn - 2] = wr[nn - 1] = x + p;
+                            wi[nn - 2] = z;
+                            wi[nn - 1] = -z;
+                        }
+                        nn -= 2;
+                    }
+                    else
+                    {
+                        if (its == EG_QR_ITERS)
+                        {
+                            for (long i = 1; i <= nn; i++)
+                            {
+                                wr[i - 1] = HQ(i, i) + t;
+                                wi[i - 1] = 0.0;
+                            }
+                            return false;
+                        }
+                        if (its % 10 == 0 && its > 0)
+                        {
+                            t += x;
+                            for (long i = 1; i <= nn; i++)
+                                HQ(i, i) -= x;
+                            s = fabs(HQ(nn, nn - 1)) + fabs(HQ(nn - 1, nn - 2));
+                            y = x = 0.75 * s;
+                            w = -0.4375 * s * s;
+                        }
+                        its++;
+
+                        long mm;
+                        for (mm = nn - 2; mm >= l; mm--)
+                        {
+                            z = HQ(mm, mm);
+                            r = x - z;
+                            s = y - z;
+                            p = (r * s - w) / HQ(mm + 1, mm) + HQ(mm, mm + 1);
+                            q = HQ(mm + 1, mm + 1) - z - r - s;
+                            r = HQ(mm + 2, mm + 1);
+                            s = fabs(p) + fabs(q) + fabs(r);
+                            p /= s;
+                            q /= s;
+                            r /= s;
+                            if (mm == l)
+                                break;
+                            double u = fabs(HQ(mm, mm - 1)) * (fabs(q) + fabs(r));
+                            double v = fabs(p) * (fabs(HQ(mm - 1, mm - 1)) + fabs(z) + fabs(HQ(mm + 1, mm + 1)));
+                            if (u + v == v)
+                                break;
+                        }
+                        for (long i = mm + 2; i <= nn; i++)
+                        {
+                            HQ(i, i - 2) = 0.0;
+                            if (i != mm + 2)
+                                HQ(i, i - 3) = 0.0;
+                        }
+
+                        // Chase the bulge down with 3 x 3 Householder reflections
+                        for (long k = mm; k <= nn - 1; k++)
+                        {
+                            if (k != mm)
+                            {
+                                p = HQ(k, k - 1);
+                                q = HQ(k + 1, k - 1);
+                                r = k != nn - 1 ? HQ(k + 2, k - 1) : 0.0;
+                                if ((x = fabs(p) + fabs(q) + fabs(r)) != 0.0)
+                                {
+                                    p /= x;
+                                    q /= x;
+                                    r /= x;
+                                }
+                            }
+                            if ((s = copysign(sqrt(p * p + q * q + r * r), p)) == 0.0)
+                                continue;
+                            if (k == mm)
+                            {
+                                if (l != mm)
+                                    HQ(k, k - 1) = -HQ(k, k - 1);
+                            }
+                            else
+                                HQ(k, k - 1) = -s * x;
+                            p += s;
+                            x = p / s;
+                            y = q / s;
+                            z = r / s;
+                            q /= p;
+                            r /= p;
+                            for (long j = k; j <= nn; j++)
+                            {
+                                p = HQ(k, j) + q * HQ(k + 1, j);
+                                if (k != nn - 1)
+                                {
+                                    p += r * HQ(k + 2, j);
+                                    HQ(k + 2, j) -= p * z;
+                                }
+                                HQ(k + 1, j) -= p * y;
+                                HQ(k, j) -= p * x;
+                            }
+                            long last = nn < k + 3 ? nn : k + 3;
+                            for (long i = l; i <= last; i++)
+                            {
+                                p = x * HQ(i, k) + y * HQ(i, k + 1);
+                                if (k != nn - 1)
+                                {
+                                    p += z * HQ(i, k + 2);
+                                    HQ(i, k + 2) -= p * r;
+                                }
+                                HQ(i, k + 1) -= p * q;
+                                HQ(i, k) -= p;
+                            }
+                        }
+                    }
+                }
+            } while (l < nn - 1);
+        }
+        return true;
+    }
+    #undef HQ
+
+    // Unit eigenvector y of the row-major m x m matrix H for the eigenvalue λ, by two steps of
+    // inverse iteration with a complex LU of H - λI; lu holds m² values and piv m
+    static void inverse_iteration(const double *H, size_t m, double complex lambda, double hnorm,
+                                  double complex *y, double complex *lu, size_t *piv)
+    {
+        // An exactly singular H - λI would leave a zero pivot; shift λ by the rounding level
+        double small = (hnorm > 0.0 ? hnorm : 1.0) * DBL_EPSILON;
+        lambda += small;
+        for (size_t i = 0; i < m; i++)
+            for (size_t j = 0; j < m; j++)
+                lu[i * m + j] = H[i * m + j] - (i == j ? lambda : 0.0);
+
+        for (size_t k = 0; k < m; k++)
+        {
+            size_t best = k;
+            for (size_t i = k + 1; i < m; i++)
+                if (cabs(lu[i * m + k]) > cabs(lu[best * m + k]))
+                    best = i;
+            piv[k] = best;
+            if (best != k)
+                for (size_t j = 0; j < m; j++)
+                {
+                    double complex t = lu[k * m + j];
+                    lu[k * m + j] = lu[best * m + j];
+                    lu[best * m + j] = t;
+                }
+            if (lu[k * m + k] == 0.0)
+                lu[k * m + k] = small;
+            for (size_t i = k + 1; i < m; i++)
+            {
+                double complex l = lu[i * m + k] /= lu[k * m + k];
+                for (size_t j = k + 1; j < m; j++)
+                    lu[i * m + j] -= l * lu[k * m + j];
+            }
+        }
+
+        for (size_t i = 0; i < m; i++)
+            y[i] = 1.0;
+        for (int step = 0; step < 2; step++)
+        {
+            for (size_t k = 0; k < m; k++)
+            {
+                double complex t = y[k];
+                y[k] = y[piv[k]];
+                y[piv[k]] = t;
+            }
+            for (size_t i = 0; i < m; i++)
+                for (size_t j = 0; j < i; j++)
+                    y[i] -= lu[i * m + j] * y[j];
+            for (size_t i = m; i-- > 0;)
+            {
+                for (size_t j = i + 1; j < m; j++)
+                    y[i] -= lu[i * m + j] * y[j];
+                y[i] /= lu[i * m + i];
+            }
+
+            double norm = 0.0;
+            for (size_t i = 0; i < m; i++)
+                norm += creal(y[i]) * creal(y[i]) + cimag(y[i]) * cimag(y[i]);
+            norm = sqrt(norm);
+            for (size_t i = 0; i < m; i++)
+                y[i] /= norm;
+        }
+    }
+
+/** Eigensolvers */
+
+typedef struct {
+    double re, im;      // Ritz value
+    double residual;    // |A x - θ x| of its Ritz vector
+    size_t index;       // column of the eigenvectors of H (symmetric case)
+} ritz_t;
+
+typedef struct {
+    const nd_operator_t *A;
+    nd_eigs_opts_t opts;
+    bool symmetric;
+    size_t n, m;                // dimension, basis size
+    ndarray_t V;                // m + 1 basis vectors as rows
+    double *H;                  // (m + 1) x m projected matrix, row-major
+    ndarray_t h;                // 1 x (m + 1) Gram-Schmidt coefficients
+    double *part;               // chunk sums of dot()
+    lcg64_t gen;                // start and breakdown vectors
+    size_t matvecs;
+} eigs_t;
+
+    // Row j of V: uniform random values, or zero once the basis spans the whole space
+    static void eigs_random(eigs_t *es, size_t j)
+    {
+        double *v = es->V.data[j];
+        for (size_t i = 0; i < es->n; i++)
+            v[i] = j < es->n ? 2.0 * lcg64_next_uniform(&es->gen) - 1.0 : 0.0;
+    }
+
+    // Orthogonalizes row count of V against rows [0, count) by classical Gram-Schmidt applied
+    // twice, both products running through nd_gemm(); the coefficients are added to coeff[0..count)
+    // with stride m. Returns the norm left
+    static double eigs_orthogonalize(eigs_t *es, size_t count, double *coeff)
+    {
+        ndarray_t basis = nd_view(&es->V, 0, 0, count, es->n);
+        ndarray_t w = nd_view(&es->V, count, 0, 1, es->n);
+        ndarray_t h = nd_view(&es->h, 0, 0, 1, count);
+        for (int pass = 0; pass < 2; pass++)
+        {
+            nd_gemm(ND_NO_TRANS, ND_TRANS, 1.0, &w, &basis, 0.0, &h);
+            nd_gemm(ND_NO_TRANS, ND_NO_TRANS, -1.0, &h, &basis, 1.0, &w);
+            if (coeff != NULL)
+                for (size_t i = 0; i < count; i++)
+                    coeff[i * es->m] += es->h.data[0][i];
+        }
+        nd_view_free(&basis);
+        nd_view_free(&w);
+        nd_view_free(&h);
+
+        const double *x = es->V.data[count];
+        return sqrt(dot(es->n, x, x, es->part));
+    }
+
+    static void eigs_normalize(eigs_t *es, size_t j, double norm)
+    {
+        double *v = es->V.data[j];
+        for (size_t i = 0; i < es->n; i++)
+            v[i] /= norm;
+    }
+
+    // Arnoldi steps for columns [j0, m) of H
+    static void eigs_extend(eigs_t *es, size_t j0)
+    {
+        size_t n = es->n, m = es->m;
+        for (size_t j = j0; j < m; j++)
+        {
+            double *w = es->V.data[j + 1];
+            es->A->apply(es->V.data[j], w, es->A->ctx);
+            es->matvecs++;
+
+            double wnorm = sqrt(dot(n, w, w, es->part));
+            for (size_t i = 0; i <= j; i++)
+                es->H[i * m + j] = 0.0;
+            double beta = eigs_orthogonalize(es, j + 1, es->H + j);
+
+            // A v_j lies in the basis: continue from a random vector, with a zero subdiagonal
+            if (beta <= EG_BREAKDOWN * wnorm)
+            {
+                eigs_random(es, j + 1);
+                beta = eigs_orthogonalize(es, j + 1, NULL);
+                es->H[(j + 1) * m + j] = 0.0;
+            }
+            else
+                es->H[(j + 1) * m + j] = beta;
+            if (beta > 0.0)
+                eigs_normalize(es, j + 1, beta);
+        }
+    }
+
+    // True when a comes before b in the order of opts.which; conjugate pairs stay adjacent
+    static bool ritz_before(const ritz_t *a, const ritz_t *b, nd_eigs_which_t which)
+    {
+        double ka, kb;
+        switch (which)
+        {
+        case ND_EIGS_LARGEST:
+            ka = a->re;
+            kb = b->re;
+            break;
+        case ND_EIGS_SMALLEST:
+            ka = -a->re;
+            kb = -b->re;
+            break;
+        default:
+            ka = hypot(a->re, a->im);
+            kb = hypot(b->re, b->im);
+            break;
+        }
+        return ka > kb || (ka == kb && a->im > b->im);
+    }
+
+    /*
+     * Ritz values of H_m sorted in the wanted order and, for the first count, the residual
+     * |β e_mᵀ y| and column i of the real m x count matrix Y: the Ritz vector of a real value, or
+     * the real and imaginary parts of the vector of a pair in its two columns. False when the
+     * small eigenproblem did not converge.
+     */
+    static bool eigs_ritz(eigs_t *es, ritz_t *ritz, size_t count, double *Y)
+    {
+        size_t m = es->m;
+        double beta = fabs(es->H[m * m + m - 1]);
+        double *Hm = malloc(sizeof(double) * m * m);
+        if (Hm == NULL)
+            malloc_error();
+
+        if (es->symmetric)
+        {
+            ndarray_t S = array(m, m);
+            for (size_t i = 0; i < m; i++)
+                for (size_t j = 0; j <= i; j++)
+                    S.data[i][j] = S.data[j][i] = 0.5 * (es->H[i * m + j] + es->H[j * m + i]);
+            nd_eigh_t eh = nd_eigh(&S, true);
+            bool ok = eh.converged;
+            for (size_t i = 0; i < m; i++)
+                ritz[i] = (ritz_t){eh.values.data[0][i], 0.0, beta * fabs(eh.vectors.data[m - 1][i]), i};
+            for (size_t i = 1; i < m; i++)
+                for (size_t j = i; j > 0 && ritz_before(&ritz[j], &ritz[j - 1], es->opts.which); j--)
+                {
+                    ritz_t t = ritz[j];
+                    ritz[j] = ritz[j - 1];
+                    ritz[j - 1] = t;
+                }
+            for (size_t i = 0; i < m; i++)
+                for (size_t c = 0; c < count; c++)
+                    Y[i * count + c] = eh.vectors.data[i][ritz[c].index];
+            nd_eigh_free(&eh);
+            clean(&S, NULL);
+            free(Hm);
+            return ok;
+        }
+
+        double *wr = malloc(sizeof(double) * m * 2), *wi = wr + m;
+        double complex *y = malloc(sizeof(double complex) * m * (m + 1));
+        size_t *piv = malloc(sizeof(size_t) * m);
+        if (wr == NULL || y == NULL || piv == NULL)
+            malloc_error();
+
+        double hnorm = 0.0;
+        for (size_t i = 0; i < m * m; i++)
+            hnorm += es->H[i] * es->H[i];
+        hnorm = sqrt(hnorm);
+        memcpy(Hm, es->H, sizeof(double) * m * m);
+        hessenberg(Hm, m, wr);
+        bool ok = hessenberg_qr(Hm, m, wr, wi);
+        for (size_t i = 0; i < m; i++)
+            ritz[i] = (ritz_t){wr[i], wi[i], 0.0, i};
+        for (size_t i = 1; i < m; i++)
+            for (size_t j = i; j > 0 && ritz_before(&ritz[j], &ritz[j - 1], es->opts.which); j--)
+            {
+                ritz_t t = ritz[j];
+                ritz[j] = ritz[j - 1];
+                ritz[j - 1] = t;
+            }
+
+        // Vectors by inverse iteration, once per pair
+        for (size_t i = 0; i < count; i++)
+        {
+            if (i > 0 && ritz[i].im < 0.0 && ritz[i - 1].im == -ritz[i].im)
+            {
+                ritz[i].residual = ritz[i - 1].residual;
+                continue;
+            }
+            inverse_iteration(es->H, m, CMPLX(ritz[i].re, ritz[i].im), hnorm, y, y + m, piv);
+            ritz[i].residual = beta * cabs(y[m - 1]);
+            for (size_t r = 0; r < m; r++)
+                Y[r * count + i] = creal(y[r]);
+            if (ritz[i].im != 0.0 && i + 1 < count)
+                for (size_t r = 0; r < m; r++)
+                    Y[r * count + i + 1] = cimag(y[r]);
+        }
+        free(wr);
+        free(y);
+        free(piv);
+        free(Hm);
+        return ok;
+    }
+
+    // Number of leading Ritz values to take so that no conjugate pair is split
+    static size_t ritz_take(const ritz_t *ritz, size_t count, size_t limit)
+    {
+        if (count > 0 && count < limit && ritz[count - 1].im > 0.0)
+            count++;
+        else if (count > 0 && count == limit && ritz[count - 1].im > 0.0)
+            count--;
+        return count;
+    }
+
+    /*
+     * Thick restart: with Q the orthonormalized first keep columns of Y, V[0, keep) = Qᵀ V_m,
+     * V[keep] = v_{m+1}, and H becomes Qᵀ H_m Q bordered below by β e_mᵀ Q, which keeps
+     * A V_keep = V_keep H_keep + v_{m+1} bᵀ exact up to rounding. Returns keep, less any column of
+     * Y dependent on the ones before it.
+     */
+    static size_t eigs_restart(eigs_t *es, double *Y, size_t cols, size_t keep)
+    {
+        size_t m = es->m, n = es->n;
+
+        // Modified Gram-Schmidt, twice, on the columns of Y
+        ndarray_t Q = array(m, keep);
+        size_t q = 0;
+        for (size_t c = 0; c < keep; c++)
+        {
+            double norm0 = 0.0, norm = 0.0;
+            for (size_t i = 0; i < m; i++)
+                norm0 += Y[i * cols + c] * Y[i * cols + c];
+            for (int pass = 0; pass < 2; pass++)
+                for (size_t p = 0; p < q; p++)
+                {
+                    double s = 0.0;
+                    for (size_t i = 0; i < m; i++)
+                        s += Q.data[i][p] * Y[i * cols + c];
+                    for (size_t i = 0; i < m; i++)
+                        Y[i * cols + c] -= s * Q.data[i][p];
+                }
+            for (size_t i = 0; i < m; i++)
+                norm += Y[i * cols + c] * Y[i * cols + c];
+            if (!(norm > EG_BREAKDOWN * EG_BREAKDOWN * norm0))
+                continue;
+            norm = sqrt(norm);
+            for (size_t i = 0; i < m; i++)
+                Q.data[i][q] = Y[i * cols + c] / norm;
+            q++;
+        }
+        keep = q;
+
+        // S = Qᵀ H_m Q and b = β Q[m - 1]
+        double beta = es->H[m * m + m - 1];
+        double *S = calloc(keep * keep + m * keep, sizeof(double)), *HQ = S + keep * keep;
+        if (S == NULL)
+            malloc_error();
+        for (size_t i = 0; i < m; i++)
+            for (size_t p = 0; p < m; p++)
+            {
+                double hip = es->H[i * m + p];
+                if (hip != 0.0)
+                    for (size_t c = 0; c < keep; c++)
+                        HQ[i * keep + c] += hip * Q.data[p][c];
+            }
+        for (size_t i = 0; i < m; i++)
+            for (size_t r = 0; r < keep; r++)
+                for (size_t c = 0; c < keep; c++)
+                    S[r * keep + c] += Q.data[i][r] * HQ[i * keep + c];
+
+        memset(es->H, 0, sizeof(double) * (m + 1) * m);
+        for (size_t r = 0; r < keep; r++)
+            for (size_t c = 0; c < keep; c++)
+                es->H[r * m + c] = S[r * keep + c];
+        for (size_t c = 0; c < keep; c++)
+            es->H[keep * m + c] = beta * Q.data[m - 1][c];
+        free(S);
+
+        // The new rows are built aside and their storage swapped into V
+        ndarray_t Vm = nd_view(&es->V, 0, 0, m, n);
+        ndarray_t W = array(keep, n);
+        nd_gemm(ND_TRANS, ND_NO_TRANS, 1.0, &Q, &Vm, 0.0, &W);
+        nd_view_free(&Vm);
+        for (size_t r = 0; r < keep; r++)
+        {
+            double *t = es->V.data[r];
+            es->V.data[r] = W.data[r];
+            W.data[r] = t;
+        }
+        double *t = es->V.data[keep];
+        es->V.data[keep] = es->V.data[m];
+        es->V.data[m] = t;
+        clean(&Q, &W, NULL);
+        return keep;
+    }
+
+    static nd_eigs_t eigs_run(const nd_operator_t *A, size_t k, const nd_eigs_opts_t *opts, bool symmetric)
+    {
+        if(A == NULL || A->apply == NULL)
+            {null_error(); exit(EXIT_FAILURE);}
+        size_t n = A->n;
+        if(k == 0 || k >= n)
+            index_error();
+
+        eigs_t es = {0};
+        es.A = A;
+        es.opts = opts != NULL ? *opts : nd_eigs_defaults();
+        es.symmetric = symmetric;
+        es.n = n;
+        size_t m = es.opts.basis > 0 ? es.opts.basis : 2 * k + 1;
+        if(es.opts.basis == 0 && m < EG_MIN_BASIS)
+            m = EG_MIN_BASIS;
+        if(m < k + 2)
+            m = k + 2;
+        es.m = m = m < n ? m : n;
+
+        es.V = array(m + 1, n);
+        es.h = array(1, m + 1);
+        es.H = calloc((m + 1) * m, sizeof(double));
+        es.part = malloc(sizeof(double) * ((n + KR_CHUNK - 1) / KR_CHUNK));
+        ritz_t *ritz = malloc(sizeof(ritz_t) * m);
+        double *Y = malloc(sizeof(double) * m * m);
+        if(es.H == NULL || es.part == NULL || ritz == NULL || Y == NULL)
+            malloc_error();
+        lcg64_seed(&es.gen, es.opts.seed);
+
+        eigs_random(&es, 0);
+        const double *v0 = es.V.data[0];
+        eigs_normalize(&es, 0, sqrt(dot(n, v0, v0, es.part)));
+
+        // Ritz vectors are formed for the values a restart keeps, k + (m - k) / 2 and a partner
+        size_t cols = k + (m - k) / 2 + 1 < m ? k + (m - k) / 2 + 1 : m;
+        nd_eigs_t result = {0};
+        size_t start = 0, want = 0;
+        for(;;)
+        {
+            eigs_extend(&es, start);
+            bool ok = eigs_ritz(&es, ritz, cols, Y);
+            want = ritz_take(ritz, k, cols);
+
+            double hnorm = 0.0;
+            for(size_t i = 0; i < m * m; i++)
+                hnorm += es.H[i] * es.H[i];
+            double floor = DBL_EPSILON * sqrt(hnorm);
+            size_t done = 0;
+            for(size_t i = 0; i < want; i++)
+            {
+                double scale = hypot(ritz[i].re, ritz[i].im);
+                done += ritz[i].residual <= es.opts.tol * (scale > floor ? scale : floor);
+            }
+            result.converged = ok && done == want;
+            if(result.converged || !ok || result.restarts == es.opts.max_restarts)
+                break;
+
+            size_t keep = ritz_take(ritz, k + (m - k) / 2, cols - 1);
+            start = eigs_restart(&es, Y, cols, keep > want ? keep : want);
+            result.restarts++;
+        }
+
+        // x = V_m y for the wanted pairs, each of unit norm as V_m is orthonormal
+        result.values = zeros(1, want);
+        result.imag = zeros(1, want);
+        ndarray_t Ym = array(m, want);
+        for(size_t c = 0; c < want; c++)
+        {
+            result.values.data[0][c] = ritz[c].re;
+            result.imag.data[0][c] = ritz[c].im;
+            for(size_t i = 0; i < m; i++)
+                Ym.data[i][c] = Y[i * cols + c];
+        }
+        ndarray_t Vm = nd_view(&es.V, 0, 0, m, n);
+        result.vectors = zeros(n, want);
+        nd_gemm(ND_TRANS, ND_NO_TRANS, 1.0, &Vm, &Ym, 0.0, &result.vectors);
+        nd_view_free(&Vm);
+        result.matvecs = es.matvecs;
+
+        clean(&es.V, &es.h, &Ym, NULL);
+        free(es.H);
+        free(es.part);
+        free(ritz);
+        free(Y);
+        return result;
+    }
+
+    nd_eigs_opts_t nd_eigs_defaults(void)
+    {
+        nd_eigs_opts_t opts = {ND_EIGS_MAGNITUDE, 0, EG_TOL, EG_MAX_RESTARTS, 0};
+        return opts;
+    }
+
+    nd_eigs_t nd_lanczos(const nd_operator_t *A, size_t k, const nd_eigs_opts_t *opts)
+    {
+        return eigs_run(A, k, opts, true);
+    }
+
+    nd_eigs_t nd_arnoldi(const nd_operator_t *A, size_t k, const nd_eigs_opts_t *opts)
+    {
+        return eigs_run(A, k, opts, false);
+    }
+
+    void nd_eigs_free(nd_eigs_t *result)
+    {
+        if(result == NULL)
+            return;
+        clean(&result->values, &result->imag, &result->vectors, NULL);
+    }
+
+#pragma GCC pop_options
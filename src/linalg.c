@@ -5,6 +5,11 @@
 #include <ndmath/error.h>
 #include <ndmath/conditionals.h>
 #include <ndmath/operations.h>
+#include <ndmath/reduce.h>
+#include <ndmath/blas.h>
+#include <ndmath/decomp.h>
+#include <ndmath/cache.h>
+#include <ndmath/backend.h>
 #include <math.h>
 
 
@@ -15,273 +20,474 @@
         if(issquare(this))
             {shape_error(); exit(EXIT_FAILURE);}
 
-        ndarray_t I = identity(this->shape[0], this->shape[1]);
-        ndarray_t arr = copy(this);
+        // Reuses the factorization when the cache is enabled (see cache.h)
+        nd_factorization_t *f = nd_cache_acquire(this, ND_FACT_LU);
+        if(f->lu.singular)
+            singular_error();
 
-        size_t i=0, j=0, k=0;
+        ndarray_t I = identity(this->shape[0], this->shape[1]);
+        ndarray_t result = nd_lu_solve(&f->lu, &I);
 
-        for(j=0; j<arr.shape[0]; j++)//j
-        {
-            double pivot = arr.data[j][j];
+        clean(&I, NULL);
+        nd_cache_release(f);
 
-            for(k=0; k<arr.shape[0]; k++)//k
-            {
-                arr.data[j][k] = arr.data[j][k]/pivot;
-                I.data[j][k] = I.data[j][k]/pivot;
-            }
+        return result;
+    }
 
-            for(i=0; i<this->shape[0]; i++)//i
-            {
-                if(j!=i)
-                {
-                    double coef = arr.data[i][j];
+    bool nd_inv_update(ndarray_t *inverse, ndarray_t *U, ndarray_t *V)
+    {
+        if(isnull(inverse) || isnull(U) || isnull(V))
+            {null_error(); exit(EXIT_FAILURE);}
+        if(issquare(inverse))
+            {shape_error(); exit(EXIT_FAILURE);}
 
-                    for(k=0; k<arr.shape[0]; k++)
-                    {
-                        arr.data[i][k] = arr.data[i][k] - coef *arr.data[j][k];
-                        I.data[i][k] = I.data[i][k] - coef * I.data[j][k];
-                    }
-                }
-            }
+        size_t n = inverse->shape[0], k = U->shape[1];
+        if(U->shape[0] != n || V->shape[0] != n || V->shape[1] != k)
+        {
+            fprintf(stderr, "Invalid dimensions %ldx%ld and %ldx%ld for an update of a %ldx%ld inverse\n",
+                    U->shape[0], U->shape[1], V->shape[0], V->shape[1], n, n);
+            perror("Use valid ndarray_t dimesions please\n");
+            exit(1);
         }
 
-        clean(&arr, NULL);
+        // (A + U Vᵀ)⁻¹ = A⁻¹ - Y S⁻¹ Z with Y = A⁻¹ U, Z = Vᵀ A⁻¹ and S = I + Vᵀ Y, k x k
+        ndarray_t Y = zeros(n, k), Z = zeros(k, n), S = identity(k, k);
+        nd_gemm(ND_NO_TRANS, ND_NO_TRANS, 1.0, inverse, U, 0.0, &Y);
+        nd_gemm(ND_TRANS, ND_NO_TRANS, 1.0, V, inverse, 0.0, &Z);
+        nd_gemm(ND_TRANS, ND_NO_TRANS, 1.0, V, &Y, 1.0, &S);
+
+        nd_lu_t lu = nd_lu(&S);
+        bool invertible = !lu.singular;
+        if(invertible)
+        {
+            ndarray_t W = nd_lu_solve(&lu, &Z);
+            nd_gemm(ND_NO_TRANS, ND_NO_TRANS, -1.0, &Y, &W, 1.0, inverse);
+            clean(&W, NULL);
+        }
 
-        return I;
+        nd_lu_free(&lu);
+        clean(&Y, &Z, &S, NULL);
+        return invertible;
     }
 
     ndarray_t norm(ndarray_t *this, char *axis) // Calculates only Euclidean distance
     {
         if(isnull(this))
             {null_error(); exit(EXIT_FAILURE);}
-        double temp=0;
 
-        if(strcmp(axis, "x")==0)
-        {
-            ndarray_t result = array(this->shape[0],1);
+        ndarray_t result = nd_reduce_axis(this, axis, ND_REDUCE_SUMSQ, NULL);
 
-           for(size_t i=0; i<this->shape[0]; i++)
+        for(size_t i=0; i<result.shape[0]; i++)
+        {
+            for(size_t j=0; j<result.shape[1]; j++)
             {
-                for(size_t j=0; j<this->shape[1]; j++)
-                {        
-                    temp += pow(this->data[i][j], 2);
-                }
-
-                result.data[i][0] = sqrt(temp);
-                
-                temp = 0;
+                result.data[i][j] = sqrt(result.data[i][j]);
             }
+        }
+        return result;
+    }
 
-            return result;
+    double det(ndarray_t *this) 
+    {
+        if(isnull(this))
+            {null_error(); exit(EXIT_FAILURE);}
+        if(issquare(this))
+            {shape_error(); exit(EXIT_FAILURE);}
+
+        // det(A) = sign(P) * prod(diag(U)) for PA = LU
+        nd_factorization_t *f = nd_cache_acquire(this, ND_FACT_LU);
+        const nd_lu_t *lu = &f->lu;
+        double determinant = lu->sign;
+        for (size_t i = 0; i < lu->LU.shape[0]; i++)
+            determinant *= lu->LU.data[i][i];
+        if (lu->singular)
+            determinant = 0.0;
+
+        nd_cache_release(f);
+        
+        return determinant;
+    }
+
+
+    nd_slogdet_t nd_slogdet(ndarray_t *this)
+    {
+        if(isnull(this))
+            {null_error(); exit(EXIT_FAILURE);}
+        if(issquare(this))
+            {shape_error(); exit(EXIT_FAILURE);}
+
+        nd_factorization_t *f = nd_cache_acquire(this, ND_FACT_LU);
+        const nd_lu_t *lu = &f->lu;
+        nd_slogdet_t result = { (double)lu->sign, 0.0 };
+        for (size_t i = 0; i < lu->LU.shape[0]; i++)
+        {
+            double u = lu->LU.data[i][i];
+            if (u < 0.0)
+                result.sign = -result.sign;
+            result.logabsdet += log(fabs(u));
         }
-        else if(strcmp(axis, "y")==0)
+        if (lu->singular)
         {
-            ndarray_t result = array(1, this->shape[1]);
+            result.sign = 0.0;
+            result.logabsdet = -INFINITY;
+        }
 
-            for(size_t i=0; i<this->shape[1]; i++)
-            {
-                for(size_t j=0; j<this->shape[0]; j++)
-                {        
-                    temp += pow(this->data[j][i], 2);
-                }
+        nd_cache_release(f);
 
-             
-                result.data[0][i] = sqrt(temp);
+        return result;
+    }
 
-                temp = 0; 
-            }
 
-            return result;
+    void qr(ndarray_t *this, ndarray_t *Q, ndarray_t *R)
+    {
+        if(!Q || !R)
+        {
+            not_null_error();    
         }
-        else if(strcmp(axis, "all")==0)
+
+        if(isnull(this))
+            {null_error(); exit(EXIT_FAILURE);}
+
+        if(!nd_backend_qr(this, Q, R))
         {
-            ndarray_t result = array(1, 1);
-            for(size_t i=0; i<this->shape[0]; i++)
-            {
-                for(size_t j=0; j<this->shape[1]; j++)
-                {        
-                    temp += pow(this->data[i][j], 2);
-                }
-            }
+            nd_qr_t f = nd_qr(this, false);
+            *Q = nd_qr_q(&f, true);
+            *R = nd_qr_r(&f);
+            nd_qr_free(&f);
+        }
 
-            result.data[0][0] = sqrt(temp);
+        // Householder leaves the signs of R's diagonal free; make it non-negative
+        for(size_t i = 0; i < R->shape[0]; i++)
+        {
+            if(R->data[i][i] >= 0.0)
+                continue;
+            for(size_t j = i; j < R->shape[1]; j++)
+                R->data[i][j] = -R->data[i][j];
+            for(size_t r = 0; r < Q->shape[0]; r++)
+                Q->data[r][i] = -Q->data[r][i];
+        }
+    }
 
+    #pragma GCC optimize("O3", "unroll-loops")
+    ndarray_t matmul(ndarray_t *this, ndarray_t *arrayB)
+    {
+       if(isnull(this))
+            {null_error(); exit(EXIT_FAILURE);}
+        if(isnull(arrayB))
+            {null_error(); exit(EXIT_FAILURE);}
 
+        ndarray_t result  = {0};
+        if(this->shape[1] == arrayB->shape[0])
+        {
+            result = array(this->shape[0], arrayB->shape[1]);
+            nd_gemm(ND_NO_TRANS, ND_NO_TRANS, 1.0, this, arrayB, 0.0, &result);
             return result;
         }
+        
         else
         {
-            axis_error(axis);
+            fprintf(stderr, "Invalid dimensions %ldx%ld and %ldx%ld for array multiplication\n", this->shape[0], this->shape[1], arrayB->shape[0], arrayB->shape[1]);
+            perror("Use valid ndarray_t dimesions please\n");
             exit(1);
         }
+    }
 
+
+
+    // Swaps the storage of two arrays of the same shape: the ping-pong buffers of the products below
+    static void swap_arrays(ndarray_t *a, ndarray_t *b)
+    {
+        ndarray_t t = *a;
+        *a = *b;
+        *b = t;
     }
 
-    double det(ndarray_t *this) 
+    #pragma GCC optimize("O3", "unroll-loops")
+    ndarray_t nd_matrix_power(ndarray_t *this, long k)
     {
+        if(isnull(this))
+            {null_error(); exit(EXIT_FAILURE);}
         if(issquare(this))
             {shape_error(); exit(EXIT_FAILURE);}
 
-        double determinant = 1.0;
-
-        ndarray_t arr = array(this->shape[0], this->shape[1]);
-        arr = copy(this);
-
-        for (size_t j = 0; j < arr.shape[0]; j++) 
+        size_t n = this->shape[0];
+        if(k == 0)
+            return identity(n, n);
+
+        // A⁻ᵏ = (A⁻¹)ᵏ; the magnitude is taken unsigned so that LONG_MIN does not overflow
+        unsigned long e = k < 0 ? 0UL - (unsigned long)k : (unsigned long)k;
+        ndarray_t inverse = {0};
+        if(k < 0)
+            inverse = inv(this);
+        ndarray_t *base = k < 0 ? &inverse : this;
+
+        // Binary exponentiation over three n x n buffers: result, the current square and a
+        // scratch product swapped with whichever was just recomputed
+        ndarray_t result = {0}, square = {0}, scratch = array(n, n);
+        for(;;)
         {
-            size_t maxRow = j;
-            double maxVal = arr.data[j][j];
-
-            // Find the maximum absolute value element in column j from rows j to n
-            for (size_t i = j + 1; i < arr.shape[0]; i++) {
-                if (arr.data[i][j] > maxVal) {
-                    maxVal = arr.data[i][j];
-                    maxRow = i;
+            if(e & 1)
+            {
+                if(result.data == NULL)
+                    result = copy(base);
+                else
+                {
+                    nd_gemm(ND_NO_TRANS, ND_NO_TRANS, 1.0, &result, base, 0.0, &scratch);
+                    swap_arrays(&result, &scratch);
                 }
             }
+            e >>= 1;
+            if(e == 0)
+                break;
+
+            if(square.data == NULL)
+                square = array(n, n);
+            nd_gemm(ND_NO_TRANS, ND_NO_TRANS, 1.0, base, base, 0.0, &scratch);
+            swap_arrays(&square, &scratch);
+            base = &square;
+        }
 
-            // Swap the row with maxVal with the current row
-            if (maxRow != j) {
-                for (size_t k = 0; k < arr.shape[0]; k++) {
-                    double temp = arr.data[j][k];
-                    arr.data[j][k] = arr.data[maxRow][k];
-                    arr.data[maxRow][k] = temp;
-                }
-                // Multiply the determinant by -1 due to row swap
-                determinant *= -1;
-            }
+        clean(&scratch, NULL);
+        if(square.data != NULL)
+            clean(&square, NULL);
+        if(inverse.data != NULL)
+            clean(&inverse, NULL);
+        return result;
+    }
 
-            // Divide the current row by the value of A[j][j] to make the leading coefficient 1
-            double pivot = arr.data[j][j];
-            for (size_t k = 0; k < arr.shape[0]; k++) {
-                arr.data[j][k] /= pivot;
-            }
-            determinant *= pivot;
+/** Matrix exponential */
+
+// Largest 1-norms for which the Padé approximants of degree 3, 5, 7, 9 and 13 reach double
+// precision (Higham, "The scaling and squaring method for the matrix exponential revisited")
+static const double expm_theta[5] = {
+    1.495585217958292e-2, 2.539398330063230e-1, 9.504178996162932e-1,
+    2.097847961257068e0, 5.371920351148152e0
+};
+
+static const double expm_b3[4] = {120.0, 60.0, 12.0, 1.0};
+static const double expm_b5[6] = {30240.0, 15120.0, 3360.0, 420.0, 30.0, 1.0};
+static const double expm_b7[8] = {17297280.0, 8648640.0, 1995840.0, 277200.0, 25200.0, 1512.0, 56.0, 1.0};
+static const double expm_b9[10] = {17643225600.0, 8821612800.0, 2075673600.0, 302702400.0, 30270240.0,
+                                   2162160.0, 110880.0, 3960.0, 90.0, 1.0};
+static const double expm_b13[14] = {64764752532480000.0, 32382376266240000.0, 7771770303897600.0,
+                                    1187353796428800.0, 129060195264000.0, 10559470521600.0,
+                                    670442572800.0, 33522128640.0, 1323241920.0, 40840800.0,
+                                    960960.0, 16380.0, 182.0, 1.0};
+
+    static double norm1(ndarray_t *A)
+    {
+        double *col = calloc(A->shape[1], sizeof(double));
+        if (col == NULL)
+            malloc_error();
+        for (size_t i = 0; i < A->shape[0]; i++)
+            for (size_t j = 0; j < A->shape[1]; j++)
+                col[j] += fabs(A->data[i][j]);
+        double best = 0.0;
+        for (size_t j = 0; j < A->shape[1]; j++)
+            best = fmax(best, col[j]);
+        free(col);
+        return best;
+    }
 
-            // Eliminate the jth column element in other rows
-            for (size_t i = j + 1; i < arr.shape[0]; i++) {
-                double factor = arr.data[i][j];
-                for (size_t k = 0; k < arr.shape[0]; k++) {
-                    arr.data[i][k] -= factor * arr.data[j][k];
-                }
+    // out = c0 I + sum of c[i] P[i] over count terms
+    static void lincomb(ndarray_t *out, double c0, const double *c, ndarray_t **P, size_t count)
+    {
+        size_t n = out->shape[0];
+        for (size_t r = 0; r < n; r++)
+        {
+            double *o = out->data[r];
+            for (size_t j = 0; j < n; j++)
+                o[j] = 0.0;
+            o[r] = c0;
+            for (size_t t = 0; t < count; t++)
+            {
+                const double *p = P[t]->data[r];
+                for (size_t j = 0; j < n; j++)
+                    o[j] += c[t] * p[j];
             }
         }
+    }
 
-        // Multiply the determinant by the diagonal elements of the row-echelon form
-        for (size_t i = 0; i < arr.shape[0]; i++) {
-            determinant *= arr.data[i][i];
-        }
+    #pragma GCC optimize("O3", "unroll-loops")
+    ndarray_t nd_expm(ndarray_t *this)
+    {
+        if(isnull(this))
+            {null_error(); exit(EXIT_FAILURE);}
+        if(issquare(this))
+            {shape_error(); exit(EXIT_FAILURE);}
 
-        clean(&arr, NULL);
-        
-        return determinant;
-    }
+        size_t n = this->shape[0];
+        double anorm = norm1(this);
 
+        // Lowest degree whose bound holds, else degree 13 on A / 2^s
+        static const double *coeffs[4] = {expm_b3, expm_b5, expm_b7, expm_b9};
+        int degree = 13;
+        for(int i = 0; i < 4; i++)
+            if(anorm <= expm_theta[i])
+            {
+                degree = 2 * i + 3;
+                break;
+            }
+        int s = 0;
+        if(degree == 13 && anorm > expm_theta[4])
+            s = (int)ceil(log2(anorm / expm_theta[4]));
 
-    #pragma GCC optimize("O3", "unroll-loops")
-    void qr(ndarray_t *this, ndarray_t *Q, ndarray_t *R) {
-        // Initialize Q and R
-        if(!Q || !R)
+        ndarray_t A = copy(this);
+        if(s > 0)
         {
-            not_null_error();    
+            double scale = ldexp(1.0, -s);
+            for(size_t i = 0; i < n; i++)
+                for(size_t j = 0; j < n; j++)
+                    A.data[i][j] *= scale;
         }
 
-        if(isnull(this))
-            {null_error(); exit(EXIT_FAILURE);}
-        
-        *Q = zeros(this->shape[0], this->shape[1]);
-        *R = zeros(this->shape[1], this->shape[1]);
-        
-        // Create working copy
-        ndarray_t V = copy(this);
-        size_t n = V.shape[1];
-        
-        // Pre-allocate temporary arrays to avoid repeated allocations
-        ndarray_t v = zeros(this->shape[0], 1);
-        ndarray_t a = zeros(this->shape[0], 1);
-        ndarray_t b = zeros(this->shape[0], 1);
-        ndarray_t c = zeros(this->shape[0], 1);
-        ndarray_t div_r = zeros(this->shape[0], 1);
-    
-        for(size_t i=0; i<n; i++) {
-            // Copy column i to v instead of creating new array
-            for(size_t k=0; k<V.shape[0]; k++) {
-                v.data[k][0] = V.data[k][i];
-            }
-            
-            // Calculate norm directly to avoid temporary ndarray_t
-            double norm_val = 0.0;
-            for(size_t k=0; k<v.shape[0]; k++) {
-                norm_val += v.data[k][0] * v.data[k][0];
-            }
-            R->data[i][i] = sqrt(norm_val);
-            
-            // Calculate Q[:, i] = v / R[i,i]
-            double r_inv = 1.0 / R->data[i][i];
-            for(size_t k=0; k<v.shape[0]; k++) {
-                Q->data[k][i] = v.data[k][0] * r_inv;
+        // Even powers A², A⁴, ... : three for degree 13, degree / 2 otherwise
+        size_t npow = degree == 13 ? 3 : (size_t)degree / 2;
+        ndarray_t pw[4];
+        ndarray_t *P[4];
+        for(size_t i = 0; i < npow; i++)
+        {
+            pw[i] = array(n, n);
+            nd_gemm(ND_NO_TRANS, ND_NO_TRANS, 1.0, i == 0 ? &A : &pw[i - 1], i == 0 ? &A : &pw[0], 0.0, &pw[i]);
+            P[i] = &pw[i];
+        }
+
+        // p(A) = V + U with U holding the odd terms: r(A) = (V - U)⁻¹ (V + U)
+        ndarray_t U = array(n, n), V = array(n, n), W = array(n, n);
+        if(degree == 13)
+        {
+            const double *b = expm_b13;
+            double cu[3] = {b[13], b[11], b[9]}, cv[3] = {b[12], b[10], b[8]};
+            double lu[3] = {b[7], b[5], b[3]}, lv[3] = {b[6], b[4], b[2]};
+            ndarray_t *desc[3] = {P[2], P[1], P[0]};
+
+            // W = A⁶ (b13 A⁶ + b11 A⁴ + b9 A²) + b7 A⁶ + b5 A⁴ + b3 A² + b1 I, then U = A W
+            lincomb(&V, 0.0, cu, desc, 3);
+            nd_gemm(ND_NO_TRANS, ND_NO_TRANS, 1.0, P[2], &V, 0.0, &W);
+            lincomb(&V, b[1], lu, desc, 3);
+            for(size_t i = 0; i < n; i++)
+                for(size_t j = 0; j < n; j++)
+                    W.data[i][j] += V.data[i][j];
+            nd_gemm(ND_NO_TRANS, ND_NO_TRANS, 1.0, &A, &W, 0.0, &U);
+
+            // V = A⁶ (b12 A⁶ + b10 A⁴ + b8 A²) + b6 A⁶ + b4 A⁴ + b2 A² + b0 I
+            lincomb(&W, 0.0, cv, desc, 3);
+            nd_gemm(ND_NO_TRANS, ND_NO_TRANS, 1.0, P[2], &W, 0.0, &V);
+            lincomb(&W, b[0], lv, desc, 3);
+            for(size_t i = 0; i < n; i++)
+                for(size_t j = 0; j < n; j++)
+                    V.data[i][j] += W.data[i][j];
+        }
+        else
+        {
+            const double *b = coeffs[(degree - 3) / 2];
+            double cu[4], cv[4];
+            for(size_t i = 0; i < npow; i++)
+            {
+                cu[i] = b[2 * i + 3];
+                cv[i] = b[2 * i + 2];
             }
-            
-            // Update remaining columns
-            #pragma GCC unroll 4
-            for(size_t j=i+1; j<n; j++) {
-                // Calculate dot product directly
-                double dot_val = 0.0;
-                for(size_t k=0; k<this->shape[0]; k++) {
-                    dot_val += Q->data[k][i] * V.data[k][j];
-                }
-                R->data[i][j] = dot_val;
-                
-                // Update V[:, j]
-                for(size_t k=0; k<V.shape[0]; k++) {
-                    V.data[k][j] -= Q->data[k][i] * dot_val;
-                }
+            lincomb(&W, b[1], cu, P, npow);
+            nd_gemm(ND_NO_TRANS, ND_NO_TRANS, 1.0, &A, &W, 0.0, &U);
+            lincomb(&V, b[0], cv, P, npow);
+        }
+
+        // Solve (V - U) R = V + U, reusing W and V
+        for(size_t i = 0; i < n; i++)
+            for(size_t j = 0; j < n; j++)
+            {
+                double u = U.data[i][j], v = V.data[i][j];
+                W.data[i][j] = v - u;
+                V.data[i][j] = v + u;
             }
+        nd_lu_t lu = nd_lu(&W);
+        if(lu.singular)
+            singular_error();
+        ndarray_t R = nd_lu_solve(&lu, &V);
+        nd_lu_free(&lu);
+
+        // Undo the scaling: exp(A) = r(A / 2^s)^(2^s), squaring between R and U
+        for(int i = 0; i < s; i++)
+        {
+            nd_gemm(ND_NO_TRANS, ND_NO_TRANS, 1.0, &R, &R, 0.0, &U);
+            swap_arrays(&R, &U);
         }
-        
-        // Clean up temporary arrays
-        clean(&v, NULL);
-        clean(&a, NULL);
-        clean(&b, NULL);
-        clean(&c, NULL);
-        clean(&div_r, NULL);
-        clean(&V, NULL);
+
+        for(size_t i = 0; i < npow; i++)
+            clean(&pw[i], NULL);
+        clean(&A, &U, &V, &W, NULL);
+        return R;
+    }
+
+/** Matrix chains */
+
+    // Product of arrays[i..j] in the order of split, into a new array; a single factor is returned
+    // as is and must not be freed
+    static ndarray_t chain_product(ndarray_t **arrays, const size_t *split, size_t count, size_t i, size_t j)
+    {
+        if (i == j)
+            return *arrays[i];
+
+        size_t k = split[i * count + j];
+        ndarray_t left = chain_product(arrays, split, count, i, k);
+        ndarray_t right = chain_product(arrays, split, count, k + 1, j);
+        ndarray_t C = array(left.shape[0], right.shape[1]);
+        nd_gemm(ND_NO_TRANS, ND_NO_TRANS, 1.0, &left, &right, 0.0, &C);
+        if (k > i)
+            clean(&left, NULL);
+        if (k + 1 < j)
+            clean(&right, NULL);
+        return C;
     }
 
     #pragma GCC optimize("O3", "unroll-loops")
-    ndarray_t matmul(ndarray_t *this, ndarray_t *arrayB)
+    ndarray_t nd_multi_matmul(ndarray_t **arrays, size_t count)
     {
-       if(isnull(this))
-            {null_error(); exit(EXIT_FAILURE);}
-        if(isnull(arrayB))
+        if(arrays == NULL || count == 0)
             {null_error(); exit(EXIT_FAILURE);}
+        for(size_t i = 0; i < count; i++)
+            if(isnull(arrays[i]))
+                {null_error(); exit(EXIT_FAILURE);}
+        for(size_t i = 0; i + 1 < count; i++)
+            if(arrays[i]->shape[1] != arrays[i + 1]->shape[0])
+            {
+                fprintf(stderr, "Invalid dimensions %ldx%ld and %ldx%ld for factors %zu and %zu of a matrix chain\n",
+                        arrays[i]->shape[0], arrays[i]->shape[1], arrays[i + 1]->shape[0], arrays[i + 1]->shape[1],
+                        i, i + 1);
+                perror("Use valid ndarray_t dimesions please\n");
+                exit(1);
+            }
 
-        ndarray_t result  = {0};
-        if(this->shape[1] == arrayB->shape[0])
-        {
-            result = array(this->shape[1], this->shape[0]);
-            for(int i = 0; i<(int)this->shape[0]; i++)
+        if(count == 1)
+            return copy(arrays[0]);
+
+        // cost[i][j]: fewest multiply-adds for arrays[i..j], split[i][j]: the last product made
+        double *cost = calloc(count * count, sizeof(double));
+        size_t *split = calloc(count * count, sizeof(size_t));
+        if(cost == NULL || split == NULL)
+            malloc_error();
+        for(size_t len = 2; len <= count; len++)
+            for(size_t i = 0; i + len <= count; i++)
+            {
+                size_t j = i + len - 1;
+                cost[i * count + j] = INFINITY;
+                for(size_t k = i; k < j; k++)
                 {
-                    for(int j=0; j<(int)this->shape[1]; j++)
+                    double c = cost[i * count + k] + cost[(k + 1) * count + j]
+                             + (double)arrays[i]->shape[0] * arrays[k]->shape[1] * arrays[j]->shape[1];
+                    if(c < cost[i * count + j])
                     {
-                         result.data[i][j] = 0;
-                        for(int k = 0; k<(int)this->shape[0]; k++)
-                        {
-                            result.data[i][j] += this->data[i][k] * arrayB->data[k][j];
-                        }
+                        cost[i * count + j] = c;
+                        split[i * count + j] = k;
                     }
                 }
-            return result;
-        }
-        
-        else
-        {
-            fprintf(stderr, "Invalid dimensions %ldx%ld and %ldx%ld for array multiplication\n", this->shape[0], this->shape[1], arrayB->shape[0], arrayB->shape[1]);
-            perror("Use valid ndarray_t dimesions please\n");
-            exit(1);
-        }
-    }
+            }
 
+        ndarray_t result = chain_product(arrays, split, count, 0, count - 1);
+        free(cost);
+        free(split);
+        return result;
+    }
   
 
 
@@ -304,15 +510,40 @@
     #pragma GCC optimize("O3", "unroll-loops")
     ndarray_t dot(ndarray_t* a, ndarray_t* b) 
     {
-        
+        if(isnull(a) || isnull(b))
+            {null_error(); exit(EXIT_FAILURE);}
+        if(a->size != b->size)
+            {shape_error(); exit(EXIT_FAILURE);}
+
         ndarray_t result = array(1, 1);
-        result.data[0][0] = 0;
-        
-        // Compute the outer product
-        for (size_t i = 0; i < a->shape[0]; i++) 
+        size_t n = a->size;
+
+        // Row vectors are contiguous and go straight to the kernel
+        if(a->shape[0] == 1 && b->shape[0] == 1)
         {
-            result.data[0][0] += a->data[i][0] * b->data[i][0];
+            result.data[0][0] = nd_reduce_dot(a->data[0], b->data[0], n);
+            return result;
         }
+
+        // Same shapes: one partial per row, combined with the same summation mode
+        if(a->shape[0] == b->shape[0] && a->shape[1] == b->shape[1])
+        {
+            double *partials = malloc(a->shape[0] * sizeof(double));
+            if(partials == NULL)
+                malloc_error();
+
+            for (size_t i = 0; i < a->shape[0]; i++)
+                partials[i] = nd_reduce_dot(a->data[i], b->data[i], a->shape[1]);
+            result.data[0][0] = nd_reduce_sum(partials, a->shape[0]);
+            free(partials);
+            return result;
+        }
+
+        // Mixed orientation: gather both operands into flat buffers
+        ndarray_t fa = ravel(a);
+        ndarray_t fb = ravel(b);
+        result.data[0][0] = nd_reduce_dot(fa.data[0], fb.data[0], n);
+        clean(&fa, &fb, NULL);
         return result;
     }
 
@@ -323,130 +554,78 @@
             {null_error(); exit(EXIT_FAILURE);}
         if(issquare(this))
             {shape_error(); exit(EXIT_FAILURE);}
-        
+
         const size_t n = this->shape[0];
-        ndarray_t Q = zeros(n, n);
-        ndarray_t R = zeros(n, n);
-        ndarray_t QQ = identity(n, n);
-        ndarray_t Ik = identity(n, n);
+
+        // Symmetric input: tridiagonal reduction and QL iteration, exact to rounding in O(n³) once
+        bool symmetric = true;
+        for(size_t i = 0; i < n && symmetric; i++)
+            for(size_t j = 0; j < i; j++)
+                if(this->data[i][j] != this->data[j][i])
+                {
+                    symmetric = false;
+                    break;
+                }
+        ndarray_t values;
+        if(nd_backend_eigvals(this, symmetric, &values))
+            return values;
+        if(symmetric)
+        {
+            nd_eigh_t eigh = nd_eigh(this, false);
+            return eigh.values;
+        }
+
+        // Otherwise shifted QR iteration, arr = RQ + shift I, until arr is upper triangular to
+        // within the threshold; the eigenvalues are then read off its diagonal
         ndarray_t arr = copy(this);
-        ndarray_t temp = zeros(n, n);  // Pre-allocate temporary matrix
-        
         double convergence_threshold = 1e-10;
-        double prev_diag_sum = 0;
-        
+
         for(size_t k = 0; k < niters; k++)
         {
-            double Sk = arr.data[0][0];
-            
-            // In-place scaling of identity matrix
-            #pragma GCC unroll 4
-            for(size_t i = 0; i < n; i++) {
-                Ik.data[i][i] = Sk;
-            }
-            
-            // Subtract Ik from arr in-place
-            for(size_t i = 0; i < n; i++) {
-                for(size_t j = 0; j < n; j++) {
-                    if(i == j) arr.data[i][j] -= Ik.data[i][j];
-                }
-            }
-            
+            double shift = arr.data[0][0];
+            for(size_t i = 0; i < n; i++)
+                arr.data[i][i] -= shift;
+
+            ndarray_t Q, R;
             qr(&arr, &Q, &R);
-            
-            // Optimized matrix multiplication for arr = R*Q + Ik
-            for(size_t i = 0; i < n; i++) {
-                for(size_t j = 0; j < n; j++) {
-                    double sum = 0.0;
-                    for(size_t p = 0; p < n; p++) {
-                        sum += R.data[i][p] * Q.data[p][j];
-                    }
-                    arr.data[i][j] = sum + (i == j ? Ik.data[i][j] : 0);
-                }
-            }
-            
-            // Check for convergence - diagonal sum convergence
-            double diag_sum = 0;
-            for(size_t i = 0; i < n; i++) {
-                diag_sum += arr.data[i][i];
-            }
-            
-            if(k > 0 && fabs(diag_sum - prev_diag_sum) < convergence_threshold) {
-                break;  // Convergence reached
-            }
-            prev_diag_sum = diag_sum;
-            
-            // Update QQ = QQ * Q more efficiently
-            for(size_t i = 0; i < n; i++) {
-                for(size_t j = 0; j < n; j++) {
-                    double sum = 0.0;
-                    for(size_t p = 0; p < n; p++) {
-                        sum += QQ.data[i][p] * Q.data[p][j];
-                    }
-                    temp.data[i][j] = sum;
-                }
-            }
-            
-            // Copy temp to QQ
-            for(size_t i = 0; i < n; i++) {
-                for(size_t j = 0; j < n; j++) {
-                    QQ.data[i][j] = temp.data[i][j];
-                }
+            nd_gemm(ND_NO_TRANS, ND_NO_TRANS, 1.0, &R, &Q, 0.0, &arr);
+            clean(&Q, &R, NULL);
+
+            double below = 0;
+            for(size_t i = 0; i < n; i++)
+            {
+                arr.data[i][i] += shift;
+                if(i > 0)
+                    below = fmax(below, fabs(arr.data[i][i - 1]));
             }
+
+            if(below < convergence_threshold)
+                break;
         }
-        
-        // Extract eigenvalues from diagonal
+
         ndarray_t result = array(1, n);
-        for(size_t i = 0; i < n; i++) {
+        for(size_t i = 0; i < n; i++)
             result.data[0][i] = arr.data[i][i];
-        }
-        
+
         clean(&arr, NULL);
-        clean(&Q, NULL);
-        clean(&R, NULL);
-        clean(&Ik, NULL);
-        clean(&QQ, NULL);
-        clean(&temp, NULL);
-        
         return result;
     }
 
 
 
-    #pragma GCC optimize("O3", "unroll-loops", "fast-math")
+    #pragma GCC optimize("O3", "unroll-loops")
     ndarray_t svd(ndarray_t *this)
     {
-        // For A = U*S*V^T, we compute singular values by finding eigenvalues of A^T*A
-        size_t m = this->shape[0];
-        size_t n = this->shape[1];
-        
-        // Compute A^T*A more efficiently
-        ndarray_t ATA = zeros(n, n);
-        
-        // Direct computation of A^T*A without creating transposed matrix
-        for(size_t i = 0; i < n; i++) {
-            for(size_t j = 0; j < n; j++) {
-                double sum = 0.0;
-                for(size_t k = 0; k < m; k++) {
-                    sum += this->data[k][i] * this->data[k][j];
-                }
-                ATA.data[i][j] = sum;
-            }
-        }
-        
-        // Use optimized eigenvalue solver with fewer iterations when possible
-        size_t niters = n < 10 ? 500 : 1000;  // Adjust based on matrix size
-        ndarray_t eigenvalues = eig(&ATA, niters);
-        
-        // Compute singular values (sqrt of eigenvalues)
-        for(size_t i = 0; i < n; i++) {
-            // Use fast approximation if available, or precise sqrt
-            eigenvalues.data[0][i] = sqrt(fabs(eigenvalues.data[0][i]));
-        }
-        
-        clean(&ATA, NULL);
-        
-        return eigenvalues;
+        if(isnull(this))
+            {null_error(); exit(EXIT_FAILURE);}
+
+        ndarray_t values;
+        if(nd_backend_svdvals(this, &values))
+            return values;
+
+        // Bidiagonalization and implicit QR on A itself; AᵀA would square its condition number
+        nd_svd_t sv = nd_svd(this, ND_SVD_VALUES);
+        return sv.S;
     }
 
 
@@ -0,0 +1,574 @@
+#include <ndmath/mask.h>
+#include <ndmath/parallel.h>
+#include <ndmath/array.h>
+#include <ndmath/error.h>
+#include <ndmath/conditionals.h>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define ND_HAVE_AVX512_COMPRESS 1
+#endif
+
+#include <pthread.h>
+
+#pragma GCC push_options
+#pragma GCC optimize("O3", "unroll-loops")
+
+#define MK_TASK_WORDS 512       // mask words per task, 32768 elements
+#define MK_TASK_WORK 32768      // elements per task in row-wise loops
+
+#define ALWAYS_INLINE static inline __attribute__((always_inline))
+
+enum { CMP_LT, CMP_LE, CMP_GT, CMP_GE, CMP_EQ, CMP_NE };
+
+    nd_mask_t nd_mask(size_t rows, size_t cols)
+    {
+        if(rows == 0 || cols == 0)
+            shape_error();
+
+        nd_mask_t mask = {0};
+        mask.shape[0] = rows;
+        mask.shape[1] = cols;
+        mask.nwords = (rows * cols + 63) / 64;
+        mask.bits = calloc(mask.nwords, sizeof(uint64_t));
+        if(mask.bits == NULL)
+            malloc_error();
+        return mask;
+    }
+
+    void nd_mask_free(nd_mask_t *mask)
+    {
+        if(mask == NULL)
+            return;
+        free(mask->bits);
+        mask->bits = NULL;
+    }
+
+    bool nd_mask_get(const nd_mask_t *mask, size_t i, size_t j)
+    {
+        size_t k = i * mask->shape[1] + j;
+        return (mask->bits[k >> 6] >> (k & 63)) & 1;
+    }
+
+    void nd_mask_set(nd_mask_t *mask, size_t i, size_t j, bool value)
+    {
+        size_t k = i * mask->shape[1] + j;
+        if(value)
+            mask->bits[k >> 6] |= (uint64_t)1 << (k & 63);
+        else
+            mask->bits[k >> 6] &= ~((uint64_t)1 << (k & 63));
+    }
+
+    static void check_mask(const nd_mask_t *mask)
+    {
+        if(mask == NULL || mask->bits == NULL)
+            {null_error(); exit(EXIT_FAILURE);}
+    }
+
+    // 64 bits starting at bit k; bits past the end of the mask read as zero
+    ALWAYS_INLINE uint64_t load_bits(const nd_mask_t *mask, size_t k)
+    {
+        size_t w = k >> 6, s = k & 63;
+        uint64_t v = mask->bits[w] >> s;
+        if(s != 0 && w + 1 < mask->nwords)
+            v |= mask->bits[w + 1] << (64 - s);
+        return v;
+    }
+
+    ALWAYS_INLINE uint64_t low_bits(size_t n)
+    {
+        return n >= 64 ? ~(uint64_t)0 : ((uint64_t)1 << n) - 1;
+    }
+
+    // Set bits in [from, to)
+    static size_t count_range(const nd_mask_t *mask, size_t from, size_t to)
+    {
+        size_t count = 0;
+        for(size_t k = from; k < to; k += 64)
+            count += __builtin_popcountll(load_bits(mask, k) & low_bits(to - k));
+        return count;
+    }
+
+/** Comparisons */
+
+typedef struct {
+    ndarray_t *a;
+    ndarray_t *b;
+    int op;
+    nd_mask_t *mask;
+} compare_ctx_t;
+
+    ALWAYS_INLINE bool compare(int op, double x, double y)
+    {
+        switch (op)
+        {
+            case CMP_LT: return x < y;
+            case CMP_LE: return x <= y;
+            case CMP_GT: return x > y;
+            case CMP_GE: return x >= y;
+            case CMP_EQ: return x == y;
+            default:     return x != y;
+        }
+    }
+
+    ALWAYS_INLINE uint64_t pack_word(int op, const double *a, size_t sa, const double *b, size_t sb)
+    {
+        uint64_t word = 0;
+        for (size_t t = 0; t < 64; t++)
+            word |= (uint64_t)compare(op, a[t * sa], b[t * sb]) << t;
+        return word;
+    }
+
+    // Fills mask words for elements [p0, p1); p0 is a multiple of 64
+    ALWAYS_INLINE void compare_words(int op, const compare_ctx_t *ctx, size_t p0, size_t p1)
+    {
+        const ndarray_t *A = ctx->a, *B = ctx->b;
+        size_t cols = ctx->mask->shape[1];
+        size_t sa = A->shape[1] == 1 ? 0 : 1, sb = B->shape[1] == 1 ? 0 : 1;
+        size_t i = p0 / cols, j = p0 % cols;
+        uint64_t *out = ctx->mask->bits + p0 / 64;
+
+        for (size_t p = p0; p < p1; p += 64)
+        {
+            uint64_t word = 0;
+
+            if (p + 64 <= p1 && j + 64 <= cols)
+            {
+                // The whole word lies inside one row: a branch-free, vectorizable run
+                const double *x = A->data[A->shape[0] == 1 ? 0 : i] + j * sa;
+                const double *y = B->data[B->shape[0] == 1 ? 0 : i] + j * sb;
+                if (sa && sb)
+                    word = pack_word(op, x, 1, y, 1);
+                else if (sa)
+                    word = pack_word(op, x, 1, y, 0);
+                else if (sb)
+                    word = pack_word(op, x, 0, y, 1);
+                else
+                    word = compare(op, x[0], y[0]) ? ~(uint64_t)0 : 0;
+
+                j += 64;
+                if (j == cols)
+                    {j = 0; i++;}
+            }
+            else
+            {
+                size_t m = p1 - p < 64 ? p1 - p : 64;
+                for (size_t t = 0; t < m; t++)
+                {
+                    double x = A->data[A->shape[0] == 1 ? 0 : i][j * sa];
+                    double y = B->data[B->shape[0] == 1 ? 0 : i][j * sb];
+                    word |= (uint64_t)compare(op, x, y) << t;
+                    if (++j == cols)
+                        {j = 0; i++;}
+                }
+            }
+            *out++ = word;
+        }
+    }
+
+    ND_SIMD_CLONES static void compare_range(const compare_ctx_t *ctx, size_t p0, size_t p1)
+    {
+        switch (ctx->op)
+        {
+            case CMP_LT: compare_words(CMP_LT, ctx, p0, p1); break;
+            case CMP_LE: compare_words(CMP_LE, ctx, p0, p1); break;
+            case CMP_GT: compare_words(CMP_GT, ctx, p0, p1); break;
+            case CMP_GE: compare_words(CMP_GE, ctx, p0, p1); break;
+            case CMP_EQ: compare_words(CMP_EQ, ctx, p0, p1); break;
+            default:     compare_words(CMP_NE, ctx, p0, p1); break;
+        }
+    }
+
+    static void compare_task(size_t begin, size_t end, void *arg)
+    {
+        compare_ctx_t *ctx = arg;
+        size_t total = ctx->mask->shape[0] * ctx->mask->shape[1];
+        size_t p0 = begin * MK_TASK_WORDS * 64;
+        size_t p1 = end * MK_TASK_WORDS * 64 < total ? end * MK_TASK_WORDS * 64 : total;
+        compare_range(ctx, p0, p1);
+    }
+
+    static int parse_compare(const char *op)
+    {
+        if(op != NULL)
+        {
+            if(strcmp(op, "<") == 0)  return CMP_LT;
+            if(strcmp(op, "<=") == 0) return CMP_LE;
+            if(strcmp(op, ">") == 0)  return CMP_GT;
+            if(strcmp(op, ">=") == 0) return CMP_GE;
+            if(strcmp(op, "==") == 0) return CMP_EQ;
+            if(strcmp(op, "!=") == 0) return CMP_NE;
+        }
+        fprintf(stderr, "Invalid comparison operator %s \n", op != NULL ? op : "(null)");
+        perror("Use valid comparison operator please\n");
+        exit(1);
+    }
+
+    // Size of one broadcast dimension, 0 when the operands are incompatible
+    static size_t broadcast_dim(size_t a, size_t b)
+    {
+        if(a == b || b == 1)
+            return a;
+        if(a == 1)
+            return b;
+        return 0;
+    }
+
+    nd_mask_t nd_compare(ndarray_t *a, const char *op, ndarray_t *b)
+    {
+        if(isnull(a))
+            {null_error(); exit(EXIT_FAILURE);}
+        if(isnull(b))
+            {null_error(); exit(EXIT_FAILURE);}
+
+        int cmp = parse_compare(op);
+        size_t rows = broadcast_dim(a->shape[0], b->shape[0]);
+        size_t cols = broadcast_dim(a->shape[1], b->shape[1]);
+        if(rows == 0 || cols == 0)
+        {
+            fprintf(stderr, "Invalid dimensions %ldx%ld and %ldx%ld\n", a->shape[0], a->shape[1], b->shape[0], b->shape[1]);
+            perror("Use valid ndarray_t dimesions please\n");
+            exit(1);
+        }
+
+        nd_mask_t mask = nd_mask(rows, cols);
+        compare_ctx_t ctx = { a, b, cmp, &mask };
+        nd_parallel_for((mask.nwords + MK_TASK_WORDS - 1) / MK_TASK_WORDS, 1, compare_task, &ctx);
+        return mask;
+    }
+
+    nd_mask_t nd_compare_scalar(ndarray_t *this, const char *op, double value)
+    {
+        double *row = &value;
+        ndarray_t scalar = {0};
+        scalar.data = &row;
+        scalar.shape[0] = 1;
+        scalar.shape[1] = 1;
+        scalar.size = 1;
+        return nd_compare(this, op, &scalar);
+    }
+
+/** Mask logic */
+
+    static nd_mask_t same_shape(const nd_mask_t *a, const nd_mask_t *b)
+    {
+        check_mask(a);
+        check_mask(b);
+        if(a->shape[0] != b->shape[0] || a->shape[1] != b->shape[1])
+            {shape_error(); exit(EXIT_FAILURE);}
+        return nd_mask(a->shape[0], a->shape[1]);
+    }
+
+    nd_mask_t nd_mask_and(const nd_mask_t *a, const nd_mask_t *b)
+    {
+        nd_mask_t result = same_shape(a, b);
+        for(size_t w = 0; w < result.nwords; w++)
+            result.bits[w] = a->bits[w] & b->bits[w];
+        return result;
+    }
+
+    nd_mask_t nd_mask_or(const nd_mask_t *a, const nd_mask_t *b)
+    {
+        nd_mask_t result = same_shape(a, b);
+        for(size_t w = 0; w < result.nwords; w++)
+            result.bits[w] = a->bits[w] | b->bits[w];
+        return result;
+    }
+
+    nd_mask_t nd_mask_not(const nd_mask_t *mask)
+    {
+        check_mask(mask);
+        nd_mask_t result = nd_mask(mask->shape[0], mask->shape[1]);
+        for(size_t w = 0; w < result.nwords; w++)
+            result.bits[w] = ~mask->bits[w];
+
+        // Keep the padding bits of the last word cleared
+        size_t used = (result.shape[0] * result.shape[1]) & 63;
+        if(used != 0)
+            result.bits[result.nwords - 1] &= low_bits(used);
+        return result;
+    }
+
+    size_t nd_mask_count(const nd_mask_t *mask)
+    {
+        check_mask(mask);
+        size_t count = 0;
+        for(size_t w = 0; w < mask->nwords; w++)
+            count += __builtin_popcountll(mask->bits[w]);
+        return count;
+    }
+
+/** Where */
+
+typedef struct {
+    const nd_mask_t *mask;
+    ndarray_t *a;
+    ndarray_t *b;
+    ndarray_t *out;
+} where_ctx_t;
+
+    ALWAYS_INLINE void blend_row(const nd_mask_t *mask, size_t base, const double *x, size_t sa,
+                                 const double *y, size_t sb, double *out, size_t n)
+    {
+        for (size_t j = 0; j < n; j += 64)
+        {
+            uint64_t m = load_bits(mask, base + j);
+            size_t len = n - j < 64 ? n - j : 64;
+            for (size_t t = 0; t < len; t++)
+                out[j + t] = (m >> t) & 1 ? x[(j + t) * sa] : y[(j + t) * sb];
+        }
+    }
+
+    ND_SIMD_CLONES static void blend_run(const nd_mask_t *mask, size_t base, const double *x, size_t sa,
+                                         const double *y, size_t sb, double *out, size_t n)
+    {
+        if (sa && sb)
+            blend_row(mask, base, x, 1, y, 1, out, n);
+        else if (sa)
+            blend_row(mask, base, x, 1, y, 0, out, n);
+        else if (sb)
+            blend_row(mask, base, x, 0, y, 1, out, n);
+        else
+            blend_row(mask, base, x, 0, y, 0, out, n);
+    }
+
+    static void where_task(size_t begin, size_t end, void *arg)
+    {
+        where_ctx_t *ctx = arg;
+        size_t cols = ctx->out->shape[1];
+        size_t sa = ctx->a->shape[1] == 1 ? 0 : 1, sb = ctx->b->shape[1] == 1 ? 0 : 1;
+
+        for (size_t i = begin; i < end; i++)
+        {
+            const double *x = ctx->a->data[ctx->a->shape[0] == 1 ? 0 : i];
+            const double *y = ctx->b->data[ctx->b->shape[0] == 1 ? 0 : i];
+            blend_run(ctx->mask, i * cols, x, sa, y, sb, ctx->out->data[i], cols);
+        }
+    }
+
+    static void check_broadcast(ndarray_t *this, size_t rows, size_t cols)
+    {
+        if(isnull(this))
+            {null_error(); exit(EXIT_FAILURE);}
+        if((this->shape[0] != rows && this->shape[0] != 1) || (this->shape[1] != cols && this->shape[1] != 1))
+        {
+            fprintf(stderr, "Invalid dimensions %ldx%ld for a %ldx%ld mask\n", this->shape[0], this->shape[1], rows, cols);
+            perror("Use valid ndarray_t dimesions please\n");
+            exit(1);
+        }
+    }
+
+    ndarray_t nd_where(const nd_mask_t *mask, ndarray_t *a, ndarray_t *b)
+    {
+        check_mask(mask);
+        size_t rows = mask->shape[0];
+        size_t cols = mask->shape[1];
+        check_broadcast(a, rows, cols);
+        check_broadcast(b, rows, cols);
+
+        ndarray_t result = array(rows, cols);
+        where_ctx_t ctx = { mask, a, b, &result };
+        size_t grain = MK_TASK_WORK / cols > 0 ? MK_TASK_WORK / cols : 1;
+        nd_parallel_for(rows, grain, where_task, &ctx);
+        return result;
+    }
+
+/** Compress */
+
+    // Stream compaction of n values whose selection bits start at bit base; returns the count kept
+    static size_t compress_generic(const nd_mask_t *mask, size_t base, const double *in, double *out, size_t n)
+    {
+        size_t kept = 0;
+        for (size_t j = 0; j < n; j += 64)
+        {
+            uint64_t m = load_bits(mask, base + j) & low_bits(n - j);
+            if (m == ~(uint64_t)0)
+            {
+                memcpy(out + kept, in + j, 64 * sizeof(double));
+                kept += 64;
+                continue;
+            }
+            while (m != 0)
+            {
+                out[kept++] = in[j + __builtin_ctzll(m)];
+                m &= m - 1;
+            }
+        }
+        return kept;
+    }
+
+#ifdef ND_HAVE_AVX512_COMPRESS
+    // Eight lanes at a time with vcompresspd; masked loads never touch unselected memory
+    __attribute__((target("avx512f,popcnt")))
+    static size_t compress_avx512(const nd_mask_t *mask, size_t base, const double *in, double *out, size_t n)
+    {
+        size_t kept = 0;
+        for (size_t j = 0; j < n; j += 64)
+        {
+            uint64_t m = load_bits(mask, base + j) & low_bits(n - j);
+            for (size_t g = 0; m != 0; g += 8, m >>= 8)
+            {
+                __mmask8 lanes = (__mmask8)(m & 0xff);
+                __m512d v = _mm512_maskz_loadu_pd(lanes, in + j + g);
+                _mm512_mask_compressstoreu_pd(out + kept, lanes, v);
+                kept += __builtin_popcount(lanes);
+            }
+        }
+        return kept;
+    }
+#endif
+
+#ifdef ND_HAVE_AVX512_COMPRESS
+static pthread_once_t compress_once = PTHREAD_ONCE_INIT;
+static bool has_avx512 = false;
+
+    static void select_compress(void)
+    {
+        __builtin_cpu_init();
+        has_avx512 = __builtin_cpu_supports("avx512f");
+    }
+#endif
+
+    static size_t compress_run(const nd_mask_t *mask, size_t base, const double *in, double *out, size_t n)
+    {
+#ifdef ND_HAVE_AVX512_COMPRESS
+        pthread_once(&compress_once, select_compress);
+        if (has_avx512)
+            return compress_avx512(mask, base, in, out, n);
+#endif
+        return compress_generic(mask, base, in, out, n);
+    }
+
+typedef struct {
+    ndarray_t *src;
+    const nd_mask_t *mask;
+    ndarray_t *out;
+    size_t grain;           // rows per chunk
+    size_t *offsets;        // per chunk: kept count, then the output offset
+    double *flat;           // "all": the single output row
+} compress_ctx_t;
+
+    static void count_task(size_t begin, size_t end, void *arg)
+    {
+        compress_ctx_t *ctx = arg;
+        size_t rows = ctx->src->shape[0];
+        size_t width = ctx->mask->shape[1];   // cols for "all", 1 for "x"
+
+        for (size_t c = begin; c < end; c++)
+        {
+            size_t r0 = c * ctx->grain;
+            size_t r1 = r0 + ctx->grain < rows ? r0 + ctx->grain : rows;
+            ctx->offsets[c] = count_range(ctx->mask, r0 * width, r1 * width);
+        }
+    }
+
+    static void compress_all_task(size_t begin, size_t end, void *arg)
+    {
+        compress_ctx_t *ctx = arg;
+        size_t rows = ctx->src->shape[0];
+        size_t cols = ctx->src->shape[1];
+
+        for (size_t c = begin; c < end; c++)
+        {
+            size_t r1 = (c + 1) * ctx->grain < rows ? (c + 1) * ctx->grain : rows;
+            double *out = ctx->flat + ctx->offsets[c];
+            for (size_t i = c * ctx->grain; i < r1; i++)
+                out += compress_run(ctx->mask, i * cols, ctx->src->data[i], out, cols);
+        }
+    }
+
+    static void compress_rows_task(size_t begin, size_t end, void *arg)
+    {
+        compress_ctx_t *ctx = arg;
+        size_t rows = ctx->src->shape[0];
+        size_t cols = ctx->src->shape[1];
+
+        for (size_t c = begin; c < end; c++)
+        {
+            size_t r1 = (c + 1) * ctx->grain < rows ? (c + 1) * ctx->grain : rows;
+            size_t k = ctx->offsets[c];
+            for (size_t i = c * ctx->grain; i < r1; i++)
+                if ((ctx->mask->bits[i >> 6] >> (i & 63)) & 1)
+                    memcpy(ctx->out->data[k++], ctx->src->data[i], cols * sizeof(double));
+        }
+    }
+
+    static void compress_cols_task(size_t begin, size_t end, void *arg)
+    {
+        compress_ctx_t *ctx = arg;
+        size_t cols = ctx->src->shape[1];
+
+        for (size_t i = begin; i < end; i++)
+            compress_run(ctx->mask, 0, ctx->src->data[i], ctx->out->data[i], cols);
+    }
+
+    ndarray_t nd_compress(ndarray_t *this, const nd_mask_t *mask, char *axis)
+    {
+        if(isnull(this))
+            {null_error(); exit(EXIT_FAILURE);}
+        check_mask(mask);
+
+        size_t rows = this->shape[0];
+        size_t cols = this->shape[1];
+        bool select_rows = strcmp(axis, "x") == 0;
+        bool select_cols = strcmp(axis, "y") == 0;
+
+        if(!select_rows && !select_cols && strcmp(axis, "all") != 0)
+        {
+            axis_error(axis);
+            exit(1);
+        }
+
+        size_t want_rows = select_cols ? 1 : rows;
+        size_t want_cols = select_rows ? 1 : cols;
+        if(mask->shape[0] != want_rows || mask->shape[1] != want_cols)
+            {shape_error(); exit(EXIT_FAILURE);}
+
+        ndarray_t empty = {0};
+        size_t grain = MK_TASK_WORK / cols > 0 ? MK_TASK_WORK / cols : 1;
+        compress_ctx_t ctx = { this, mask, NULL, grain, NULL, NULL };
+
+        if(select_cols)
+        {
+            size_t count = nd_mask_count(mask);
+            if(count == 0)
+                return empty;
+
+            ndarray_t result = array(rows, count);
+            ctx.out = &result;
+            nd_parallel_for(rows, grain, compress_cols_task, &ctx);
+            return result;
+        }
+
+        // Two passes over row chunks: count what each keeps, then write at the prefix offset
+        size_t nchunks = (rows + grain - 1) / grain;
+        ctx.offsets = malloc(nchunks * sizeof(size_t));
+        if(ctx.offsets == NULL)
+            malloc_error();
+
+        nd_parallel_for(nchunks, 1, count_task, &ctx);
+
+        size_t count = 0;
+        for(size_t c = 0; c < nchunks; c++)
+        {
+            size_t kept = ctx.offsets[c];
+            ctx.offsets[c] = count;
+            count += kept;
+        }
+
+        if(count == 0)
+        {
+            free(ctx.offsets);
+            return empty;
+        }
+
+        ndarray_t result = select_rows ? array(count, cols) : array(1, count);
+        ctx.out = &result;
+        ctx.flat = result.data[0];
+        nd_parallel_for(nchunks, 1, select_rows ? compress_rows_task : compress_all_task, &ctx);
+
+        free(ctx.offsets);
+        return result;
+    }
+
+#pragma GCC pop_options
@@ -4,6 +4,7 @@
 #include <ndmath/array.h>
 #include <ndmath/error.h>
 #include <ndmath/conditionals.h>
+#include <ndmath/ufunc.h>
 #include <math.h>
 
 
@@ -15,60 +16,12 @@
 
     ndarray_t sum(ndarray_t *this,  ndarray_t *arrayB)
     {
-        if(isnull(this))
-            {null_error(); exit(EXIT_FAILURE);}
-        if(isnull(arrayB))
-            {null_error(); exit(EXIT_FAILURE);}
-
-        ndarray_t result = {0};
-        if(this->shape[0] == arrayB->shape[0] && this->shape[1] == arrayB->shape[1])
-        {
-            result = array(this->shape[0], this->shape[1]);
-            for(int i=0; i<(int)this->shape[0]; i++)
-            {
-                for(int j=0; j<(int)this->shape[1]; j++)
-                {
-                    result.data[i][j] = this->data[i][j] + arrayB->data[i][j];
-                }
-            }
-            return result;
-        }
-        else
-        {
-            fprintf(stderr, "Invalid dimensions %ldx%ld and %ldx%ld for array addition\n", this->shape[0], this->shape[1], arrayB->shape[0], arrayB->shape[1]);
-            perror("Use valid ndarray_t dimesions please\n");
-            exit(1);
-        }
-        
+        return nd_ufunc_binary(&nd_ufunc_add, this, arrayB, NULL);
     }
 
     ndarray_t subtract (ndarray_t *this, ndarray_t *arrayB)
     {
-        if(isnull(this))
-            {null_error(); exit(EXIT_FAILURE);}
-        if(isnull(arrayB))
-            {null_error(); exit(EXIT_FAILURE);}
-
-        
-        ndarray_t result  = {0};
-        if(this->shape[0] == arrayB->shape[0] && this->shape[1] == arrayB->shape[1])
-        {
-            result = array(this->shape[0], this->shape[1]);
-            for(int i = 0; i<(int)this->shape[0]; i++)
-                {
-                    for(int j=0; j<(int)this->shape[1]; j++)
-                    {
-                        result.data[i][j] = this->data[i][j] - arrayB->data[i][j];
-                    }
-                }
-            return result;
-        }
-        else
-        {
-            fprintf(stderr, "Invalid dimensions %ldx%ld and %ldx%ld for array subtraction\n", this->shape[0], this->shape[1], arrayB->shape[0], arrayB->shape[1]);
-            perror("Use valid ndarray_t dimesions please\n");
-            exit(1);
-        }
+        return nd_ufunc_binary(&nd_ufunc_subtract, this, arrayB, NULL);
     }
 
 
@@ -98,38 +51,33 @@
     {
         if(isnull(this))
             {null_error(); exit(EXIT_FAILURE);}
-       
-        int i, j;
-        ndarray_t result = array(this->shape[0], this->shape[1]);
-        for(i=0; i<(int)this->shape[0]; i++)
+
+        // The operator is resolved once, the kernel then runs over whole rows
+        const nd_ufunc_t *ufunc = NULL;
+        if(op == '+')
+            ufunc = &nd_ufunc_add_scalar;
+        else if(op == '*')
+            ufunc = &nd_ufunc_multiply_scalar;
+        else if(op == '-')
+            ufunc = &nd_ufunc_subtract_scalar;
+        else if(op == '/')
         {
-            for(j=0; j<(int)this->shape[1]; j++)
+            if(sc  == 0)    
             {
-                if(op == '+')
-                    result.data[i][j] = this->data[i][j] + sc;
-                else if(op == '*')
-                    result.data[i][j] = this->data[i][j] * sc;
-                else if(op == '-')
-                    result.data[i][j] = this->data[i][j] - sc;
-                else if(op == '/')
-                {
-                    if(sc  == 0)    
-                    {
-                        fprintf(stderr, "Division by zero \n");
-                        perror("A division by zero occured\n");
-                        exit(1);
-                    }
-                    result.data[i][j] = this->data[i][j] / sc;
-                }
-                else
-                {
-                    fprintf(stderr, "Invalid arithmetic operator %c \n", op);
-                    perror("Use valid arithmetic operator please\n");
-                    exit(1);
-                }
+                fprintf(stderr, "Division by zero \n");
+                perror("A division by zero occured\n");
+                exit(1);
             }
+            ufunc = &nd_ufunc_divide_scalar;
         }
-        return result;
+        else
+        {
+            fprintf(stderr, "Invalid arithmetic operator %c \n", op);
+            perror("Use valid arithmetic operator please\n");
+            exit(1);
+        }
+
+        return nd_ufunc_unary(ufunc, this, NULL, sc);
     }
 
     ndarray_t divide(ndarray_t *this, ndarray_t *arrayB)
@@ -139,19 +87,9 @@
         if(isnull(arrayB))
             {null_error(); exit(EXIT_FAILURE);}
 
-        
-        if(this->shape[0] != arrayB->shape[0] || this->shape[1] != arrayB->shape[1])
+        for(size_t i=0; i<arrayB->shape[0]; i++)
         {
-            fprintf(stderr, "Invalid dimensions %ldx%ld and %ldx%ld for element wise division\n", this->shape[0], this->shape[1], arrayB->shape[0], arrayB->shape[1]);
-            perror("Use valid ndarray_t dimesions please\n");
-            exit(1);
-        }
-
-        int i, j;
-        ndarray_t result = array(this->shape[0], this->shape[1]);
-        for(i=0; i<(int)this->shape[0]; i++)
-        {
-            for(j=0; j<(int)this->shape[1]; j++)
+            for(size_t j=0; j<arrayB->shape[1]; j++)
             {
                 if(arrayB->data[i][j]  == 0)    
                 {
@@ -159,28 +97,16 @@
                     perror("A division by zero occured\n");
                     exit(1);
                 }
-                result.data[i][j] = this->data[i][j]/arrayB->data[i][j];
             }
         }
-        return result;
+
+        return nd_ufunc_binary(&nd_ufunc_divide, this, arrayB, NULL);
     }
     
   
     ndarray_t nd_log(ndarray_t *this)
     {
-        if(isnull(this))
-            {null_error(); exit(EXIT_FAILURE);}
-        
-        size_t i, j;
-        ndarray_t result = array(this->shape[0], this->shape[1]);
-        for(i=0; i<this->shape[0]; i++)
-        {
-            for(j=0;j<this->shape[1]; j++)
-            {
-                result.data[i][j] = log10(this->data[i][j]);
-            }
-        }
-        return result;
+        return nd_ufunc_unary(&nd_ufunc_log10, this, NULL, 0.0);
     }
 
     //Creates a new variable containing the transposed version of the previous matrix
@@ -204,150 +130,46 @@
 
     ndarray_t power(ndarray_t *this, double exponent)
     {
-        if(isnull(this))
-            {null_error(); exit(EXIT_FAILURE);}
-       
-        size_t i, j;
-        ndarray_t result = array(this->shape[0], this->shape[1]);
-        for(i=0; i<this->shape[0]; i++)
-        {
-            for(j=0;j<this->shape[1]; j++)
-            {
-                result.data[i][j] = pow(this->data[i][j], exponent);
-            }
-        }
-        return result;
+        return nd_ufunc_unary(&nd_ufunc_power, this, NULL, exponent);
     }
 
     inline ndarray_t nd_log2(ndarray_t *this)
     {
-        if(isnull(this))
-            {null_error(); exit(EXIT_FAILURE);}
-        
-
-        size_t i, j;
-        ndarray_t result = array(this->shape[0], this->shape[1]);
-        for(i=0; i<this->shape[0]; i++)
-        {
-            for(j=0;j<this->shape[1]; j++)
-            {
-                result.data[i][j] = log2(this->data[i][j]);
-            }
-        }
-        return result;
+        return nd_ufunc_unary(&nd_ufunc_log2, this, NULL, 0.0);
     }
 
     inline ndarray_t nd_exp(ndarray_t *this)
     {
-        if(isnull(this))
-            {null_error(); exit(EXIT_FAILURE);}
-        
-
-        size_t i, j;
-        ndarray_t result = array(this->shape[0], this->shape[1]);
-        for(i=0; i<this->shape[0]; i++)
-        {
-            for(j=0;j<this->shape[1]; j++)
-            {
-                result.data[i][j] = exp(this->data[i][j]);
-            }
-        }
-        return result;
+        return nd_ufunc_unary(&nd_ufunc_exp, this, NULL, 0.0);
     }
 
     
     inline ndarray_t neg(ndarray_t *this)
     {
-        if(isnull(this))
-            {null_error(); exit(EXIT_FAILURE);}
-        
-
-        size_t i, j;
-        ndarray_t result = array(this->shape[0], this->shape[1]);
-        for(i=0; i<this->shape[0]; i++)
-        {
-            for(j=0;j<this->shape[1]; j++)
-            {
-               
-                result.data[i][j] = this->data[i][j] * -1;
-            }
-        }
-        return result;
+        return nd_ufunc_unary(&nd_ufunc_negative, this, NULL, 0.0);
     }
 
     inline ndarray_t square(ndarray_t *this)
     {
-        if(isnull(this))
-            {null_error(); exit(EXIT_FAILURE);}
-        
-
-        size_t i, j;
-        ndarray_t result = array(this->shape[0], this->shape[1]);
-        for(i=0; i<this->shape[0]; i++)
-        {
-            for(j=0;j<this->shape[1]; j++)
-            {
-                    result.data[i][j] = this->data[i][j] * this->data[i][j];
-            }
-        }
-        return result;
+        return nd_ufunc_unary(&nd_ufunc_square, this, NULL, 0.0);
     }
 
     
     inline ndarray_t cube(ndarray_t *this)
     {
-        if(isnull(this))
-            {null_error(); exit(EXIT_FAILURE);}
-        
-
-        size_t i, j;
-        ndarray_t result = array(this->shape[0], this->shape[1]);
-        for(i=0; i<this->shape[0]; i++)
-        {
-            for(j=0;j<this->shape[1]; j++)
-            {
-                result.data[i][j] = this->data[i][j] * this->data[i][j] * this->data[i][j];
-            }
-        }
-        return result;
+        return nd_ufunc_unary(&nd_ufunc_cube, this, NULL, 0.0);
     }
 
     
     inline ndarray_t nd_abs(ndarray_t *this)
     {
-        if(isnull(this))
-            {null_error(); exit(EXIT_FAILURE);}
-        
-
-        size_t i, j;
-        ndarray_t result = array(this->shape[0], this->shape[1]);
-        for(i=0; i<this->shape[0]; i++)
-        {
-            for(j=0;j<this->shape[1]; j++)
-            {
-                result.data[i][j] = fabs(this->data[i][j]);
-            }
-        }
-        return result;
+        return nd_ufunc_unary(&nd_ufunc_abs, this, NULL, 0.0);
     }
 
     
     inline ndarray_t nd_sqrt(ndarray_t *this)
     {
-        if(isnull(this))
-            {null_error(); exit(EXIT_FAILURE);}
-        
-        
-        size_t i, j;
-        ndarray_t result = array(this->shape[0], this->shape[1]);
-        for(i=0; i<this->shape[0]; i++)
-        {
-            for(j=0;j<this->shape[1]; j++)
-            {
-                result.data[i][j] = sqrt(this->data[i][j]);
-            }
-        }
-        return result;  
+        return nd_ufunc_unary(&nd_ufunc_sqrt, this, NULL, 0.0);
     }
 
     #pragma GCC pop_options
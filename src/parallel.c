@@ -0,0 +1,170 @@
+#include <ndmath/parallel.h>
+#include <ndmath/error.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#define ND_MAX_THREADS 256
+
+/** A parallel_for call shared with the workers */
+typedef struct {
+    nd_task_fn fn;
+    void *ctx;
+    size_t n;
+    size_t grain;
+    size_t nchunks;
+    size_t next;          // next chunk to hand out, updated atomically
+    size_t participants;  // workers taking part in this job
+    size_t pending;       // participating workers that have not finished yet
+} nd_job_t;
+
+static pthread_mutex_t submit_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pool_wake = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t pool_done = PTHREAD_COND_INITIALIZER;
+static pthread_once_t threads_once = PTHREAD_ONCE_INIT;
+
+static pthread_t workers[ND_MAX_THREADS];
+static size_t nworkers = 0;
+static size_t nthreads = 1;          // read by every kernel: accessed atomically
+static unsigned long generation = 0;
+static nd_job_t job;
+
+static __thread int in_task = 0;
+
+
+    static void init_num_threads(void)
+    {
+        long n = 0;
+        const char *env = getenv("NDMATH_NUM_THREADS");
+
+        if (env != NULL)
+            n = strtol(env, NULL, 10);
+        if (n <= 0)
+            n = sysconf(_SC_NPROCESSORS_ONLN);
+        if (n <= 0)
+            n = 1;
+        if (n > ND_MAX_THREADS)
+            n = ND_MAX_THREADS;
+
+        __atomic_store_n(&nthreads, (size_t)n, __ATOMIC_RELAXED);
+    }
+
+    void nd_set_num_threads(size_t n)
+    {
+        pthread_once(&threads_once, init_num_threads);
+
+        pthread_mutex_lock(&submit_mutex);
+        if (n == 0)
+            init_num_threads();
+        else
+            __atomic_store_n(&nthreads, n > ND_MAX_THREADS ? ND_MAX_THREADS : n, __ATOMIC_RELAXED);
+        pthread_mutex_unlock(&submit_mutex);
+    }
+
+    size_t nd_get_num_threads(void)
+    {
+        pthread_once(&threads_once, init_num_threads);
+        return __atomic_load_n(&nthreads, __ATOMIC_RELAXED);
+    }
+
+    static void run_chunks(nd_job_t *j)
+    {
+        for (;;)
+        {
+            size_t k = __atomic_fetch_add(&j->next, 1, __ATOMIC_RELAXED);
+            if (k >= j->nchunks)
+                break;
+
+            size_t begin = k * j->grain;
+            size_t end = begin + j->grain < j->n ? begin + j->grain : j->n;
+            j->fn(begin, end, j->ctx);
+        }
+    }
+
+    static void *worker_main(void *arg)
+    {
+        size_t id = (size_t)arg;
+        unsigned long seen = 0;
+
+        pthread_mutex_lock(&pool_mutex);
+        for (;;)
+        {
+            while (generation == seen)
+                pthread_cond_wait(&pool_wake, &pool_mutex);
+            seen = generation;
+
+            if (id >= job.participants)
+                continue;
+
+            pthread_mutex_unlock(&pool_mutex);
+            in_task = 1;
+            run_chunks(&job);
+            in_task = 0;
+            pthread_mutex_lock(&pool_mutex);
+
+            if (--job.pending == 0)
+                pthread_cond_signal(&pool_done);
+        }
+        return NULL;
+    }
+
+    // Starts workers until `wanted` of them exist, returns how many are available
+    static size_t spawn_workers(size_t wanted)
+    {
+        while (nworkers < wanted)
+        {
+            if (pthread_create(&workers[nworkers], NULL, worker_main, (void *)nworkers) != 0)
+                break;
+            pthread_detach(workers[nworkers]);
+            nworkers++;
+        }
+        return nworkers < wanted ? nworkers : wanted;
+    }
+
+    void nd_parallel_for(size_t n, size_t grain, nd_task_fn fn, void *ctx)
+    {
+        if (fn == NULL)
+            {null_error(); exit(EXIT_FAILURE);}
+        if (n == 0)
+            return;
+        if (grain == 0)
+            grain = 1;
+
+        size_t nchunks = (n + grain - 1) / grain;
+        size_t threads = nd_get_num_threads();
+
+        // Nested calls, single chunks and concurrent submitters run inline
+        if (threads <= 1 || nchunks == 1 || in_task || pthread_mutex_trylock(&submit_mutex) != 0)
+        {
+            for (size_t begin = 0; begin < n; begin += grain)
+                fn(begin, begin + grain < n ? begin + grain : n, ctx);
+            return;
+        }
+
+        size_t helpers = (threads < nchunks ? threads : nchunks) - 1;
+        helpers = spawn_workers(helpers);
+
+        pthread_mutex_lock(&pool_mutex);
+        job.fn = fn;
+        job.ctx = ctx;
+        job.n = n;
+        job.grain = grain;
+        job.nchunks = nchunks;
+        job.next = 0;
+        job.participants = helpers;
+        job.pending = helpers;
+        generation++;
+        pthread_cond_broadcast(&pool_wake);
+        pthread_mutex_unlock(&pool_mutex);
+
+        in_task = 1;
+        run_chunks(&job);
+        in_task = 0;
+
+        pthread_mutex_lock(&pool_mutex);
+        while (job.pending > 0)
+            pthread_cond_wait(&pool_done, &pool_mutex);
+        pthread_mutex_unlock(&pool_mutex);
+
+        pthread_mutex_unlock(&submit_mutex);
+    }
@@ -0,0 +1,1042 @@
+#include <ndmath/reduce.h>
+#include <ndmath/parallel.h>
+#include <ndmath/array.h>
+#include <ndmath/error.h>
+#include <ndmath/conditionals.h>
+#include <math.h>
+
+#pragma GCC push_options
+#pragma GCC optimize("O3", "unroll-loops")
+
+#define ND_LANES 8              // independent accumulators per contiguous run
+#define ND_BLOCK 128            // leaf size of the pairwise tree
+#define ND_ROW_BLOCK 32         // rows folded naively before a pairwise merge
+#define ND_ROW_CHUNK 4096       // rows per task in column reductions
+#define ND_COL_CHUNK 4096       // columns per task in column reductions
+#define ND_TASK_WORK 32768      // elements per task in row reductions
+#define ND_MAX_LEVELS 64
+#define ND_SCAN_CHUNK 16384     // elements per chunk of a two-pass row scan
+#define ND_EXTREMA_CHUNK 16384  // columns per task when searching rows for extrema
+
+#define ALWAYS_INLINE static inline __attribute__((always_inline))
+
+enum { TERM_SUM, TERM_SUMSQ, TERM_SQDEV, TERM_DOT };
+
+static nd_summation_t summation_mode = ND_SUM_PAIRWISE;
+
+    void nd_set_summation(nd_summation_t mode)
+    {
+        summation_mode = mode;
+    }
+
+    nd_summation_t nd_get_summation(void)
+    {
+        return summation_mode;
+    }
+
+/** Contiguous kernels */
+
+    ALWAYS_INLINE double term(int kind, const double *x, const double *y, double mu, size_t i)
+    {
+        switch (kind)
+        {
+            case TERM_SUMSQ: return x[i] * x[i];
+            case TERM_SQDEV: return (x[i] - mu) * (x[i] - mu);
+            case TERM_DOT:   return x[i] * y[i];
+            default:         return x[i];
+        }
+    }
+
+    // Neumaier's variant of the Kahan step, also correct when |v| > |sum|
+    ALWAYS_INLINE void neumaier_add(double *sum, double *comp, double v)
+    {
+        double t = *sum + v;
+        if (fabs(*sum) >= fabs(v))
+            *comp += (*sum - t) + v;
+        else
+            *comp += (v - t) + *sum;
+        *sum = t;
+    }
+
+    ALWAYS_INLINE double sum_naive(int kind, const double *x, const double *y, double mu, size_t begin, size_t end)
+    {
+        double acc[ND_LANES] = {0};
+        size_t i = begin;
+
+        for (; i + ND_LANES <= end; i += ND_LANES)
+            for (size_t k = 0; k < ND_LANES; k++)
+                acc[k] += term(kind, x, y, mu, i + k);
+
+        double tail = 0.0;
+        for (; i < end; i++)
+            tail += term(kind, x, y, mu, i);
+
+        return ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7])) + tail;
+    }
+
+    // Leaves of ND_BLOCK elements merged like a binary counter: level l holds 2^l leaves
+    ALWAYS_INLINE double sum_pairwise(int kind, const double *x, const double *y, double mu, size_t n)
+    {
+        double level[ND_MAX_LEVELS];
+        size_t count = 0;
+
+        for (size_t b = 0; b < n; b += ND_BLOCK)
+        {
+            double carry = sum_naive(kind, x, y, mu, b, b + ND_BLOCK < n ? b + ND_BLOCK : n);
+            size_t l = 0;
+            for (size_t c = count; c & 1; c >>= 1, l++)
+                carry = level[l] + carry;
+            level[l] = carry;
+            count++;
+        }
+
+        double total = 0.0;
+        for (size_t l = 0; count; count >>= 1, l++)
+            if (count & 1)
+                total += level[l];
+        return total;
+    }
+
+    ALWAYS_INLINE double sum_kahan(int kind, const double *x, const double *y, double mu, size_t n)
+    {
+        double s[ND_LANES] = {0};
+        double c[ND_LANES] = {0};
+        size_t i = 0;
+
+        for (; i + ND_LANES <= n; i += ND_LANES)
+        {
+            for (size_t k = 0; k < ND_LANES; k++)
+            {
+                double v = term(kind, x, y, mu, i + k) - c[k];
+                double t = s[k] + v;
+                c[k] = (t - s[k]) - v;
+                s[k] = t;
+            }
+        }
+
+        double total = 0.0, comp = 0.0;
+        for (size_t k = 0; k < ND_LANES; k++)
+        {
+            neumaier_add(&total, &comp, s[k]);
+            neumaier_add(&total, &comp, -c[k]);
+        }
+        for (; i < n; i++)
+            neumaier_add(&total, &comp, term(kind, x, y, mu, i));
+
+        return total + comp;
+    }
+
+    ALWAYS_INLINE double reduce_contiguous(int kind, const double *x, const double *y, double mu, size_t n)
+    {
+        switch (summation_mode)
+        {
+            case ND_SUM_KAHAN: return sum_kahan(kind, x, y, mu, n);
+            case ND_SUM_NAIVE: return sum_naive(kind, x, y, mu, 0, n);
+            default:           return sum_pairwise(kind, x, y, mu, n);
+        }
+    }
+
+    ND_SIMD_CLONES double nd_reduce_sum(const double *x, size_t n)
+    {
+        return reduce_contiguous(TERM_SUM, x, NULL, 0.0, n);
+    }
+
+    ND_SIMD_CLONES double nd_reduce_sumsq(const double *x, size_t n)
+    {
+        return reduce_contiguous(TERM_SUMSQ, x, NULL, 0.0, n);
+    }
+
+    ND_SIMD_CLONES double nd_reduce_sqdev(const double *x, size_t n, double mu)
+    {
+        return reduce_contiguous(TERM_SQDEV, x, NULL, mu, n);
+    }
+
+    ND_SIMD_CLONES double nd_reduce_dot(const double *x, const double *y, size_t n)
+    {
+        return reduce_contiguous(TERM_DOT, x, y, 0.0, n);
+    }
+
+/** Array reductions */
+
+typedef struct {
+    ndarray_t *src;
+    nd_reduce_op_t op;
+    ndarray_t *center;
+    bool row_centers;       // center holds one value per row ("x") instead of one overall
+    nd_summation_t mode;
+    double *out;            // one value per row, or nrow_chunks x cols column partials
+    size_t ncol_chunks;
+} reduce_ctx_t;
+
+    static void rows_task(size_t begin, size_t end, void *arg)
+    {
+        reduce_ctx_t *ctx = arg;
+        size_t cols = ctx->src->shape[1];
+
+        for (size_t i = begin; i < end; i++)
+        {
+            const double *row = ctx->src->data[i];
+            double mu = 0.0;
+            if (ctx->center != NULL)
+                mu = ctx->row_centers ? ctx->center->data[i][0] : ctx->center->data[0][0];
+
+            switch (ctx->op)
+            {
+                case ND_REDUCE_SUMSQ: ctx->out[i] = nd_reduce_sumsq(row, cols); break;
+                case ND_REDUCE_SQDEV: ctx->out[i] = nd_reduce_sqdev(row, cols, mu); break;
+                default:              ctx->out[i] = nd_reduce_sum(row, cols); break;
+            }
+        }
+    }
+
+    ALWAYS_INLINE double col_term(nd_reduce_op_t op, const double *row, const double *mu, size_t j)
+    {
+        switch (op)
+        {
+            case ND_REDUCE_SUMSQ: return row[j] * row[j];
+            case ND_REDUCE_SQDEV: return (row[j] - mu[j]) * (row[j] - mu[j]);
+            default:              return row[j];
+        }
+    }
+
+    // Reduces rows [r0, r1) of columns [c0, c0 + w) into out[0..w)
+    ALWAYS_INLINE void column_block(nd_reduce_op_t op, nd_summation_t mode, double **data,
+                                    size_t r0, size_t r1, size_t c0, size_t w, const double *mu, double *out)
+    {
+        for (size_t j = 0; j < w; j++)
+            out[j] = 0.0;
+
+        if (mode == ND_SUM_NAIVE)
+        {
+            for (size_t i = r0; i < r1; i++)
+            {
+                const double *row = data[i] + c0;
+                for (size_t j = 0; j < w; j++)
+                    out[j] += col_term(op, row, mu, j);
+            }
+            return;
+        }
+
+        if (mode == ND_SUM_KAHAN)
+        {
+            double *comp = calloc(w, sizeof(double));
+            if (comp == NULL)
+                malloc_error();
+
+            for (size_t i = r0; i < r1; i++)
+            {
+                const double *row = data[i] + c0;
+                for (size_t j = 0; j < w; j++)
+                {
+                    double v = col_term(op, row, mu, j) - comp[j];
+                    double t = out[j] + v;
+                    comp[j] = (t - out[j]) - v;
+                    out[j] = t;
+                }
+            }
+            for (size_t j = 0; j < w; j++)
+                out[j] -= comp[j];
+
+            free(comp);
+            return;
+        }
+
+        // Pairwise: fold ND_ROW_BLOCK rows at a time, then merge blocks as a binary counter
+        size_t nlevels = 1;
+        for (size_t nb = (r1 - r0 + ND_ROW_BLOCK - 1) / ND_ROW_BLOCK; nb > 1; nb = (nb + 1) / 2)
+            nlevels++;
+
+        double *work = malloc((nlevels + 1) * w * sizeof(double));
+        if (work == NULL)
+            malloc_error();
+        double *carry = work + nlevels * w;
+        size_t count = 0;
+
+        for (size_t b = r0; b < r1; b += ND_ROW_BLOCK)
+        {
+            size_t e = b + ND_ROW_BLOCK < r1 ? b + ND_ROW_BLOCK : r1;
+
+            for (size_t j = 0; j < w; j++)
+                carry[j] = 0.0;
+            for (size_t i = b; i < e; i++)
+            {
+                const double *row = data[i] + c0;
+                for (size_t j = 0; j < w; j++)
+                    carry[j] += col_term(op, row, mu, j);
+            }
+
+            size_t l = 0;
+            for (size_t c = count; c & 1; c >>= 1, l++)
+            {
+                const double *lv = work + l * w;
+                for (size_t j = 0; j < w; j++)
+                    carry[j] = lv[j] + carry[j];
+            }
+            memcpy(work + l * w, carry, w * sizeof(double));
+            count++;
+        }
+
+        for (size_t l = 0; count; count >>= 1, l++)
+        {
+            if (count & 1)
+            {
+                const double *lv = work + l * w;
+                for (size_t j = 0; j < w; j++)
+                    out[j] += lv[j];
+            }
+        }
+
+        free(work);
+    }
+
+    static void columns_task(size_t begin, size_t end, void *arg)
+    {
+        reduce_ctx_t *ctx = arg;
+        size_t rows = ctx->src->shape[0];
+        size_t cols = ctx->src->shape[1];
+
+        for (size_t t = begin; t < end; t++)
+        {
+            size_t rc = t / ctx->ncol_chunks;
+            size_t c0 = (t % ctx->ncol_chunks) * ND_COL_CHUNK;
+            size_t r0 = rc * ND_ROW_CHUNK;
+            size_t r1 = r0 + ND_ROW_CHUNK < rows ? r0 + ND_ROW_CHUNK : rows;
+            size_t w = c0 + ND_COL_CHUNK < cols ? ND_COL_CHUNK : cols - c0;
+            const double *mu = ctx->center != NULL ? ctx->center->data[0] + c0 : NULL;
+            double *out = ctx->out + rc * cols + c0;
+
+            switch (ctx->op)
+            {
+                case ND_REDUCE_SUMSQ:
+                    column_block(ND_REDUCE_SUMSQ, ctx->mode, ctx->src->data, r0, r1, c0, w, mu, out);
+                    break;
+                case ND_REDUCE_SQDEV:
+                    column_block(ND_REDUCE_SQDEV, ctx->mode, ctx->src->data, r0, r1, c0, w, mu, out);
+                    break;
+                default:
+                    column_block(ND_REDUCE_SUM, ctx->mode, ctx->src->data, r0, r1, c0, w, mu, out);
+                    break;
+            }
+        }
+    }
+
+    // Combines nparts partial rows of length cols in place, the result lands in parts[0..cols)
+    static void combine_partials(double *parts, size_t nparts, size_t cols, nd_summation_t mode)
+    {
+        if (mode == ND_SUM_KAHAN)
+        {
+            for (size_t j = 0; j < cols; j++)
+            {
+                double total = parts[j], comp = 0.0;
+                for (size_t p = 1; p < nparts; p++)
+                    neumaier_add(&total, &comp, parts[p * cols + j]);
+                parts[j] = total + comp;
+            }
+            return;
+        }
+
+        for (size_t step = 1; step < nparts; step *= 2)
+        {
+            for (size_t p = 0; p + step < nparts; p += 2 * step)
+            {
+                double *dst = parts + p * cols;
+                const double *src = parts + (p + step) * cols;
+                for (size_t j = 0; j < cols; j++)
+                    dst[j] += src[j];
+            }
+        }
+    }
+
+    ndarray_t nd_reduce_axis(ndarray_t *this, char *axis, nd_reduce_op_t op, ndarray_t *center)
+    {
+        if(isnull(this))
+            {null_error(); exit(EXIT_FAILURE);}
+        if(op == ND_REDUCE_SQDEV && (center == NULL || isnull(center)))
+            {null_error(); exit(EXIT_FAILURE);}
+
+        size_t rows = this->shape[0];
+        size_t cols = this->shape[1];
+
+        reduce_ctx_t ctx = {0};
+        ctx.src = this;
+        ctx.op = op;
+        ctx.center = op == ND_REDUCE_SQDEV ? center : NULL;
+        ctx.mode = nd_get_summation();
+
+        size_t grain = ND_TASK_WORK / cols > 0 ? ND_TASK_WORK / cols : 1;
+
+        if(strcmp(axis, "x") == 0)
+        {
+            if(ctx.center != NULL && (center->shape[0] != rows || center->shape[1] != 1))
+                {shape_error(); exit(EXIT_FAILURE);}
+
+            ndarray_t result = array(rows, 1);
+            ctx.row_centers = true;
+            ctx.out = malloc(rows * sizeof(double));
+            if(ctx.out == NULL)
+                malloc_error();
+
+            nd_parallel_for(rows, grain, rows_task, &ctx);
+
+            for(size_t i = 0; i < rows; i++)
+                result.data[i][0] = ctx.out[i];
+            free(ctx.out);
+            return result;
+        }
+        else if(strcmp(axis, "y") == 0)
+        {
+            if(ctx.center != NULL && (center->shape[0] != 1 || center->shape[1] != cols))
+                {shape_error(); exit(EXIT_FAILURE);}
+
+            ndarray_t result = array(1, cols);
+            size_t nrow_chunks = (rows + ND_ROW_CHUNK - 1) / ND_ROW_CHUNK;
+            ctx.ncol_chunks = (cols + ND_COL_CHUNK - 1) / ND_COL_CHUNK;
+            ctx.out = malloc(nrow_chunks * cols * sizeof(double));
+            if(ctx.out == NULL)
+                malloc_error();
+
+            nd_parallel_for(nrow_chunks * ctx.ncol_chunks, 1, columns_task, &ctx);
+            combine_partials(ctx.out, nrow_chunks, cols, ctx.mode);
+
+            memcpy(result.data[0], ctx.out, cols * sizeof(double));
+            free(ctx.out);
+            return result;
+        }
+        else if(strcmp(axis, "all") == 0)
+        {
+            ndarray_t result = array(1, 1);
+            ctx.out = malloc(rows * sizeof(double));
+            if(ctx.out == NULL)
+                malloc_error();
+
+            nd_parallel_for(rows, grain, rows_task, &ctx);
+
+            result.data[0][0] = nd_reduce_sum(ctx.out, rows);
+            free(ctx.out);
+            return result;
+        }
+        else
+        {
+            axis_error(axis);
+            exit(1);
+        }
+    }
+
+    ndarray_t nd_sum_axis(ndarray_t *this, char *axis)
+    {
+        return nd_reduce_axis(this, axis, ND_REDUCE_SUM, NULL);
+    }
+
+/** Extrema */
+
+typedef struct {
+    double min;
+    double max;
+    size_t imin;
+    size_t imax;
+} extrema_t;
+
+    // Folds a partial that comes later in index order; strict compares keep the first occurrence
+    ALWAYS_INLINE void extrema_merge(extrema_t *acc, const extrema_t *part)
+    {
+        if (part->min < acc->min)
+            {acc->min = part->min; acc->imin = part->imin;}
+        if (part->max > acc->max)
+            {acc->max = part->max; acc->imax = part->imax;}
+    }
+
+    // Both extrema of a contiguous run; each lane tracks its own value and index with selects
+    ND_SIMD_CLONES static extrema_t extrema_run(const double *x, size_t n, size_t offset)
+    {
+        double mn[ND_LANES], mx[ND_LANES];
+        size_t mi[ND_LANES], xi[ND_LANES];
+        size_t i = 0;
+
+        for (size_t k = 0; k < ND_LANES; k++)
+        {
+            mn[k] = INFINITY; mx[k] = -INFINITY;
+            mi[k] = 0; xi[k] = 0;
+        }
+
+        for (; i + ND_LANES <= n; i += ND_LANES)
+        {
+            for (size_t k = 0; k < ND_LANES; k++)
+            {
+                double v = x[i + k];
+                bool lt = v < mn[k], gt = v > mx[k];
+                mn[k] = lt ? v : mn[k];
+                mi[k] = lt ? i + k : mi[k];
+                mx[k] = gt ? v : mx[k];
+                xi[k] = gt ? i + k : xi[k];
+            }
+        }
+
+        extrema_t r = { INFINITY, -INFINITY, 0, 0 };
+        for (size_t k = 0; k < ND_LANES; k++)
+        {
+            if (mn[k] < r.min || (mn[k] == r.min && mi[k] < r.imin))
+                {r.min = mn[k]; r.imin = mi[k];}
+            if (mx[k] > r.max || (mx[k] == r.max && xi[k] < r.imax))
+                {r.max = mx[k]; r.imax = xi[k];}
+        }
+        for (; i < n; i++)
+        {
+            if (x[i] < r.min)
+                {r.min = x[i]; r.imin = i;}
+            if (x[i] > r.max)
+                {r.max = x[i]; r.imax = i;}
+        }
+
+        r.imin += offset;
+        r.imax += offset;
+        return r;
+    }
+
+    // Column extrema of rows [r0, r1) over columns [c0, c0 + w), vectorized across columns
+    ND_SIMD_CLONES static void extrema_columns(double **data, size_t r0, size_t r1, size_t c0, size_t w,
+                                               double *mn, double *mx, size_t *mi, size_t *xi)
+    {
+        for (size_t j = 0; j < w; j++)
+        {
+            mn[j] = INFINITY; mx[j] = -INFINITY;
+            mi[j] = r0; xi[j] = r0;
+        }
+
+        for (size_t i = r0; i < r1; i++)
+        {
+            const double *row = data[i] + c0;
+            for (size_t j = 0; j < w; j++)
+            {
+                double v = row[j];
+                bool lt = v < mn[j], gt = v > mx[j];
+                mn[j] = lt ? v : mn[j];
+                mi[j] = lt ? i : mi[j];
+                mx[j] = gt ? v : mx[j];
+                xi[j] = gt ? i : xi[j];
+            }
+        }
+    }
+
+typedef struct {
+    ndarray_t *src;
+    size_t nchunks;         // column chunks per task row
+    extrema_t *parts;       // "x"/"all": one per (row, chunk) task
+    double *mn, *mx;        // "y": nrow_chunks x cols partials
+    size_t *mi, *xi;
+} extrema_ctx_t;
+
+    static void extrema_rows_task(size_t begin, size_t end, void *arg)
+    {
+        extrema_ctx_t *ctx = arg;
+        size_t cols = ctx->src->shape[1];
+
+        for (size_t t = begin; t < end; t++)
+        {
+            size_t i = t / ctx->nchunks;
+            size_t c0 = (t % ctx->nchunks) * ND_EXTREMA_CHUNK;
+            size_t w = c0 + ND_EXTREMA_CHUNK < cols ? ND_EXTREMA_CHUNK : cols - c0;
+            ctx->parts[t] = extrema_run(ctx->src->data[i] + c0, w, c0);
+        }
+    }
+
+    static void extrema_cols_task(size_t begin, size_t end, void *arg)
+    {
+        extrema_ctx_t *ctx = arg;
+        size_t rows = ctx->src->shape[0];
+        size_t cols = ctx->src->shape[1];
+
+        for (size_t t = begin; t < end; t++)
+        {
+            size_t rc = t / ctx->nchunks;
+            size_t c0 = (t % ctx->nchunks) * ND_COL_CHUNK;
+            size_t w = c0 + ND_COL_CHUNK < cols ? ND_COL_CHUNK : cols - c0;
+            size_t r0 = rc * ND_ROW_CHUNK;
+            size_t r1 = r0 + ND_ROW_CHUNK < rows ? r0 + ND_ROW_CHUNK : rows;
+            size_t off = rc * cols + c0;
+            extrema_columns(ctx->src->data, r0, r1, c0, w, ctx->mn + off, ctx->mx + off, ctx->mi + off, ctx->xi + off);
+        }
+    }
+
+    void nd_minmax(ndarray_t *this, char *axis, ndarray_t *min, ndarray_t *max,
+                   ndarray_t *argmin, ndarray_t *argmax)
+    {
+        if(isnull(this))
+            {null_error(); exit(EXIT_FAILURE);}
+
+        size_t rows = this->shape[0];
+        size_t cols = this->shape[1];
+        bool by_row = strcmp(axis, "x") == 0;
+        bool by_col = strcmp(axis, "y") == 0;
+
+        if(!by_row && !by_col && strcmp(axis, "all") != 0)
+        {
+            axis_error(axis);
+            exit(1);
+        }
+
+        size_t nout = by_row ? rows : by_col ? cols : 1;
+        extrema_t *res = malloc(nout * sizeof(extrema_t));
+        if(res == NULL)
+            malloc_error();
+
+        extrema_ctx_t ctx = {0};
+        ctx.src = this;
+
+        if(by_col)
+        {
+            size_t nrow_chunks = (rows + ND_ROW_CHUNK - 1) / ND_ROW_CHUNK;
+            ctx.nchunks = (cols + ND_COL_CHUNK - 1) / ND_COL_CHUNK;
+            ctx.mn = malloc(2 * nrow_chunks * cols * sizeof(double));
+            ctx.mi = malloc(2 * nrow_chunks * cols * sizeof(size_t));
+            if(ctx.mn == NULL || ctx.mi == NULL)
+                malloc_error();
+            ctx.mx = ctx.mn + nrow_chunks * cols;
+            ctx.xi = ctx.mi + nrow_chunks * cols;
+
+            nd_parallel_for(nrow_chunks * ctx.nchunks, 1, extrema_cols_task, &ctx);
+
+            for(size_t j = 0; j < cols; j++)
+            {
+                res[j] = (extrema_t){ ctx.mn[j], ctx.mx[j], ctx.mi[j], ctx.xi[j] };
+                for(size_t rc = 1; rc < nrow_chunks; rc++)
+                {
+                    size_t off = rc * cols + j;
+                    extrema_t part = { ctx.mn[off], ctx.mx[off], ctx.mi[off], ctx.xi[off] };
+                    extrema_merge(&res[j], &part);
+                }
+            }
+            free(ctx.mn);
+            free(ctx.mi);
+        }
+        else
+        {
+            ctx.nchunks = (cols + ND_EXTREMA_CHUNK - 1) / ND_EXTREMA_CHUNK;
+            ctx.parts = malloc(rows * ctx.nchunks * sizeof(extrema_t));
+            if(ctx.parts == NULL)
+                malloc_error();
+
+            size_t width = cols < ND_EXTREMA_CHUNK ? cols : ND_EXTREMA_CHUNK;
+            size_t grain = ND_TASK_WORK / width > 0 ? ND_TASK_WORK / width : 1;
+            nd_parallel_for(rows * ctx.nchunks, grain, extrema_rows_task, &ctx);
+
+            for(size_t i = 0; i < rows; i++)
+            {
+                extrema_t acc = ctx.parts[i * ctx.nchunks];
+                for(size_t c = 1; c < ctx.nchunks; c++)
+                    extrema_merge(&acc, &ctx.parts[i * ctx.nchunks + c]);
+
+                if(by_row)
+                    res[i] = acc;
+                else
+                {
+                    acc.imin += i * cols;
+                    acc.imax += i * cols;
+                    if(i == 0)
+                        res[0] = acc;
+                    else
+                        extrema_merge(&res[0], &acc);
+                }
+            }
+            free(ctx.parts);
+        }
+
+        // Values are read back at the found positions, so a line of NaN reports NaN
+        size_t out_rows = by_row ? rows : 1;
+        size_t out_cols = by_col ? cols : 1;
+        if(min != NULL)    *min = array(out_rows, out_cols);
+        if(max != NULL)    *max = array(out_rows, out_cols);
+        if(argmin != NULL) *argmin = array(out_rows, out_cols);
+        if(argmax != NULL) *argmax = array(out_rows, out_cols);
+
+        for(size_t o = 0; o < nout; o++)
+        {
+            size_t r = by_row ? o : 0, c = by_col ? o : 0;
+            const double *lo = by_row ? &this->data[o][res[o].imin]
+                             : by_col ? &this->data[res[o].imin][o]
+                             : &this->data[res[o].imin / cols][res[o].imin % cols];
+            const double *hi = by_row ? &this->data[o][res[o].imax]
+                             : by_col ? &this->data[res[o].imax][o]
+                             : &this->data[res[o].imax / cols][res[o].imax % cols];
+
+            if(min != NULL)    min->data[r][c] = *lo;
+            if(max != NULL)    max->data[r][c] = *hi;
+            if(argmin != NULL) argmin->data[r][c] = (double)res[o].imin;
+            if(argmax != NULL) argmax->data[r][c] = (double)res[o].imax;
+        }
+
+        free(res);
+    }
+
+/** Prefix scans */
+
+typedef double v4df __attribute__((vector_size(32)));
+typedef long long v4di __attribute__((vector_size(32)));
+
+    ALWAYS_INLINE double scan_identity(nd_scan_op_t op)
+    {
+        switch (op)
+        {
+            case ND_SCAN_PROD: return 1.0;
+            case ND_SCAN_MIN:  return INFINITY;
+            case ND_SCAN_MAX:  return -INFINITY;
+            default:           return 0.0;
+        }
+    }
+
+    ALWAYS_INLINE double scan_combine(nd_scan_op_t op, double acc, double x)
+    {
+        switch (op)
+        {
+            case ND_SCAN_PROD: return acc * x;
+            case ND_SCAN_MIN:  return x < acc ? x : acc;
+            case ND_SCAN_MAX:  return x > acc ? x : acc;
+            default:           return acc + x;
+        }
+    }
+
+    // Scans n contiguous values starting from carry; returns the last scanned value.
+    // Sums and products scan four values in-register (two shift-and-combine steps)
+    // so the serial dependency is one vector op per four elements instead of four.
+    ALWAYS_INLINE double scan_run(nd_scan_op_t op, const double *in, double *out, size_t n, double carry)
+    {
+        size_t i = 0;
+
+        if (op == ND_SCAN_SUM || op == ND_SCAN_PROD)
+        {
+            const double e = scan_identity(op);
+            const v4df fill = { e, e, e, e };
+            v4df c = { carry, carry, carry, carry };
+
+            for (; i + 4 <= n; i += 4)
+            {
+                v4df v;
+                memcpy(&v, in + i, sizeof(v));
+                v4df s1 = __builtin_shuffle(v, fill, (v4di){ 4, 0, 1, 2 });
+                v = op == ND_SCAN_SUM ? v + s1 : v * s1;
+                v4df s2 = __builtin_shuffle(v, fill, (v4di){ 4, 5, 0, 1 });
+                v = op == ND_SCAN_SUM ? v + s2 : v * s2;
+                v = op == ND_SCAN_SUM ? v + c : v * c;
+                memcpy(out + i, &v, sizeof(v));
+                c = __builtin_shuffle(v, (v4di){ 3, 3, 3, 3 });
+            }
+            carry = c[0];
+        }
+
+        for (; i < n; i++)
+        {
+            carry = scan_combine(op, carry, in[i]);
+            out[i] = carry;
+        }
+        return carry;
+    }
+
+    ALWAYS_INLINE double scan_total(nd_scan_op_t op, const double *in, size_t n)
+    {
+        double lane[4];
+        size_t i = 0;
+
+        for (size_t k = 0; k < 4; k++)
+            lane[k] = scan_identity(op);
+        for (; i + 4 <= n; i += 4)
+            for (size_t k = 0; k < 4; k++)
+                lane[k] = scan_combine(op, lane[k], in[i + k]);
+
+        double total = scan_combine(op, scan_combine(op, lane[0], lane[1]), scan_combine(op, lane[2], lane[3]));
+        for (; i < n; i++)
+            total = scan_combine(op, total, in[i]);
+        return total;
+    }
+
+    // Column scan of rows [r0, r1) over columns [c0, c0 + w), seeded with prev (or the first row)
+    ALWAYS_INLINE void scan_columns(nd_scan_op_t op, double **src, double **dst, size_t r0, size_t r1,
+                                    size_t c0, size_t w, const double *seed)
+    {
+        size_t i = r0;
+        const double *prev = seed;
+
+        if (prev == NULL && i < r1)
+        {
+            if (dst[i] != src[i])
+                memcpy(dst[i] + c0, src[i] + c0, w * sizeof(double));
+            prev = dst[i++] + c0;
+        }
+
+        for (; i < r1; i++)
+        {
+            const double *row = src[i] + c0;
+            double *out = dst[i] + c0;
+            for (size_t j = 0; j < w; j++)
+                out[j] = scan_combine(op, prev[j], row[j]);
+            prev = out;
+        }
+    }
+
+    ALWAYS_INLINE void total_columns(nd_scan_op_t op, double **src, size_t r0, size_t r1,
+                                     size_t c0, size_t w, double *out)
+    {
+        for (size_t j = 0; j < w; j++)
+            out[j] = scan_identity(op);
+        for (size_t i = r0; i < r1; i++)
+        {
+            const double *row = src[i] + c0;
+            for (size_t j = 0; j < w; j++)
+                out[j] = scan_combine(op, out[j], row[j]);
+        }
+    }
+
+    // Out-of-line entry points, one clone per instruction set, with op constant-folded
+#define SCAN_DISPATCH(op, call)                                 \
+    switch (op)                                                 \
+    {                                                           \
+        case ND_SCAN_PROD: call(ND_SCAN_PROD); break;           \
+        case ND_SCAN_MIN:  call(ND_SCAN_MIN); break;            \
+        case ND_SCAN_MAX:  call(ND_SCAN_MAX); break;            \
+        default:           call(ND_SCAN_SUM); break;            \
+    }
+
+    ND_SIMD_CLONES static double scan_segment(nd_scan_op_t op, const double *in, double *out, size_t n, double carry)
+    {
+#define CALL(k) carry = scan_run(k, in, out, n, carry)
+        SCAN_DISPATCH(op, CALL)
+#undef CALL
+        return carry;
+    }
+
+    ND_SIMD_CLONES static double segment_total(nd_scan_op_t op, const double *in, size_t n)
+    {
+        double total = 0.0;
+#define CALL(k) total = scan_total(k, in, n)
+        SCAN_DISPATCH(op, CALL)
+#undef CALL
+        return total;
+    }
+
+    ND_SIMD_CLONES static void column_segment(nd_scan_op_t op, double **src, double **dst, size_t r0, size_t r1,
+                                              size_t c0, size_t w, const double *seed)
+    {
+#define CALL(k) scan_columns(k, src, dst, r0, r1, c0, w, seed)
+        SCAN_DISPATCH(op, CALL)
+#undef CALL
+    }
+
+    ND_SIMD_CLONES static void column_totals(nd_scan_op_t op, double **src, size_t r0, size_t r1,
+                                             size_t c0, size_t w, double *out)
+    {
+#define CALL(k) total_columns(k, src, r0, r1, c0, w, out)
+        SCAN_DISPATCH(op, CALL)
+#undef CALL
+    }
+
+typedef struct {
+    ndarray_t *src;
+    ndarray_t *dst;
+    nd_scan_op_t op;
+    size_t nchunks;         // column chunks per row
+    double *totals;         // pass one: one total per task ("x"/"all"), or per row chunk x cols ("y")
+} scan_ctx_t;
+
+    // Task t covers chunk t % nchunks of row t / nchunks; tasks are in row-major element order
+    static void scan_rows_task(size_t begin, size_t end, void *arg)
+    {
+        scan_ctx_t *ctx = arg;
+        size_t cols = ctx->src->shape[1];
+
+        for (size_t t = begin; t < end; t++)
+        {
+            size_t i = t / ctx->nchunks;
+            size_t c0 = (t % ctx->nchunks) * ND_SCAN_CHUNK;
+            size_t w = c0 + ND_SCAN_CHUNK < cols ? ND_SCAN_CHUNK : cols - c0;
+            const double *in = ctx->src->data[i] + c0;
+
+            if (ctx->totals == NULL)
+                scan_segment(ctx->op, in, ctx->dst->data[i] + c0, w, scan_identity(ctx->op));
+            else
+                ctx->totals[t] = segment_total(ctx->op, in, w);
+        }
+    }
+
+    static void rescan_rows_task(size_t begin, size_t end, void *arg)
+    {
+        scan_ctx_t *ctx = arg;
+        size_t cols = ctx->src->shape[1];
+
+        for (size_t t = begin; t < end; t++)
+        {
+            size_t i = t / ctx->nchunks;
+            size_t c0 = (t % ctx->nchunks) * ND_SCAN_CHUNK;
+            size_t w = c0 + ND_SCAN_CHUNK < cols ? ND_SCAN_CHUNK : cols - c0;
+            scan_segment(ctx->op, ctx->src->data[i] + c0, ctx->dst->data[i] + c0, w, ctx->totals[t]);
+        }
+    }
+
+    // Task t covers row chunk t / nchunks of column chunk t % nchunks
+    static void scan_cols_task(size_t begin, size_t end, void *arg)
+    {
+        scan_ctx_t *ctx = arg;
+        size_t rows = ctx->src->shape[0];
+        size_t cols = ctx->src->shape[1];
+
+        for (size_t t = begin; t < end; t++)
+        {
+            size_t rc = t / ctx->nchunks;
+            size_t c0 = (t % ctx->nchunks) * ND_COL_CHUNK;
+            size_t w = c0 + ND_COL_CHUNK < cols ? ND_COL_CHUNK : cols - c0;
+            size_t r0 = ctx->totals == NULL ? 0 : rc * ND_ROW_CHUNK;
+            size_t r1 = ctx->totals == NULL || r0 + ND_ROW_CHUNK > rows ? rows : r0 + ND_ROW_CHUNK;
+
+            if (ctx->totals == NULL)
+                column_segment(ctx->op, ctx->src->data, ctx->dst->data, r0, r1, c0, w, NULL);
+            else
+                column_totals(ctx->op, ctx->src->data, r0, r1, c0, w, ctx->totals + rc * cols + c0);
+        }
+    }
+
+    static void rescan_cols_task(size_t begin, size_t end, void *arg)
+    {
+        scan_ctx_t *ctx = arg;
+        size_t rows = ctx->src->shape[0];
+        size_t cols = ctx->src->shape[1];
+
+        for (size_t t = begin; t < end; t++)
+        {
+            size_t rc = t / ctx->nchunks;
+            size_t c0 = (t % ctx->nchunks) * ND_COL_CHUNK;
+            size_t w = c0 + ND_COL_CHUNK < cols ? ND_COL_CHUNK : cols - c0;
+            size_t r0 = rc * ND_ROW_CHUNK;
+            size_t r1 = r0 + ND_ROW_CHUNK < rows ? r0 + ND_ROW_CHUNK : rows;
+            column_segment(ctx->op, ctx->src->data, ctx->dst->data, r0, r1, c0, w,
+                           rc == 0 ? NULL : ctx->totals + rc * cols + c0);
+        }
+    }
+
+    ndarray_t nd_scan(ndarray_t *this, ndarray_t *out, char *axis, nd_scan_op_t op)
+    {
+        if(isnull(this))
+            {null_error(); exit(EXIT_FAILURE);}
+
+        size_t rows = this->shape[0];
+        size_t cols = this->shape[1];
+        bool along_rows = strcmp(axis, "x") == 0;
+        bool flat = strcmp(axis, "all") == 0;
+
+        if(!along_rows && !flat && strcmp(axis, "y") != 0)
+        {
+            axis_error(axis);
+            exit(1);
+        }
+
+        ndarray_t result;
+        if(out == NULL)
+            result = array(rows, cols);
+        else
+        {
+            if(isnull(out))
+                {null_error(); exit(EXIT_FAILURE);}
+            if(out->shape[0] != rows || out->shape[1] != cols)
+                {shape_error(); exit(EXIT_FAILURE);}
+            result = *out;
+        }
+
+        scan_ctx_t ctx = { this, &result, op, 0, NULL };
+        bool threaded = nd_get_num_threads() > 1;
+
+        if(!along_rows && !flat)
+        {
+            // Columns are independent; long columns are split into row chunks and rescanned
+            ctx.nchunks = (cols + ND_COL_CHUNK - 1) / ND_COL_CHUNK;
+            size_t nrow_chunks = (rows + ND_ROW_CHUNK - 1) / ND_ROW_CHUNK;
+
+            if(!threaded || nrow_chunks <= 1 || ctx.nchunks >= nd_get_num_threads())
+            {
+                nd_parallel_for(ctx.nchunks, 1, scan_cols_task, &ctx);
+                return result;
+            }
+
+            ctx.totals = malloc(nrow_chunks * cols * sizeof(double));
+            if(ctx.totals == NULL)
+                malloc_error();
+
+            nd_parallel_for(nrow_chunks * ctx.nchunks, 1, scan_cols_task, &ctx);
+
+            // Replace each chunk's totals by the carry it starts from; the first
+            // chunk needs none, so its row doubles as the running accumulator
+            double *run = ctx.totals;
+            for(size_t rc = 1; rc < nrow_chunks; rc++)
+            {
+                double *cur = ctx.totals + rc * cols;
+                for(size_t j = 0; j < cols; j++)
+                {
+                    double t = cur[j];
+                    cur[j] = run[j];
+                    run[j] = scan_combine(op, run[j], t);
+                }
+            }
+
+            nd_parallel_for(nrow_chunks * ctx.nchunks, 1, rescan_cols_task, &ctx);
+            free(ctx.totals);
+            return result;
+        }
+
+        ctx.nchunks = (cols + ND_SCAN_CHUNK - 1) / ND_SCAN_CHUNK;
+        size_t ntasks = rows * ctx.nchunks;
+        size_t grain = ND_TASK_WORK / cols > 0 ? ND_TASK_WORK / cols : 1;
+
+        if(along_rows && ctx.nchunks == 1)
+        {
+            // Short rows scan independently in a single pass
+            nd_parallel_for(rows, grain, scan_rows_task, &ctx);
+            return result;
+        }
+
+        if(!threaded || ntasks == 1)
+        {
+            double carry = scan_identity(op);
+            for(size_t i = 0; i < rows; i++)
+                carry = scan_segment(op, this->data[i], result.data[i], cols, along_rows ? scan_identity(op) : carry);
+            return result;
+        }
+
+        // Pass one: every chunk's total; then an exclusive scan of the totals
+        // (restarting at each row for "x"); pass two: rescan with the carries
+        ctx.totals = malloc(ntasks * sizeof(double));
+        if(ctx.totals == NULL)
+            malloc_error();
+
+        nd_parallel_for(ntasks, grain, scan_rows_task, &ctx);
+
+        double carry = scan_identity(op);
+        for(size_t t = 0; t < ntasks; t++)
+        {
+            if(along_rows && t % ctx.nchunks == 0)
+                carry = scan_identity(op);
+            double total = ctx.totals[t];
+            ctx.totals[t] = carry;
+            carry = scan_combine(op, carry, total);
+        }
+
+        nd_parallel_for(ntasks, grain, rescan_rows_task, &ctx);
+        free(ctx.totals);
+        return result;
+    }
+
+    ndarray_t nd_cumsum(ndarray_t *this, ndarray_t *out, char *axis)
+    {
+        return nd_scan(this, out, axis, ND_SCAN_SUM);
+    }
+
+    ndarray_t nd_cumprod(ndarray_t *this, ndarray_t *out, char *axis)
+    {
+        return nd_scan(this, out, axis, ND_SCAN_PROD);
+    }
+
+    ndarray_t nd_cummin(ndarray_t *this, ndarray_t *out, char *axis)
+    {
+        return nd_scan(this, out, axis, ND_SCAN_MIN);
+    }
+
+    ndarray_t nd_cummax(ndarray_t *this, ndarray_t *out, char *axis)
+    {
+        return nd_scan(this, out, axis, ND_SCAN_MAX);
+    }
+
+#pragma GCC pop_options
@@ -0,0 +1,586 @@
+#include <ndmath/sort.h>
+#include <ndmath/parallel.h>
+#include <ndmath/array.h>
+#include <ndmath/error.h>
+#include <ndmath/conditionals.h>
+#include <stdint.h>
+
+#pragma GCC push_options
+#pragma GCC optimize("O3", "unroll-loops")
+
+#define SR_INSERTION 32             // runs sorted by insertion
+#define SR_MERGE_MAX 4096           // above this, radix sort
+#define SR_PARALLEL_MIN (1 << 19)   // lines at least this long are sorted in chunks on the pool
+#define SR_CHUNK (1 << 18)          // elements per radix-sorted chunk, a multiple of SR_PIECE
+#define SR_PIECE (1 << 16)          // output elements per merge task
+#define SR_TASK_WORK 32768          // elements per task when lines are independent
+
+#define ALWAYS_INLINE static inline __attribute__((always_inline))
+#define SIGN_BIT ((uint64_t)1 << 63)
+
+typedef enum { LINE_ROW, LINE_COL, LINE_ALL } line_mode_t;
+typedef enum { JOB_SORT, JOB_ARGSORT, JOB_PARTITION, JOB_TOPK } sort_job_t;
+
+// Key and index buffers of one line; idx/tidx are NULL when indices are not tracked
+typedef struct {
+    uint64_t *key;
+    uint64_t *tkey;
+    size_t *idx;
+    size_t *tidx;
+} scratch_t;
+
+/** Keys */
+
+    // Order-preserving map from doubles to unsigned integers, NaN last
+    ALWAYS_INLINE uint64_t to_key(double x)
+    {
+        uint64_t u;
+        memcpy(&u, &x, sizeof(u));
+        if (x != x)
+            return UINT64_MAX;
+        return (u & SIGN_BIT) ? ~u : u | SIGN_BIT;
+    }
+
+    ALWAYS_INLINE double from_key(uint64_t k)
+    {
+        uint64_t u = (k & SIGN_BIT) ? k & ~SIGN_BIT : ~k;
+        double x;
+        memcpy(&x, &u, sizeof(x));
+        return x;
+    }
+
+    static scratch_t scratch_alloc(size_t n, bool with_idx)
+    {
+        scratch_t s = {0};
+        s.key = malloc(2 * n * sizeof(uint64_t));
+        if (s.key == NULL)
+            malloc_error();
+        s.tkey = s.key + n;
+
+        if (with_idx)
+        {
+            s.idx = malloc(2 * n * sizeof(size_t));
+            if (s.idx == NULL)
+                malloc_error();
+            s.tidx = s.idx + n;
+        }
+        return s;
+    }
+
+    static void scratch_free(scratch_t *s)
+    {
+        free(s->key);
+        free(s->idx);
+    }
+
+    ALWAYS_INLINE scratch_t scratch_at(const scratch_t *s, size_t offset)
+    {
+        scratch_t sub = { s->key + offset, s->tkey + offset,
+                          s->idx ? s->idx + offset : NULL, s->tidx ? s->tidx + offset : NULL };
+        return sub;
+    }
+
+/** Serial sorts, all stable */
+
+    static void insertion_sort(uint64_t *key, size_t *idx, size_t n)
+    {
+        for (size_t i = 1; i < n; i++)
+        {
+            uint64_t k = key[i];
+            size_t x = idx ? idx[i] : 0;
+            size_t j = i;
+
+            for (; j > 0 && key[j - 1] > k; j--)
+            {
+                key[j] = key[j - 1];
+                if (idx)
+                    idx[j] = idx[j - 1];
+            }
+            key[j] = k;
+            if (idx)
+                idx[j] = x;
+        }
+    }
+
+    // Writes count merged elements of A[i..na) and B[j..nb) to out; A wins ties
+    static void merge_count(const uint64_t *a, const size_t *ai, size_t i, size_t na,
+                            const uint64_t *b, const size_t *bi, size_t j, size_t nb,
+                            uint64_t *out, size_t *oi, size_t count)
+    {
+        for (size_t o = 0; o < count; o++)
+        {
+            if (j >= nb || (i < na && a[i] <= b[j]))
+            {
+                if (oi)
+                    oi[o] = ai[i];
+                out[o] = a[i++];
+            }
+            else
+            {
+                if (oi)
+                    oi[o] = bi[j];
+                out[o] = b[j++];
+            }
+        }
+    }
+
+    static void merge_sort(scratch_t *s, size_t n)
+    {
+        for (size_t r = 0; r < n; r += SR_INSERTION)
+            insertion_sort(s->key + r, s->idx ? s->idx + r : NULL, r + SR_INSERTION < n ? SR_INSERTION : n - r);
+
+        uint64_t *src = s->key, *dst = s->tkey;
+        size_t *si = s->idx, *di = s->tidx;
+
+        for (size_t w = SR_INSERTION; w < n; w *= 2)
+        {
+            for (size_t lo = 0; lo < n; lo += 2 * w)
+            {
+                size_t mid = lo + w < n ? lo + w : n;
+                size_t hi = lo + 2 * w < n ? lo + 2 * w : n;
+                merge_count(src + lo, si ? si + lo : NULL, 0, mid - lo,
+                            src + mid, si ? si + mid : NULL, 0, hi - mid,
+                            dst + lo, di ? di + lo : NULL, hi - lo);
+            }
+            uint64_t *tk = src; src = dst; dst = tk;
+            size_t *ti = si; si = di; di = ti;
+        }
+
+        if (src != s->key)
+        {
+            memcpy(s->key, src, n * sizeof(uint64_t));
+            if (s->idx)
+                memcpy(s->idx, si, n * sizeof(size_t));
+        }
+    }
+
+    // LSD radix sort, one histogram pass for all eight digits
+    static void radix_sort(scratch_t *s, size_t n)
+    {
+        static const size_t DIGITS = 8;
+        size_t count[8][256];
+        memset(count, 0, sizeof(count));
+
+        for (size_t i = 0; i < n; i++)
+        {
+            uint64_t k = s->key[i];
+            for (size_t d = 0; d < DIGITS; d++)
+                count[d][(k >> (8 * d)) & 0xff]++;
+        }
+
+        uint64_t *src = s->key, *dst = s->tkey;
+        size_t *si = s->idx, *di = s->tidx;
+
+        for (size_t d = 0; d < DIGITS; d++)
+        {
+            size_t shift = 8 * d;
+            if (count[d][(src[0] >> shift) & 0xff] == n)
+                continue;   // every key has the same digit here
+
+            size_t offset[256], sum = 0;
+            for (size_t b = 0; b < 256; b++)
+            {
+                offset[b] = sum;
+                sum += count[d][b];
+            }
+
+            for (size_t i = 0; i < n; i++)
+            {
+                size_t pos = offset[(src[i] >> shift) & 0xff]++;
+                dst[pos] = src[i];
+                if (si)
+                    di[pos] = si[i];
+            }
+            uint64_t *tk = src; src = dst; dst = tk;
+            size_t *ti = si; si = di; di = ti;
+        }
+
+        if (src != s->key)
+        {
+            memcpy(s->key, src, n * sizeof(uint64_t));
+            if (s->idx)
+                memcpy(s->idx, si, n * sizeof(size_t));
+        }
+    }
+
+    static void sort_serial(scratch_t *s, size_t n)
+    {
+        if (n <= SR_INSERTION)
+            insertion_sort(s->key, s->idx, n);
+        else if (n <= SR_MERGE_MAX)
+            merge_sort(s, n);
+        else
+            radix_sort(s, n);
+    }
+
+/** Parallel sort of one long line */
+
+typedef struct {
+    scratch_t *s;
+    size_t n;
+    size_t width;                   // length of the sorted runs being merged
+    const uint64_t *src;
+    const size_t *si;
+    uint64_t *dst;
+    size_t *di;
+} psort_ctx_t;
+
+    static void chunk_sort_task(size_t begin, size_t end, void *arg)
+    {
+        psort_ctx_t *ctx = arg;
+        for (size_t c = begin; c < end; c++)
+        {
+            size_t lo = c * SR_CHUNK;
+            scratch_t sub = scratch_at(ctx->s, lo);
+            sort_serial(&sub, lo + SR_CHUNK < ctx->n ? SR_CHUNK : ctx->n - lo);
+        }
+    }
+
+    // Number of elements of A among the first d outputs of a stable merge of A and B
+    static size_t merge_path(const uint64_t *a, size_t na, const uint64_t *b, size_t nb, size_t d)
+    {
+        size_t lo = d > nb ? d - nb : 0;
+        size_t hi = d < na ? d : na;
+        while (lo < hi)
+        {
+            size_t mid = lo + (hi - lo) / 2;
+            if (a[mid] <= b[d - 1 - mid])
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    // Piece t writes outputs [t * SR_PIECE, ...) of the pair of runs that contains it
+    static void merge_piece_task(size_t begin, size_t end, void *arg)
+    {
+        psort_ctx_t *ctx = arg;
+        size_t w = ctx->width;
+
+        for (size_t t = begin; t < end; t++)
+        {
+            size_t p0 = t * SR_PIECE;
+            size_t p1 = p0 + SR_PIECE < ctx->n ? p0 + SR_PIECE : ctx->n;
+            size_t lo = p0 / (2 * w) * (2 * w);
+            size_t mid = lo + w < ctx->n ? lo + w : ctx->n;
+            size_t hi = lo + 2 * w < ctx->n ? lo + 2 * w : ctx->n;
+
+            const uint64_t *a = ctx->src + lo, *b = ctx->src + mid;
+            const size_t *ai = ctx->si ? ctx->si + lo : NULL, *bi = ctx->si ? ctx->si + mid : NULL;
+            size_t i = merge_path(a, mid - lo, b, hi - mid, p0 - lo);
+
+            merge_count(a, ai, i, mid - lo, b, bi, p0 - lo - i, hi - mid,
+                        ctx->dst + p0, ctx->di ? ctx->di + p0 : NULL, p1 - p0);
+        }
+    }
+
+    static void sort_parallel(scratch_t *s, size_t n)
+    {
+        psort_ctx_t ctx = { s, n, SR_CHUNK, NULL, NULL, NULL, NULL };
+        nd_parallel_for((n + SR_CHUNK - 1) / SR_CHUNK, 1, chunk_sort_task, &ctx);
+
+        uint64_t *src = s->key, *dst = s->tkey;
+        size_t *si = s->idx, *di = s->tidx;
+
+        for (size_t w = SR_CHUNK; w < n; w *= 2)
+        {
+            ctx.width = w;
+            ctx.src = src; ctx.si = si;
+            ctx.dst = dst; ctx.di = di;
+            nd_parallel_for((n + SR_PIECE - 1) / SR_PIECE, 1, merge_piece_task, &ctx);
+
+            uint64_t *tk = src; src = dst; dst = tk;
+            size_t *ti = si; si = di; di = ti;
+        }
+
+        if (src != s->key)
+        {
+            memcpy(s->key, src, n * sizeof(uint64_t));
+            if (s->idx)
+                memcpy(s->idx, si, n * sizeof(size_t));
+        }
+    }
+
+    static void sort_line(scratch_t *s, size_t n)
+    {
+        if (n >= SR_PARALLEL_MIN && nd_get_num_threads() > 1)
+            sort_parallel(s, n);
+        else
+            sort_serial(s, n);
+    }
+
+/** Selection */
+
+    ALWAYS_INLINE void swap_at(uint64_t *key, size_t *idx, size_t a, size_t b)
+    {
+        uint64_t k = key[a]; key[a] = key[b]; key[b] = k;
+        if (idx)
+        {
+            size_t x = idx[a]; idx[a] = idx[b]; idx[b] = x;
+        }
+    }
+
+    // Introselect: afterwards key[kth] holds its sorted value, smaller keys before, larger after
+    static void select_kth(scratch_t *s, size_t n, size_t kth)
+    {
+        uint64_t *key = s->key;
+        size_t *idx = s->idx;
+        size_t lo = 0, hi = n;
+        size_t budget = 2 * (64 - __builtin_clzll((unsigned long long)n | 1));
+
+        while (hi - lo > SR_INSERTION)
+        {
+            if (budget-- == 0)
+            {
+                // Too many unbalanced rounds: finish with a guaranteed O(n log n) sort
+                scratch_t sub = scratch_at(s, lo);
+                sort_serial(&sub, hi - lo);
+                return;
+            }
+
+            uint64_t a = key[lo], b = key[lo + (hi - lo) / 2], c = key[hi - 1];
+            uint64_t pivot = a < b ? (b < c ? b : (a < c ? c : a)) : (a < c ? a : (b < c ? c : b));
+
+            // Three-way partition: [lo, lt) < pivot, [lt, gt) == pivot, [gt, hi) > pivot
+            size_t lt = lo, i = lo, gt = hi;
+            while (i < gt)
+            {
+                if (key[i] < pivot)
+                    swap_at(key, idx, lt++, i++);
+                else if (key[i] > pivot)
+                    swap_at(key, idx, i, --gt);
+                else
+                    i++;
+            }
+
+            if (kth < lt)
+                hi = lt;
+            else if (kth >= gt)
+                lo = gt;
+            else
+                return;
+        }
+
+        insertion_sort(key + lo, idx ? idx + lo : NULL, hi - lo);
+    }
+
+/** Lines */
+
+typedef struct {
+    ndarray_t *src;
+    ndarray_t *out;
+    ndarray_t *out_idx;
+    line_mode_t mode;
+    sort_job_t job;
+    size_t len;                     // input line length
+    size_t k;                       // kth for partition, count for top-k
+    bool largest;
+} sort_ctx_t;
+
+    static void gather_keys(const sort_ctx_t *ctx, size_t l, uint64_t *key)
+    {
+        double **data = ctx->src->data;
+        size_t rows = ctx->src->shape[0], cols = ctx->src->shape[1];
+
+        switch (ctx->mode)
+        {
+            case LINE_ROW:
+                for (size_t j = 0; j < cols; j++)
+                    key[j] = to_key(data[l][j]);
+                break;
+            case LINE_COL:
+                for (size_t i = 0; i < rows; i++)
+                    key[i] = to_key(data[i][l]);
+                break;
+            default:
+                for (size_t i = 0; i < rows; i++)
+                    for (size_t j = 0; j < cols; j++)
+                        key[i * cols + j] = to_key(data[i][j]);
+                break;
+        }
+    }
+
+    // Writes n values (flipped keys when flip is set) or n indices to line l of out
+    static void scatter_line(const sort_ctx_t *ctx, ndarray_t *out, size_t l, const uint64_t *key,
+                             const size_t *idx, size_t n, bool flip)
+    {
+        double **data = out->data;
+        size_t ocols = out->shape[1];
+        size_t i = 0, j = 0;
+
+        for (size_t p = 0; p < n; p++)
+        {
+            double v = idx ? (double)idx[p] : from_key(flip ? ~key[p] : key[p]);
+            switch (ctx->mode)
+            {
+                case LINE_ROW: data[l][p] = v; break;
+                case LINE_COL: data[p][l] = v; break;
+                default:
+                    data[i][j] = v;
+                    if (++j == ocols)
+                        {j = 0; i++;}
+                    break;
+            }
+        }
+    }
+
+    static void line_task(size_t begin, size_t end, void *arg)
+    {
+        sort_ctx_t *ctx = arg;
+        size_t n = ctx->len;
+        bool with_idx = ctx->job == JOB_ARGSORT || (ctx->job == JOB_TOPK && ctx->out_idx != NULL);
+        bool flip = ctx->job == JOB_TOPK && ctx->largest;
+        scratch_t s = scratch_alloc(n, with_idx);
+
+        for (size_t l = begin; l < end; l++)
+        {
+            gather_keys(ctx, l, s.key);
+            if (with_idx)
+                for (size_t p = 0; p < n; p++)
+                    s.idx[p] = p;
+            if (flip)
+                for (size_t p = 0; p < n; p++)
+                    s.key[p] = ~s.key[p];
+
+            switch (ctx->job)
+            {
+                case JOB_PARTITION:
+                    select_kth(&s, n, ctx->k);
+                    scatter_line(ctx, ctx->out, l, s.key, NULL, n, false);
+                    break;
+                case JOB_TOPK:
+                    if (ctx->k < n)
+                        select_kth(&s, n, ctx->k - 1);
+                    sort_line(&s, ctx->k);
+                    scatter_line(ctx, ctx->out, l, s.key, NULL, ctx->k, flip);
+                    if (with_idx)
+                        scatter_line(ctx, ctx->out_idx, l, NULL, s.idx, ctx->k, false);
+                    break;
+                default:
+                    sort_line(&s, n);
+                    scatter_line(ctx, ctx->out, l, s.key, ctx->job == JOB_ARGSORT ? s.idx : NULL, n, false);
+                    break;
+            }
+        }
+
+        scratch_free(&s);
+    }
+
+    static line_mode_t parse_axis(char *axis)
+    {
+        if(strcmp(axis, "x") == 0)
+            return LINE_ROW;
+        if(strcmp(axis, "y") == 0)
+            return LINE_COL;
+        if(strcmp(axis, "all") == 0)
+            return LINE_ALL;
+        axis_error(axis);
+        exit(1);
+    }
+
+    static void run_lines(sort_ctx_t *ctx)
+    {
+        size_t rows = ctx->src->shape[0], cols = ctx->src->shape[1];
+        size_t nlines = ctx->mode == LINE_ROW ? rows : ctx->mode == LINE_COL ? cols : 1;
+        size_t grain = SR_TASK_WORK / ctx->len > 0 ? SR_TASK_WORK / ctx->len : 1;
+        nd_parallel_for(nlines, grain, line_task, ctx);
+    }
+
+    static sort_ctx_t make_ctx(ndarray_t *this, char *axis, sort_job_t job)
+    {
+        if(isnull(this))
+            {null_error(); exit(EXIT_FAILURE);}
+
+        sort_ctx_t ctx = {0};
+        ctx.src = this;
+        ctx.job = job;
+        ctx.mode = parse_axis(axis);
+        ctx.len = ctx.mode == LINE_ROW ? this->shape[1]
+                : ctx.mode == LINE_COL ? this->shape[0]
+                : this->shape[0] * this->shape[1];
+        return ctx;
+    }
+
+    static ndarray_t prepare_out(ndarray_t *this, ndarray_t *out)
+    {
+        if(out == NULL)
+            return array(this->shape[0], this->shape[1]);
+
+        if(isnull(out))
+            {null_error(); exit(EXIT_FAILURE);}
+        if(out->shape[0] != this->shape[0] || out->shape[1] != this->shape[1])
+            {shape_error(); exit(EXIT_FAILURE);}
+        return *out;
+    }
+
+/** Public entry points */
+
+    void nd_sort_buffer(double *x, size_t n)
+    {
+        if(x == NULL || n < 2)
+            return;
+
+        scratch_t s = scratch_alloc(n, false);
+        for(size_t i = 0; i < n; i++)
+            s.key[i] = to_key(x[i]);
+        sort_line(&s, n);
+        for(size_t i = 0; i < n; i++)
+            x[i] = from_key(s.key[i]);
+        scratch_free(&s);
+    }
+
+    ndarray_t nd_sort(ndarray_t *this, ndarray_t *out, char *axis)
+    {
+        sort_ctx_t ctx = make_ctx(this, axis, JOB_SORT);
+        ndarray_t result = prepare_out(this, out);
+        ctx.out = &result;
+        run_lines(&ctx);
+        return result;
+    }
+
+    ndarray_t nd_argsort(ndarray_t *this, char *axis)
+    {
+        sort_ctx_t ctx = make_ctx(this, axis, JOB_ARGSORT);
+        ndarray_t result = array(this->shape[0], this->shape[1]);
+        ctx.out = &result;
+        run_lines(&ctx);
+        return result;
+    }
+
+    ndarray_t nd_partition(ndarray_t *this, ndarray_t *out, size_t kth, char *axis)
+    {
+        sort_ctx_t ctx = make_ctx(this, axis, JOB_PARTITION);
+        if(kth >= ctx.len)
+            index_error();
+
+        ndarray_t result = prepare_out(this, out);
+        ctx.out = &result;
+        ctx.k = kth;
+        run_lines(&ctx);
+        return result;
+    }
+
+    ndarray_t nd_topk(ndarray_t *this, size_t k, char *axis, bool largest, ndarray_t *indices)
+    {
+        sort_ctx_t ctx = make_ctx(this, axis, JOB_TOPK);
+        if(k == 0 || k > ctx.len)
+            index_error();
+
+        size_t rows = ctx.mode == LINE_ROW ? this->shape[0] : ctx.mode == LINE_COL ? k : 1;
+        size_t cols = ctx.mode == LINE_ROW ? k : ctx.mode == LINE_COL ? this->shape[1] : k;
+
+        ndarray_t result = array(rows, cols);
+        if(indices != NULL)
+        {
+            *indices = array(rows, cols);
+            ctx.out_idx = indices;
+        }
+        ctx.out = &result;
+        ctx.k = k;
+        ctx.largest = largest;
+        run_lines(&ctx);
+        return result;
+    }
+
+#pragma GCC pop_options
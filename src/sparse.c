@@ -0,0 +1,185 @@
+#include <ndmath/sparse.h>
+#include <ndmath/parallel.h>
+#include <ndmath/array.h>
+#include <ndmath/error.h>
+#include <ndmath/conditionals.h>
+#include <math.h>
+#include <string.h>
+
+#pragma GCC push_options
+#pragma GCC optimize("O3", "unroll-loops")
+
+#define SP_ROW_WORK 16384       // stored entries per task in products
+
+/** Construction */
+
+    static nd_csr_t csr_alloc(size_t rows, size_t cols, size_t nnz)
+    {
+        if(rows == 0 || cols == 0)
+            shape_error();
+
+        nd_csr_t A = {0};
+        A.shape[0] = rows;
+        A.shape[1] = cols;
+        A.nnz = nnz;
+        A.row_ptr = calloc(rows + 1, sizeof(size_t));
+        A.col = malloc(sizeof(size_t) * (nnz > 0 ? nnz : 1));
+        A.val = malloc(sizeof(double) * (nnz > 0 ? nnz : 1));
+        if(A.row_ptr == NULL || A.col == NULL || A.val == NULL)
+            malloc_error();
+        return A;
+    }
+
+    nd_csr_t nd_csr_from_triplets(size_t rows, size_t cols, size_t count,
+                                  const size_t *ri, const size_t *ci, const double *v)
+    {
+        if(rows == 0 || cols == 0)
+            shape_error();
+        if(count > 0 && (ri == NULL || ci == NULL || v == NULL))
+            {null_error(); exit(EXIT_FAILURE);}
+        for(size_t t = 0; t < count; t++)
+            if(ri[t] >= rows || ci[t] >= cols)
+                index_error();
+
+        // Counting sort by column, then a stable one by row: (row, column) order
+        size_t *start = calloc((rows > cols ? rows : cols) + 1, sizeof(size_t));
+        size_t *by_col = malloc(sizeof(size_t) * (count > 0 ? count : 1));
+        size_t *order = malloc(sizeof(size_t) * (count > 0 ? count : 1));
+        if(start == NULL || by_col == NULL || order == NULL)
+            malloc_error();
+
+        for(size_t t = 0; t < count; t++)
+            start[ci[t] + 1]++;
+        for(size_t c = 0; c < cols; c++)
+            start[c + 1] += start[c];
+        for(size_t t = 0; t < count; t++)
+            by_col[start[ci[t]]++] = t;
+
+        memset(start, 0, sizeof(size_t) * (rows + 1));
+        for(size_t t = 0; t < count; t++)
+            start[ri[t] + 1]++;
+        for(size_t r = 0; r < rows; r++)
+            start[r + 1] += start[r];
+        for(size_t k = 0; k < count; k++)
+        {
+            size_t t = by_col[k];
+            order[start[ri[t]]++] = t;
+        }
+
+        // Sorted triplets with duplicates merged; start[r] now ends row r
+        nd_csr_t A = csr_alloc(rows, cols, count);
+        size_t nnz = 0;
+        for(size_t r = 0, k = 0; r < rows; r++)
+        {
+            for(; k < start[r]; k++)
+            {
+                size_t t = order[k];
+                if(nnz > A.row_ptr[r] && A.col[nnz - 1] == ci[t])
+                    A.val[nnz - 1] += v[t];
+                else
+                {
+                    A.col[nnz] = ci[t];
+                    A.val[nnz] = v[t];
+                    nnz++;
+                }
+            }
+            A.row_ptr[r + 1] = nnz;
+        }
+        A.nnz = nnz;
+
+        free(start);
+        free(by_col);
+        free(order);
+        return A;
+    }
+
+    nd_csr_t nd_csr_from_dense(ndarray_t *this, double drop)
+    {
+        if(isnull(this))
+            {null_error(); exit(EXIT_FAILURE);}
+
+        size_t rows = this->shape[0], cols = this->shape[1], nnz = 0;
+        for(size_t i = 0; i < rows; i++)
+            for(size_t j = 0; j < cols; j++)
+                nnz += fabs(this->data[i][j]) > drop;
+
+        nd_csr_t A = csr_alloc(rows, cols, nnz);
+        size_t k = 0;
+        for(size_t i = 0; i < rows; i++)
+        {
+            for(size_t j = 0; j < cols; j++)
+                if(fabs(this->data[i][j]) > drop)
+                {
+                    A.col[k] = j;
+                    A.val[k] = this->data[i][j];
+                    k++;
+                }
+            A.row_ptr[i + 1] = k;
+        }
+        return A;
+    }
+
+    ndarray_t nd_csr_to_dense(const nd_csr_t *A)
+    {
+        if(A == NULL || A->row_ptr == NULL)
+            {null_error(); exit(EXIT_FAILURE);}
+
+        ndarray_t D = zeros(A->shape[0], A->shape[1]);
+        for(size_t i = 0; i < A->shape[0]; i++)
+            for(size_t k = A->row_ptr[i]; k < A->row_ptr[i + 1]; k++)
+                D.data[i][A->col[k]] = A->val[k];
+        return D;
+    }
+
+    void nd_csr_free(nd_csr_t *A)
+    {
+        if(A == NULL)
+            return;
+        free(A->row_ptr);
+        free(A->col);
+        free(A->val);
+        A->row_ptr = NULL;
+        A->col = NULL;
+        A->val = NULL;
+    }
+
+/** Products */
+
+typedef struct {
+    const nd_csr_t *A;
+    const double *x;
+    double *y;
+} csr_matvec_ctx_t;
+
+    static void csr_matvec_task(size_t begin, size_t end, void *ctx)
+    {
+        csr_matvec_ctx_t *mc = ctx;
+        const size_t *row_ptr = mc->A->row_ptr, *col = mc->A->col;
+        const double *val = mc->A->val, *x = mc->x;
+        for (size_t i = begin; i < end; i++)
+        {
+            double s0 = 0.0, s1 = 0.0;
+            size_t k = row_ptr[i], k1 = row_ptr[i + 1];
+            for (; k + 2 <= k1; k += 2)
+            {
+                s0 += val[k] * x[col[k]];
+                s1 += val[k + 1] * x[col[k + 1]];
+            }
+            if (k < k1)
+                s0 += val[k] * x[col[k]];
+            mc->y[i] = s0 + s1;
+        }
+    }
+
+    void nd_csr_matvec(const nd_csr_t *A, const double *x, double *y)
+    {
+        if(A == NULL || A->row_ptr == NULL || x == NULL || y == NULL)
+            {null_error(); exit(EXIT_FAILURE);}
+
+        size_t rows = A->shape[0];
+        size_t grain = SP_ROW_WORK / (A->nnz / rows + 1) + 1;
+        csr_matvec_ctx_t mc = {A, x, y};
+        nd_parallel_for(rows, grain, csr_matvec_task, &mc);
+    }
+
+#pragma GCC pop_options
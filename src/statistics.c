@@ -4,6 +4,7 @@
 #include <ndmath/error.h>
 #include <ndmath/helper.h>
 #include <ndmath/conditionals.h>
+#include <ndmath/reduce.h>
 #include <math.h>
 
 ndarray_t mean (ndarray_t *this, char *axis)
@@ -11,66 +12,27 @@ ndarray_t mean (ndarray_t *this, char *axis)
     if(isnull(this))
             {null_error(); exit(EXIT_FAILURE);}
 
-    
-    double temp = 0;
-    if(strcmp(axis, "x") == 0)
+    if(this->size  == 0)
     {
-        ndarray_t result = array(this->shape[0], 1);
-        for(int i=0; i<(int)this->shape[0]; i++)
-        {
-            for(int j=0; j<(int)this->shape[1]; j++)
-            {
-                temp += this->data[i][j];
-            }
-            result.data[i][0] = temp;
-            result.data[i][0] = result.data[i][0]/(double)this->shape[1];
-            temp = 0;
-        }
-        return result;
-
+        zero_error();
     }
+
+    ndarray_t result = nd_sum_axis(this, axis);
+
+    double count = (double)this->size;
+    if(strcmp(axis, "x") == 0)
+        count = (double)this->shape[1];
     else if(strcmp(axis, "y") == 0)
-    {
-        ndarray_t result = array(1, this->shape[1]);            
-        for(int i=0; i<(int)this->shape[1]; i++)
-        {
-            for(int j=0; j<(int)this->shape[0]; j++)
-            {
-                temp += this->data[j][i];
-            }
-            result.data[0][i] = temp;
-            result.data[0][i] = result.data[0][i]/(double)this->shape[0];
-            temp = 0;
-        }
-        return result;
+        count = (double)this->shape[0];
 
-    }
-    else if(strcmp(axis, "all") == 0)
+    for(size_t i=0; i<result.shape[0]; i++)
     {
-        ndarray_t result = array(1, 1);
-         if(this->size  == 0)    
-        {   
-                fprintf(stderr, "Division by zero \n");
-                perror("A division by zero occured\n");
-                exit(1);
-        }
-
-        for(int i=0; i<(int)this->shape[0]; i++)
+        for(size_t j=0; j<result.shape[1]; j++)
         {
-            for(int j=0; j<(int)this->shape[1]; j++)
-            {
-                result.data[0][0] += this->data[i][j];
-            }
+            result.data[i][j] = result.data[i][j]/count;
         }
-        result.data[0][0] = result.data[0][0]/(double)this->size;
-        return result;
-    }
-    else
-    {
-            fprintf(stderr, "Unkown Axis\n");
-            perror("Provide a valid axis\n");
-            exit(1);
     }
+    return result;
 } 
 
 
@@ -79,71 +41,26 @@ ndarray_t variance (ndarray_t *this, char *axis)
     if(isnull(this))
             {null_error(); exit(EXIT_FAILURE);}
 
+    // Two-pass variance: deviations are taken from the mean, which keeps the
+    // accumulated terms small and avoids the cancellation of E[x^2] - E[x]^2
     ndarray_t x_ = mean(this, axis);
-    
-    if(strcmp("x", axis)==0)
-    {
-        ndarray_t result = array(this->shape[0], 1);
-        double temp=0;
+    ndarray_t result = nd_reduce_axis(this, axis, ND_REDUCE_SQDEV, &x_);
+    clean(&x_, NULL);
 
-        for(int i=0; i<(int)this->shape[0]; i++)
-        {
-            for(int j=0; j<(int)this->shape[1]; j++)
-            {
-                temp += (this->data[i][j] - x_.data[i][0]) * (this->data[i][j] - x_.data[i][0]);
-            }
-            result.data[i][0] = temp/((double)this->shape[1]);
-           
-            temp = 0;
-        }
-        clean(&x_, NULL);    
-        return result;
-    }
-    else if (strcmp("y", axis)==0)
-    {
-        ndarray_t result = array(1, this->shape[1]);
-        double temp=0;
+    double count = (double)this->size;
+    if(strcmp(axis, "x") == 0)
+        count = (double)this->shape[1];
+    else if(strcmp(axis, "y") == 0)
+        count = (double)this->shape[0];
 
-        for(int i=0; i<(int)this->shape[1]; i++)
-        {
-            for(int j=0; j<(int)this->shape[0]; j++)
-            {
-                temp += (this->data[j][i] - x_.data[0][i])*(this->data[j][i] - x_.data[0][i]);
-            }
-            result.data[0][i] = temp/((double)this->shape[0]);
-           
-            temp = 0;
-        }
-        clean(&x_, NULL);
-        return result;
-    }
-    else if (strcmp("all", axis)==0)
+    for(size_t i=0; i<result.shape[0]; i++)
     {
-        ndarray_t result = array(1, 1);
-
-        if(this->size  == 0)    
-        {   
-            zero_error();
-        }
-
-        for(int i=0; i<(int)this->shape[0]; i++)
+        for(size_t j=0; j<result.shape[1]; j++)
         {
-            for(int j=0; j<(int)this->shape[1]; j++)
-            {
-                result.data[0][0] += (this->data[i][j] - x_.data[0][0])*(this->data[i][j] - x_.data[0][0]);
-            }
+            result.data[i][j] = result.data[i][j]/count;
         }
-        result.data[0][0] = result.data[0][0]/(double)this->size;
-        clean(&x_, NULL);
-
-        return result;
     }
-    else
-    { 
-        fprintf(stderr, "Unkown Axis\n");
-        perror("Provide a valid axis\n");
-        exit(1);
-    }  
+    return result;
 }
 
 
@@ -154,40 +71,14 @@ ndarray_t std(ndarray_t *this, char *axis)
     if(isnull(this))
             {null_error(); exit(EXIT_FAILURE);}
 
-    
-    if(strcmp("x", axis) == 0)
-    {
-        ndarray_t result = array(this->shape[0], 1);
+    ndarray_t result = variance(this, axis);
 
-        for(int i=0;i<(int)this->shape[0]; i++)
-        {
-            result.data[i][0] = sqrt(variance(this, axis).data[i][0]);
-        }
-        return result;
-    }
-
-    else if(strcmp("y", axis) == 0)
+    for(size_t i=0; i<result.shape[0]; i++)
     {
-        ndarray_t result = array(1, this->shape[1]);
-
-        for(int i=0;i<(int)this->shape[1]; i++)
+        for(size_t j=0; j<result.shape[1]; j++)
         {
-            result.data[0][i] = sqrt(variance(this, axis).data[0][i]);
+            result.data[i][j] = sqrt(result.data[i][j]);
         }
-        return result;
-    }
-
-    else if(strcmp("all", axis) == 0)
-    {
-        ndarray_t result = array(1, 1);
-
-        result.data[0][0] = sqrt(variance(this, axis).data[0][0]);
-        return result;
-    }
-    else
-    {
-       axis_error(axis);
-       exit(1);
     }
+    return result;
 }
-
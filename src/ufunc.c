@@ -0,0 +1,369 @@
+#include <ndmath/ufunc.h>
+#include <ndmath/reduce.h>
+#include <ndmath/array.h>
+#include <ndmath/error.h>
+#include <ndmath/conditionals.h>
+#include <pthread.h>
+#include <math.h>
+
+#pragma GCC push_options
+#pragma GCC optimize("O3", "unroll-loops")
+
+#define UF_COL_CHUNK 65536      // columns per task, lets single long rows run in parallel
+#define UF_ROW_CHUNK 4096       // rows per task in column reductions
+#define UF_TASK_WORK 32768      // elements per task
+#define UF_MAX_REGISTERED 256
+
+/** Built-in kernels */
+
+ND_BINARY_KERNEL(add_kernel, x + y)
+ND_BINARY_KERNEL(subtract_kernel, x - y)
+ND_BINARY_KERNEL(multiply_kernel, x * y)
+ND_BINARY_KERNEL(divide_kernel, x / y)
+ND_BINARY_KERNEL(maximum_kernel, x > y ? x : y)
+ND_BINARY_KERNEL(minimum_kernel, x < y ? x : y)
+
+ND_UNARY_KERNEL(add_scalar_kernel, x + arg)
+ND_UNARY_KERNEL(subtract_scalar_kernel, x - arg)
+ND_UNARY_KERNEL(multiply_scalar_kernel, x * arg)
+ND_UNARY_KERNEL(divide_scalar_kernel, x / arg)
+ND_UNARY_KERNEL(power_kernel, pow(x, arg))
+
+ND_UNARY_KERNEL(negative_kernel, -x)
+ND_UNARY_KERNEL(abs_kernel, fabs(x))
+ND_UNARY_KERNEL(sqrt_kernel, sqrt(x))
+ND_UNARY_KERNEL(square_kernel, x * x)
+ND_UNARY_KERNEL(cube_kernel, x * x * x)
+ND_UNARY_KERNEL(exp_kernel, exp(x))
+ND_UNARY_KERNEL(log10_kernel, log10(x))
+ND_UNARY_KERNEL(log2_kernel, log2(x))
+
+ND_UNARY_KERNEL(sin_kernel, sin(x))
+ND_UNARY_KERNEL(cos_kernel, cos(x))
+ND_UNARY_KERNEL(tan_kernel, tan(x))
+ND_UNARY_KERNEL(sinh_kernel, sinh(x))
+ND_UNARY_KERNEL(cosh_kernel, cosh(x))
+ND_UNARY_KERNEL(tanh_kernel, tanh(x))
+ND_UNARY_KERNEL(sec_kernel, 1.0 / cos(x))
+ND_UNARY_KERNEL(cosec_kernel, 1.0 / sin(x))
+ND_UNARY_KERNEL(cot_kernel, 1.0 / tan(x))
+
+ND_REDUCE_KERNEL(prod_kernel, 1.0, acc * x)
+ND_REDUCE_KERNEL(max_kernel, -INFINITY, acc > x ? acc : x)
+ND_REDUCE_KERNEL(min_kernel, INFINITY, acc < x ? acc : x)
+
+const nd_ufunc_t nd_ufunc_add      = { "add",      ND_UFUNC_BINARY, NULL, add_kernel, NULL };
+const nd_ufunc_t nd_ufunc_subtract = { "subtract", ND_UFUNC_BINARY, NULL, subtract_kernel, NULL };
+const nd_ufunc_t nd_ufunc_multiply = { "multiply", ND_UFUNC_BINARY, NULL, multiply_kernel, NULL };
+const nd_ufunc_t nd_ufunc_divide   = { "divide",   ND_UFUNC_BINARY, NULL, divide_kernel, NULL };
+const nd_ufunc_t nd_ufunc_maximum  = { "maximum",  ND_UFUNC_BINARY, NULL, maximum_kernel, NULL };
+const nd_ufunc_t nd_ufunc_minimum  = { "minimum",  ND_UFUNC_BINARY, NULL, minimum_kernel, NULL };
+
+const nd_ufunc_t nd_ufunc_add_scalar      = { "add_scalar",      ND_UFUNC_UNARY, add_scalar_kernel, NULL, NULL };
+const nd_ufunc_t nd_ufunc_subtract_scalar = { "subtract_scalar", ND_UFUNC_UNARY, subtract_scalar_kernel, NULL, NULL };
+const nd_ufunc_t nd_ufunc_multiply_scalar = { "multiply_scalar", ND_UFUNC_UNARY, multiply_scalar_kernel, NULL, NULL };
+const nd_ufunc_t nd_ufunc_divide_scalar   = { "divide_scalar",   ND_UFUNC_UNARY, divide_scalar_kernel, NULL, NULL };
+const nd_ufunc_t nd_ufunc_power           = { "power",           ND_UFUNC_UNARY, power_kernel, NULL, NULL };
+
+const nd_ufunc_t nd_ufunc_negative = { "negative", ND_UFUNC_UNARY, negative_kernel, NULL, NULL };
+const nd_ufunc_t nd_ufunc_abs      = { "abs",      ND_UFUNC_UNARY, abs_kernel, NULL, NULL };
+const nd_ufunc_t nd_ufunc_sqrt     = { "sqrt",     ND_UFUNC_UNARY, sqrt_kernel, NULL, NULL };
+const nd_ufunc_t nd_ufunc_square   = { "square",   ND_UFUNC_UNARY, square_kernel, NULL, NULL };
+const nd_ufunc_t nd_ufunc_cube     = { "cube",     ND_UFUNC_UNARY, cube_kernel, NULL, NULL };
+const nd_ufunc_t nd_ufunc_exp      = { "exp",      ND_UFUNC_UNARY, exp_kernel, NULL, NULL };
+const nd_ufunc_t nd_ufunc_log10    = { "log10",    ND_UFUNC_UNARY, log10_kernel, NULL, NULL };
+const nd_ufunc_t nd_ufunc_log2     = { "log2",     ND_UFUNC_UNARY, log2_kernel, NULL, NULL };
+
+const nd_ufunc_t nd_ufunc_sin   = { "sin",   ND_UFUNC_UNARY, sin_kernel, NULL, NULL };
+const nd_ufunc_t nd_ufunc_cos   = { "cos",   ND_UFUNC_UNARY, cos_kernel, NULL, NULL };
+const nd_ufunc_t nd_ufunc_tan   = { "tan",   ND_UFUNC_UNARY, tan_kernel, NULL, NULL };
+const nd_ufunc_t nd_ufunc_sinh  = { "sinh",  ND_UFUNC_UNARY, sinh_kernel, NULL, NULL };
+const nd_ufunc_t nd_ufunc_cosh  = { "cosh",  ND_UFUNC_UNARY, cosh_kernel, NULL, NULL };
+const nd_ufunc_t nd_ufunc_tanh  = { "tanh",  ND_UFUNC_UNARY, tanh_kernel, NULL, NULL };
+const nd_ufunc_t nd_ufunc_sec   = { "sec",   ND_UFUNC_UNARY, sec_kernel, NULL, NULL };
+const nd_ufunc_t nd_ufunc_cosec = { "cosec", ND_UFUNC_UNARY, cosec_kernel, NULL, NULL };
+const nd_ufunc_t nd_ufunc_cot   = { "cot",   ND_UFUNC_UNARY, cot_kernel, NULL, NULL };
+
+const nd_ufunc_t nd_ufunc_sum  = { "sum",  ND_UFUNC_REDUCE, NULL, add_kernel, nd_reduce_sum };
+const nd_ufunc_t nd_ufunc_prod = { "prod", ND_UFUNC_REDUCE, NULL, multiply_kernel, prod_kernel };
+const nd_ufunc_t nd_ufunc_max  = { "max",  ND_UFUNC_REDUCE, NULL, maximum_kernel, max_kernel };
+const nd_ufunc_t nd_ufunc_min  = { "min",  ND_UFUNC_REDUCE, NULL, minimum_kernel, min_kernel };
+
+static const nd_ufunc_t *const builtins[] = {
+    &nd_ufunc_add, &nd_ufunc_subtract, &nd_ufunc_multiply, &nd_ufunc_divide,
+    &nd_ufunc_maximum, &nd_ufunc_minimum,
+    &nd_ufunc_add_scalar, &nd_ufunc_subtract_scalar, &nd_ufunc_multiply_scalar,
+    &nd_ufunc_divide_scalar, &nd_ufunc_power,
+    &nd_ufunc_negative, &nd_ufunc_abs, &nd_ufunc_sqrt, &nd_ufunc_square, &nd_ufunc_cube,
+    &nd_ufunc_exp, &nd_ufunc_log10, &nd_ufunc_log2,
+    &nd_ufunc_sin, &nd_ufunc_cos, &nd_ufunc_tan, &nd_ufunc_sinh, &nd_ufunc_cosh,
+    &nd_ufunc_tanh, &nd_ufunc_sec, &nd_ufunc_cosec, &nd_ufunc_cot,
+    &nd_ufunc_sum, &nd_ufunc_prod, &nd_ufunc_max, &nd_ufunc_min,
+};
+
+/** Registry */
+
+static const nd_ufunc_t *registered[UF_MAX_REGISTERED];
+static size_t nregistered = 0;
+static pthread_mutex_t registry_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+    void nd_ufunc_register(const nd_ufunc_t *ufunc)
+    {
+        if (ufunc == NULL || ufunc->name == NULL)
+            {null_error(); exit(EXIT_FAILURE);}
+
+        pthread_mutex_lock(&registry_mutex);
+        if (nregistered == UF_MAX_REGISTERED)
+        {
+            pthread_mutex_unlock(&registry_mutex);
+            TRACE();
+            fprintf(stderr, "UFUNC REGISTRY FULL: cannot register %s\n", ufunc->name);
+            exit(EXIT_FAILURE);
+        }
+        registered[nregistered++] = ufunc;
+        pthread_mutex_unlock(&registry_mutex);
+    }
+
+    const nd_ufunc_t *nd_ufunc_find(const char *name)
+    {
+        const nd_ufunc_t *found = NULL;
+
+        if (name == NULL)
+            return NULL;
+
+        pthread_mutex_lock(&registry_mutex);
+        for (size_t i = nregistered; i > 0 && found == NULL; i--)
+            if (strcmp(registered[i - 1]->name, name) == 0)
+                found = registered[i - 1];
+        pthread_mutex_unlock(&registry_mutex);
+
+        for (size_t i = 0; i < sizeof(builtins) / sizeof(builtins[0]) && found == NULL; i++)
+            if (strcmp(builtins[i]->name, name) == 0)
+                found = builtins[i];
+
+        return found;
+    }
+
+/** Element-wise execution */
+
+typedef struct {
+    const nd_ufunc_t *ufunc;
+    ndarray_t *a;
+    ndarray_t *b;
+    ndarray_t *out;
+    double arg;
+    size_t ncol_chunks;
+} elementwise_ctx_t;
+
+    static void check_kind(const nd_ufunc_t *ufunc, nd_ufunc_kind_t kind)
+    {
+        if (ufunc == NULL)
+            {null_error(); exit(EXIT_FAILURE);}
+
+        bool ok = ufunc->kind == kind;
+        if (kind == ND_UFUNC_UNARY)
+            ok = ok && ufunc->unary != NULL;
+        else if (kind == ND_UFUNC_BINARY)
+            ok = ok && ufunc->binary != NULL;
+        else
+            ok = ok && ufunc->reduce != NULL && ufunc->binary != NULL;
+
+        if (!ok)
+        {
+            TRACE();
+            fprintf(stderr, "UFUNC ERROR: %s cannot be applied this way\n", ufunc->name ? ufunc->name : "(unnamed)");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    static ndarray_t prepare_out(ndarray_t *out, size_t rows, size_t cols)
+    {
+        if (out == NULL)
+            return array(rows, cols);
+
+        if (isnull(out))
+            {null_error(); exit(EXIT_FAILURE);}
+        if (out->shape[0] != rows || out->shape[1] != cols)
+        {
+            fprintf(stderr, "Invalid output dimensions %ldx%ld, expected %ldx%ld\n", out->shape[0], out->shape[1], rows, cols);
+            perror("Use valid ndarray_t dimesions please\n");
+            exit(1);
+        }
+        return *out;
+    }
+
+    static void elementwise_task(size_t begin, size_t end, void *arg)
+    {
+        elementwise_ctx_t *ctx = arg;
+        size_t cols = ctx->out->shape[1];
+
+        for (size_t t = begin; t < end; t++)
+        {
+            size_t i = t / ctx->ncol_chunks;
+            size_t c0 = (t % ctx->ncol_chunks) * UF_COL_CHUNK;
+            size_t w = c0 + UF_COL_CHUNK < cols ? UF_COL_CHUNK : cols - c0;
+            double *po = ctx->out->data[i] + c0;
+
+            size_t sa = ctx->a->shape[1] == 1 && cols > 1 ? 0 : 1;
+            const double *pa = ctx->a->data[ctx->a->shape[0] == 1 ? 0 : i] + sa * c0;
+
+            if (ctx->b == NULL)
+            {
+                ctx->ufunc->unary(pa, po, w, ctx->arg);
+                continue;
+            }
+
+            size_t sb = ctx->b->shape[1] == 1 && cols > 1 ? 0 : 1;
+            const double *pb = ctx->b->data[ctx->b->shape[0] == 1 ? 0 : i] + sb * c0;
+            ctx->ufunc->binary(pa, sa, pb, sb, po, w);
+        }
+    }
+
+    static void run_elementwise(elementwise_ctx_t *ctx)
+    {
+        size_t rows = ctx->out->shape[0];
+        size_t cols = ctx->out->shape[1];
+        size_t width = cols < UF_COL_CHUNK ? cols : UF_COL_CHUNK;
+
+        ctx->ncol_chunks = (cols + UF_COL_CHUNK - 1) / UF_COL_CHUNK;
+        nd_parallel_for(rows * ctx->ncol_chunks, UF_TASK_WORK / width > 0 ? UF_TASK_WORK / width : 1,
+                        elementwise_task, ctx);
+    }
+
+    ndarray_t nd_ufunc_unary(const nd_ufunc_t *ufunc, ndarray_t *this, ndarray_t *out, double arg)
+    {
+        check_kind(ufunc, ND_UFUNC_UNARY);
+        if(isnull(this))
+            {null_error(); exit(EXIT_FAILURE);}
+
+        ndarray_t result = prepare_out(out, this->shape[0], this->shape[1]);
+
+        elementwise_ctx_t ctx = { ufunc, this, NULL, &result, arg, 0 };
+        run_elementwise(&ctx);
+        return result;
+    }
+
+    ndarray_t nd_ufunc_binary(const nd_ufunc_t *ufunc, ndarray_t *a, ndarray_t *b, ndarray_t *out)
+    {
+        check_kind(ufunc, ND_UFUNC_BINARY);
+        if(isnull(a))
+            {null_error(); exit(EXIT_FAILURE);}
+        if(isnull(b))
+            {null_error(); exit(EXIT_FAILURE);}
+
+        size_t shape[2];
+        for (int d = 0; d < 2; d++)
+        {
+            if (a->shape[d] != b->shape[d] && a->shape[d] != 1 && b->shape[d] != 1)
+            {
+                fprintf(stderr, "Invalid dimensions %ldx%ld and %ldx%ld for %s\n", a->shape[0], a->shape[1], b->shape[0], b->shape[1], ufunc->name);
+                perror("Use valid ndarray_t dimesions please\n");
+                exit(1);
+            }
+            shape[d] = a->shape[d] > b->shape[d] ? a->shape[d] : b->shape[d];
+        }
+
+        ndarray_t result = prepare_out(out, shape[0], shape[1]);
+
+        elementwise_ctx_t ctx = { ufunc, a, b, &result, 0.0, 0 };
+        run_elementwise(&ctx);
+        return result;
+    }
+
+/** Reductions */
+
+typedef struct {
+    const nd_ufunc_t *ufunc;
+    ndarray_t *src;
+    double *out;
+    size_t ncol_chunks;
+} reduction_ctx_t;
+
+    static void reduce_rows_task(size_t begin, size_t end, void *arg)
+    {
+        reduction_ctx_t *ctx = arg;
+        for (size_t i = begin; i < end; i++)
+            ctx->out[i] = ctx->ufunc->reduce(ctx->src->data[i], ctx->src->shape[1]);
+    }
+
+    static void reduce_columns_task(size_t begin, size_t end, void *arg)
+    {
+        reduction_ctx_t *ctx = arg;
+        size_t rows = ctx->src->shape[0];
+        size_t cols = ctx->src->shape[1];
+
+        for (size_t t = begin; t < end; t++)
+        {
+            size_t r0 = (t / ctx->ncol_chunks) * UF_ROW_CHUNK;
+            size_t r1 = r0 + UF_ROW_CHUNK < rows ? r0 + UF_ROW_CHUNK : rows;
+            size_t c0 = (t % ctx->ncol_chunks) * UF_COL_CHUNK;
+            size_t w = c0 + UF_COL_CHUNK < cols ? UF_COL_CHUNK : cols - c0;
+            double *acc = ctx->out + (r0 / UF_ROW_CHUNK) * cols + c0;
+
+            memcpy(acc, ctx->src->data[r0] + c0, w * sizeof(double));
+            for (size_t i = r0 + 1; i < r1; i++)
+                ctx->ufunc->binary(acc, 1, ctx->src->data[i] + c0, 1, acc, w);
+        }
+    }
+
+    ndarray_t nd_ufunc_reduce(const nd_ufunc_t *ufunc, ndarray_t *this, char *axis)
+    {
+        check_kind(ufunc, ND_UFUNC_REDUCE);
+        if(isnull(this))
+            {null_error(); exit(EXIT_FAILURE);}
+
+        size_t rows = this->shape[0];
+        size_t cols = this->shape[1];
+        size_t grain = UF_TASK_WORK / cols > 0 ? UF_TASK_WORK / cols : 1;
+        reduction_ctx_t ctx = { ufunc, this, NULL, 0 };
+
+        if(strcmp(axis, "x") == 0 || strcmp(axis, "all") == 0)
+        {
+            ctx.out = malloc(rows * sizeof(double));
+            if(ctx.out == NULL)
+                malloc_error();
+
+            nd_parallel_for(rows, grain, reduce_rows_task, &ctx);
+
+            ndarray_t result;
+            if(strcmp(axis, "x") == 0)
+            {
+                result = array(rows, 1);
+                for(size_t i = 0; i < rows; i++)
+                    result.data[i][0] = ctx.out[i];
+            }
+            else
+            {
+                result = array(1, 1);
+                result.data[0][0] = ufunc->reduce(ctx.out, rows);
+            }
+            free(ctx.out);
+            return result;
+        }
+        else if(strcmp(axis, "y") == 0)
+        {
+            size_t nrow_chunks = (rows + UF_ROW_CHUNK - 1) / UF_ROW_CHUNK;
+            ctx.ncol_chunks = (cols + UF_COL_CHUNK - 1) / UF_COL_CHUNK;
+            ctx.out = malloc(nrow_chunks * cols * sizeof(double));
+            if(ctx.out == NULL)
+                malloc_error();
+
+            nd_parallel_for(nrow_chunks * ctx.ncol_chunks, 1, reduce_columns_task, &ctx);
+
+            // Chunk partials are folded in order, independent of the thread count
+            for(size_t p = 1; p < nrow_chunks; p++)
+                ufunc->binary(ctx.out, 1, ctx.out + p * cols, 1, ctx.out, cols);
+
+            ndarray_t result = array(1, cols);
+            memcpy(result.data[0], ctx.out, cols * sizeof(double));
+            free(ctx.out);
+            return result;
+        }
+        else
+        {
+            axis_error(axis);
+            exit(1);
+        }
+    }
+
+#pragma GCC pop_options
@@ -9,6 +9,15 @@
 #include <ndmath/random.h>
 #include <ndmath/trig.h>
 #include <ndmath/statistics.h>
+#include <ndmath/reduce.h>
+#include <ndmath/mask.h>
+#include <ndmath/sort.h>
+#include <ndmath/blas.h>
+#include <ndmath/decomp.h>
+#include <ndmath/iterative.h>
+#include <ndmath/cache.h>
+#include <ndmath/backend.h>
+#include <ndmath/batched.h>
 
 int main()
 {
@@ -62,7 +71,100 @@ int main()
     
     ndarray_t z = cslice(&l, 4, 5);
 
-    ndarray_t aa = cassign(&q, &o, 9, 1);
+    ndarray_t sum_y = nd_sum_axis(&l, "y");
+
+    ndarray_t cum_x = nd_cumsum(&l, NULL, "x");
+
+    nd_mask_t above = nd_compare_scalar(&l, ">", 12.0);
+    ndarray_t kept = nd_compress(&l, &above, "all");
+    nd_mask_free(&above);
+
+    ndarray_t top2 = nd_topk(&l, 2, "y", true, NULL);
+
+    ndarray_t gram = zeros(l.shape[1], l.shape[1]);
+    nd_gemm(ND_TRANS, ND_NO_TRANS, 1.0, &l, &l, 0.0, &gram);
+
+    ndarray_t spd = identity(l.shape[1], l.shape[1]);
+    nd_gemm(ND_TRANS, ND_NO_TRANS, 1.0, &l, &l, 1.0, &spd);
+    nd_cholesky_t chol = nd_cholesky(&spd);
+    ndarray_t spd_solve = nd_cholesky_solve(&chol, &gram);
+    printf("log det of I + Gram = %lf\n", chol.logdet);
+    ndarray_t spd_trsm = copy(&gram);
+    nd_trsm(ND_LEFT, ND_LOWER, ND_NO_TRANS, ND_NON_UNIT, 1.0, &chol.L, &spd_trsm, &spd_trsm);
+    nd_trsm(ND_LEFT, ND_LOWER, ND_TRANS, ND_NON_UNIT, 1.0, &chol.L, &spd_trsm, &spd_trsm);
+    ndarray_t spd_trmm = transpose(&chol.L);
+    nd_trmm(ND_LEFT, ND_LOWER, ND_NO_TRANS, ND_NON_UNIT, 1.0, &chol.L, &spd_trmm, &spd_trmm);
+    ndarray_t obs = nd_view(&l, 0, 0, 1, l.shape[1]);
+    bool downdated = nd_cholesky_downdate(&chol, &obs);
+    printf("log det without the first row of l = %lf (%d)\n", chol.logdet, downdated);
+    nd_cholesky_update(&chol, &obs);
+    ndarray_t obs_col = transpose(&obs);
+    nd_view_free(&obs);
+    ndarray_t spd_inv = inv(&spd);
+    nd_inv_update(&spd_inv, &obs_col, &obs_col);
+    nd_cholesky_free(&chol);
+
+    nd_qr_t fq = nd_qr(&spd, true);
+    ndarray_t spd_qr = nd_qr_solve(&fq, &gram);
+    nd_qr_free(&fq);
+
+    nd_eigh_t eh = nd_eigh(&spd, false);
+    nd_eigh_t eh_top = nd_eigh_range(&spd, spd.shape[0] - 2, 2, true);
+
+    nd_svd_t sv = nd_svd(&l, ND_SVD_THIN);
+    nd_svd_t rsv = nd_svd_randomized(&l, 2, 3, 1, 7);
+
+    ndarray_t l_rhs = ones(l.shape[0], 1);
+    nd_lstsq_t fit = nd_lstsq(&l, &l_rhs);
+    printf("lstsq of l: rank %zu, through the SVD %d\n", fit.rank, fit.used_svd);
+    nd_normal_eq_t ne = nd_normal_eq(l.shape[1], 1);
+    for(size_t first = 0; first < l.shape[0]; first += 4)
+    {
+        size_t rows = first + 4 < l.shape[0] ? 4 : l.shape[0] - first;
+        ndarray_t l_rows = nd_view(&l, first, 0, rows, l.shape[1]);
+        ndarray_t rhs_rows = nd_view(&l_rhs, first, 0, rows, 1);
+        nd_normal_eq_add(&ne, &l_rows, &rhs_rows);
+        nd_view_free(&l_rows);
+        nd_view_free(&rhs_rows);
+    }
+    nd_lstsq_t fit_ne = nd_normal_eq_solve(&ne);
+    nd_normal_eq_free(&ne);
+
+    nd_mixed_t mixed = nd_solve_mixed(&spd, &gram);
+    printf("mixed precision on I + Gram: %zu refinement steps, Cholesky %d, fallback %d\n",
+           mixed.iterations, mixed.cholesky, mixed.fallback);
+
+    // Leading 3x3 block of I + Gram, plus item on the diagonal, as one row per item
+    ndarray_t spd_batch = zeros(4, 9);
+    for(size_t item = 0; item < spd_batch.shape[0]; item++)
+        for(size_t entry = 0; entry < 9; entry++)
+            spd_batch.data[item][entry] = spd.data[entry / 3][entry % 3] + (entry % 4 == 0 ? item : 0);
+    ndarray_t batch_rhs = ones(4, 3);
+    ndarray_t batch_x = nd_batched_solve(&spd_batch, &batch_rhs);
+    ndarray_t batch_inv = nd_batched_inv(&spd_batch);
+
+    nd_csr_t spd_csr = nd_csr_from_dense(&spd, 0.0);
+    nd_operator_t spd_op = nd_operator_csr(&spd_csr);
+    nd_precond_t jacobi = nd_precond_jacobi(&spd_csr);
+    nd_krylov_opts_t kopts = nd_krylov_defaults();
+    kopts.precond = &jacobi;
+    ndarray_t spd_rhs = ones(spd.shape[0], 1);
+    nd_krylov_t kcg = nd_cg(&spd_op, &spd_rhs, NULL, &kopts);
+    printf("CG on I + Gram: %zu iterations, converged %d\n", kcg.iterations, kcg.converged);
+    nd_krylov_t kgm = nd_gmres(&spd_op, &spd_rhs, NULL, NULL);
+    bool gmres_trace_ok = kgm.trace.data[0][0] == 1.0;
+    for(size_t it = 0; it < kgm.trace.shape[1]; it++)
+        gmres_trace_ok = gmres_trace_ok && kgm.trace.data[0][it] >= 0.0
+                         && (it == 0 || kgm.trace.data[0][it] <= kgm.trace.data[0][it - 1]);
+    printf("GMRES on I + Gram: %zu iterations, trace from 1 and non-increasing %d\n",
+           kgm.iterations, gmres_trace_ok);
+    nd_krylov_free(&kgm);
+    nd_eigs_t lz = nd_lanczos(&spd_op, 2, NULL);
+    printf("Lanczos on I + Gram: %zu restarts, converged %d\n", lz.restarts, lz.converged);
+    nd_precond_free(&jacobi);
+    nd_csr_free(&spd_csr);
+
+    ndarray_t aa = cassign(&q, &o, 0, 1);
 
     ndarray_t XX = array(3, 3);
 
@@ -79,6 +181,24 @@ int main()
     XX.data[2][1] = -100;
     XX.data[2][2] =  32;
 
+    nd_lu_t lu = nd_lu(&XX);
+    ndarray_t XX_solve = nd_lu_solve(&lu, &XX);
+    nd_lu_free(&lu);
+
+    nd_cache_set_budget(1 << 20);
+    ndarray_t XX_cached = nd_cache_solve(&XX, &XX, ND_FACT_LU);
+    double XX_det = det(&XX);
+    printf("det of XX = %lf, LU cache hits %zu\n", XX_det, nd_cache_stats().hits);
+    nd_slogdet_t spd_ld = nd_slogdet(&spd);
+    printf("slogdet of I + Gram: sign %.0lf, log|det| %lf\n", spd_ld.sign, spd_ld.logabsdet);
+    nd_cache_set_budget(0);
+
+    printf("dense kernels: %s\n", nd_get_backend() == ND_BACKEND_EXTERNAL ? nd_backend_name() : "builtin");
+    ndarray_t XX_cube = nd_matrix_power(&XX, 3);
+    ndarray_t r_exp = nd_expm(&r);
+    ndarray_t *chain[] = {&q, &l, &gram};
+    ndarray_t chain_prod = nd_multi_matmul(chain, 3);
+
     ndarray_t R;
     ndarray_t Q;   
 
@@ -111,7 +231,31 @@ int main()
         {"shuffle", &u}, {"Inverse", &v}, {"Product of x and inv(x)", &w},
         {"Norm of k", &x}, {"row slice of l", &y}, {"col slice of l", &z},
         {"Q", &Q}, {"R", &R}, {"XX", &XX},{"test Q-R", &test}, {"Assign", &aa},
-        {"eig val", &eig_v}, {"svd", &svd_v}
+        {"eig val", &eig_v}, {"svd", &svd_v}, {"column sums of l", &sum_y},
+        {"cumsum of l", &cum_x}, {"elements of l above 12", &kept},
+        {"top 2 of each column of l", &top2}, {"Gram matrix of l", &gram},
+        {"XX solved against itself", &XX_solve},
+        {"the same with a cached LU", &XX_cached}, {"XX cubed", &XX_cube},
+        {"exponential of r", &r_exp}, {"q l Gram in the cheapest order", &chain_prod}, {"I + Gram", &spd},
+        {"Gram solved against I + Gram", &spd_solve},
+        {"the same by two triangular solves", &spd_trsm},
+        {"I + Gram rebuilt as L Lᵀ", &spd_trmm},
+        {"inverse of I + Gram with the first row of l added again", &spd_inv},
+        {"Gram solved against I + Gram by pivoted QR", &spd_qr},
+        {"the same in float32 with double refinement", &mixed.x},
+        {"batch of 3x3 blocks of I + Gram", &spd_batch},
+        {"each solved against ones", &batch_x},
+        {"their inverses", &batch_inv},
+        {"eigenvalues of I + Gram", &eh.values},
+        {"2 largest eigenvalues of I + Gram", &eh_top.values},
+        {"their eigenvectors", &eh_top.vectors},
+        {"singular values of l", &sv.S},
+        {"2 leading singular values of l, randomized", &rsv.S},
+        {"I + Gram solved against ones by CG", &kcg.x},
+        {"its relative residuals", &kcg.trace},
+        {"2 largest eigenvalues of I + Gram by Lanczos", &lz.values},
+        {"l solved against ones by least squares", &fit.x},
+        {"the same from normal equations over batches of 4 rows", &fit_ne.x}
     };
 
     print_all_arrays(arrays, sizeof(arrays) / sizeof(arrays[0]));
@@ -124,10 +268,11 @@ int main()
     printf("after printing\n\n");
 
     clean_all_arrays(arrays, sizeof(arrays) / sizeof(arrays[0]));
+    clean(&sv.U, &sv.Vt, &rsv.U, &rsv.Vt, &spd_rhs, &l_rhs, &lz.imag, &lz.vectors, &obs_col, &batch_rhs, NULL);
 
     stop = clock();
     double t2 = ((double)(stop-start))/CLOCKS_PER_SEC;
     printf("Liberation terminer\n\n");
     printf("Temps d'execution = %.12lf\n", t2);
-    return 0;
+    return gmres_trace_ok ? 0 : 1;
 }